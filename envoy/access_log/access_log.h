@@ -53,6 +53,19 @@ public:
    */
   virtual AccessLogFileSharedPtr
   createAccessLog(const Envoy::Filesystem::FilePathAndType& file_info) PURE;
+
+  /**
+   * Create a new access log file managed by the access log manager, whose writing threads buffer
+   * their writes into rings rather than into a buffer shared under a lock. A file already managed
+   * keeps the buffering it was created with.
+   * @param file_info specifies the file to create/open.
+   * @param write_ring_size specifies the size in bytes of the ring of each writing thread, or 0
+   *        to buffer the writes of all threads in a shared buffer.
+   * @return the opened file.
+   */
+  virtual AccessLogFileSharedPtr
+  createAccessLog(const Envoy::Filesystem::FilePathAndType& file_info,
+                  uint64_t write_ring_size) PURE;
 };
 
 using AccessLogManagerPtr = std::unique_ptr<AccessLogManager>;
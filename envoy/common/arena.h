@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+
+/**
+ * Memory from which the objects sharing a lifetime, e.g. those of a stream, are allocated. The
+ * objects are not freed individually: all of the memory is freed at once when the arena is
+ * destroyed. The destructors of the objects are not run by the arena.
+ */
+class Arena {
+public:
+  virtual ~Arena() = default;
+
+  /**
+   * Allocate memory, valid until the arena is destroyed.
+   * @param size supplies the size of the memory.
+   * @param alignment supplies the alignment of the memory, a power of 2.
+   * @return void* the memory.
+   */
+  virtual void* allocate(size_t size, size_t alignment) PURE;
+};
+
+} // namespace Envoy
@@ -91,6 +91,16 @@ public:
    * @return true if a connection was preconnected, false otherwise.
    */
   virtual bool maybePreconnect(float preconnect_ratio) PURE;
+
+  /**
+   * Creates upstream connections ahead of demand, so that the pool can serve the given number of
+   * additional streams without waiting for a connection to be established.
+   *
+   * @param unused_capacity the number of streams the pool should be able to serve immediately.
+   * @param max_new_connections the maximum number of connections to create.
+   * @return the number of connections created.
+   */
+  virtual uint32_t prewarm(uint32_t unused_capacity, uint32_t max_new_connections) PURE;
 };
 
 enum class PoolFailureReason {
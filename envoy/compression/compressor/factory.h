@@ -13,6 +13,13 @@ public:
   virtual CompressorPtr createCompressor() PURE;
   virtual const std::string& statsPrefix() const PURE;
   virtual const std::string& contentEncoding() const PURE;
+
+  /**
+   * @return true if the concatenation of finished streams, each produced by a separate compressor
+   *         of this factory, is itself a valid stream decoding to the concatenated input, as with
+   *         gzip members or zstd frames. This allows a body to be compressed in independent blocks.
+   */
+  virtual bool supportsConcatenatedStreams() const { return false; }
 };
 
 using CompressorFactoryPtr = std::unique_ptr<CompressorFactory>;
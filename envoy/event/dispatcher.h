@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -51,6 +52,15 @@ struct DispatcherStats {
 
 using DispatcherStatsPtr = std::unique_ptr<DispatcherStats>;
 
+/**
+ * The share of an event loop iteration a connection may spend reading before yielding to the other
+ * connections of the dispatcher. Zero means no limit.
+ */
+struct ConnectionReadBudget {
+  uint64_t max_bytes_{};
+  std::chrono::microseconds max_time_{};
+};
+
 /**
  * Callback invoked when a dispatcher post() runs.
  */
@@ -149,6 +159,15 @@ public:
    */
   virtual Event::TimerPtr createScaledTimer(Event::ScaledTimerMinimum minimum, TimerCb cb) PURE;
 
+  /**
+   * Allocates a coarse timer. If the timer wheel is enabled by the bootstrap, the timer fires on
+   * the first millisecond tick after its timeout rather than at its exact time, but is armed and
+   * disabled in constant time. Otherwise it is a regular timer. Suited to timeouts, of which a
+   * worker may have many armed. @see Timer for docs on how to use the timer.
+   * @param cb supplies the callback to invoke when the timer fires.
+   */
+  virtual Event::TimerPtr createCoarseTimer(TimerCb cb) PURE;
+
   /**
    * Allocates a schedulable callback. @see SchedulableCallback for docs on how to use the wrapped
    * callback.
@@ -277,6 +296,13 @@ public:
    */
   virtual Buffer::WatermarkFactory& getWatermarkFactory() PURE;
 
+  /**
+   * @return the budget of each connection reading in an iteration of the event loop. A connection
+   *         which exhausts it resumes reading at the next iteration, after the events of the other
+   *         connections.
+   */
+  virtual const ConnectionReadBudget& connectionReadBudget() const PURE;
+
   /**
    * Updates approximate monotonic time to current value.
    */
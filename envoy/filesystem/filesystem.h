@@ -183,6 +183,15 @@ public:
    */
   virtual Api::IoCallBoolResult createPath(absl::string_view path) PURE;
 
+  /**
+   * Atomically renames a file, replacing the destination if it exists.
+   * @param old_path the path of the file to rename.
+   * @param new_path the new path of the file.
+   * @return bool true if the file was renamed, or an error status.
+   */
+  virtual Api::IoCallBoolResult rename(const std::string& old_path,
+                                       const std::string& new_path) PURE;
+
   /**
    * @return bool whether a directory exists on disk and can be opened for read.
    */
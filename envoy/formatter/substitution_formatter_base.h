@@ -27,6 +27,19 @@ public:
    */
   virtual std::string formatWithContext(const FormatterContext& context,
                                         const StreamInfo::StreamInfo& stream_info) const PURE;
+
+  /**
+   * Append a formatted substitution line to the output. This lets callers reuse the output
+   * buffer across lines, and formatters avoid building intermediate strings.
+   * @param context supplies the formatter context.
+   * @param stream_info supplies the stream info.
+   * @param output supplies the string to append the line to.
+   */
+  virtual void appendWithContext(const FormatterContext& context,
+                                 const StreamInfo::StreamInfo& stream_info,
+                                 std::string& output) const {
+    output.append(formatWithContext(context, stream_info));
+  }
 };
 
 template <class FormatterContext>
@@ -60,6 +73,25 @@ public:
   virtual ProtobufWkt::Value
   formatValueWithContext(const FormatterContext& context,
                          const StreamInfo::StreamInfo& stream_info) const PURE;
+
+  /**
+   * Append the value to the output, which is equivalent to formatWithContext() but does not
+   * require allocating a string for the value. Providers on the hot path should override this.
+   * @param context supplies the formatter context.
+   * @param stream_info supplies the stream info.
+   * @param output supplies the string to append the value to.
+   * @return bool false if there is no value, in which case nothing was appended.
+   */
+  virtual bool appendWithContext(const FormatterContext& context,
+                                 const StreamInfo::StreamInfo& stream_info,
+                                 std::string& output) const {
+    const absl::optional<std::string> value = formatWithContext(context, stream_info);
+    if (!value.has_value()) {
+      return false;
+    }
+    output.append(value.value());
+    return true;
+  }
 };
 
 template <class FormatterContext>
@@ -7,6 +7,8 @@
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/buffer/buffer.h"
+#include "envoy/common/arena.h"
+#include "envoy/common/optref.h"
 #include "envoy/common/scope_tracker.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/grpc/status.h"
@@ -1135,6 +1137,39 @@ class StreamFilter : public virtual StreamDecoderFilter, public virtual StreamEn
 
 using StreamFilterSharedPtr = std::shared_ptr<StreamFilter>;
 
+/**
+ * Implemented by the filters which may be reset and reused by a later stream rather than destroyed
+ * with their stream. Such filters are recycled by the filter chains opting in, see
+ * Http::FilterRecycler. A filter allocated from the arena of its stream, see
+ * FilterChainFactoryCallbacks::streamArena(), must not implement it.
+ */
+class ResettableFilter {
+public:
+  virtual ~ResettableFilter() = default;
+
+  /**
+   * Reset the filter to the state it had when constructed by its factory. Called on the worker
+   * thread of the filter once its stream dropped its references to the filter, which is after
+   * onDestroy(). A later stream of the same worker may then reuse the filter, starting with the
+   * setting of its callbacks.
+   */
+  virtual void resetForReuse() PURE;
+};
+
+/**
+ * Callbacks notified once a stream dropped its references to its filters.
+ */
+class FilterReleaseCallbacks {
+public:
+  virtual ~FilterReleaseCallbacks() = default;
+
+  /**
+   * Called on the destruction of the filter manager of the stream, after the destruction of its
+   * filter wrappers. The callbacks are not referenced by the stream afterwards.
+   */
+  virtual void onFiltersReleased() PURE;
+};
+
 class HttpMatchingData {
 public:
   static absl::string_view name() { return "http"; }
@@ -1196,6 +1231,22 @@ public:
    * @param return the worker thread's dispatcher.
    */
   virtual Event::Dispatcher& dispatcher() PURE;
+
+  /**
+   * Allows filters to allocate their instances, and the objects living as long as them, from the
+   * arena of the stream, which is freed at once with the stream rather than object by object. A
+   * filter allocated from the arena must not be referenced, even weakly, after the stream is
+   * destroyed, e.g. by callbacks posted to the dispatcher.
+   * @return the arena of the stream, if any.
+   */
+  virtual OptRef<Arena> streamArena() PURE;
+
+  /**
+   * Register callbacks notified once the stream dropped its references to its filters, e.g. to
+   * recycle them. The callbacks must stay valid until notified.
+   * @param callbacks supplies the callbacks to notify.
+   */
+  virtual void addFilterReleaseCallbacks(FilterReleaseCallbacks& callbacks) PURE;
 };
 } // namespace Http
 } // namespace Envoy
@@ -111,6 +111,12 @@ private:
 #define ENVOY_SOCKET_UDP_GRO Network::SocketOptionName()
 #endif
 
+#ifdef UDP_SEGMENT
+#define ENVOY_SOCKET_UDP_SEGMENT ENVOY_MAKE_SOCKET_OPTION_NAME(SOL_UDP, UDP_SEGMENT)
+#else
+#define ENVOY_SOCKET_UDP_SEGMENT Network::SocketOptionName()
+#endif
+
 #ifdef TCP_KEEPCNT
 #define ENVOY_SOCKET_TCP_KEEPCNT ENVOY_MAKE_SOCKET_OPTION_NAME(IPPROTO_TCP, TCP_KEEPCNT)
 #else
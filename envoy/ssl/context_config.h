@@ -3,6 +3,7 @@
 #include <array>
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -13,11 +14,45 @@
 
 #include "source/common/network/cidr_range.h"
 
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Ssl {
 
+/**
+ * A cache of serialized TLS sessions for stateful session resumption, which may be shared by
+ * several server contexts. All methods are thread-safe.
+ */
+class SessionCache {
+public:
+  virtual ~SessionCache() = default;
+
+  /**
+   * Adds a session to the cache, replacing any session with the same ID.
+   * @param session_id supplies the session ID.
+   * @param session supplies the serialized session.
+   * @param timeout supplies the lifetime of the session.
+   */
+  virtual void insert(absl::string_view session_id, std::string&& session,
+                      std::chrono::seconds timeout) PURE;
+
+  /**
+   * @return the serialized session with the given ID, if it is cached and has not expired.
+   */
+  virtual absl::optional<std::string> lookup(absl::string_view session_id) PURE;
+
+  /**
+   * Removes the session with the given ID from the cache, if present.
+   */
+  virtual void remove(absl::string_view session_id) PURE;
+};
+
+using SessionCacheSharedPtr = std::shared_ptr<SessionCache>;
+
+class SessionTicketKeyProvider;
+using SessionTicketKeyProviderSharedPtr = std::shared_ptr<SessionTicketKeyProvider>;
+
 /**
  * Supplies the configuration for an SSL context.
  */
@@ -117,6 +152,12 @@ public:
    * @return the access log manager object reference
    */
   virtual AccessLog::AccessLogManager& accessLogManager() const PURE;
+
+  /**
+   * @return true if the record protection of established connections should be offloaded to the
+   * kernel, when supported.
+   */
+  virtual bool kernelTlsOffload() const PURE;
 };
 
 class ClientContextConfig : public virtual ContextConfig {
@@ -199,9 +240,38 @@ public:
    * downstream TLS handshake, false otherwise.
    */
   virtual bool fullScanCertsOnSNIMismatch() const PURE;
+
+  /**
+   * @return the cache shared with other server contexts for stateful session resumption, or
+   * nullptr if each context should use its own cache.
+   */
+  virtual SessionCacheSharedPtr sessionCache() const PURE;
+
+  /**
+   * @return the provider of the session ticket keys if they change over time, in which case
+   * sessionTicketKeys() is empty, or nullptr otherwise.
+   */
+  virtual SessionTicketKeyProviderSharedPtr sessionTicketKeyProvider() const PURE;
 };
 
 using ServerContextConfigPtr = std::unique_ptr<ServerContextConfig>;
 
+using SessionTicketKeysConstSharedPtr =
+    std::shared_ptr<const std::vector<ServerContextConfig::SessionTicketKey>>;
+
+/**
+ * Supplies session ticket keys which change over time, e.g. because they are rotated.
+ */
+class SessionTicketKeyProvider {
+public:
+  virtual ~SessionTicketKeyProvider() = default;
+
+  /**
+   * @return the current keys, which are never empty. The first key is used for encrypting new
+   * tickets, and all the keys are candidates for decrypting received tickets. Thread-safe.
+   */
+  virtual SessionTicketKeysConstSharedPtr keys() const PURE;
+};
+
 } // namespace Ssl
 } // namespace Envoy
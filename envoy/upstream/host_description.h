@@ -31,12 +31,14 @@ using MetadataConstSharedPtr = std::shared_ptr<const envoy::config::core::v3::Me
  */
 #define ALL_HOST_STATS(COUNTER, GAUGE)                                                             \
   COUNTER(cx_connect_fail)                                                                         \
+  COUNTER(cx_prewarm)                                                                              \
   COUNTER(cx_total)                                                                                \
   COUNTER(rq_error)                                                                                \
   COUNTER(rq_success)                                                                              \
   COUNTER(rq_timeout)                                                                              \
   COUNTER(rq_total)                                                                                \
   GAUGE(cx_active)                                                                                 \
+  GAUGE(cx_warm)                                                                                   \
   GAUGE(rq_active)
 
 /**
@@ -767,7 +767,8 @@ public:
   GAUGE(upstream_rq_active, Accumulate)                                                            \
   GAUGE(upstream_rq_pending_active, Accumulate)                                                    \
   HISTOGRAM(upstream_cx_connect_ms, Milliseconds)                                                  \
-  HISTOGRAM(upstream_cx_length_ms, Milliseconds)
+  HISTOGRAM(upstream_cx_length_ms, Milliseconds)                                                   \
+  HISTOGRAM(upstream_rq_cx_concurrency, Unspecified)
 
 /**
  * All cluster load report stats. These are only use for EDS load reporting and not sent to the
@@ -966,6 +967,12 @@ public:
    */
   virtual float peekaheadRatio() const PURE;
 
+  /**
+   * @return the configuration of adaptive connection prewarming, if enabled.
+   */
+  virtual OptRef<const envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm>
+  adaptivePrewarm() const PURE;
+
   /**
    * @return soft limit on size of the cluster's connections read and write buffers.
    */
@@ -1,5 +1,7 @@
 #include "source/common/access_log/access_log_manager_impl.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "envoy/common/exception.h"
@@ -9,10 +11,54 @@
 #include "source/common/common/lock_guard.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 
 namespace Envoy {
 namespace AccessLog {
 
+namespace {
+std::atomic<uint64_t> next_file_id{0};
+
+uint64_t roundUpToPowerOf2(uint64_t value) {
+  uint64_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+} // namespace
+
+AccessLogWriteRing::AccessLogWriteRing(uint64_t capacity)
+    : mask_(roundUpToPowerOf2(capacity) - 1), data_(new char[mask_ + 1]) {}
+
+bool AccessLogWriteRing::push(absl::string_view data) {
+  const uint64_t tail = tail_.load(std::memory_order_relaxed);
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  if (data.size() > capacity() - (tail - head)) {
+    return false;
+  }
+  const uint64_t offset = tail & mask_;
+  const uint64_t first = std::min<uint64_t>(data.size(), capacity() - offset);
+  memcpy(data_.get() + offset, data.data(), first);
+  memcpy(data_.get(), data.data() + first, data.size() - first);
+  tail_.store(tail + data.size(), std::memory_order_release);
+  return true;
+}
+
+uint64_t AccessLogWriteRing::size() const {
+  return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_relaxed);
+}
+
+void AccessLogWriteRing::read(char* output, uint64_t length) {
+  ASSERT(length <= size());
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  const uint64_t offset = head & mask_;
+  const uint64_t first = std::min<uint64_t>(length, capacity() - offset);
+  memcpy(output, data_.get() + offset, first);
+  memcpy(output + first, data_.get(), length - first);
+  head_.store(head + length, std::memory_order_release);
+}
+
 AccessLogManagerImpl::~AccessLogManagerImpl() {
   for (auto& [log_key, log_file_ptr] : access_logs_) {
     ENVOY_LOG(debug, "destroying access logger {}", log_key);
@@ -29,28 +75,47 @@ void AccessLogManagerImpl::reopen() {
 
 AccessLogFileSharedPtr
 AccessLogManagerImpl::createAccessLog(const Filesystem::FilePathAndType& file_info) {
+  return createAccessLog(file_info, 0);
+}
+
+AccessLogFileSharedPtr
+AccessLogManagerImpl::createAccessLog(const Filesystem::FilePathAndType& file_info,
+                                      uint64_t write_ring_size) {
   auto file = api_.fileSystem().createFile(file_info);
   std::string file_name = file->path();
   if (access_logs_.count(file_name)) {
     return access_logs_[file_name];
   }
-  access_logs_[file_name] =
-      std::make_shared<AccessLogFileImpl>(std::move(file), dispatcher_, lock_, file_stats_,
-                                          file_flush_interval_msec_, api_.threadFactory());
+  access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
+      std::move(file), dispatcher_, lock_, file_stats_, file_flush_interval_msec_,
+      api_.threadFactory(), write_ring_size);
   return access_logs_[file_name];
 }
 
 AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                                      Thread::BasicLockable& lock, AccessLogFileStats& stats,
                                      std::chrono::milliseconds flush_interval_msec,
-                                     Thread::ThreadFactory& thread_factory)
+                                     Thread::ThreadFactory& thread_factory,
+                                     uint64_t write_ring_size)
     : file_(std::move(file)), file_lock_(lock),
       flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        if (write_ring_size_ > 0) {
+          Thread::LockGuard lock(write_lock_);
+          if (pruneRings()) {
+            drain_rings_ = true;
+          }
+          // Do not wake the flush thread up when it has nothing to write.
+          if (drain_rings_ || flush_buffer_.length() > 0) {
+            flush_event_.notifyOne();
+          }
+        } else {
+          flush_event_.notifyOne();
+        }
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats),
+      write_ring_size_(write_ring_size), id_(next_file_id++) {
   flush_timer_->enableTimer(flush_interval_msec_);
   auto open_result = open();
   if (!open_result.return_value_) {
@@ -91,8 +156,13 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    {
+      Thread::LockGuard lock(write_lock_);
+      about_to_write_buffer_.move(flush_buffer_);
+      drainRings();
+    }
+    if (about_to_write_buffer_.length() > 0) {
+      doWrite(about_to_write_buffer_);
     }
     const Api::IoCallBoolResult result = file_->close();
     ASSERT(result.return_value_, fmt::format("unable to close file '{}': {}", file_->path(),
@@ -148,7 +218,8 @@ void AccessLogFileImpl::flushThreadFunc() {
       // Note: do not stop waiting when only `do_reopen` is true. In this case, we tried to
       // reopen and failed. We don't want to retry this in a tight loop, so wait for the next
       // event (timer or flush).
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_ && !reopen_file_) {
+      while (flush_buffer_.length() == 0 && !drain_rings_ && !flush_thread_exit_ &&
+             !reopen_file_) {
         // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
         flush_event_.wait(write_lock_);
       }
@@ -160,6 +231,7 @@ void AccessLogFileImpl::flushThreadFunc() {
       flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
       about_to_write_buffer_.move(flush_buffer_);
       ASSERT(flush_buffer_.length() == 0);
+      drainRings();
 
       if (reopen_file_) {
         do_reopen = true;
@@ -198,24 +270,131 @@ void AccessLogFileImpl::flush() {
     // return before the pending data has actually been written to disk.
     flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
 
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
     about_to_write_buffer_.move(flush_buffer_);
     ASSERT(flush_buffer_.length() == 0);
+    drainRings();
+    if (about_to_write_buffer_.length() == 0) {
+      return;
+    }
   }
 
   doWrite(about_to_write_buffer_);
 }
 
+namespace {
+// The rings of a thread, by file id. When the thread exits, the flush threads of the files remove
+// its rings once they are drained.
+class ThreadRings {
+public:
+  ~ThreadRings() {
+    for (auto& [id, ring] : rings_) {
+      ring->closeProducer();
+    }
+  }
+
+  // Forgets the rings of the destroyed files, which are only referenced here.
+  void prune() {
+    absl::erase_if(rings_, [](const auto& entry) { return entry.second.use_count() == 1; });
+  }
+
+  absl::flat_hash_map<uint64_t, std::shared_ptr<AccessLogWriteRing>> rings_;
+};
+} // namespace
+
+AccessLogWriteRing& AccessLogFileImpl::threadRing() {
+  static thread_local ThreadRings thread_rings;
+  auto it = thread_rings.rings_.find(id_);
+  if (it == thread_rings.rings_.end()) {
+    thread_rings.prune();
+    auto ring = std::make_shared<AccessLogWriteRing>(write_ring_size_);
+    {
+      Thread::LockGuard lock(write_lock_);
+      if (flush_thread_ == nullptr) {
+        createFlushStructures();
+      }
+      rings_.push_back(ring);
+    }
+    it = thread_rings.rings_.emplace(id_, std::move(ring)).first;
+  }
+  return *it->second;
+}
+
+bool AccessLogFileImpl::pruneRings() {
+  bool has_data = false;
+  rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                              [&has_data](const std::shared_ptr<AccessLogWriteRing>& ring) {
+                                // Checked first, so that no write can follow an empty size.
+                                const bool closed = ring->producerClosed();
+                                if (ring->size() > 0) {
+                                  has_data = true;
+                                  return false;
+                                }
+                                return closed;
+                              }),
+               rings_.end());
+  return has_data;
+}
+
+void AccessLogFileImpl::drainRings() {
+  drain_rings_ = false;
+  // The sizes are sampled first, as the rings keep filling while they are drained.
+  absl::FixedArray<uint64_t> sizes(rings_.size());
+  uint64_t total = 0;
+  for (size_t i = 0; i < rings_.size(); i++) {
+    sizes[i] = rings_[i]->size();
+    total += sizes[i];
+  }
+
+  if (total > 0) {
+    Buffer::ReservationSingleSlice reservation = about_to_write_buffer_.reserveSingleSlice(total);
+    char* output = static_cast<char*>(reservation.slice().mem_);
+    for (size_t i = 0; i < rings_.size(); i++) {
+      rings_[i]->read(output, sizes[i]);
+      output += sizes[i];
+    }
+    reservation.commit(total);
+  }
+  pruneRings();
+}
+
 void AccessLogFileImpl::write(absl::string_view data) {
+  AccessLogWriteRing* ring = nullptr;
+  if (write_ring_size_ > 0) {
+    ring = &threadRing();
+    const uint64_t buffered = ring->size();
+    if (ring->push(data)) {
+      stats_.write_buffered_.inc();
+      stats_.write_total_buffered_.add(data.length());
+      // Wake up the flush thread once per fill of the ring, so that writes do not take the lock.
+      const uint64_t watermark = ring->capacity() / 2;
+      if (buffered < watermark && buffered + data.length() >= watermark) {
+        Thread::LockGuard lock(write_lock_);
+        drain_rings_ = true;
+        flush_event_.notifyOne();
+      }
+      return;
+    }
+    stats_.write_blocked_.inc();
+  }
+
   Thread::LockGuard lock(write_lock_);
 
   if (flush_thread_ == nullptr) {
     createFlushStructures();
   }
 
+  if (ring != nullptr) {
+    // The earlier lines of the thread still in its ring go first, and the later ones are drained
+    // after flush_buffer_, so that the lines of the thread stay in order. The write lock makes this
+    // thread the only consumer of the ring.
+    const uint64_t buffered = ring->size();
+    if (buffered > 0) {
+      Buffer::ReservationSingleSlice reservation = flush_buffer_.reserveSingleSlice(buffered);
+      ring->read(static_cast<char*>(reservation.slice().mem_), buffered);
+      reservation.commit(buffered);
+    }
+  }
+
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
   flush_buffer_.add(data.data(), data.size());
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/api.h"
@@ -20,6 +23,7 @@ namespace Envoy {
 #define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE)                                                      \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
+  COUNTER(write_blocked)                                                                           \
   COUNTER(write_buffered)                                                                          \
   COUNTER(write_completed)                                                                         \
   COUNTER(write_failed)                                                                            \
@@ -45,6 +49,8 @@ public:
   // AccessLog::AccessLogManager
   void reopen() override;
   AccessLogFileSharedPtr createAccessLog(const Filesystem::FilePathAndType& file_info) override;
+  AccessLogFileSharedPtr createAccessLog(const Filesystem::FilePathAndType& file_info,
+                                         uint64_t write_ring_size) override;
 
 private:
   const std::chrono::milliseconds file_flush_interval_msec_;
@@ -55,6 +61,56 @@ private:
   absl::node_hash_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
+/**
+ * A bounded byte ring with a single producer and a single consumer, which never lock. The producer
+ * only publishes whole writes, so the consumer always reads whole lines.
+ */
+class AccessLogWriteRing {
+public:
+  // The capacity is rounded up to a power of 2.
+  explicit AccessLogWriteRing(uint64_t capacity);
+
+  /**
+   * Adds data to the ring. Only called by the producer.
+   * @return whether the data fit in the ring. If not, nothing was added.
+   */
+  bool push(absl::string_view data);
+
+  /**
+   * @return the number of bytes that can be read. This is exact for the consumer, and an upper
+   *         bound for the producer, as the consumer may read concurrently.
+   */
+  uint64_t size() const;
+
+  /**
+   * Moves data out of the ring. Only called by the consumer.
+   * @param output supplies the memory to copy the data to.
+   * @param length supplies the number of bytes to read, at most size().
+   */
+  void read(char* output, uint64_t length);
+
+  uint64_t capacity() const { return mask_ + 1; }
+
+  /**
+   * Marks that the producer will never push again, as its thread exited.
+   */
+  void closeProducer() { producer_closed_.store(true, std::memory_order_release); }
+
+  /**
+   * @return whether the producer will never push again. Once true, size() is exact for all.
+   */
+  bool producerClosed() const { return producer_closed_.load(std::memory_order_acquire); }
+
+private:
+  const uint64_t mask_;
+  const std::unique_ptr<char[]> data_;
+  // The positions only ever grow, and are masked to index the data. Keep them on separate cache
+  // lines, as each is written by a different thread.
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  std::atomic<bool> producer_closed_{false};
+};
+
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
@@ -64,10 +120,15 @@ private:
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
+  /**
+   * @param write_ring_size supplies the size of the ring each writing thread buffers its writes
+   *        into, so that they do not contend on the write lock. Writes which do not fit in the
+   *        ring of their thread are buffered under the write lock. 0 disables the rings.
+   */
   AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
                     std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+                    Thread::ThreadFactory& thread_factory, uint64_t write_ring_size = 0);
   ~AccessLogFileImpl() override;
 
   // AccessLog::AccessLogFile
@@ -82,7 +143,18 @@ public:
   void flush() override;
 
 private:
+  friend class AccessLogFileImplPeer;
+
   void doWrite(Buffer::Instance& buffer);
+  // Returns the ring of the calling thread, creating it on the first write of the thread.
+  AccessLogWriteRing& threadRing();
+  // Moves the data of all rings into about_to_write_buffer_, as a single slice so that it is
+  // written with a single call. Called after moving flush_buffer_, as the data of each ring is
+  // more recent than the data its thread added to flush_buffer_.
+  void drainRings() ABSL_EXCLUSIVE_LOCKS_REQUIRED(write_lock_);
+  // Removes the drained rings of the threads which exited.
+  // @return whether any of the remaining rings has data.
+  bool pruneRings() ABSL_EXCLUSIVE_LOCKS_REQUIRED(write_lock_);
   void flushThreadFunc();
   Api::IoCallBoolResult open();
   void createFlushStructures();
@@ -116,6 +188,10 @@ private:
   Thread::CondVar flush_event_;
   bool flush_thread_exit_ ABSL_GUARDED_BY(write_lock_){false};
   bool reopen_file_ ABSL_GUARDED_BY(write_lock_){false};
+  // Set when the rings should be drained, as their writes do not notify the flush thread.
+  bool drain_rings_ ABSL_GUARDED_BY(write_lock_){false};
+  // Shared with the ring cache of the writing threads, as either may go away first.
+  std::vector<std::shared_ptr<AccessLogWriteRing>> rings_ ABSL_GUARDED_BY(write_lock_);
   Buffer::OwnedImpl
       flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
                                                   // gets filled and then flushed either when max
@@ -134,6 +210,9 @@ private:
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
   AccessLogFileStats& stats_;
+  const uint64_t write_ring_size_;
+  // Identifies the file in the ring cache of each thread. Unlike its address, it is never reused.
+  const uint64_t id_;
 };
 
 } // namespace AccessLog
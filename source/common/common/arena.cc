@@ -0,0 +1,39 @@
+#include "source/common/common/arena.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+
+ArenaImpl::ArenaImpl(void* initial_block, size_t initial_block_size)
+    : current_(reinterpret_cast<uintptr_t>(initial_block)),
+      end_(initial_block != nullptr ? current_ + initial_block_size : current_),
+      next_block_size_(std::max<size_t>(initial_block_size, 256)) {}
+
+ArenaImpl::~ArenaImpl() {
+  while (blocks_ != nullptr) {
+    Block* next = blocks_->next_;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+}
+
+void* ArenaImpl::allocateSlow(size_t size, size_t alignment) {
+  ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  // Room for the header and the alignment padding.
+  const size_t block_size = std::max(next_block_size_, sizeof(Block) + alignment + size);
+  Block* block = static_cast<Block*>(::operator new(block_size));
+  block->next_ = blocks_;
+  blocks_ = block;
+  allocated_blocks_++;
+  next_block_size_ = block_size * 2;
+  current_ = reinterpret_cast<uintptr_t>(block) + sizeof(Block);
+  end_ = reinterpret_cast<uintptr_t>(block) + block_size;
+  const uintptr_t aligned = (current_ + alignment - 1) & ~(uintptr_t(alignment) - 1);
+  current_ = aligned + size;
+  allocated_bytes_ += size;
+  return reinterpret_cast<void*>(aligned);
+}
+
+} // namespace Envoy
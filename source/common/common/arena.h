@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "envoy/common/arena.h"
+#include "envoy/common/optref.h"
+
+#include "source/common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * An arena allocating from blocks of memory, by bumping a pointer. The first block is the storage
+ * supplied at construction, if any, e.g. storage inlined in the owner of the arena. The next blocks
+ * are allocated on demand, each twice as large as the previous one.
+ */
+class ArenaImpl : public Arena, NonCopyable {
+public:
+  /**
+   * @param initial_block supplies the storage of the first block, or nullptr.
+   * @param initial_block_size supplies the size of the first block. Also the minimum size of the
+   *        blocks allocated on demand.
+   */
+  ArenaImpl(void* initial_block, size_t initial_block_size);
+  ~ArenaImpl() override;
+
+  // Arena
+  void* allocate(size_t size, size_t alignment) final {
+    allocations_++;
+    const uintptr_t aligned = (current_ + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    if (aligned + size > end_ || aligned < current_) {
+      return allocateSlow(size, alignment);
+    }
+    current_ = aligned + size;
+    allocated_bytes_ += size;
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  /**
+   * @return the number of allocations from the arena.
+   */
+  uint64_t allocations() const { return allocations_; }
+
+  /**
+   * @return the number of bytes allocated from the arena.
+   */
+  uint64_t allocatedBytes() const { return allocated_bytes_; }
+
+  /**
+   * @return the number of blocks allocated on demand by the arena.
+   */
+  uint32_t allocatedBlocks() const { return allocated_blocks_; }
+
+private:
+  // The header of the blocks allocated on demand, which are freed with the arena.
+  struct Block {
+    Block* next_;
+  };
+
+  void* allocateSlow(size_t size, size_t alignment);
+
+  uintptr_t current_;
+  uintptr_t end_;
+  size_t next_block_size_;
+  Block* blocks_{};
+  uint64_t allocations_{};
+  uint64_t allocated_bytes_{};
+  uint32_t allocated_blocks_{};
+};
+
+/**
+ * An ArenaImpl whose first block is inlined.
+ */
+template <size_t InlineSize> class InlineArena : public ArenaImpl {
+public:
+  InlineArena() : ArenaImpl(storage_, InlineSize) {}
+
+private:
+  alignas(std::max_align_t) char storage_[InlineSize];
+};
+
+/**
+ * The deleter of the objects which may be allocated from an arena. Objects allocated from an
+ * arena are destroyed, but not freed. Other objects are deleted.
+ */
+template <class T> class ArenaDeleter {
+public:
+  ArenaDeleter() = default;
+  explicit ArenaDeleter(bool in_arena) : in_arena_(in_arena) {}
+  // Allows converting the std::unique_ptr of objects allocated from the heap.
+  template <class U, class = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+  ArenaDeleter(const std::default_delete<U>&) {} // NOLINT(google-explicit-constructor)
+  template <class U, class = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+  ArenaDeleter(const ArenaDeleter<U>& other) // NOLINT(google-explicit-constructor)
+      : in_arena_(other.inArena()) {}
+
+  void operator()(T* object) const {
+    if (in_arena_) {
+      object->~T();
+    } else {
+      delete object;
+    }
+  }
+
+  bool inArena() const { return in_arena_; }
+
+private:
+  bool in_arena_{};
+};
+
+template <class T> using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+/**
+ * Create an object from an arena, or from the heap if there is no arena.
+ * @param arena supplies the arena, if any.
+ * @param args supplies the arguments of the constructor of the object.
+ * @return ArenaPtr<T> the object.
+ */
+template <class T, class... Args> ArenaPtr<T> makeArenaPtr(OptRef<Arena> arena, Args&&... args) {
+  if (!arena.has_value()) {
+    return ArenaPtr<T>(new T(std::forward<Args>(args)...));
+  }
+  void* memory = arena->allocate(sizeof(T), alignof(T));
+  return ArenaPtr<T>(new (memory) T(std::forward<Args>(args)...), ArenaDeleter<T>(true));
+}
+
+/**
+ * An allocator of the standard library allocating from an arena, or from the heap if there is no
+ * arena. Deallocating memory of an arena is a no-op.
+ */
+template <class T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(OptRef<Arena> arena) : arena_(arena.ptr()) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>& other) // NOLINT(google-explicit-constructor)
+      : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    if (arena_ == nullptr) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* memory, size_t n) {
+    if (arena_ == nullptr) {
+      std::allocator<T>().deallocate(memory, n);
+    }
+  }
+
+  Arena* arena() const { return arena_; }
+
+  template <class U> bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+  template <class U> bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena_ != other.arena();
+  }
+
+private:
+  Arena* arena_;
+};
+
+/**
+ * Create a shared object from an arena, or from the heap if there is no arena. The object is
+ * destroyed when its last reference is released, but its memory is only freed with the arena: no
+ * reference to the object, including weak ones, may outlive the arena.
+ * @param arena supplies the arena, if any.
+ * @param args supplies the arguments of the constructor of the object.
+ * @return std::shared_ptr<T> the object.
+ */
+template <class T, class... Args>
+std::shared_ptr<T> makeArenaShared(OptRef<Arena> arena, Args&&... args) {
+  if (!arena.has_value()) {
+    return std::make_shared<T>(std::forward<Args>(args)...);
+  }
+  return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
+
+} // namespace Envoy
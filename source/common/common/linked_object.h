@@ -17,8 +17,8 @@ namespace LinkedList {
  * @param item supplies the item to move in.
  * @param list supplies the list to move the item into.
  */
-template <typename T, typename U>
-void moveIntoList(std::unique_ptr<T>&& item, std::list<std::unique_ptr<U>>& list) {
+template <typename T, typename D, typename U, typename E, typename A>
+void moveIntoList(std::unique_ptr<T, D>&& item, std::list<std::unique_ptr<U, E>, A>& list) {
   ASSERT(!item->inserted_);
   item->inserted_ = true;
   auto position = list.emplace(list.begin(), std::move(item));
@@ -30,8 +30,8 @@ void moveIntoList(std::unique_ptr<T>&& item, std::list<std::unique_ptr<U>>& list
  * @param item supplies the item to move in.
  * @param list supplies the list to move the item into.
  */
-template <typename T, typename U>
-void moveIntoListBack(std::unique_ptr<T>&& item, std::list<std::unique_ptr<U>>& list) {
+template <typename T, typename D, typename U, typename E, typename A>
+void moveIntoListBack(std::unique_ptr<T, D>&& item, std::list<std::unique_ptr<U, E>, A>& list) {
   ASSERT(!item->inserted_);
   item->inserted_ = true;
   auto position = list.emplace(list.end(), std::move(item));
@@ -42,11 +42,11 @@ void moveIntoListBack(std::unique_ptr<T>&& item, std::list<std::unique_ptr<U>>&
 
 /**
  * Mixin class that allows an object contained in a unique pointer to be easily linked and unlinked
- * from lists.
+ * from lists. The lists may use custom deleters and allocators, e.g. those of an arena.
  */
-template <class T> class LinkedObject {
+template <class T, class List = std::list<std::unique_ptr<T>>> class LinkedObject {
 public:
-  using ListType = std::list<std::unique_ptr<T>>;
+  using ListType = List;
 
   /**
    * @return the list iterator for the object.
@@ -77,11 +77,11 @@ public:
    * Remove this item from a list.
    * @param list supplies the list to remove from. This item should be in this list.
    */
-  std::unique_ptr<T> removeFromList(ListType& list) {
+  typename ListType::value_type removeFromList(ListType& list) {
     ASSERT(inserted_);
     ASSERT(std::find(list.begin(), list.end(), *entry_) != list.end());
 
-    std::unique_ptr<T> removed = std::move(*entry_);
+    typename ListType::value_type removed = std::move(*entry_);
     list.erase(entry_);
     inserted_ = false;
     return removed;
@@ -91,10 +91,12 @@ protected:
   LinkedObject() = default;
 
 private:
-  template <typename U, typename V>
-  friend void LinkedList::moveIntoList(std::unique_ptr<U>&&, std::list<std::unique_ptr<V>>&);
-  template <typename U, typename V>
-  friend void LinkedList::moveIntoListBack(std::unique_ptr<U>&&, std::list<std::unique_ptr<V>>&);
+  template <typename U, typename D, typename V, typename E, typename A>
+  friend void LinkedList::moveIntoList(std::unique_ptr<U, D>&&,
+                                       std::list<std::unique_ptr<V, E>, A>&);
+  template <typename U, typename D, typename V, typename E, typename A>
+  friend void LinkedList::moveIntoListBack(std::unique_ptr<U, D>&&,
+                                           std::list<std::unique_ptr<V, E>, A>&);
 
   typename ListType::iterator entry_;
   bool inserted_{false}; // iterators do not have any "invalid" value so we need this boolean for
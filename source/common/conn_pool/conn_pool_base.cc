@@ -19,6 +19,73 @@ namespace {
 }
 } // namespace
 
+void ReadyClientIndex::add(ActiveClient& client) {
+  ASSERT(client.ready_index_position_ == ActiveClient::NotIndexed);
+  entries_.push_back({client.numActiveStreams(), &client});
+  client.ready_index_position_ = entries_.size() - 1;
+  siftUp(entries_.size() - 1);
+}
+
+void ReadyClientIndex::remove(ActiveClient& client) {
+  const size_t position = client.ready_index_position_;
+  ASSERT(position < entries_.size() && entries_[position].client_ == &client);
+  client.ready_index_position_ = ActiveClient::NotIndexed;
+  const Entry last = entries_.back();
+  entries_.pop_back();
+  if (position < entries_.size()) {
+    // Fill the hole with the last entry, which may belong either above or below it.
+    place(position, last);
+    siftUp(position);
+    siftDown(last.client_->ready_index_position_);
+  }
+}
+
+void ReadyClientIndex::update(ActiveClient& client) {
+  const size_t position = client.ready_index_position_;
+  ASSERT(position < entries_.size() && entries_[position].client_ == &client);
+  entries_[position].active_streams_ = client.numActiveStreams();
+  siftUp(position);
+  siftDown(client.ready_index_position_);
+}
+
+void ReadyClientIndex::place(size_t position, const Entry& entry) {
+  entries_[position] = entry;
+  entry.client_->ready_index_position_ = position;
+}
+
+void ReadyClientIndex::siftUp(size_t position) {
+  const Entry entry = entries_[position];
+  while (position > 0) {
+    const size_t parent = (position - 1) / 2;
+    if (entries_[parent].active_streams_ <= entry.active_streams_) {
+      break;
+    }
+    place(position, entries_[parent]);
+    position = parent;
+  }
+  place(position, entry);
+}
+
+void ReadyClientIndex::siftDown(size_t position) {
+  const Entry entry = entries_[position];
+  while (true) {
+    size_t child = 2 * position + 1;
+    if (child >= entries_.size()) {
+      break;
+    }
+    if (child + 1 < entries_.size() &&
+        entries_[child + 1].active_streams_ < entries_[child].active_streams_) {
+      child++;
+    }
+    if (entries_[child].active_streams_ >= entry.active_streams_) {
+      break;
+    }
+    place(position, entries_[child]);
+    position = child;
+  }
+  place(position, entry);
+}
+
 ConnPoolImplBase::ConnPoolImplBase(
     Upstream::HostConstSharedPtr host, Upstream::ResourcePriority priority,
     Event::Dispatcher& dispatcher, const Network::ConnectionSocket::OptionsSharedPtr& options,
@@ -181,6 +248,11 @@ void ConnPoolImplBase::attachStreamToClient(Envoy::ConnectionPool::ActiveClient&
   }
   ENVOY_CONN_LOG(debug, "creating stream", client);
 
+  if (least_loaded_client_selection_) {
+    // Tracks how evenly the streams are spread over the connections.
+    traffic_stats.upstream_rq_cx_concurrency_.recordValue(client.numActiveStreams() + 1);
+  }
+
   // Latch capacity before updating remaining streams.
   uint64_t capacity = client.currentUnusedCapacity();
   client.remaining_streams_--;
@@ -198,6 +270,9 @@ void ConnPoolImplBase::attachStreamToClient(Envoy::ConnectionPool::ActiveClient&
   if (trackStreamCapacity()) {
     decrConnectingAndConnectedStreamCapacity(1, client);
   }
+  if (client.warm_) {
+    onWarmClientUsed(client);
+  }
   // Track the new active stream.
   state_.incrActiveStreams(1);
   num_active_streams_++;
@@ -208,6 +283,9 @@ void ConnPoolImplBase::attachStreamToClient(Envoy::ConnectionPool::ActiveClient&
   host_->cluster().resourceManager(priority_).requests().inc();
 
   onPoolReady(client, context);
+  if (client.ready_index_position_ != ActiveClient::NotIndexed) {
+    ready_client_index_.update(client);
+  }
 }
 
 void ConnPoolImplBase::onStreamClosed(Envoy::ConnectionPool::ActiveClient& client,
@@ -234,6 +312,9 @@ void ConnPoolImplBase::onStreamClosed(Envoy::ConnectionPool::ActiveClient& clien
       incrConnectingAndConnectedStreamCapacity(1, client);
     }
   }
+  if (client.ready_index_position_ != ActiveClient::NotIndexed) {
+    ready_client_index_.update(client);
+  }
   if (client.state() == ActiveClient::State::Draining && client.numActiveStreams() == 0) {
     // Close out the draining client if we no longer have active streams.
     client.close();
@@ -261,7 +342,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
          connectingCapacity(connecting_clients_) +
              connectingCapacity(early_data_clients_)); // O(n) debug check.
   if (!ready_clients_.empty()) {
-    ActiveClient& client = *ready_clients_.front();
+    ActiveClient& client = nextReadyClient();
     ENVOY_CONN_LOG(debug, "using existing fully connected connection", client);
     attachStreamToClient(client, context);
     // Even if there's a ready client, we may want to preconnect to handle the next incoming stream.
@@ -318,16 +399,65 @@ bool ConnPoolImplBase::maybePreconnectImpl(float global_preconnect_ratio) {
   return tryCreateNewConnection(global_preconnect_ratio) == ConnectionResult::CreatedNewConnection;
 }
 
+uint32_t ConnPoolImplBase::prewarmImpl(uint32_t unused_capacity, uint32_t max_new_connections) {
+  ASSERT(!deferred_deleting_);
+  // As for preconnecting, do not make unhealthy hosts do extra work.
+  if (is_draining_for_deletion_ || host_->coarseHealth() != Upstream::Host::Health::Healthy) {
+    return 0;
+  }
+
+  // The streams which can be served without connecting, assuming Connecting connections succeed.
+  int64_t available_capacity = static_cast<int64_t>(connecting_stream_capacity_) -
+                               static_cast<int64_t>(pending_streams_.size());
+  for (const auto* list : {&ready_clients_, &early_data_clients_}) {
+    for (const auto& client : *list) {
+      available_capacity += client->currentUnusedCapacity();
+    }
+  }
+
+  uint32_t created = 0;
+  while (available_capacity < static_cast<int64_t>(unused_capacity) &&
+         created < max_new_connections) {
+    // Unlike for streams, there is no reason to exceed the circuit breaker here. This is not an
+    // overflow either, as no stream is refused a connection.
+    if (!host_->canCreateConnection(priority_)) {
+      break;
+    }
+    ActiveClientPtr client = instantiateActiveClient();
+    if (client.get() == nullptr) {
+      break;
+    }
+    ASSERT(client->state() == ActiveClient::State::Connecting);
+    ENVOY_LOG(debug, "prewarming a new connection (warm={})", warm_connections_);
+    client->warm_ = true;
+    warm_connections_++;
+    host_->stats().cx_prewarm_.inc();
+    host_->stats().cx_warm_.inc();
+    available_capacity += client->currentUnusedCapacity();
+    incrConnectingAndConnectedStreamCapacity(client->currentUnusedCapacity(), *client);
+    LinkedList::moveIntoList(std::move(client), owningList(ActiveClient::State::Connecting));
+    created++;
+  }
+  return created;
+}
+
+void ConnPoolImplBase::onWarmClientUsed(ActiveClient& client) {
+  ASSERT(client.warm_ && warm_connections_ > 0);
+  client.warm_ = false;
+  warm_connections_--;
+  host_->stats().cx_warm_.dec();
+}
+
 void ConnPoolImplBase::scheduleOnUpstreamReady() {
   upstream_ready_cb_->scheduleCallbackCurrentIteration();
 }
 
 void ConnPoolImplBase::onUpstreamReady() {
   while (!pending_streams_.empty() && !ready_clients_.empty()) {
-    ActiveClientPtr& client = ready_clients_.front();
-    ENVOY_CONN_LOG(debug, "attaching to next stream", *client);
+    ActiveClient& client = nextReadyClient();
+    ENVOY_CONN_LOG(debug, "attaching to next stream", client);
     // Pending streams are pushed onto the front, so pull from the back.
-    attachStreamToClient(*client, pending_streams_.back()->context());
+    attachStreamToClient(client, pending_streams_.back()->context());
     state_.decrPendingStreams(1);
     pending_streams_.pop_back();
   }
@@ -357,6 +487,13 @@ void ConnPoolImplBase::transitionActiveClientState(ActiveClient& client,
                                                    ActiveClient::State new_state) {
   auto& old_list = owningList(client.state());
   auto& new_list = owningList(new_state);
+  if (least_loaded_client_selection_ && &old_list != &new_list) {
+    if (&old_list == &ready_clients_) {
+      ready_client_index_.remove(client);
+    } else if (&new_list == &ready_clients_) {
+      ready_client_index_.add(client);
+    }
+  }
   client.setState(new_state);
 
   // old_list and new_list can be equal when transitioning from Busy to Draining.
@@ -369,6 +506,13 @@ void ConnPoolImplBase::transitionActiveClientState(ActiveClient& client,
   }
 }
 
+ActiveClientPtr ConnPoolImplBase::removeFromOwningList(ActiveClient& client) {
+  if (client.ready_index_position_ != ActiveClient::NotIndexed) {
+    ready_client_index_.remove(client);
+  }
+  return client.removeFromList(owningList(client.state()));
+}
+
 void ConnPoolImplBase::addIdleCallbackImpl(Instance::IdleCb cb) { idle_callbacks_.push_back(cb); }
 
 void ConnPoolImplBase::closeIdleConnectionsForDrainingPool() {
@@ -547,7 +691,10 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
       client.connection_duration_timer_.reset();
     }
 
-    dispatcher_.deferredDelete(client.removeFromList(owningList(client.state())));
+    if (client.warm_) {
+      onWarmClientUsed(client);
+    }
+    dispatcher_.deferredDelete(removeFromOwningList(client));
 
     // Check if the pool transitioned to idle state after removing closed client
     // from one of the client tracking lists.
@@ -679,14 +826,19 @@ void ConnPoolImplBase::onPendingStreamCancel(PendingStream& stream,
     stream.removeFromList(pending_streams_);
   }
   if (policy == Envoy::ConnectionPool::CancelPolicy::CloseExcess) {
-    if (!connecting_clients_.empty() &&
-        connectingConnectionIsExcess(*connecting_clients_.front())) {
-      auto& client = *connecting_clients_.front();
+    // Connections created by prewarmImpl() are established ahead of demand on purpose, so they
+    // are never closed as excess.
+    const auto connecting_client =
+        std::find_if(connecting_clients_.begin(), connecting_clients_.end(),
+                     [](const ActiveClientPtr& client) { return !client->warm_; });
+    if (connecting_client != connecting_clients_.end() &&
+        connectingConnectionIsExcess(**connecting_client)) {
+      auto& client = **connecting_client;
       transitionActiveClientState(client, ActiveClient::State::Draining);
       client.close();
     } else if (!early_data_clients_.empty()) {
       for (ActiveClientPtr& client : early_data_clients_) {
-        if (client->numActiveStreams() == 0) {
+        if (client->numActiveStreams() == 0 && !client->warm_) {
           // Find an idle early data client and check if it is excess.
           if (connectingConnectionIsExcess(*client)) {
             // Close the client after the for loop avoid messing up with iterator.
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <limits>
+#include <vector>
+
 #include "envoy/common/conn_pool.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection.h"
@@ -126,7 +129,11 @@ public:
     return state_ != State::Connecting;
   }
 
+  static constexpr size_t NotIndexed = std::numeric_limits<size_t>::max();
+
   ConnPoolImplBase& parent_;
+  // The position of this client in the ReadyClientIndex of the pool, or NotIndexed.
+  size_t ready_index_position_{NotIndexed};
   // The count of remaining streams allowed for this connection.
   // This will start out as the total number of streams per connection if capped
   // by configuration, or it will be set to std::numeric_limits<uint32_t>::max() to be
@@ -148,6 +155,8 @@ public:
   Event::TimerPtr connection_duration_timer_;
   bool resources_released_{false};
   bool timed_out_{false};
+  // True if the connection was created by prewarmImpl() and has not served a stream yet.
+  bool warm_{false};
   // TODO(danzh) remove this once http codec exposes the handshake state for h3.
   bool has_handshake_completed_{false};
 
@@ -182,6 +191,39 @@ using PendingStreamPtr = std::unique_ptr<PendingStream>;
 
 using ActiveClientPtr = std::unique_ptr<ActiveClient>;
 
+// The Ready clients of a pool ordered by their number of active streams, so that streams can be
+// assigned to the least loaded connection. This is a binary min-heap stored in a vector, in which
+// each client records its position, so that it can be removed or re-ordered in O(log n).
+class ReadyClientIndex {
+public:
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+  // Returns the client with the fewest active streams.
+  ActiveClient& leastLoaded() const {
+    ASSERT(!entries_.empty());
+    return *entries_.front().client_;
+  }
+
+  void add(ActiveClient& client);
+  void remove(ActiveClient& client);
+  // Re-orders the client after its number of active streams changed.
+  void update(ActiveClient& client);
+
+private:
+  struct Entry {
+    // The number of active streams of the client when it was last ordered.
+    uint32_t active_streams_;
+    ActiveClient* client_;
+  };
+
+  void place(size_t position, const Entry& entry);
+  void siftUp(size_t position);
+  void siftDown(size_t position);
+
+  std::vector<Entry> entries_;
+};
+
 // Base class that handles stream queueing logic shared between connection pool implementations.
 class ConnPoolImplBase : protected Logger::Loggable<Logger::Id::pool> {
 public:
@@ -222,6 +264,9 @@ public:
   const Upstream::HostConstSharedPtr& host() const { return host_; }
   // Called if this pool is likely to be picked soon, to determine if it's worth preconnecting.
   bool maybePreconnectImpl(float global_preconnect_ratio);
+  // Creates at most max_new_connections connections ahead of demand, until the pool can serve
+  // unused_capacity more streams without connecting. Returns the number of connections created.
+  uint32_t prewarmImpl(uint32_t unused_capacity, uint32_t max_new_connections);
 
   // Closes and destroys all connections. This must be called in the destructor of
   // derived classes because the derived ActiveClient will downcast parent_ to a more
@@ -250,6 +295,9 @@ public:
   // Changes the state_ of an ActiveClient and moves to the appropriate list.
   void transitionActiveClientState(ActiveClient& client, ActiveClient::State new_state);
 
+  // Removes a client from the list owning it, e.g. once it is closed.
+  ActiveClientPtr removeFromOwningList(ActiveClient& client);
+
   void onConnectionEvent(ActiveClient& client, absl::string_view failure_reason,
                          Network::ConnectionEvent event);
 
@@ -354,6 +402,23 @@ protected:
 
   bool hasActiveStreams() const { return num_active_streams_ > 0; }
 
+  // Called when a client created by prewarmImpl() serves its first stream or closes.
+  void onWarmClientUsed(ActiveClient& client);
+
+  // Makes new streams go to the Ready client with the fewest active streams rather than to the
+  // front of ready_clients_. Must be called before any client is created.
+  void enableLeastLoadedClientSelection() {
+    ASSERT(isIdleImpl());
+    least_loaded_client_selection_ = true;
+  }
+
+  // Returns the Ready client the next stream should be attached to.
+  ActiveClient& nextReadyClient() {
+    ASSERT(!least_loaded_client_selection_ || ready_client_index_.size() == ready_clients_.size());
+    return least_loaded_client_selection_ ? ready_client_index_.leastLoaded()
+                                          : *ready_clients_.front();
+  }
+
   Upstream::ClusterConnectivityState& state_;
 
   const Upstream::HostConstSharedPtr host_;
@@ -387,6 +452,10 @@ protected:
   // credentials.
   std::list<ActiveClientPtr> early_data_clients_;
 
+  // The clients of ready_clients_ ordered by load, if least_loaded_client_selection_ is set.
+  ReadyClientIndex ready_client_index_;
+  bool least_loaded_client_selection_{false};
+
   // The number of streams that can be immediately dispatched
   // if all Connecting connections become connected.
   uint32_t connecting_stream_capacity_{0};
@@ -401,6 +470,9 @@ private:
   // The number of streams currently attached to clients.
   uint32_t num_active_streams_{0};
 
+  // The number of clients created by prewarmImpl() which have not served a stream yet.
+  uint32_t warm_connections_{0};
+
   // Whether the connection pool is currently in the process of closing
   // all connections so that it can be gracefully deleted.
   bool is_draining_for_deletion_{false};
@@ -26,6 +26,7 @@
 #include "source/common/filesystem/watcher_impl.h"
 #include "source/common/network/address_impl.h"
 #include "source/common/network/connection_impl.h"
+#include "source/common/protobuf/utility.h"
 #include "source/common/runtime/runtime_features.h"
 
 #include "event2/event.h"
@@ -60,7 +61,14 @@ DispatcherImpl::DispatcherImpl(const std::string& name, Api::Api& api,
                      watermark_factory != nullptr
                          ? watermark_factory
                          : std::make_shared<Buffer::WatermarkBufferFactory>(
-                               api.bootstrap().overload_manager().buffer_factory_config())) {}
+                               api.bootstrap().overload_manager().buffer_factory_config())) {
+  const auto& budget = api.bootstrap().connection_read_budget();
+  connection_read_budget_.max_bytes_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(budget, max_bytes, 0);
+  // Rounded up, so that a budget below a microsecond does not disable the limit.
+  connection_read_budget_.max_time_ = std::chrono::microseconds(
+      budget.max_time().seconds() * 1000000 + (budget.max_time().nanos() + 999) / 1000);
+  use_timer_wheel_ = api.bootstrap().use_timer_wheel();
+}
 
 DispatcherImpl::DispatcherImpl(const std::string& name, Thread::ThreadFactory& thread_factory,
                                TimeSource& time_source, Random::RandomGenerator&,
@@ -220,6 +228,22 @@ TimerPtr DispatcherImpl::createTimerInternal(TimerCb cb) {
       *this);
 }
 
+TimerPtr DispatcherImpl::createCoarseTimer(TimerCb cb) {
+  ASSERT(isThreadSafe());
+  if (!use_timer_wheel_) {
+    return createTimerInternal(cb);
+  }
+  if (timer_wheel_ == nullptr) {
+    timer_wheel_ = std::make_unique<TimerWheel>(*scheduler_, *this, time_source_);
+  }
+  return timer_wheel_->createTimer(
+      [this, cb]() {
+        touchWatchdog();
+        cb();
+      },
+      *this);
+}
+
 void DispatcherImpl::deferredDelete(DeferredDeletablePtr&& to_delete) {
   ASSERT(isThreadSafe());
   if (to_delete != nullptr) {
@@ -0,0 +1,251 @@
+#include "source/common/event/timer_wheel.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/scope_tracker.h"
+
+namespace Envoy {
+namespace Event {
+
+namespace {
+
+constexpr uint64_t TickMicroseconds = 1000;
+
+// @return the first slot at or after from which has timers, or NumSlots if there is none.
+template <size_t NumWords>
+uint32_t nextOccupiedSlot(const std::array<uint64_t, NumWords>& occupied, uint32_t from) {
+  for (uint32_t word = from / 64; word < NumWords; word++) {
+    uint64_t bits = occupied[word];
+    if (word == from / 64) {
+      bits &= ~uint64_t(0) << (from % 64);
+    }
+    if (bits != 0) {
+      return word * 64 + __builtin_ctzll(bits);
+    }
+  }
+  return NumWords * 64;
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(Scheduler& scheduler, Dispatcher& dispatcher, TimeSource& time_source)
+    : scheduler_(scheduler), time_source_(time_source), epoch_(time_source.monotonicTime()),
+      tick_timer_(scheduler.createTimer([this]() { onTick(); }, dispatcher)) {}
+
+TimerPtr TimerWheel::createTimer(const TimerCb& cb, Dispatcher& dispatcher) {
+  return std::make_unique<WheelTimer>(*this, cb, dispatcher);
+}
+
+uint64_t TimerWheel::currentTick() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time_source_.monotonicTime() -
+                                                               epoch_)
+      .count();
+}
+
+void TimerWheel::arm(WheelTimer& timer, std::chrono::milliseconds duration) {
+  if (timer.linked_) {
+    remove(timer);
+  } else if (armed_timers_++ == 0) {
+    // The ticks are only processed while timers are armed: catch up, so that the timer goes to
+    // the level of its duration.
+    now_tick_ = std::max(now_tick_, currentTick());
+  }
+  // The first tick at or after the deadline, so that timers never fire early.
+  const uint64_t deadline_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                   time_source_.monotonicTime() - epoch_ + duration)
+                                   .count();
+  timer.tick_ = std::max((deadline_us + TickMicroseconds - 1) / TickMicroseconds, now_tick_ + 1);
+  insert(timer);
+  if (timer.tick_ < scheduled_tick_) {
+    scheduleTick(timer.tick_);
+  }
+}
+
+void TimerWheel::disarm(WheelTimer& timer) {
+  remove(timer);
+  armed_timers_--;
+  // The tick timer is left armed, and rescheduled when it fires.
+}
+
+void TimerWheel::insert(WheelTimer& timer) {
+  const uint64_t delta = timer.tick_ > now_tick_ ? timer.tick_ - now_tick_ : 0;
+  uint32_t level = 0;
+  while (level < NumLevels - 1 && delta >= (uint64_t(1) << (SlotBits * (level + 1)))) {
+    level++;
+  }
+  uint64_t tick = timer.tick_;
+  if (delta >= (uint64_t(1) << (SlotBits * NumLevels))) {
+    // Beyond the range of the wheel: wait in the last slot, and move again from there.
+    tick = ((now_tick_ >> (SlotBits * level)) + NumSlots - 1) << (SlotBits * level);
+  }
+  const uint32_t slot = (tick >> (SlotBits * level)) & (NumSlots - 1);
+
+  Level& wheel_level = levels_[level];
+  timer.level_ = level;
+  timer.slot_ = slot;
+  timer.prev_ = nullptr;
+  timer.next_ = wheel_level.slots_[slot];
+  if (timer.next_ != nullptr) {
+    timer.next_->prev_ = &timer;
+  }
+  wheel_level.slots_[slot] = &timer;
+  wheel_level.occupied_[slot / 64] |= uint64_t(1) << (slot % 64);
+  timer.linked_ = true;
+}
+
+void TimerWheel::remove(WheelTimer& timer) {
+  ASSERT(timer.linked_);
+  Level& wheel_level = levels_[timer.level_];
+  if (timer.prev_ != nullptr) {
+    timer.prev_->next_ = timer.next_;
+  } else {
+    wheel_level.slots_[timer.slot_] = timer.next_;
+    if (timer.next_ == nullptr) {
+      wheel_level.occupied_[timer.slot_ / 64] &= ~(uint64_t(1) << (timer.slot_ % 64));
+    }
+  }
+  if (timer.next_ != nullptr) {
+    timer.next_->prev_ = timer.prev_;
+  }
+  timer.next_ = nullptr;
+  timer.prev_ = nullptr;
+  timer.linked_ = false;
+}
+
+void TimerWheel::onTick() {
+  scheduled_tick_ = UINT64_MAX;
+  advance(currentTick());
+  if (armed_timers_ > 0) {
+    scheduleTick(nextTick());
+  }
+}
+
+void TimerWheel::advance(uint64_t tick) {
+  for (uint64_t next = nextTick(); next <= tick; next = nextTick()) {
+    now_tick_ = next;
+    // Move the timers of the slots starting at this tick to the lower levels, from the highest.
+    for (uint32_t level = NumLevels - 1; level > 0; level--) {
+      if ((now_tick_ & ((uint64_t(1) << (SlotBits * level)) - 1)) == 0) {
+        cascade(level, (now_tick_ >> (SlotBits * level)) & (NumSlots - 1));
+      }
+    }
+    // The callbacks may arm timers, but never for the current tick, so this terminates.
+    const uint32_t slot = now_tick_ & (NumSlots - 1);
+    while (WheelTimer* timer = levels_[0].slots_[slot]) {
+      disarm(*timer);
+      timer->fire();
+    }
+  }
+  now_tick_ = std::max(now_tick_, tick);
+}
+
+void TimerWheel::cascade(uint32_t level, uint32_t slot) {
+  while (WheelTimer* timer = levels_[level].slots_[slot]) {
+    remove(*timer);
+    insert(*timer);
+  }
+}
+
+uint64_t TimerWheel::nextTick() const {
+  if (armed_timers_ == 0) {
+    return UINT64_MAX;
+  }
+  uint64_t next = UINT64_MAX;
+  for (uint32_t level = 0; level < NumLevels; level++) {
+    const uint32_t shift = SlotBits * level;
+    const uint32_t current = (now_tick_ >> shift) & (NumSlots - 1);
+    // The current slot of a level was already reached, so its timers are those of the next
+    // rotation of the level.
+    uint32_t slot = nextOccupiedSlot(levels_[level].occupied_, current + 1);
+    uint32_t distance = slot - current;
+    if (slot == NumSlots) {
+      slot = nextOccupiedSlot(levels_[level].occupied_, 0);
+      if (slot == NumSlots) {
+        continue;
+      }
+      distance = slot + NumSlots - current;
+    }
+    next = std::min(next, ((now_tick_ >> shift) + distance) << shift);
+  }
+  return next;
+}
+
+void TimerWheel::scheduleTick(uint64_t tick) {
+  scheduled_tick_ = tick;
+  const auto delay = epoch_ + std::chrono::milliseconds(tick) - time_source_.monotonicTime();
+  tick_timer_->enableHRTimer(std::max(
+      std::chrono::microseconds(0), std::chrono::duration_cast<std::chrono::microseconds>(delay)));
+}
+
+WheelTimer::WheelTimer(TimerWheel& wheel, TimerCb cb, Dispatcher& dispatcher)
+    : wheel_(wheel), cb_(std::move(cb)), dispatcher_(dispatcher) {
+  ASSERT(cb_);
+}
+
+WheelTimer::~WheelTimer() {
+  if (linked_) {
+    wheel_.disarm(*this);
+  }
+}
+
+void WheelTimer::disableTimer() {
+  ASSERT(dispatcher_.isThreadSafe());
+  if (linked_) {
+    wheel_.disarm(*this);
+  }
+  if (fallback_timer_ != nullptr) {
+    fallback_timer_->disableTimer();
+  }
+}
+
+void WheelTimer::enableTimer(std::chrono::milliseconds duration,
+                             const ScopeTrackedObject* object) {
+  ASSERT(dispatcher_.isThreadSafe());
+  if (duration.count() <= 0) {
+    // Keep the semantics of zero timers, which fire at the next iteration of the event loop.
+    enableHRTimer(duration, object);
+    return;
+  }
+  if (fallback_timer_ != nullptr) {
+    fallback_timer_->disableTimer();
+  }
+  object_ = object;
+  wheel_.arm(*this, duration);
+}
+
+void WheelTimer::enableHRTimer(std::chrono::microseconds duration,
+                               const ScopeTrackedObject* object) {
+  ASSERT(dispatcher_.isThreadSafe());
+  // The wheel cannot honor the precision of high resolution timers.
+  if (linked_) {
+    wheel_.disarm(*this);
+  }
+  object_ = nullptr;
+  fallbackTimer().enableHRTimer(duration, object);
+}
+
+bool WheelTimer::enabled() {
+  ASSERT(dispatcher_.isThreadSafe());
+  return linked_ || (fallback_timer_ != nullptr && fallback_timer_->enabled());
+}
+
+void WheelTimer::fire() {
+  if (object_ == nullptr) {
+    cb_();
+    return;
+  }
+  ScopeTrackerScopeState scope(object_, dispatcher_);
+  object_ = nullptr;
+  cb_();
+}
+
+Timer& WheelTimer::fallbackTimer() {
+  if (fallback_timer_ == nullptr) {
+    fallback_timer_ = wheel_.scheduler_.createTimer(cb_, dispatcher_);
+  }
+  return *fallback_timer_;
+}
+
+} // namespace Event
+} // namespace Envoy
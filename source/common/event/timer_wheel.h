@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Event {
+
+class WheelTimer;
+
+/**
+ * Hierarchical timing wheel for coarse timers, e.g. timeouts. Timers expire on millisecond ticks,
+ * and are armed and disarmed in constant time, whereas the timers of libevent are kept in a heap.
+ * The wheel has 4 levels of 256 slots: the slots of the first level hold the timers expiring in a
+ * single tick, and each slot of the next levels those expiring in 256 times as many ticks as the
+ * previous level. The timers of a slot move to the lower levels when the wheel reaches the ticks
+ * of the slot, so that a timer moves at most 3 times before it expires. Timers expiring beyond the
+ * range of the wheel, about 49 days, stay in its last slot until they are in range.
+ *
+ * The wheel is driven by a single timer of the underlying scheduler, armed for the next tick with
+ * work to do. Timers armed with a zero duration, which fire at the next iteration of the event
+ * loop, and high resolution timers bypass the wheel and use a timer of the underlying scheduler.
+ */
+class TimerWheel : public Scheduler {
+public:
+  /**
+   * @param scheduler supplies the scheduler of the timer driving the wheel.
+   * @param dispatcher supplies the dispatcher of the timers.
+   * @param time_source supplies the time source of the ticks of the wheel.
+   */
+  TimerWheel(Scheduler& scheduler, Dispatcher& dispatcher, TimeSource& time_source);
+
+  // Scheduler
+  TimerPtr createTimer(const TimerCb& cb, Dispatcher& dispatcher) override;
+
+private:
+  friend class WheelTimer;
+
+  static constexpr uint32_t SlotBits = 8;
+  static constexpr uint32_t NumSlots = 1 << SlotBits;
+  static constexpr uint32_t NumLevels = 4;
+
+  struct Level {
+    // The head of the list of the timers of each slot.
+    std::array<WheelTimer*, NumSlots> slots_{};
+    // A bit per slot, set if the slot has timers.
+    std::array<uint64_t, NumSlots / 64> occupied_{};
+  };
+
+  // Arms a timer for the first tick at or after its deadline.
+  void arm(WheelTimer& timer, std::chrono::milliseconds duration);
+  void disarm(WheelTimer& timer);
+  void insert(WheelTimer& timer);
+  void remove(WheelTimer& timer);
+  void onTick();
+  // Processes the ticks up to the given one, moving the timers of the slots it reaches to the
+  // lower levels and firing the timers which expire.
+  void advance(uint64_t tick);
+  void cascade(uint32_t level, uint32_t slot);
+  // @return the next tick with work to do, i.e. at which a slot is reached, or UINT64_MAX if no
+  // timer is armed.
+  uint64_t nextTick() const;
+  void scheduleTick(uint64_t tick);
+  uint64_t currentTick() const;
+
+  Scheduler& scheduler_;
+  TimeSource& time_source_;
+  const MonotonicTime epoch_;
+  // The last tick processed.
+  uint64_t now_tick_{};
+  // The tick the tick timer is armed for, or UINT64_MAX if it is not armed.
+  uint64_t scheduled_tick_{UINT64_MAX};
+  uint64_t armed_timers_{};
+  std::array<Level, NumLevels> levels_;
+  const TimerPtr tick_timer_;
+};
+
+/**
+ * A timer of a TimerWheel.
+ */
+class WheelTimer : public Timer {
+public:
+  WheelTimer(TimerWheel& wheel, TimerCb cb, Dispatcher& dispatcher);
+  ~WheelTimer() override;
+
+  // Timer
+  void disableTimer() override;
+  void enableTimer(std::chrono::milliseconds duration, const ScopeTrackedObject* object) override;
+  void enableHRTimer(std::chrono::microseconds duration, const ScopeTrackedObject* object) override;
+  bool enabled() override;
+
+private:
+  friend class TimerWheel;
+
+  void fire();
+  Timer& fallbackTimer();
+
+  TimerWheel& wheel_;
+  const TimerCb cb_;
+  Dispatcher& dispatcher_;
+  const ScopeTrackedObject* object_{};
+  // The timer used for the durations the wheel cannot honor, created on first use.
+  TimerPtr fallback_timer_;
+  // The links of the timer in the list of its slot, when armed in the wheel.
+  WheelTimer* next_{};
+  WheelTimer* prev_{};
+  uint64_t tick_{};
+  uint8_t level_{};
+  uint8_t slot_{};
+  bool linked_{};
+};
+
+} // namespace Event
+} // namespace Envoy
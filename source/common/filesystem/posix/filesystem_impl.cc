@@ -219,6 +219,14 @@ Api::IoCallBoolResult InstanceImplPosix::createPath(absl::string_view path) {
   return resultSuccess(true);
 }
 
+Api::IoCallBoolResult InstanceImplPosix::rename(const std::string& old_path,
+                                                const std::string& new_path) {
+  if (::rename(old_path.c_str(), new_path.c_str()) != 0) {
+    return resultFailure(false, errno);
+  }
+  return resultSuccess(true);
+}
+
 FileImplPosix::FlagsAndMode FileImplPosix::translateFlag(FlagSet in) {
   int out = 0;
   mode_t mode = 0;
@@ -63,6 +63,7 @@ public:
   bool illegalPath(const std::string& path) override;
   Api::IoCallResult<FileInfo> stat(absl::string_view path) override;
   Api::IoCallBoolResult createPath(absl::string_view path) override;
+  Api::IoCallBoolResult rename(const std::string& old_path, const std::string& new_path) override;
 
 private:
   Api::SysCallStringResult canonicalPath(const std::string& path);
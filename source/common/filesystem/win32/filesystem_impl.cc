@@ -201,6 +201,15 @@ Api::IoCallBoolResult InstanceImplWin32::createPath(absl::string_view path) {
   return ec ? resultFailure(false, ec.value()) : resultSuccess(result);
 }
 
+Api::IoCallBoolResult InstanceImplWin32::rename(const std::string& old_path,
+                                                const std::string& new_path) {
+  // ::rename does not replace an existing file on Windows, so MoveFileEx is used instead.
+  if (!::MoveFileEx(old_path.c_str(), new_path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    return resultFailure(false, ::GetLastError());
+  }
+  return resultSuccess(true);
+}
+
 FileImplWin32::FlagsAndMode FileImplWin32::translateFlag(FlagSet in) {
   DWORD access = 0;
   DWORD creation = OPEN_EXISTING;
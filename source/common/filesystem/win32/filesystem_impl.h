@@ -97,6 +97,7 @@ public:
   bool illegalPath(const std::string& path) override;
   Api::IoCallResult<FileInfo> stat(absl::string_view path) override;
   Api::IoCallBoolResult createPath(absl::string_view path) override;
+  Api::IoCallBoolResult rename(const std::string& old_path, const std::string& new_path) override;
 };
 
 using FileImpl = FileImplWin32;
@@ -107,6 +107,17 @@ ProtobufWkt::Value HeaderFormatter::formatValue(const Http::HeaderMap& headers)
   return ValueUtil::stringValue(val);
 }
 
+bool HeaderFormatter::append(const Http::HeaderMap& headers, std::string& output) const {
+  const Http::HeaderEntry* header = findHeader(headers);
+  if (!header) {
+    return false;
+  }
+
+  const absl::string_view val = header->value().getStringView();
+  output.append(max_length_.has_value() ? val.substr(0, max_length_.value()) : val);
+  return true;
+}
+
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
                                                  const std::string& alternative_header,
                                                  absl::optional<size_t> max_length)
@@ -124,6 +135,12 @@ ResponseHeaderFormatter::formatValueWithContext(const HttpFormatterContext& cont
   return HeaderFormatter::formatValue(context.responseHeaders());
 }
 
+bool ResponseHeaderFormatter::appendWithContext(const HttpFormatterContext& context,
+                                                const StreamInfo::StreamInfo&,
+                                                std::string& output) const {
+  return HeaderFormatter::append(context.responseHeaders(), output);
+}
+
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                const std::string& alternative_header,
                                                absl::optional<size_t> max_length)
@@ -141,6 +158,12 @@ RequestHeaderFormatter::formatValueWithContext(const HttpFormatterContext& conte
   return HeaderFormatter::formatValue(context.requestHeaders());
 }
 
+bool RequestHeaderFormatter::appendWithContext(const HttpFormatterContext& context,
+                                               const StreamInfo::StreamInfo&,
+                                               std::string& output) const {
+  return HeaderFormatter::append(context.requestHeaders(), output);
+}
+
 ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_header,
                                                    const std::string& alternative_header,
                                                    absl::optional<size_t> max_length)
@@ -158,6 +181,12 @@ ResponseTrailerFormatter::formatValueWithContext(const HttpFormatterContext& con
   return HeaderFormatter::formatValue(context.responseTrailers());
 }
 
+bool ResponseTrailerFormatter::appendWithContext(const HttpFormatterContext& context,
+                                                 const StreamInfo::StreamInfo&,
+                                                 std::string& output) const {
+  return HeaderFormatter::append(context.responseTrailers(), output);
+}
+
 HeadersByteSizeFormatter::HeadersByteSizeFormatter(const HeaderType header_type)
     : header_type_(header_type) {}
 
@@ -450,6 +450,16 @@ public:
 
     return fmt::format_int(millis.value()).str();
   }
+  bool append(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const auto millis = extractMillis(stream_info);
+    if (!millis) {
+      return false;
+    }
+
+    const fmt::format_int formatted(millis.value());
+    output.append(formatted.data(), formatted.size());
+    return true;
+  }
   ProtobufWkt::Value formatValue(const StreamInfo::StreamInfo& stream_info) const override {
     const auto millis = extractMillis(stream_info);
     if (!millis) {
@@ -482,6 +492,11 @@ public:
   absl::optional<std::string> format(const StreamInfo::StreamInfo& stream_info) const override {
     return fmt::format_int(field_extractor_(stream_info)).str();
   }
+  bool append(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    const fmt::format_int formatted(field_extractor_(stream_info));
+    output.append(formatted.data(), formatted.size());
+    return true;
+  }
   ProtobufWkt::Value formatValue(const StreamInfo::StreamInfo& stream_info) const override {
     return ValueUtil::numberValue(field_extractor_(stream_info));
   }
@@ -524,6 +539,30 @@ public:
 
     return toString(*address);
   }
+  bool append(const StreamInfo::StreamInfo& stream_info, std::string& output) const override {
+    Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
+    if (!address) {
+      return false;
+    }
+
+    // Addresses cache their string forms, so only the port needs formatting.
+    switch (extraction_type_) {
+    case StreamInfoAddressFieldExtractionType::WithPort:
+      output.append(address->asStringView());
+      break;
+    case StreamInfoAddressFieldExtractionType::WithoutPort:
+      if (address->type() == Network::Address::Type::Ip) {
+        output.append(address->ip()->addressAsString());
+      } else {
+        output.append(address->asStringView());
+      }
+      break;
+    case StreamInfoAddressFieldExtractionType::JustPort:
+      output.append(toString(*address));
+      break;
+    }
+    return true;
+  }
   ProtobufWkt::Value formatValue(const StreamInfo::StreamInfo& stream_info) const override {
     Network::Address::InstanceConstSharedPtr address = field_extractor_(stream_info);
     if (!address) {
@@ -25,6 +25,17 @@ public:
 
   virtual absl::optional<std::string> format(const StreamInfo::StreamInfo&) const PURE;
   virtual ProtobufWkt::Value formatValue(const StreamInfo::StreamInfo&) const PURE;
+
+  // Appends the value to the output, returning false if there is no value. This is equivalent
+  // to format(), and is overridden by the providers which can avoid the intermediate string.
+  virtual bool append(const StreamInfo::StreamInfo& stream_info, std::string& output) const {
+    const absl::optional<std::string> value = format(stream_info);
+    if (!value.has_value()) {
+      return false;
+    }
+    output.append(value.value());
+    return true;
+  }
 };
 
 using StreamInfoFormatterProviderPtr = std::unique_ptr<StreamInfoFormatterProvider>;
@@ -220,6 +231,13 @@ public:
                                             const StreamInfo::StreamInfo&) const override {
     return str_;
   }
+  bool appendWithContext(const FormatterContext&, const StreamInfo::StreamInfo&,
+                         std::string& output) const override {
+    output.append(str_.string_value());
+    return true;
+  }
+
+  const std::string& value() const { return str_.string_value(); }
 
 private:
   ProtobufWkt::Value str_;
@@ -299,6 +317,10 @@ public:
                          const StreamInfo::StreamInfo& stream_info) const override {
     return formatter_->formatValue(stream_info);
   }
+  bool appendWithContext(const FormatterContext&, const StreamInfo::StreamInfo& stream_info,
+                         std::string& output) const override {
+    return formatter_->append(stream_info, output);
+  }
 
 private:
   StreamInfoFormatterProviderPtr formatter_;
@@ -15,6 +15,7 @@
 #include "source/common/formatter/http_specific_formatter.h"
 #include "source/common/formatter/stream_info_formatter.h"
 #include "source/common/json/json_loader.h"
+#include "source/common/json/json_streamer.h"
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
@@ -142,12 +143,14 @@ public:
       : empty_value_string_(omit_empty_values ? absl::string_view{}
                                               : DefaultUnspecifiedValueStringView) {
     providers_ = SubstitutionFormatParser::parse<FormatterContext>(format);
+    compileSegments();
   }
   CommonFormatterBaseImpl(const std::string& format, bool omit_empty_values,
                           const CommandParsers& command_parsers)
       : empty_value_string_(omit_empty_values ? absl::string_view{}
                                               : DefaultUnspecifiedValueStringView) {
     providers_ = SubstitutionFormatParser::parse<FormatterContext>(format, command_parsers);
+    compileSegments();
   }
 
   // FormatterBase
@@ -155,18 +158,49 @@ public:
                                 const StreamInfo::StreamInfo& stream_info) const override {
     std::string log_line;
     log_line.reserve(256);
+    appendWithContext(context, stream_info, log_line);
+    return log_line;
+  }
+  void appendWithContext(const FormatterContext& context, const StreamInfo::StreamInfo& stream_info,
+                         std::string& output) const override {
+    for (const Segment& segment : segments_) {
+      output.append(segment.constant_);
+      if (segment.provider_ != nullptr &&
+          !segment.provider_->appendWithContext(context, stream_info, output)) {
+        output.append(empty_value_string_);
+      }
+    }
+  }
+
+private:
+  // A constant text followed by the output of a provider, if any. Consecutive constants are
+  // merged at construction, so that formatting a line only calls the providers of the commands.
+  struct Segment {
+    std::string constant_;
+    const FormatterProviderBase<FormatterContext>* provider_{};
+  };
 
+  void compileSegments() {
+    Segment segment;
     for (const auto& provider : providers_) {
-      const auto bit = provider->formatWithContext(context, stream_info);
-      log_line += bit.value_or(empty_value_string_);
+      const auto* plain_string =
+          dynamic_cast<const CommonPlainStringFormatterBase<FormatterContext>*>(provider.get());
+      if (plain_string != nullptr) {
+        segment.constant_.append(plain_string->value());
+        continue;
+      }
+      segment.provider_ = provider.get();
+      segments_.push_back(std::move(segment));
+      segment = Segment();
+    }
+    if (!segment.constant_.empty()) {
+      segments_.push_back(std::move(segment));
     }
-
-    return log_line;
   }
 
-private:
   const std::string empty_value_string_;
   std::vector<FormatterProviderBasePtr<FormatterContext>> providers_;
+  std::vector<Segment> segments_;
 };
 
 template <class FormatterContext>
@@ -212,6 +246,32 @@ public:
     return structFormatMapCallback(struct_output_format_, visitor).struct_value();
   }
 
+  /**
+   * Stream the log entry as a JSON map, writing the typed values of the commands directly into
+   * the streamer rather than building a Struct first. The properties of the format are written
+   * in the order of their names.
+   */
+  void streamWithContext(const FormatterContext& context, const StreamInfo::StreamInfo& info,
+                         Json::Streamer& streamer) const {
+    StructFormatMapVisitor visitor{
+        [&](const std::vector<FormatterProviderBasePtr<FormatterContext>>& providers) {
+          return providersCallback(providers, context, info);
+        },
+        [&, this](const StructFormatterBase::StructFormatMapWrapper& format_map) {
+          return structFormatMapCallback(format_map, visitor);
+        },
+        [&, this](const StructFormatterBase::StructFormatListWrapper& format_list) {
+          return structFormatListCallback(format_list, visitor);
+        },
+    };
+    // Reused by the string values of all the properties.
+    std::string str;
+    Json::Streamer::MapPtr map = streamer.makeRootMap();
+    for (const auto& pair : *struct_output_format_.value_) {
+      streamFormatValue(pair.second, context, info, visitor, *map, map.get(), pair.first, str);
+    }
+  }
+
 private:
   struct StructFormatMapWrapper;
   struct StructFormatListWrapper;
@@ -325,20 +385,25 @@ private:
         return provider->formatValueWithContext(context, stream_info);
       }
 
-      if (omit_empty_values_) {
-        return ValueUtil::optionalStringValue(provider->formatWithContext(context, stream_info));
+      // Append directly into the value, rather than copying an intermediate string into it.
+      ProtobufWkt::Value value;
+      if (!provider->appendWithContext(context, stream_info, *value.mutable_string_value())) {
+        if (omit_empty_values_) {
+          return ValueUtil::nullValue();
+        }
+        value.set_string_value(empty_value_);
       }
-
-      const auto str = provider->formatWithContext(context, stream_info);
-      return ValueUtil::stringValue(str.value_or(empty_value_));
+      return value;
     }
     // Multiple providers forces string output.
-    std::string str;
+    ProtobufWkt::Value value;
+    std::string& str = *value.mutable_string_value();
     for (const auto& provider : providers) {
-      const auto bit = provider->formatWithContext(context, stream_info);
-      str += bit.value_or(empty_value_);
+      if (!provider->appendWithContext(context, stream_info, str)) {
+        str.append(empty_value_);
+      }
     }
-    return ValueUtil::stringValue(str);
+    return value;
   }
   ProtobufWkt::Value
   structFormatMapCallback(const StructFormatterBase::StructFormatMapWrapper& format_map,
@@ -371,6 +436,103 @@ private:
     return ValueUtil::listValue(output);
   }
 
+
+  // Methods for streaming JSON, which write the same values as the ones above. The value is
+  // written into the level, preceded by the key if the level is a map.
+  void streamFormatValue(const StructFormatValue& format_value, const FormatterContext& context,
+                         const StreamInfo::StreamInfo& stream_info,
+                         const StructFormatMapVisitor& visitor, Json::Streamer::Level& level,
+                         Json::Streamer::Map* map, absl::string_view key, std::string& str) const {
+    const auto add_key = [map, key] {
+      if (map != nullptr) {
+        map->addKey(key);
+      }
+    };
+    using Providers = const std::vector<FormatterProviderBasePtr<FormatterContext>>;
+    if (absl::holds_alternative<Providers>(format_value)) {
+      const auto& providers = absl::get<Providers>(format_value);
+      if (providers.size() == 1 && preserve_types_) {
+        const ProtobufWkt::Value value =
+            providers.front()->formatValueWithContext(context, stream_info);
+        if (omit_empty_values_ && value.kind_case() == ProtobufWkt::Value::kNullValue) {
+          return;
+        }
+        add_key();
+        streamValue(value, level);
+        return;
+      }
+
+      str.clear();
+      for (const auto& provider : providers) {
+        if (!provider->appendWithContext(context, stream_info, str)) {
+          if (omit_empty_values_ && providers.size() == 1) {
+            return;
+          }
+          str.append(empty_value_);
+        }
+      }
+      add_key();
+      level.addString(str);
+      return;
+    }
+
+    // Whether a nested map is empty, and so omitted with its key, is only known once formatted.
+    if (omit_empty_values_) {
+      const ProtobufWkt::Value value = absl::visit(visitor, format_value);
+      if (value.kind_case() == ProtobufWkt::Value::kNullValue) {
+        return;
+      }
+      add_key();
+      streamValue(value, level);
+      return;
+    }
+
+    add_key();
+    if (absl::holds_alternative<const StructFormatMapWrapper>(format_value)) {
+      Json::Streamer::MapPtr sub_map = level.addMap();
+      for (const auto& pair : *absl::get<const StructFormatMapWrapper>(format_value).value_) {
+        streamFormatValue(pair.second, context, stream_info, visitor, *sub_map, sub_map.get(),
+                          pair.first, str);
+      }
+      return;
+    }
+    Json::Streamer::ArrayPtr array = level.addArray();
+    for (const auto& val : *absl::get<const StructFormatListWrapper>(format_value).value_) {
+      streamFormatValue(val, context, stream_info, visitor, *array, nullptr, {}, str);
+    }
+  }
+  static void streamValue(const ProtobufWkt::Value& value, Json::Streamer::Level& level) {
+    switch (value.kind_case()) {
+    case ProtobufWkt::Value::kStringValue:
+      level.addString(value.string_value());
+      break;
+    case ProtobufWkt::Value::kNumberValue:
+      level.addNumber(value.number_value());
+      break;
+    case ProtobufWkt::Value::kBoolValue:
+      level.addBool(value.bool_value());
+      break;
+    case ProtobufWkt::Value::kStructValue: {
+      Json::Streamer::MapPtr map = level.addMap();
+      for (const auto& pair : value.struct_value().fields()) {
+        map->addKey(pair.first);
+        streamValue(pair.second, *map);
+      }
+      break;
+    }
+    case ProtobufWkt::Value::kListValue: {
+      Json::Streamer::ArrayPtr array = level.addArray();
+      for (const auto& val : value.list_value().values()) {
+        streamValue(val, *array);
+      }
+      break;
+    }
+    default:
+      level.addNull();
+      break;
+    }
+  }
+
   const bool omit_empty_values_;
   const bool preserve_types_;
   const std::string empty_value_;
@@ -411,6 +573,22 @@ public:
     return absl::StrCat(log_line, "\n");
   }
 
+  /**
+   * Stream the log line into the output, serializing the typed values of the commands as they are
+   * formatted rather than through an intermediate Struct. The properties are written in the order
+   * of their names, and the numbers in their shortest form, so the line may differ from the one
+   * of formatWithContext() in its layout but not in its content.
+   * @param context supplies the formatter context.
+   * @param info supplies the stream info.
+   * @param output supplies the buffer to stream the line into.
+   */
+  void streamWithContext(const FormatterContext& context, const StreamInfo::StreamInfo& info,
+                         Buffer::Instance& output) const {
+    Json::Streamer streamer(output);
+    struct_formatter_.streamWithContext(context, info, streamer);
+    output.add("\n");
+  }
+
 private:
   const StructFormatterBase<FormatterContext> struct_formatter_;
   const bool sort_properties_;
@@ -35,7 +35,7 @@ CodecClient::CodecClient(CodecType type, Network::ClientConnectionPtr&& connecti
   connection_->addReadFilter(Network::ReadFilterSharedPtr{new CodecReadFilter(*this)});
 
   if (idle_timeout_) {
-    idle_timer_ = dispatcher.createTimer([this]() -> void { onIdleTimeout(); });
+    idle_timer_ = dispatcher.createCoarseTimer([this]() -> void { onIdleTimeout(); });
     enableIdleTimer();
   }
 
@@ -842,7 +842,10 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
                       connection_manager_.config_.localReply(),
                       connection_manager_.codec_->protocol(), connection_manager_.timeSource(),
                       connection_manager_.read_callbacks_->connection().streamInfo().filterState(),
-                      StreamInfo::FilterState::LifeSpan::Connection),
+                      StreamInfo::FilterState::LifeSpan::Connection,
+                      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http_stream_arena")
+                          ? makeOptRef<Arena>(arena_)
+                          : OptRef<Arena>()),
       request_response_timespan_(new Stats::HistogramCompletableTimespanImpl(
           connection_manager_.stats_.named_.downstream_rq_time_, connection_manager_.timeSource())),
       header_validator_(
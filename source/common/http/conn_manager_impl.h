@@ -36,6 +36,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "source/common/buffer/watermark_buffer.h"
+#include "source/common/common/arena.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/linked_object.h"
 #include "source/common/grpc/common.h"
@@ -433,6 +434,11 @@ private:
     // present). Return false if this stream was not deferred.
     bool onDeferredRequestProcessing();
 
+    // The arena of the objects living as long as the stream, e.g. the filters. It is declared
+    // first, so that it is destroyed after them. Its first block is only allocated on the first
+    // allocation, so that streams do not grow when the arena is disabled, and the filters of a
+    // typical chain then take a single allocation.
+    ArenaImpl arena_{nullptr, 2048};
     ConnectionManagerImpl& connection_manager_;
     OptRef<const TracingConnectionManagerConfig> connection_manager_tracing_config_;
     // TODO(snowp): It might make sense to move this to the FilterManager to avoid storing it in
@@ -52,6 +52,12 @@ HttpConnPoolImplBase::HttpConnPoolImplBase(
           wrapTransportSocketOptions(transport_socket_options, protocols), state),
       random_generator_(random_generator) {
   ASSERT(!protocols.empty());
+  const auto& upstream_options = host_->cluster().upstreamHttpProtocolOptions();
+  if (upstream_options.has_value() && upstream_options->least_loaded_connection() &&
+      std::find(protocols.begin(), protocols.end(), Http::Protocol::Http11) == protocols.end()) {
+    // Only connections multiplexing streams have a load to balance.
+    enableLeastLoadedClientSelection();
+  }
 }
 
 HttpConnPoolImplBase::~HttpConnPoolImplBase() { destructAllConnections(); }
@@ -71,6 +71,9 @@ public:
                                          Http::ConnectionPool::Callbacks& callbacks,
                                          const Instance::StreamOptions& options) override;
   bool maybePreconnect(float ratio) override { return maybePreconnectImpl(ratio); }
+  uint32_t prewarm(uint32_t unused_capacity, uint32_t max_new_connections) override {
+    return prewarmImpl(unused_capacity, max_new_connections);
+  }
   bool hasActiveConnections() const override;
 
   // Creates a new PendingStream and enqueues it into the queue.
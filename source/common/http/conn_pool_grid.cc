@@ -361,6 +361,10 @@ bool ConnectivityGrid::maybePreconnect(float) {
   return false; // Preconnect not yet supported for the grid.
 }
 
+uint32_t ConnectivityGrid::prewarm(uint32_t, uint32_t) {
+  return 0; // Prewarming not yet supported for the grid.
+}
+
 absl::optional<ConnectivityGrid::PoolIterator> ConnectivityGrid::nextPool(PoolIterator pool_it) {
   pool_it++;
   if (pool_it != pools_.end()) {
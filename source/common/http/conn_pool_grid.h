@@ -154,6 +154,7 @@ public:
   void drainConnections(Envoy::ConnectionPool::DrainBehavior drain_behavior) override;
   Upstream::HostDescriptionConstSharedPtr host() const override;
   bool maybePreconnect(float preconnect_ratio) override;
+  uint32_t prewarm(uint32_t unused_capacity, uint32_t max_new_connections) override;
   absl::string_view protocolDescription() const override { return "connection grid"; }
 
   // Returns the next pool in the ordered priority list.
@@ -10,6 +10,7 @@
 #include "source/common/common/logger.h"
 #include "source/common/filter/config_discovery_impl.h"
 #include "source/common/http/dependency_manager.h"
+#include "source/common/http/filter_recycler.h"
 #include "source/extensions/filters/http/common/pass_through_filter.h"
 
 namespace Envoy {
@@ -71,13 +72,17 @@ public:
   using FilterConfigProviderManager =
       Filter::FilterConfigProviderManager<Filter::NamedHttpFilterFactoryCb, FilterCtx>;
 
+  // If max_recycled_filters is not zero, the filters of the static filter configs are recycled
+  // for the next streams of their worker, up to max_recycled_filters per filter config and worker.
+  // See Http::FilterRecycler.
   FilterChainHelper(FilterConfigProviderManager& filter_config_provider_manager,
                     Server::Configuration::ServerFactoryContext& server_context,
                     Upstream::ClusterManager& cluster_manager, FilterCtx& factory_context,
-                    const std::string& stats_prefix)
+                    const std::string& stats_prefix, uint32_t max_recycled_filters = 0)
       : filter_config_provider_manager_(filter_config_provider_manager),
         server_context_(server_context), cluster_manager_(cluster_manager),
-        factory_context_(factory_context), stats_prefix_(stats_prefix) {}
+        factory_context_(factory_context), stats_prefix_(stats_prefix),
+        max_recycled_filters_(max_recycled_filters) {}
 
   using FiltersList = Protobuf::RepeatedPtrField<
       envoy::extensions::filters::network::http_connection_manager::v3::HttpFilter>;
@@ -151,6 +156,10 @@ private:
     Config::Utility::validateTerminalFilters(proto_config.name(), factory->name(),
                                              filter_chain_type, is_terminal,
                                              last_filter_in_current_config);
+    if (max_recycled_filters_ > 0) {
+      callback = FilterRecycler::createRecyclingFactoryCb(server_context_.threadLocal(),
+                                                          max_recycled_filters_, callback);
+    }
     auto filter_config_provider = filter_config_provider_manager_.createStaticFilterConfigProvider(
         {factory->name(), callback}, proto_config.name());
 #ifdef ENVOY_ENABLE_YAML
@@ -197,6 +206,7 @@ private:
   Upstream::ClusterManager& cluster_manager_;
   FilterCtx& factory_context_;
   const std::string& stats_prefix_;
+  const uint32_t max_recycled_filters_;
 };
 
 } // namespace Http
@@ -14,6 +14,7 @@
 #include "envoy/protobuf/message_validator.h"
 
 #include "source/common/buffer/watermark_buffer.h"
+#include "source/common/common/arena.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/linked_object.h"
 #include "source/common/common/logger.h"
@@ -35,6 +36,17 @@ class FilterManager;
 class DownstreamFilterManager;
 
 struct ActiveStreamFilterBase;
+struct ActiveStreamDecoderFilter;
+struct ActiveStreamEncoderFilter;
+
+// The filter wrappers and the nodes of their lists are allocated from the arena of the stream, if
+// any.
+using ActiveStreamDecoderFilterPtr = ArenaPtr<ActiveStreamDecoderFilter>;
+using ActiveStreamDecoderFilterList =
+    std::list<ActiveStreamDecoderFilterPtr, ArenaAllocator<ActiveStreamDecoderFilterPtr>>;
+using ActiveStreamEncoderFilterPtr = ArenaPtr<ActiveStreamEncoderFilter>;
+using ActiveStreamEncoderFilterList =
+    std::list<ActiveStreamEncoderFilterPtr, ArenaAllocator<ActiveStreamEncoderFilterPtr>>;
 
 constexpr absl::string_view LocalReplyFilterStateKey =
     "envoy.filters.network.http_connection_manager.local_reply_owner";
@@ -198,9 +210,10 @@ struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks,
 /**
  * Wrapper for a stream decoder filter.
  */
-struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
-                                   public StreamDecoderFilterCallbacks,
-                                   LinkedObject<ActiveStreamDecoderFilter> {
+struct ActiveStreamDecoderFilter
+    : public ActiveStreamFilterBase,
+      public StreamDecoderFilterCallbacks,
+      LinkedObject<ActiveStreamDecoderFilter, ActiveStreamDecoderFilterList> {
   ActiveStreamDecoderFilter(FilterManager& parent, StreamDecoderFilterSharedPtr filter,
                             bool is_encoder_decoder_filter, FilterContext filter_context)
       : ActiveStreamFilterBase(parent, is_encoder_decoder_filter, std::move(filter_context)),
@@ -284,14 +297,13 @@ struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
   bool is_grpc_request_{};
 };
 
-using ActiveStreamDecoderFilterPtr = std::unique_ptr<ActiveStreamDecoderFilter>;
-
 /**
  * Wrapper for a stream encoder filter.
  */
-struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
-                                   public StreamEncoderFilterCallbacks,
-                                   LinkedObject<ActiveStreamEncoderFilter> {
+struct ActiveStreamEncoderFilter
+    : public ActiveStreamFilterBase,
+      public StreamEncoderFilterCallbacks,
+      LinkedObject<ActiveStreamEncoderFilter, ActiveStreamEncoderFilterList> {
   ActiveStreamEncoderFilter(FilterManager& parent, StreamEncoderFilterSharedPtr filter,
                             bool is_encoder_decoder_filter, FilterContext filter_context)
       : ActiveStreamFilterBase(parent, is_encoder_decoder_filter, std::move(filter_context)),
@@ -343,8 +355,6 @@ struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
   StreamEncoderFilterSharedPtr handle_;
 };
 
-using ActiveStreamEncoderFilterPtr = std::unique_ptr<ActiveStreamEncoderFilter>;
-
 /**
  * Callbacks invoked by the FilterManager to pass filter data/events back to the caller.
  */
@@ -636,16 +646,31 @@ public:
   FilterManager(FilterManagerCallbacks& filter_manager_callbacks, Event::Dispatcher& dispatcher,
                 OptRef<const Network::Connection> connection, uint64_t stream_id,
                 Buffer::BufferMemoryAccountSharedPtr account, bool proxy_100_continue,
-                uint32_t buffer_limit, const FilterChainFactory& filter_chain_factory)
+                uint32_t buffer_limit, const FilterChainFactory& filter_chain_factory,
+                OptRef<Arena> arena)
       : filter_manager_callbacks_(filter_manager_callbacks), dispatcher_(dispatcher),
         connection_(connection), stream_id_(stream_id), account_(std::move(account)),
-        proxy_100_continue_(proxy_100_continue), buffer_limit_(buffer_limit),
+        proxy_100_continue_(proxy_100_continue), arena_(arena),
+        decoder_filters_(ArenaAllocator<ActiveStreamDecoderFilterPtr>(arena)),
+        encoder_filters_(ArenaAllocator<ActiveStreamEncoderFilterPtr>(arena)),
+        filters_(ArenaAllocator<StreamFilterBase*>(arena)),
+        filter_release_callbacks_(ArenaAllocator<FilterReleaseCallbacks*>(arena)),
+        buffer_limit_(buffer_limit),
         filter_chain_factory_(filter_chain_factory),
         no_downgrade_to_canonical_name_(Runtime::runtimeFeatureEnabled(
             "envoy.reloadable_features.no_downgrade_to_canonical_name")) {}
   ~FilterManager() override {
     ASSERT(state_.destroyed_);
     ASSERT(state_.filter_call_state_ == 0);
+    if (!filter_release_callbacks_.empty()) {
+      // Drop the references to the filters before releasing them.
+      decoder_filters_.clear();
+      encoder_filters_.clear();
+      filters_.clear();
+      for (FilterReleaseCallbacks* callbacks : filter_release_callbacks_) {
+        callbacks->onFiltersReleased();
+      }
+    }
   }
 
   // ScopeTrackedObject
@@ -905,24 +930,24 @@ private:
 
     void addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr filter) override {
       manager_.addStreamFilterBase(filter.get());
-      manager_.addStreamDecoderFilter(std::make_unique<ActiveStreamDecoderFilter>(
-          manager_, std::move(filter), false, context_));
+      manager_.addStreamDecoderFilter(makeArenaPtr<ActiveStreamDecoderFilter>(
+          manager_.arena_, manager_, std::move(filter), false, context_));
     }
 
     void addStreamEncoderFilter(Http::StreamEncoderFilterSharedPtr filter) override {
       manager_.addStreamFilterBase(filter.get());
-      manager_.addStreamEncoderFilter(std::make_unique<ActiveStreamEncoderFilter>(
-          manager_, std::move(filter), false, context_));
+      manager_.addStreamEncoderFilter(makeArenaPtr<ActiveStreamEncoderFilter>(
+          manager_.arena_, manager_, std::move(filter), false, context_));
     }
 
     void addStreamFilter(Http::StreamFilterSharedPtr filter) override {
       StreamDecoderFilter* decoder_filter = filter.get();
       manager_.addStreamFilterBase(decoder_filter);
 
-      manager_.addStreamDecoderFilter(
-          std::make_unique<ActiveStreamDecoderFilter>(manager_, filter, true, context_));
-      manager_.addStreamEncoderFilter(
-          std::make_unique<ActiveStreamEncoderFilter>(manager_, std::move(filter), true, context_));
+      manager_.addStreamDecoderFilter(makeArenaPtr<ActiveStreamDecoderFilter>(
+          manager_.arena_, manager_, filter, true, context_));
+      manager_.addStreamEncoderFilter(makeArenaPtr<ActiveStreamEncoderFilter>(
+          manager_.arena_, manager_, std::move(filter), true, context_));
     }
 
     void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override {
@@ -930,6 +955,10 @@ private:
     }
 
     Event::Dispatcher& dispatcher() override { return manager_.dispatcher_; }
+    OptRef<Arena> streamArena() override { return manager_.arena_; }
+    void addFilterReleaseCallbacks(FilterReleaseCallbacks& callbacks) override {
+      manager_.filter_release_callbacks_.push_back(&callbacks);
+    }
 
   private:
     FilterManager& manager_;
@@ -952,11 +981,11 @@ private:
   enum class FilterIterationStartState { AlwaysStartFromNext, CanStartFromCurrent };
 
   // Returns the encoder filter to start iteration with.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator
+  ActiveStreamEncoderFilterList::iterator
   commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream,
                      FilterIterationStartState filter_iteration_start_state);
   // Returns the decoder filter to start iteration with.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator
+  ActiveStreamDecoderFilterList::iterator
   commonDecodePrefix(ActiveStreamDecoderFilter* filter,
                      FilterIterationStartState filter_iteration_start_state);
   void addDecodedData(ActiveStreamDecoderFilter& filter, Buffer::Instance& data, bool streaming);
@@ -965,7 +994,7 @@ private:
   // Helper function for the case where we have a header only request, but a filter adds a body
   // to it.
   void maybeContinueDecoding(
-      const std::list<ActiveStreamDecoderFilterPtr>::iterator& maybe_continue_data_entry);
+      const ActiveStreamDecoderFilterList::iterator& maybe_continue_data_entry);
   void decodeHeaders(ActiveStreamDecoderFilter* filter, RequestHeaderMap& headers, bool end_stream);
   // Sends data through decoding filter chains. filter_iteration_start_state indicates which
   // filter to start the iteration with.
@@ -980,7 +1009,7 @@ private:
   // filters before calling encodeHeadersInternal which does final header munging and passes the
   // headers to the encoder.
   void maybeContinueEncoding(
-      const std::list<ActiveStreamEncoderFilterPtr>::iterator& maybe_continue_data_entry);
+      const ActiveStreamEncoderFilterList::iterator& maybe_continue_data_entry);
   void encodeHeaders(ActiveStreamEncoderFilter* filter, ResponseHeaderMap& headers,
                      bool end_stream);
   // Sends data through encoding filter chains. filter_iteration_start_state indicates which
@@ -1015,10 +1044,15 @@ private:
   const uint64_t stream_id_;
   Buffer::BufferMemoryAccountSharedPtr account_;
   const bool proxy_100_continue_;
-
-  std::list<ActiveStreamDecoderFilterPtr> decoder_filters_;
-  std::list<ActiveStreamEncoderFilterPtr> encoder_filters_;
-  std::list<StreamFilterBase*> filters_;
+  // The arena of the stream, from which the filters are allocated, if any.
+  const OptRef<Arena> arena_;
+
+  ActiveStreamDecoderFilterList decoder_filters_;
+  ActiveStreamEncoderFilterList encoder_filters_;
+  std::list<StreamFilterBase*, ArenaAllocator<StreamFilterBase*>> filters_;
+  // Notified once the filters above are destroyed, e.g. to recycle them.
+  std::list<FilterReleaseCallbacks*, ArenaAllocator<FilterReleaseCallbacks*>>
+      filter_release_callbacks_;
   std::list<AccessLog::InstanceSharedPtr> access_log_handlers_;
 
   // Stores metadata added in the decoding filter that is being processed. Will be cleared before
@@ -1089,9 +1123,10 @@ public:
                           const LocalReply::LocalReply& local_reply, Http::Protocol protocol,
                           TimeSource& time_source,
                           StreamInfo::FilterStateSharedPtr parent_filter_state,
-                          StreamInfo::FilterState::LifeSpan filter_state_life_span)
+                          StreamInfo::FilterState::LifeSpan filter_state_life_span,
+                          OptRef<Arena> arena)
       : FilterManager(filter_manager_callbacks, dispatcher, connection, stream_id, account,
-                      proxy_100_continue, buffer_limit, filter_chain_factory),
+                      proxy_100_continue, buffer_limit, filter_chain_factory, arena),
         stream_info_(protocol, time_source, connection.connectionInfoProviderSharedPtr(),
                      parent_filter_state, filter_state_life_span),
         local_reply_(local_reply) {}
@@ -0,0 +1,146 @@
+#include "source/common/http/filter_recycler.h"
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Http {
+
+FilterRecycler::FilterRecycler(ThreadLocal::SlotAllocator& tls, uint32_t max_recycled_filters)
+    : slot_(ThreadLocal::TypedSlot<ThreadLocalRecycler>::makeUnique(tls)) {
+  slot_->set([max_recycled_filters](Event::Dispatcher&) {
+    return std::make_shared<ThreadLocalRecycler>(max_recycled_filters);
+  });
+}
+
+FilterFactoryCb FilterRecycler::createRecyclingFactoryCb(ThreadLocal::SlotAllocator& tls,
+                                                         uint32_t max_recycled_filters,
+                                                         FilterFactoryCb factory) {
+  auto recycler = std::make_shared<FilterRecycler>(tls, max_recycled_filters);
+  return [recycler, factory = std::move(factory)](FilterChainFactoryCallbacks& callbacks) {
+    recycler->createFilters(callbacks, factory);
+  };
+}
+
+void FilterRecycler::createFilters(FilterChainFactoryCallbacks& callbacks,
+                                   const FilterFactoryCb& factory) {
+  OptRef<ThreadLocalRecycler> recycler = slot_->get();
+  if (!recycler.has_value()) {
+    factory(callbacks);
+    return;
+  }
+  recycler->createFilters(callbacks, factory);
+}
+
+void FilterRecycler::FilterSet::addTo(FilterChainFactoryCallbacks& callbacks) const {
+  for (const RecycledFilter& filter : filters_) {
+    if (absl::holds_alternative<StreamDecoderFilterSharedPtr>(filter)) {
+      callbacks.addStreamDecoderFilter(absl::get<StreamDecoderFilterSharedPtr>(filter));
+    } else if (absl::holds_alternative<StreamEncoderFilterSharedPtr>(filter)) {
+      callbacks.addStreamEncoderFilter(absl::get<StreamEncoderFilterSharedPtr>(filter));
+    } else {
+      callbacks.addStreamFilter(absl::get<StreamFilterSharedPtr>(filter));
+    }
+  }
+}
+
+bool FilterRecycler::FilterSet::released() const {
+  for (const RecycledFilter& filter : filters_) {
+    const long use_count =
+        absl::visit([](const auto& shared_filter) { return shared_filter.use_count(); }, filter);
+    if (use_count != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FilterRecycler::FilterSet::resetForReuse() {
+  for (const RecycledFilter& filter : filters_) {
+    absl::visit(
+        [](const auto& shared_filter) {
+          dynamic_cast<ResettableFilter&>(*shared_filter).resetForReuse();
+        },
+        filter);
+  }
+}
+
+void FilterRecycler::FilterSet::onFiltersReleased() {
+  FilterSetPtr filter_set(this);
+  std::shared_ptr<ThreadLocalRecycler> recycler = parent_.lock();
+  // The filters outliving their recycler, e.g. on the shutdown of their worker, are destroyed.
+  if (recycler != nullptr) {
+    recycler->release(std::move(filter_set));
+  }
+}
+
+void FilterRecycler::RecordingCallbacks::addStreamDecoderFilter(
+    StreamDecoderFilterSharedPtr filter) {
+  recyclable_ = recyclable_ && dynamic_cast<ResettableFilter*>(filter.get()) != nullptr;
+  filter_set_.filters_.emplace_back(filter);
+  callbacks_.addStreamDecoderFilter(std::move(filter));
+}
+
+void FilterRecycler::RecordingCallbacks::addStreamEncoderFilter(
+    StreamEncoderFilterSharedPtr filter) {
+  recyclable_ = recyclable_ && dynamic_cast<ResettableFilter*>(filter.get()) != nullptr;
+  filter_set_.filters_.emplace_back(filter);
+  callbacks_.addStreamEncoderFilter(std::move(filter));
+}
+
+void FilterRecycler::RecordingCallbacks::addStreamFilter(StreamFilterSharedPtr filter) {
+  recyclable_ = recyclable_ && dynamic_cast<ResettableFilter*>(filter.get()) != nullptr;
+  filter_set_.filters_.emplace_back(filter);
+  callbacks_.addStreamFilter(std::move(filter));
+}
+
+void FilterRecycler::RecordingCallbacks::addAccessLogHandler(
+    AccessLog::InstanceSharedPtr handler) {
+  // The handlers are not recorded, so the filters adding them are not recycled.
+  recyclable_ = false;
+  callbacks_.addAccessLogHandler(std::move(handler));
+}
+
+void FilterRecycler::RecordingCallbacks::addFilterReleaseCallbacks(
+    FilterReleaseCallbacks& callbacks) {
+  callbacks_.addFilterReleaseCallbacks(callbacks);
+}
+
+void FilterRecycler::ThreadLocalRecycler::createFilters(FilterChainFactoryCallbacks& callbacks,
+                                                        const FilterFactoryCb& factory) {
+  if (!recyclable_) {
+    factory(callbacks);
+    return;
+  }
+
+  if (!free_filter_sets_.empty()) {
+    FilterSetPtr filter_set = std::move(free_filter_sets_.back());
+    free_filter_sets_.pop_back();
+    filter_set->addTo(callbacks);
+    // The set owns itself until its stream releases it.
+    callbacks.addFilterReleaseCallbacks(*filter_set.release());
+    return;
+  }
+
+  auto filter_set = std::make_unique<FilterSet>(weak_from_this());
+  RecordingCallbacks recording_callbacks(callbacks, *filter_set);
+  factory(recording_callbacks);
+  if (!recording_callbacks.recyclable()) {
+    recyclable_ = false;
+    return;
+  }
+  if (filter_set->filters_.empty()) {
+    return;
+  }
+  callbacks.addFilterReleaseCallbacks(*filter_set.release());
+}
+
+void FilterRecycler::ThreadLocalRecycler::release(FilterSetPtr&& filter_set) {
+  if (free_filter_sets_.size() >= max_recycled_filters_ || !filter_set->released()) {
+    return;
+  }
+  filter_set->resetForReuse();
+  free_filter_sets_.push_back(std::move(filter_set));
+}
+
+} // namespace Http
+} // namespace Envoy
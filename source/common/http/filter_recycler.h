@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/http/filter.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "absl/container/inlined_vector.h"
+#include "absl/types/variant.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Recycles the filters created by a filter factory for the next streams of their worker, rather
+ * than destroying them with their stream. The filters released by a stream are reset and kept, up
+ * to a limit per worker, and added to the next streams of the worker instead of calling the
+ * factory again. A recycled filter keeps its shared_ptr, so its reuse takes no allocation.
+ *
+ * The filters of a factory are recycled if they all implement Http::ResettableFilter, and the
+ * factory adds no access log handler. Otherwise the factory is called for each stream as usual.
+ * A filter still referenced elsewhere when its stream is destroyed, e.g. by a pending callback, is
+ * not recycled.
+ */
+class FilterRecycler {
+public:
+  /**
+   * @param tls supplies the allocator of the slot of the per-worker filters.
+   * @param max_recycled_filters supplies the maximum number of sets of filters, i.e. of calls to
+   *        the factory, kept by each worker.
+   */
+  FilterRecycler(ThreadLocal::SlotAllocator& tls, uint32_t max_recycled_filters);
+
+  /**
+   * @return a factory callback adding the filters of the supplied factory, recycled if possible.
+   */
+  static FilterFactoryCb createRecyclingFactoryCb(ThreadLocal::SlotAllocator& tls,
+                                                  uint32_t max_recycled_filters,
+                                                  FilterFactoryCb factory);
+
+  /**
+   * Add the recycled filters of the current worker to the stream, or the filters of the supplied
+   * factory if there are none.
+   */
+  void createFilters(FilterChainFactoryCallbacks& callbacks, const FilterFactoryCb& factory);
+
+private:
+  class ThreadLocalRecycler;
+
+  using RecycledFilter = absl::variant<StreamDecoderFilterSharedPtr, StreamEncoderFilterSharedPtr,
+                                       StreamFilterSharedPtr>;
+
+  // The filters added by a call to the factory, released together with their stream.
+  struct FilterSet : public FilterReleaseCallbacks {
+    FilterSet(std::weak_ptr<ThreadLocalRecycler> parent) : parent_(std::move(parent)) {}
+
+    void addTo(FilterChainFactoryCallbacks& callbacks) const;
+    // @return whether the filters are only referenced by the set.
+    bool released() const;
+    void resetForReuse();
+
+    // Http::FilterReleaseCallbacks
+    void onFiltersReleased() override;
+
+    const std::weak_ptr<ThreadLocalRecycler> parent_;
+    absl::InlinedVector<RecycledFilter, 1> filters_;
+  };
+
+  using FilterSetPtr = std::unique_ptr<FilterSet>;
+
+  // The callbacks recording the filters added by the factory, forwarded to the stream.
+  class RecordingCallbacks : public FilterChainFactoryCallbacks {
+  public:
+    RecordingCallbacks(FilterChainFactoryCallbacks& callbacks, FilterSet& filter_set)
+        : callbacks_(callbacks), filter_set_(filter_set) {}
+
+    bool recyclable() const { return recyclable_; }
+
+    // Http::FilterChainFactoryCallbacks
+    void addStreamDecoderFilter(StreamDecoderFilterSharedPtr filter) override;
+    void addStreamEncoderFilter(StreamEncoderFilterSharedPtr filter) override;
+    void addStreamFilter(StreamFilterSharedPtr filter) override;
+    void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override;
+    Event::Dispatcher& dispatcher() override { return callbacks_.dispatcher(); }
+    OptRef<Arena> streamArena() override { return callbacks_.streamArena(); }
+    void addFilterReleaseCallbacks(FilterReleaseCallbacks& callbacks) override;
+
+  private:
+    FilterChainFactoryCallbacks& callbacks_;
+    FilterSet& filter_set_;
+    bool recyclable_{true};
+  };
+
+  class ThreadLocalRecycler : public ThreadLocal::ThreadLocalObject,
+                              public std::enable_shared_from_this<ThreadLocalRecycler> {
+  public:
+    ThreadLocalRecycler(uint32_t max_recycled_filters)
+        : max_recycled_filters_(max_recycled_filters) {}
+
+    void createFilters(FilterChainFactoryCallbacks& callbacks, const FilterFactoryCb& factory);
+    void release(FilterSetPtr&& filter_set);
+
+  private:
+    const uint32_t max_recycled_filters_;
+    // Cleared once the factory added a filter which cannot be recycled.
+    bool recyclable_{true};
+    std::vector<FilterSetPtr> free_filter_sets_;
+  };
+
+  const ThreadLocal::TypedSlotPtr<ThreadLocalRecycler> slot_;
+};
+
+using FilterRecyclerSharedPtr = std::shared_ptr<FilterRecycler>;
+
+} // namespace Http
+} // namespace Envoy
@@ -74,6 +74,10 @@ struct DelegatingFactoryCallbacks : public Envoy::Http::FilterChainFactoryCallba
       : delegated_callbacks_(delegated_callbacks), match_tree_(match_tree) {}
 
   Event::Dispatcher& dispatcher() override { return delegated_callbacks_.dispatcher(); }
+  OptRef<Arena> streamArena() override { return delegated_callbacks_.streamArena(); }
+  void addFilterReleaseCallbacks(Envoy::Http::FilterReleaseCallbacks& callbacks) override {
+    delegated_callbacks_.addFilterReleaseCallbacks(callbacks);
+  }
   void addStreamDecoderFilter(Envoy::Http::StreamDecoderFilterSharedPtr filter) override {
     auto delegating_filter =
         std::make_shared<DelegatingStreamFilter>(match_tree_, std::move(filter), nullptr);
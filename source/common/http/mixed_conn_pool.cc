@@ -70,7 +70,7 @@ void HttpConnPoolImplMixed::onConnected(Envoy::ConnectionPool::ActiveClient& cli
   data.connection_->readDisable(false);
   data.connection_->removeConnectionCallbacks(*tcp_client);
   data.connection_->removeReadFilter(tcp_client->read_filter_handle_);
-  dispatcher_.deferredDelete(client.removeFromList(owningList(client.state())));
+  dispatcher_.deferredDelete(removeFromOwningList(client));
 
   std::unique_ptr<ActiveClient> new_client;
   if (protocol_ == Http::Protocol::Http11) {
@@ -88,6 +88,18 @@ void Streamer::Level::addString(absl::string_view str) {
   streamer_.addSanitized("\"", str, "\"");
 }
 
+void Streamer::Level::addBool(bool b) {
+  ASSERT_THIS_IS_TOP_LEVEL;
+  nextField();
+  streamer_.addConstantString(b ? "true" : "false");
+}
+
+void Streamer::Level::addNull() {
+  ASSERT_THIS_IS_TOP_LEVEL;
+  nextField();
+  streamer_.addConstantString("null");
+}
+
 #ifndef NDEBUG
 void Streamer::pop(Level* level) {
   ASSERT(levels_.top() == level);
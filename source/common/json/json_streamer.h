@@ -85,6 +85,15 @@ public:
      */
     void addString(absl::string_view str);
 
+    /**
+     * Adds a boolean or a null value to the current array or map. It's a
+     * programming error to call these methods on a map or array that's not the
+     * top level. It's also a programming error to call this on map that isn't
+     * expecting a value. You must call Map::addKey prior to calling this.
+     */
+    void addBool(bool b);
+    void addNull();
+
   protected:
     /**
      * Initiates a new field, serializing a comma separator if this is not the
@@ -83,7 +83,7 @@ ConnectionImpl::ConnectionImpl(Event::Dispatcher& dispatcher, ConnectionSocketPt
       write_buffer_above_high_watermark_(false), detect_early_close_(true),
       enable_half_close_(false), read_end_stream_raised_(false), read_end_stream_(false),
       write_end_stream_(false), current_write_end_stream_(false), dispatch_buffered_data_(false),
-      transport_wants_read_(false) {
+      transport_wants_read_(false), reading_(false), read_budget_exhausted_(false) {
 
   // Keep it as a bool flag to reduce the times calling runtime method..
   enable_rst_detect_send_ = Runtime::runtimeFeatureEnabled(
@@ -246,6 +246,17 @@ void ConnectionImpl::setTransportSocketIsReadable() {
   // Remember that the transport requested read resumption, in case the resumption event is not
   // scheduled immediately or is "lost" because read was disabled.
   transport_wants_read_ = true;
+  if (read_budget_exhausted_) {
+    // Yield to the other connections of the dispatcher. Activating the read event would run it
+    // again in the current iteration of the event loop, before the events of the other
+    // connections which became ready in the meantime are polled.
+    read_budget_exhausted_ = false;
+    if (read_resume_cb_ == nullptr) {
+      read_resume_cb_ = dispatcher_.createSchedulableCallback([this]() { onReadResume(); });
+    }
+    read_resume_cb_->scheduleCallbackNextIteration();
+    return;
+  }
   // Only schedule a read activation if the connection is not read disabled to avoid spurious
   // wakeups. When read disabled, the connection will not read from the transport, and limit
   // dispatch to the current contents of the read buffer if its high-watermark is triggered and
@@ -677,7 +688,14 @@ void ConnectionImpl::onReadReady() {
   // reading from the transport if the read buffer is above high watermark at the start of the
   // method.
   transport_wants_read_ = false;
+  reading_ = true;
+  read_start_length_ = read_buffer_->length();
+  if (dispatcher_.connectionReadBudget().max_time_.count() > 0) {
+    read_start_time_ = dispatcher_.timeSource().monotonicTime();
+  }
   IoResult result = transport_socket_->doRead(*read_buffer_);
+  reading_ = false;
+  read_budget_exhausted_ = false;
   uint64_t new_buffer_size = read_buffer_->length();
   updateReadBufferStats(result.bytes_processed_, new_buffer_size);
 
@@ -716,6 +734,25 @@ void ConnectionImpl::onReadReady() {
   }
 }
 
+void ConnectionImpl::onReadResume() {
+  // A read disabled connection resumes reading when it is read enabled again.
+  if (ioHandle().isOpen() && transport_wants_read_ && read_disable_count_ == 0) {
+    ioHandle().activateFileEvents(Event::FileReadyType::Read);
+  }
+}
+
+bool ConnectionImpl::readBudgetExhausted() {
+  if (!reading_) {
+    return false;
+  }
+  const Event::ConnectionReadBudget& budget = dispatcher_.connectionReadBudget();
+  read_budget_exhausted_ =
+      (budget.max_bytes_ > 0 && read_buffer_->length() >= read_start_length_ + budget.max_bytes_) ||
+      (budget.max_time_.count() > 0 &&
+       dispatcher_.timeSource().monotonicTime() - read_start_time_ >= budget.max_time_);
+  return read_budget_exhausted_;
+}
+
 absl::optional<Connection::UnixDomainSocketPeerCredentials>
 ConnectionImpl::unixSocketPeerCredentials() const {
   // TODO(snowp): Support non-linux platforms.
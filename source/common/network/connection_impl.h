@@ -7,6 +7,8 @@
 #include <string>
 
 #include "envoy/common/scope_tracker.h"
+#include "envoy/common/time.h"
+#include "envoy/event/schedulable_cb.h"
 #include "envoy/network/transport_socket.h"
 
 #include "source/common/buffer/watermark_buffer.h"
@@ -132,13 +134,13 @@ public:
   void raiseEvent(ConnectionEvent event) override;
   // Should the read buffer be drained?
   bool shouldDrainReadBuffer() override {
-    return read_buffer_limit_ > 0 && read_buffer_->length() >= read_buffer_limit_;
+    return (read_buffer_limit_ > 0 && read_buffer_->length() >= read_buffer_limit_) ||
+           readBudgetExhausted();
   }
   // Mark read buffer ready to read in the event loop. This is used when yielding following
-  // shouldDrainReadBuffer().
-  // TODO(htuch): While this is the basis for also yielding to other connections to provide some
-  // fair sharing of CPU resources, the underlying event loop does not make any fairness guarantees.
-  // Reconsider how to make fairness happen.
+  // shouldDrainReadBuffer(). If the connection yields because it exhausted the read budget of the
+  // dispatcher, reading resumes at the next iteration of the event loop, after the events of the
+  // other connections, rather than in the current one.
   void setTransportSocketIsReadable() override;
   void flushWriteBuffer() override;
   TransportSocketPtr& transportSocket() { return transport_socket_; }
@@ -204,6 +206,9 @@ private:
   void onFileEvent(uint32_t events);
   void onRead(uint64_t read_buffer_size);
   void onReadReady();
+  void onReadResume();
+  // Whether the current read exhausted the connection read budget of the dispatcher.
+  bool readBudgetExhausted();
   void onWriteReady();
   void updateReadBufferStats(uint64_t num_read, uint64_t new_size);
   void updateWriteBufferStats(uint64_t num_written, uint64_t new_size);
@@ -227,6 +232,12 @@ private:
   // has been called N times.
   uint64_t last_read_buffer_size_{};
   uint64_t last_write_buffer_size_{};
+  // The length of the read buffer and the time at the start of the current read, against which the
+  // read budget is accounted.
+  uint64_t read_start_length_{};
+  MonotonicTime read_start_time_;
+  // Resumes reading after yielding to the other connections.
+  Event::SchedulableCallbackPtr read_resume_cb_;
   Buffer::Instance* current_write_buffer_{};
   uint32_t read_disable_count_{0};
   DetectedCloseType detected_close_type_{DetectedCloseType::Normal};
@@ -245,6 +256,9 @@ private:
   // in transport socket internal buffers.
   bool transport_wants_read_ : 1;
   bool enable_rst_detect_send_ : 1;
+  // True while the transport socket reads, and once it exhausted the read budget.
+  bool reading_ : 1;
+  bool read_budget_exhausted_ : 1;
 };
 
 class ServerConnectionImpl : public ConnectionImpl, virtual public ServerConnection {
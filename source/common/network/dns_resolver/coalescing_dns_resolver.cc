@@ -0,0 +1,217 @@
+#include "source/common/network/dns_resolver/coalescing_dns_resolver.h"
+
+#include <algorithm>
+
+#include "source/common/protobuf/protobuf.h"
+#include "source/common/protobuf/utility.h"
+#include "source/common/runtime/runtime_features.h"
+
+namespace Envoy {
+namespace Network {
+
+SINGLETON_MANAGER_REGISTRATION(coalescing_dns_resolver_registry);
+
+CoalescingDnsResolver::CoalescingDnsResolver(DnsResolverSharedPtr resolver,
+                                             TimeSource& time_source,
+                                             DnsResolutionCacheStats& stats)
+    : resolver_(std::move(resolver)), time_source_(time_source), stats_(stats) {}
+
+CoalescingDnsResolver::~CoalescingDnsResolver() {
+  for (auto& pending : pending_resolutions_) {
+    if (pending.second->query_ != nullptr) {
+      pending.second->query_->cancel(ActiveDnsQuery::CancelReason::QueryAbandoned);
+    }
+  }
+  stats_.pending_resolutions_.sub(pending_resolutions_.size());
+  stats_.cached_answers_.sub(cached_answers_.size());
+}
+
+ActiveDnsQuery* CoalescingDnsResolver::resolve(const std::string& dns_name,
+                                               DnsLookupFamily dns_lookup_family,
+                                               ResolveCb callback) {
+  stats_.queries_.inc();
+  const Key key{dns_name, dns_lookup_family};
+
+  const auto cached = cached_answers_.find(key);
+  if (cached != cached_answers_.end()) {
+    const MonotonicTime now = time_source_.monotonicTime();
+    if (cached->second.expiry_ > now) {
+      ENVOY_LOG(debug, "answering the query for {} from the cache", dns_name);
+      stats_.cache_hits_.inc();
+      callback(ResolutionStatus::Success, cachedResponses(cached->second, now));
+      return nullptr;
+    }
+    cached_answers_.erase(cached);
+    stats_.cached_answers_.dec();
+  }
+
+  const auto pending = pending_resolutions_.find(key);
+  if (pending != pending_resolutions_.end()) {
+    ENVOY_LOG(debug, "coalescing the query for {} with a pending resolution", dns_name);
+    stats_.coalesced_queries_.inc();
+    return addQuery(*pending->second, std::move(callback));
+  }
+
+  stats_.resolutions_.inc();
+  stats_.pending_resolutions_.inc();
+  PendingResolution& resolution =
+      *pending_resolutions_.emplace(key, std::make_unique<PendingResolution>(*this, key))
+           .first->second;
+  ActiveDnsQuery* query = addQuery(resolution, std::move(callback));
+  ActiveDnsQuery* resolver_query =
+      resolver_->resolve(dns_name, dns_lookup_family,
+                         [this, key](ResolutionStatus status, std::list<DnsResponse>&& response) {
+                           onResolution(key, status, std::move(response));
+                         });
+  if (resolver_query == nullptr) {
+    // The resolution completed inline, and answered the query.
+    return nullptr;
+  }
+  resolution.query_ = resolver_query;
+  return query;
+}
+
+void CoalescingDnsResolver::resetNetworking() {
+  stats_.cached_answers_.sub(cached_answers_.size());
+  cached_answers_.clear();
+  resolver_->resetNetworking();
+}
+
+ActiveDnsQuery* CoalescingDnsResolver::addQuery(PendingResolution& resolution,
+                                                ResolveCb callback) {
+  auto query = std::make_unique<PendingQuery>(resolution, std::move(callback));
+  ActiveDnsQuery* handle = query.get();
+  LinkedList::moveIntoListBack(std::move(query), resolution.queries_);
+  return handle;
+}
+
+void CoalescingDnsResolver::PendingQuery::cancel(CancelReason reason) {
+  PendingResolution& resolution = resolution_;
+  // Destroys this query.
+  removeFromList(resolution.queries_);
+  resolution.parent_.onQueryCancelled(resolution, reason);
+}
+
+void CoalescingDnsResolver::onQueryCancelled(PendingResolution& resolution,
+                                             ActiveDnsQuery::CancelReason reason) {
+  // The resolution is only abandoned once none of its queries needs it.
+  if (resolution.completed_ || !resolution.queries_.empty()) {
+    return;
+  }
+  ASSERT(resolution.query_ != nullptr);
+  resolution.query_->cancel(reason);
+  stats_.pending_resolutions_.dec();
+  // Destroys the resolution.
+  pending_resolutions_.erase(resolution.key_);
+}
+
+void CoalescingDnsResolver::onResolution(const Key& key, ResolutionStatus status,
+                                         std::list<DnsResponse>&& response) {
+  const auto pending = pending_resolutions_.find(key);
+  ASSERT(pending != pending_resolutions_.end());
+  PendingResolutionPtr resolution = std::move(pending->second);
+  pending_resolutions_.erase(pending);
+  stats_.pending_resolutions_.dec();
+  resolution->completed_ = true;
+
+  if (status == ResolutionStatus::Success && !response.empty()) {
+    cacheAnswer(key, response);
+  }
+
+  // The callbacks may cancel the other queries of the resolution, or destroy this resolver when
+  // they release the last reference to it, so only the resolution is used while invoking them.
+  while (!resolution->queries_.empty()) {
+    PendingQueryPtr query = resolution->queries_.front()->removeFromList(resolution->queries_);
+    if (resolution->queries_.empty()) {
+      query->callback_(status, std::move(response));
+    } else {
+      std::list<DnsResponse> copy = response;
+      query->callback_(status, std::move(copy));
+    }
+  }
+}
+
+void CoalescingDnsResolver::cacheAnswer(const Key& key, const std::list<DnsResponse>& response) {
+  std::chrono::seconds ttl = std::chrono::seconds::max();
+  for (const DnsResponse& dns_response : response) {
+    ttl = std::min(ttl, dns_response.addrInfo().ttl_);
+  }
+  if (ttl.count() <= 0) {
+    return;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (cached_answers_.size() >= MaxCachedAnswers) {
+    const size_t cached = cached_answers_.size();
+    absl::erase_if(cached_answers_,
+                   [now](const auto& entry) { return entry.second.expiry_ <= now; });
+    stats_.cached_answers_.sub(cached - cached_answers_.size());
+    if (cached_answers_.size() >= MaxCachedAnswers) {
+      ENVOY_LOG(debug, "not caching the answer for {}, the cache is full", key.first);
+      return;
+    }
+  }
+  if (cached_answers_.insert_or_assign(key, CachedAnswer{response, now + ttl}).second) {
+    stats_.cached_answers_.inc();
+  }
+}
+
+std::list<DnsResponse> CoalescingDnsResolver::cachedResponses(const CachedAnswer& answer,
+                                                              MonotonicTime now) {
+  const auto ttl = std::chrono::ceil<std::chrono::seconds>(answer.expiry_ - now);
+  std::list<DnsResponse> responses;
+  for (const DnsResponse& response : answer.responses_) {
+    responses.emplace_back(response.addrInfo().address_, ttl);
+  }
+  return responses;
+}
+
+CoalescingDnsResolverRegistry::CoalescingDnsResolverRegistry(Stats::Scope& scope)
+    : stats_({ALL_DNS_RESOLUTION_CACHE_STATS(POOL_COUNTER_PREFIX(scope, "dns_resolution_cache."),
+                                             POOL_GAUGE_PREFIX(scope, "dns_resolution_cache."))}) {
+}
+
+DnsResolverSharedPtr CoalescingDnsResolverRegistry::getOrCreate(
+    DnsResolverFactory& dns_resolver_factory,
+    const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+    Event::Dispatcher& dispatcher, Api::Api& api) {
+  ASSERT(dispatcher.isThreadSafe());
+  const size_t hash = MessageUtil::hash(typed_dns_resolver_config);
+  const auto existing = resolvers_.find(hash);
+  if (existing != resolvers_.end()) {
+    DnsResolverSharedPtr resolver = existing->second.resolver_.lock();
+    if (resolver != nullptr) {
+      if (Protobuf::util::MessageDifferencer::Equivalent(typed_dns_resolver_config,
+                                                         existing->second.config_)) {
+        return resolver;
+      }
+      // The resolvers of the configs whose hashes collide are not shared.
+      return dns_resolver_factory.createDnsResolver(dispatcher, api, typed_dns_resolver_config);
+    }
+  }
+
+  auto resolver = std::make_shared<CoalescingDnsResolver>(
+      dns_resolver_factory.createDnsResolver(dispatcher, api, typed_dns_resolver_config),
+      dispatcher.timeSource(), stats_);
+  resolvers_.insert_or_assign(hash, SharedResolver{typed_dns_resolver_config, resolver});
+  return resolver;
+}
+
+DnsResolverSharedPtr createCoalescingDnsResolver(
+    DnsResolverFactory& dns_resolver_factory,
+    const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+    Event::Dispatcher& dispatcher, Api::Api& api, Singleton::Manager& singleton_manager,
+    Stats::Scope& scope) {
+  if (!Runtime::runtimeFeatureEnabled("envoy.reloadable_features.coalesce_dns_resolutions")) {
+    return dns_resolver_factory.createDnsResolver(dispatcher, api, typed_dns_resolver_config);
+  }
+  return singleton_manager
+      .getTyped<CoalescingDnsResolverRegistry>(
+          SINGLETON_MANAGER_REGISTERED_NAME(coalescing_dns_resolver_registry),
+          [&scope] { return std::make_shared<CoalescingDnsResolverRegistry>(scope); },
+          /*pin=*/true)
+      ->getOrCreate(dns_resolver_factory, typed_dns_resolver_config, dispatcher, api);
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "envoy/api/api.h"
+#include "envoy/common/time.h"
+#include "envoy/config/core/v3/extension.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/dns.h"
+#include "envoy/network/dns_resolver.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/singleton/manager.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/common/linked_object.h"
+#include "source/common/common/logger.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * All DNS resolution cache stats, shared by all the coalescing DNS resolvers of the process. The
+ * queries saved are the queries minus the resolutions. @see stats_macros.h
+ */
+#define ALL_DNS_RESOLUTION_CACHE_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(cache_hits)                                                                              \
+  COUNTER(coalesced_queries)                                                                       \
+  COUNTER(queries)                                                                                 \
+  COUNTER(resolutions)                                                                             \
+  GAUGE(cached_answers, NeverImport)                                                               \
+  GAUGE(pending_resolutions, NeverImport)
+
+/**
+ * Struct definition for all DNS resolution cache stats. @see stats_macros.h
+ */
+struct DnsResolutionCacheStats {
+  ALL_DNS_RESOLUTION_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A DnsResolver shared by several users, such as clusters and DNS caches, which coalesces their
+ * concurrent queries for the same name and lookup family into a single resolution of the
+ * decorated resolver, and answers their following queries from the answers of the resolution
+ * until the smallest TTL of the answers expires. Failed resolutions are not cached.
+ */
+class CoalescingDnsResolver : public DnsResolver, Logger::Loggable<Logger::Id::dns> {
+public:
+  CoalescingDnsResolver(DnsResolverSharedPtr resolver, TimeSource& time_source,
+                        DnsResolutionCacheStats& stats);
+  ~CoalescingDnsResolver() override;
+
+  // The maximum number of cached answers. The answers of the resolutions are not cached while the
+  // cache is full of unexpired answers.
+  static constexpr size_t MaxCachedAnswers = 4096;
+
+  // Network::DnsResolver
+  ActiveDnsQuery* resolve(const std::string& dns_name, DnsLookupFamily dns_lookup_family,
+                          ResolveCb callback) override;
+  void resetNetworking() override;
+
+private:
+  using Key = std::pair<std::string, DnsLookupFamily>;
+  struct PendingResolution;
+
+  // A query waiting for the answer of a pending resolution.
+  class PendingQuery : public ActiveDnsQuery, public LinkedObject<PendingQuery> {
+  public:
+    PendingQuery(PendingResolution& resolution, ResolveCb callback)
+        : resolution_(resolution), callback_(std::move(callback)) {}
+
+    // Network::ActiveDnsQuery
+    void cancel(CancelReason reason) override;
+
+    PendingResolution& resolution_;
+    ResolveCb callback_;
+  };
+  using PendingQueryPtr = std::unique_ptr<PendingQuery>;
+
+  struct PendingResolution {
+    PendingResolution(CoalescingDnsResolver& parent, const Key& key) : parent_(parent), key_(key) {}
+
+    CoalescingDnsResolver& parent_;
+    const Key key_;
+    // The query of the decorated resolver, set once it is known not to have completed inline.
+    ActiveDnsQuery* query_{};
+    // Set once the callbacks of the queries are being invoked.
+    bool completed_{};
+    // The queries waiting for the resolution, in the order they were made.
+    std::list<PendingQueryPtr> queries_;
+  };
+  using PendingResolutionPtr = std::unique_ptr<PendingResolution>;
+
+  struct CachedAnswer {
+    std::list<DnsResponse> responses_;
+    MonotonicTime expiry_;
+  };
+
+  ActiveDnsQuery* addQuery(PendingResolution& resolution, ResolveCb callback);
+  void onQueryCancelled(PendingResolution& resolution, ActiveDnsQuery::CancelReason reason);
+  void onResolution(const Key& key, ResolutionStatus status, std::list<DnsResponse>&& response);
+  void cacheAnswer(const Key& key, const std::list<DnsResponse>& response);
+  // Returns the cached responses, with their TTLs set to the remaining lifetime of the answer.
+  static std::list<DnsResponse> cachedResponses(const CachedAnswer& answer, MonotonicTime now);
+
+  const DnsResolverSharedPtr resolver_;
+  TimeSource& time_source_;
+  DnsResolutionCacheStats& stats_;
+  absl::flat_hash_map<Key, PendingResolutionPtr> pending_resolutions_;
+  absl::flat_hash_map<Key, CachedAnswer> cached_answers_;
+};
+
+/**
+ * The coalescing DNS resolvers of the process, shared by the users of equivalent DNS resolver
+ * configs on the main thread, such as the DNS clusters and the DNS caches of the dynamic forward
+ * proxy.
+ */
+class CoalescingDnsResolverRegistry : public Singleton::Instance {
+public:
+  explicit CoalescingDnsResolverRegistry(Stats::Scope& scope);
+
+  /**
+   * Returns the resolver of a DNS resolver config, creating it if no user of an equivalent config
+   * holds it.
+   * @param dns_resolver_factory supplies the factory of the resolver decorated by the coalescing
+   *        resolver.
+   * @param typed_dns_resolver_config supplies the config of the decorated resolver.
+   * @param dispatcher supplies the main thread dispatcher.
+   * @param api supplies the API of the process.
+   * @return DnsResolverSharedPtr the coalescing resolver.
+   */
+  DnsResolverSharedPtr
+  getOrCreate(DnsResolverFactory& dns_resolver_factory,
+              const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+              Event::Dispatcher& dispatcher, Api::Api& api);
+
+private:
+  struct SharedResolver {
+    envoy::config::core::v3::TypedExtensionConfig config_;
+    std::weak_ptr<DnsResolver> resolver_;
+  };
+
+  DnsResolutionCacheStats stats_;
+  // The resolvers by the hash of their config.
+  absl::flat_hash_map<size_t, SharedResolver> resolvers_;
+};
+
+/**
+ * Creates the DNS resolver of a DNS resolver config on the main thread. The resolver is a
+ * CoalescingDnsResolver shared by the users of equivalent configs in the process if
+ * envoy.reloadable_features.coalesce_dns_resolutions is enabled, or a resolver of the user
+ * otherwise.
+ */
+DnsResolverSharedPtr createCoalescingDnsResolver(
+    DnsResolverFactory& dns_resolver_factory,
+    const envoy::config::core::v3::TypedExtensionConfig& typed_dns_resolver_config,
+    Event::Dispatcher& dispatcher, Api::Api& api, Singleton::Manager& singleton_manager,
+    Stats::Scope& scope);
+
+} // namespace Network
+} // namespace Envoy
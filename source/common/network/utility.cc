@@ -767,14 +767,20 @@ Api::IoErrorPtr Utility::readPacketsFromSocket(IoHandle& handle,
 }
 
 ResolvedUdpSocketConfig::ResolvedUdpSocketConfig(
-    const envoy::config::core::v3::UdpSocketConfig& config, bool prefer_gro_default)
+    const envoy::config::core::v3::UdpSocketConfig& config, bool prefer_gro_default,
+    bool prefer_gso_default)
     : max_rx_datagram_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_rx_datagram_size,
                                                             DEFAULT_UDP_MAX_DATAGRAM_SIZE)),
-      prefer_gro_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, prefer_gro, prefer_gro_default)) {
+      prefer_gro_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, prefer_gro, prefer_gro_default)),
+      prefer_gso_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, prefer_gso, prefer_gso_default)) {
   if (prefer_gro_ && !Api::OsSysCallsSingleton::get().supportsUdpGro()) {
     ENVOY_LOG_MISC(
         warn, "GRO requested but not supported by the OS. Check OS config or disable prefer_gro.");
   }
+  if (prefer_gso_ && !Api::OsSysCallsSingleton::get().supportsUdpGso()) {
+    ENVOY_LOG_MISC(
+        warn, "GSO requested but not supported by the OS. Check OS config or disable prefer_gso.");
+  }
 }
 
 } // namespace Network
@@ -79,10 +79,11 @@ static const uint64_t MAX_NUM_PACKETS_PER_EVENT_LOOP = 6000;
  */
 struct ResolvedUdpSocketConfig {
   ResolvedUdpSocketConfig(const envoy::config::core::v3::UdpSocketConfig& config,
-                          bool prefer_gro_default);
+                          bool prefer_gro_default, bool prefer_gso_default = false);
 
   uint64_t max_rx_datagram_size_;
   bool prefer_gro_;
+  bool prefer_gso_;
 };
 
 /**
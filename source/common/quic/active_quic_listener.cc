@@ -18,6 +18,7 @@
 #include "source/common/quic/envoy_quic_proof_source.h"
 #include "source/common/quic/envoy_quic_utils.h"
 #include "source/common/quic/quic_network_connection.h"
+#include "source/common/quic/udp_gso_batch_writer.h"
 #include "source/common/runtime/runtime_features.h"
 
 namespace Envoy {
@@ -76,6 +77,16 @@ ActiveQuicListener::ActiveQuicListener(
       listener_config.udpListenerConfig()->packetWriterFactory().createUdpPacketWriter(
           listen_socket_.ioHandle(), listener_config.listenerScope());
   udp_packet_writer_ = udp_packet_writer.get();
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+  // All the connections of the listener on this worker share the writer, so that their flushes can
+  // be merged at the end of each event loop iteration.
+  auto* gso_batch_writer = dynamic_cast<UdpGsoBatchWriter*>(udp_packet_writer.get());
+  if (gso_batch_writer != nullptr &&
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.quic_defer_gso_batch_flushes")) {
+    gso_batch_writer->deferFlushes(dispatcher_);
+    flushes_deferred_ = true;
+  }
+#endif
 
   // Some packet writers (like `UdpGsoBatchWriter`) already directly implement
   // `quic::QuicPacketWriter` and can be used directly here. Other types need
@@ -94,6 +105,10 @@ ActiveQuicListener::~ActiveQuicListener() { onListenerShutdown(); }
 void ActiveQuicListener::onListenerShutdown() {
   ENVOY_LOG(info, "Quic listener {} shutdown.", config_->name());
   quic_dispatcher_->Shutdown();
+  if (flushes_deferred_) {
+    // Sends the packets closing the connections before the writer is destroyed.
+    udp_packet_writer_->flush();
+  }
   udp_listener_.reset();
 }
 
@@ -164,6 +179,10 @@ void ActiveQuicListener::onReadReady() {
 
 void ActiveQuicListener::onWriteReady(const Network::Socket& /*socket*/) {
   quic_dispatcher_->OnCanWrite();
+  if (flushes_deferred_) {
+    // Sends the packets left buffered by a deferred flush which found the socket write blocked.
+    udp_packet_writer_->flush();
+  }
 }
 
 void ActiveQuicListener::pauseListening() { quic_dispatcher_->StopAcceptingNewConnections(); }
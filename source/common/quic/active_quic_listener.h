@@ -83,6 +83,8 @@ private:
   const bool kernel_worker_routing_;
   absl::optional<Runtime::FeatureFlag> enabled_{};
   Network::UdpPacketWriter* udp_packet_writer_;
+  // Whether the flushes of the connections are deferred to the end of the event loop iteration.
+  bool flushes_deferred_{false};
 
   // The number of runs of the event loop in which at least one CHLO was buffered.
   // TODO(ggreenway): Consider making this a published stat, or some variation of this information.
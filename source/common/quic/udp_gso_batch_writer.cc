@@ -78,12 +78,35 @@ UdpGsoBatchWriter::getNextWriteLocation(const Network::Address::Ip* local_ip,
 }
 
 Api::IoCallUint64Result UdpGsoBatchWriter::flush() {
-  quic::WriteResult quic_result = Flush();
+  quic::WriteResult quic_result = quic::QuicGsoBatchWriter::Flush();
   updateUdpGsoBatchWriterStats(quic_result);
 
   return convertQuicWriteResult(quic_result, /*payload_len=*/0);
 }
 
+quic::WriteResult UdpGsoBatchWriter::Flush() {
+  // A blocked writer is flushed right away so that the connection learns it is write blocked.
+  if (deferred_flush_ == nullptr || IsWriteBlocked() || buffered_writes().empty()) {
+    return quic::QuicGsoBatchWriter::Flush();
+  }
+  if (!deferred_flush_->enabled()) {
+    deferred_flush_->scheduleCallbackCurrentIteration();
+  }
+  return {quic::WRITE_STATUS_OK, 0};
+}
+
+void UdpGsoBatchWriter::deferFlushes(Event::Dispatcher& dispatcher) {
+  deferred_flush_ = dispatcher.createSchedulableCallback([this]() {
+    // The packets stay buffered if the socket is write blocked, and are sent by the next flush
+    // once it is writable. The packets are dropped on other errors, which QUIC recovers from as
+    // from a loss.
+    const Api::IoCallUint64Result result = flush();
+    if (!result.ok()) {
+      ENVOY_LOG_MISC(debug, "deferred flush failed: {}", result.err_->getErrorDetails());
+    }
+  });
+}
+
 void UdpGsoBatchWriter::updateUdpGsoBatchWriterStats(quic::WriteResult quic_result) {
   if (quic_result.status == quic::WRITE_STATUS_OK && quic_result.bytes_written > 0) {
     if (gso_size_ > 0u) {
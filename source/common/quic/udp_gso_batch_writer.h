@@ -5,6 +5,7 @@
 #else
 #define UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT 1
 
+#include "envoy/event/dispatcher.h"
 #include "envoy/network/udp_packet_writer_handler.h"
 
 #include "source/common/protobuf/utility.h"
@@ -73,6 +74,20 @@ public:
                        const Network::Address::Instance& peer_address) override;
   Api::IoCallUint64Result flush() override;
 
+  // quic::QuicPacketWriter
+  // Overridden to defer the flushes of the QUIC connections, see deferFlushes().
+  quic::WriteResult Flush() override;
+
+  /**
+   * Defers the flushes of the QUIC connections sharing this writer to the end of the current
+   * iteration of the event loop, so that the packets written to a peer by successive flushes in an
+   * iteration, such as those of the alarms and of the streams of a connection, are sent in a
+   * single GSO burst rather than a sendmsg per flush. The flushes of the UdpPacketWriter interface
+   * are not deferred.
+   * @param dispatcher supplies the dispatcher of the worker owning the writer.
+   */
+  void deferFlushes(Event::Dispatcher& dispatcher);
+
 private:
   /**
    * @brief Update stats_ field for the udp packet writer
@@ -88,6 +103,8 @@ private:
   UdpGsoBatchWriterStats generateStats(Stats::Scope& scope);
   UdpGsoBatchWriterStats stats_;
   uint64_t gso_size_;
+  // Flushes the buffered packets at the end of the event loop iteration, if flushes are deferred.
+  Event::SchedulableCallbackPtr deferred_flush_;
 };
 
 class UdpGsoBatchWriterFactory : public Network::UdpPacketWriterFactory {
@@ -50,8 +50,9 @@ public:
                         bool proxy_100_continue, uint32_t buffer_limit,
                         const Http::FilterChainFactory& filter_chain_factory,
                         UpstreamRequest& request)
+      // The upstream requests of a stream may outlive it, so do not share its arena.
       : FilterManager(filter_manager_callbacks, dispatcher, connection, stream_id, account,
-                      proxy_100_continue, buffer_limit, filter_chain_factory),
+                      proxy_100_continue, buffer_limit, filter_chain_factory, {}),
         upstream_request_(request) {}
 
   StreamInfo::StreamInfo& streamInfo() override {
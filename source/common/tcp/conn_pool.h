@@ -197,6 +197,9 @@ public:
   bool maybePreconnect(float preconnect_ratio) override {
     return maybePreconnectImpl(preconnect_ratio);
   }
+  uint32_t prewarm(uint32_t unused_capacity, uint32_t max_new_connections) override {
+    return prewarmImpl(unused_capacity, max_new_connections);
+  }
 
   ConnectionPool::Cancellable* newPendingStream(Envoy::ConnectionPool::AttachContext& context,
                                                 bool can_send_early_data) override {
@@ -5,6 +5,7 @@
 
 #include "source/common/http/utility.h"
 #include "source/common/network/address_impl.h"
+#include "source/common/network/dns_resolver/coalescing_dns_resolver.h"
 #include "source/common/network/dns_resolver/dns_factory_util.h"
 #include "source/common/network/resolver_impl.h"
 #include "source/common/network/socket_option_factory.h"
@@ -84,8 +85,9 @@ ClusterFactoryImplBase::selectDnsResolver(const envoy::config::cluster::v3::Clus
     Network::DnsResolverFactory& dns_resolver_factory =
         Network::createDnsResolverFactoryFromProto(cluster, typed_dns_resolver_config);
     auto& server_context = context.serverFactoryContext();
-    return dns_resolver_factory.createDnsResolver(server_context.mainThreadDispatcher(),
-                                                  server_context.api(), typed_dns_resolver_config);
+    return Network::createCoalescingDnsResolver(
+        dns_resolver_factory, typed_dns_resolver_config, server_context.mainThreadDispatcher(),
+        server_context.api(), server_context.singletonManager(), server_context.serverScope());
   }
 
   return context.dnsResolver();
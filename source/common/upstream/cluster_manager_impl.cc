@@ -2013,19 +2013,26 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     return nullptr;
   }
 
-  // Right now, HTTP, HTTP/2 and ALPN pools are considered separate.
-  // We could do better here, and always use the ALPN pool and simply make sure
-  // we end up on a connection of the correct protocol, but for simplicity we're
-  // starting with something simpler.
-  auto upstream_protocols = host->cluster().upstreamHttpProtocol(downstream_protocol);
-  std::vector<uint8_t> hash_key;
-  hash_key.reserve(upstream_protocols.size());
-  for (auto protocol : upstream_protocols) {
-    hash_key.push_back(uint8_t(protocol));
+  const HttpConnPoolOptions options = httpConnPoolOptions(priority, downstream_protocol, context);
+  std::vector<uint8_t> hash_key = httpConnPoolHashKey(host, options);
+
+  if (cluster_info_->connectionPoolPerDownstreamConnection()) {
+    // If configured, use the downstream connection id in pool hash key. As there is then a pool
+    // per downstream connection, there is nothing to prewarm.
+    if (context && context->downstreamConnection()) {
+      context->downstreamConnection()->hashKey(hash_key);
+    }
+  } else if (!peek && cluster_info_->adaptivePrewarm().has_value()) {
+    recordRequestForPrewarm(host, options, hash_key);
   }
 
-  absl::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>
-      alternate_protocol_options = host->cluster().alternateProtocolsCacheOptions();
+  return httpConnPoolForHost(host, options, hash_key);
+}
+
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::HttpConnPoolOptions
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolOptions(
+    ResourcePriority priority, absl::optional<Http::Protocol> downstream_protocol,
+    LoadBalancerContext* context) {
   Network::Socket::OptionsSharedPtr upstream_options(std::make_shared<Network::Socket::Options>());
   if (context) {
     // Inherit socket options from downstream connection, if set.
@@ -2034,25 +2041,45 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     }
     addOptionsIfNotNull(upstream_options, context->upstreamSocketOptions());
   }
+  return {priority, downstream_protocol, std::move(upstream_options),
+          context ? context->upstreamTransportSocketOptions() : nullptr};
+}
+
+std::vector<uint8_t>
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolHashKey(
+    const HostConstSharedPtr& host, const HttpConnPoolOptions& options) {
+  // Right now, HTTP, HTTP/2 and ALPN pools are considered separate.
+  // We could do better here, and always use the ALPN pool and simply make sure
+  // we end up on a connection of the correct protocol, but for simplicity we're
+  // starting with something simpler.
+  auto upstream_protocols = host->cluster().upstreamHttpProtocol(options.downstream_protocol_);
+  std::vector<uint8_t> hash_key;
+  hash_key.reserve(upstream_protocols.size());
+  for (auto protocol : upstream_protocols) {
+    hash_key.push_back(uint8_t(protocol));
+  }
 
   // Use the socket options for computing connection pool hash key, if any.
   // This allows socket options to control connection pooling so that connections with
   // different options are not pooled together.
-  for (const auto& option : *upstream_options) {
+  for (const auto& option : *options.upstream_options_) {
     option->hashKey(hash_key);
   }
 
-  bool have_transport_socket_options = false;
-  if (context && context->upstreamTransportSocketOptions()) {
-    host->transportSocketFactory().hashKey(hash_key, context->upstreamTransportSocketOptions());
-    have_transport_socket_options = true;
+  if (options.transport_socket_options_) {
+    host->transportSocketFactory().hashKey(hash_key, options.transport_socket_options_);
   }
+  return hash_key;
+}
 
-  // If configured, use the downstream connection id in pool hash key
-  if (cluster_info_->connectionPoolPerDownstreamConnection() && context &&
-      context->downstreamConnection()) {
-    context->downstreamConnection()->hashKey(hash_key);
-  }
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolForHost(
+    const HostConstSharedPtr& host, const HttpConnPoolOptions& options,
+    const std::vector<uint8_t>& hash_key) {
+  auto upstream_protocols = host->cluster().upstreamHttpProtocol(options.downstream_protocol_);
+  absl::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>
+      alternate_protocol_options = host->cluster().alternateProtocolsCacheOptions();
+  const ResourcePriority priority = options.priority_;
 
   ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
 
@@ -2062,9 +2089,10 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
       container.pools_->getPool(priority, hash_key, [&]() {
         auto pool = parent_.parent_.factory_.allocateConnPool(
             parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
-            alternate_protocol_options, !upstream_options->empty() ? upstream_options : nullptr,
-            have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
-            parent_.parent_.time_source_, parent_.cluster_manager_state_, quic_info_);
+            alternate_protocol_options,
+            !options.upstream_options_->empty() ? options.upstream_options_ : nullptr,
+            options.transport_socket_options_, parent_.parent_.time_source_,
+            parent_.cluster_manager_state_, quic_info_);
 
         pool->addIdleCallback([&parent = parent_, host, priority, hash_key]() {
           parent.httpConnPoolIsIdle(host, priority, hash_key);
@@ -2080,6 +2108,45 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
   }
 }
 
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::recordRequestForPrewarm(
+    const HostConstSharedPtr& host, const HttpConnPoolOptions& options,
+    const std::vector<uint8_t>& hash_key) {
+  if (prewarm_pool_options_vary_) {
+    return;
+  }
+  if (!prewarm_pool_options_.has_value()) {
+    prewarm_pool_options_ = options;
+    prewarm_pool_hash_key_ = hash_key;
+  } else if (prewarm_pool_options_->priority_ != options.priority_ ||
+             prewarm_pool_hash_key_ != hash_key) {
+    // The demand of each pool is unknown, and warming the wrong one would only waste connections.
+    ENVOY_LOG(debug, "requests to cluster '{}' use different connection pools, not prewarming",
+              cluster_info_->name());
+    prewarm_pool_options_vary_ = true;
+    prewarmer_.reset();
+    return;
+  }
+
+  if (prewarmer_ == nullptr) {
+    prewarmer_ = std::make_unique<ConnectionPrewarmer>(
+        *cluster_info_->adaptivePrewarm(), priority_set_, parent_.thread_local_dispatcher_,
+        [this](const HostConstSharedPtr& host, uint32_t unused_capacity,
+               uint32_t max_new_connections) {
+          return prewarmHttpConnPool(host, unused_capacity, max_new_connections);
+        });
+  }
+  prewarmer_->onRequest(host);
+}
+
+uint32_t ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::prewarmHttpConnPool(
+    const HostConstSharedPtr& host, uint32_t unused_capacity, uint32_t max_new_connections) {
+  ASSERT(prewarm_pool_options_.has_value() && !prewarm_pool_options_vary_);
+  // Warm the pool the requests to the cluster use, as they have all used the same so far.
+  Http::ConnectionPool::Instance* pool = httpConnPoolForHost(
+      host, *prewarm_pool_options_, httpConnPoolHashKey(host, *prewarm_pool_options_));
+  return pool != nullptr ? pool->prewarm(unused_capacity, max_new_connections) : 0;
+}
+
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::httpConnPoolIsIdle(
     HostConstSharedPtr host, ResourcePriority priority, const std::vector<uint8_t>& hash_key) {
   if (destroying_) {
@@ -36,6 +36,7 @@
 #include "source/common/quic/quic_stat_names.h"
 #include "source/common/tcp/async_tcp_client_impl.h"
 #include "source/common/upstream/cluster_discovery_manager.h"
+#include "source/common/upstream/connection_prewarmer.h"
 #include "source/common/upstream/host_utility.h"
 #include "source/common/upstream/load_stats_reporter.h"
 #include "source/common/upstream/od_cds_api_impl.h"
@@ -618,10 +619,32 @@ private:
       void setDropOverload(UnitFloat drop_overload) override { drop_overload_ = drop_overload; }
 
     private:
+      // What an HTTP connection pool of a host is selected and created from.
+      struct HttpConnPoolOptions {
+        ResourcePriority priority_;
+        absl::optional<Http::Protocol> downstream_protocol_;
+        Network::Socket::OptionsSharedPtr upstream_options_;
+        Network::TransportSocketOptionsConstSharedPtr transport_socket_options_;
+      };
+
       Http::ConnectionPool::Instance*
       httpConnPoolImpl(ResourcePriority priority,
                        absl::optional<Http::Protocol> downstream_protocol,
                        LoadBalancerContext* context, bool peek);
+      HttpConnPoolOptions httpConnPoolOptions(ResourcePriority priority,
+                                              absl::optional<Http::Protocol> downstream_protocol,
+                                              LoadBalancerContext* context);
+      std::vector<uint8_t> httpConnPoolHashKey(const HostConstSharedPtr& host,
+                                               const HttpConnPoolOptions& options);
+      Http::ConnectionPool::Instance* httpConnPoolForHost(const HostConstSharedPtr& host,
+                                                          const HttpConnPoolOptions& options,
+                                                          const std::vector<uint8_t>& hash_key);
+      // Counts a request for adaptive prewarming, unless requests use different pools.
+      void recordRequestForPrewarm(const HostConstSharedPtr& host,
+                                   const HttpConnPoolOptions& options,
+                                   const std::vector<uint8_t>& hash_key);
+      uint32_t prewarmHttpConnPool(const HostConstSharedPtr& host, uint32_t unused_capacity,
+                                   uint32_t max_new_connections);
 
       Tcp::ConnectionPool::Instance* tcpConnPoolImpl(ResourcePriority priority,
                                                      LoadBalancerContext* context, bool peek);
@@ -660,6 +683,13 @@ private:
       // If multiple bit fields are set, it is acceptable as long as the status of override host is
       // in any of these statuses.
       const HostUtility::HostStatusSet override_host_statuses_{};
+      // Created on the first HTTP stream if adaptive prewarming is configured.
+      ConnectionPrewarmerPtr prewarmer_;
+      // The options and hash key of the pools used by the HTTP streams so far, which are the ones
+      // prewarmed. Prewarming stops for good once streams use different pools.
+      absl::optional<HttpConnPoolOptions> prewarm_pool_options_;
+      std::vector<uint8_t> prewarm_pool_hash_key_;
+      bool prewarm_pool_options_vary_{false};
     };
 
     using ClusterEntryPtr = std::unique_ptr<ClusterEntry>;
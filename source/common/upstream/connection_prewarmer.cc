@@ -0,0 +1,140 @@
+#include "source/common/upstream/connection_prewarmer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Upstream {
+
+namespace {
+// Below this number of requests expected over the lookahead, a host is considered idle. Without
+// it, the decaying average of a host which stopped receiving requests would keep a connection
+// warm forever.
+constexpr double MinExpectedRequests = 0.01;
+} // namespace
+
+ConnectionPrewarmer::ConnectionPrewarmer(
+    const envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm& config,
+    const PrioritySet& priority_set, Event::Dispatcher& dispatcher, PrewarmCb prewarm_cb)
+    : priority_set_(priority_set), prewarm_cb_(std::move(prewarm_cb)),
+      interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, interval, 1000)),
+      alpha_(1.0 - std::exp(-static_cast<double>(interval_.count()) /
+                            PROTOBUF_GET_MS_OR_DEFAULT(config, rate_window, 30000))),
+      lookahead_seconds_(PROTOBUF_GET_MS_OR_DEFAULT(config, lookahead, 100) / 1000.0),
+      max_warm_connections_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_warm_connections, 16)),
+      timer_(dispatcher.createTimer([this]() { onInterval(); })) {}
+
+void ConnectionPrewarmer::onRequest(const HostConstSharedPtr& host) {
+  hosts_[host].requests_++;
+  if (!timer_->enabled()) {
+    timer_->enableTimer(interval_);
+  }
+}
+
+double ConnectionPrewarmer::requestRate(const HostConstSharedPtr& host) const {
+  const auto it = hosts_.find(host);
+  return it != hosts_.end() ? it->second.rate_ : 0;
+}
+
+void ConnectionPrewarmer::onInterval() {
+  sampleRequestRates();
+  if (prewarm()) {
+    timer_->enableTimer(interval_);
+    return;
+  }
+  // Without demand, e.g. once the requests stopped or the hosts left the cluster, the timer stops
+  // until the next request, and the rates start over then.
+  ENVOY_LOG(trace, "no demand left, stopping prewarming");
+  hosts_.clear();
+}
+
+void ConnectionPrewarmer::sampleRequestRates() {
+  const double interval_seconds = interval_.count() / 1000.0;
+  absl::flat_hash_map<HostConstSharedPtr, HostRate> hosts;
+  std::vector<std::pair<HostConstSharedPtr, uint64_t>> unsampled_hosts;
+  double total_rate = 0;
+  for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
+    for (const HostSharedPtr& host : host_set->hosts()) {
+      const auto it = hosts_.find(host);
+      if (it == hosts_.end() || !it->second.sampled_) {
+        unsampled_hosts.emplace_back(host, it == hosts_.end() ? 0 : it->second.requests_);
+        continue;
+      }
+      HostRate rate = it->second;
+      rate.rate_ += alpha_ * (rate.requests_ / interval_seconds - rate.rate_);
+      rate.requests_ = 0;
+      total_rate += rate.rate_;
+      hosts.emplace(host, rate);
+    }
+  }
+
+  // Assume that hosts seen for the first time get as many requests as the others on average,
+  // unless they already got more.
+  const double average_rate = hosts.empty() ? 0 : total_rate / hosts.size();
+  for (const auto& [host, requests] : unsampled_hosts) {
+    hosts.emplace(host, HostRate{0, std::max(average_rate, requests / interval_seconds), true});
+  }
+  // Hosts which left the cluster are dropped here.
+  hosts_ = std::move(hosts);
+}
+
+bool ConnectionPrewarmer::prewarm() {
+  std::vector<std::pair<HostConstSharedPtr, uint32_t>> demands;
+  uint64_t total_demand = 0;
+  bool has_demand = false;
+  for (const auto& [host, rate] : hosts_) {
+    const double expected_requests = rate.rate_ * lookahead_seconds_;
+    if (expected_requests < MinExpectedRequests) {
+      continue;
+    }
+    // Unhealthy hosts keep their rate, and are prewarmed again once healthy.
+    has_demand = true;
+    if (host->coarseHealth() != Host::Health::Healthy) {
+      continue;
+    }
+    const uint32_t demand = static_cast<uint32_t>(
+        std::min<double>(std::ceil(expected_requests), std::numeric_limits<uint32_t>::max()));
+    demands.emplace_back(host, demand);
+    total_demand += demand;
+  }
+
+  if (!has_demand) {
+    return false;
+  }
+
+  // A connection serves at least one stream, so the demand is an upper bound of the connections
+  // needed. If it exceeds what is left of the budget of the cluster, what is left is shared in
+  // proportion to demand.
+  const uint64_t warm_connections = warmConnections();
+  const uint64_t budget =
+      warm_connections < max_warm_connections_ ? max_warm_connections_ - warm_connections : 0;
+  for (const auto& [host, demand] : demands) {
+    const uint32_t max_new_connections =
+        total_demand <= budget ? demand
+                               : static_cast<uint32_t>(uint64_t(demand) * budget / total_demand);
+    if (max_new_connections == 0) {
+      continue;
+    }
+    const uint32_t created = prewarm_cb_(host, demand, max_new_connections);
+    ENVOY_LOG(trace, "prewarmed {} connections to {} for {} expected requests", created,
+              host->address()->asStringView(), demand);
+  }
+  return true;
+}
+
+uint64_t ConnectionPrewarmer::warmConnections() const {
+  uint64_t warm_connections = 0;
+  for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
+    for (const HostSharedPtr& host : host_set->hosts()) {
+      warm_connections += host->stats().cx_warm_.value();
+    }
+  }
+  return warm_connections;
+}
+
+} // namespace Upstream
+} // namespace Envoy
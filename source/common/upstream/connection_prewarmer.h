@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Keeps connections to the hosts of a cluster established ahead of demand. The prewarmer tracks
+ * the exponentially weighted moving average of the request rate of each host, and periodically
+ * asks the connection pool of each healthy host to be able to serve the requests expected over
+ * the lookahead without connecting. Hosts without a rate yet, e.g. those just added by EDS, are
+ * assumed to get the average rate of the cluster, so that they are warm before taking traffic.
+ * The number of connections kept warm is bounded for the whole cluster, and shared in proportion
+ * to the expected demand when it is exceeded.
+ *
+ * A prewarmer is owned by the thread local cluster of a worker, and only sees and warms the
+ * traffic of that worker. The bound is shared by the workers, as the warm connections of the
+ * cluster are counted by the per host cx_warm gauges of all the workers. The timer only runs while
+ * the worker sends requests to the cluster, and stops once the expected demand is gone.
+ */
+class ConnectionPrewarmer : Logger::Loggable<Logger::Id::upstream> {
+public:
+  /**
+   * Prewarms the connection pool of a host.
+   * @param host the host.
+   * @param unused_capacity the number of streams the pool should be able to serve immediately.
+   * @param max_new_connections the maximum number of connections to create.
+   * @return the number of connections created.
+   */
+  using PrewarmCb = std::function<uint32_t(const HostConstSharedPtr& host, uint32_t unused_capacity,
+                                           uint32_t max_new_connections)>;
+
+  ConnectionPrewarmer(
+      const envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm& config,
+      const PrioritySet& priority_set, Event::Dispatcher& dispatcher, PrewarmCb prewarm_cb);
+
+  /**
+   * Records a request to a host, and starts the timer if it is not running.
+   */
+  void onRequest(const HostConstSharedPtr& host);
+
+  /**
+   * @return the average request rate of a host in requests per second, or 0 if it is unknown.
+   */
+  double requestRate(const HostConstSharedPtr& host) const;
+
+private:
+  struct HostRate {
+    // The requests since the last sample.
+    uint64_t requests_{};
+    double rate_{};
+    // False until the first sample, e.g. for hosts just added.
+    bool sampled_{};
+  };
+
+  void onInterval();
+  // Samples the request rates, dropping the hosts which left the cluster.
+  void sampleRequestRates();
+  // @return whether there is demand left to prewarm for.
+  bool prewarm();
+  // @return the warm connections of the cluster, on all the workers.
+  uint64_t warmConnections() const;
+
+  const PrioritySet& priority_set_;
+  const PrewarmCb prewarm_cb_;
+  const std::chrono::milliseconds interval_;
+  // The weight of each new sample in the moving average.
+  const double alpha_;
+  const double lookahead_seconds_;
+  const uint32_t max_warm_connections_;
+  absl::flat_hash_map<HostConstSharedPtr, HostRate> hosts_;
+  const Event::TimerPtr timer_;
+};
+
+using ConnectionPrewarmerPtr = std::unique_ptr<ConnectionPrewarmer>;
+
+} // namespace Upstream
+} // namespace Envoy
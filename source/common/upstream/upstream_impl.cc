@@ -1024,6 +1024,12 @@ ClusterInfoImpl::ClusterInfoImpl(
           config.preconnect_policy(), per_upstream_preconnect_ratio, 1.0)),
       peekahead_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.preconnect_policy(),
                                                        predictive_preconnect_ratio, 0)),
+      adaptive_prewarm_(
+          config.preconnect_policy().has_adaptive_prewarm()
+              ? std::make_unique<
+                    const envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm>(
+                    config.preconnect_policy().adaptive_prewarm())
+              : nullptr),
       socket_matcher_(std::move(socket_matcher)), stats_scope_(std::move(stats_scope)),
       traffic_stats_(generateStats(stats_scope_,
                                    factory_context.clusterManager().clusterStatNames(),
@@ -864,6 +864,12 @@ public:
 
   float perUpstreamPreconnectRatio() const override { return per_upstream_preconnect_ratio_; }
   float peekaheadRatio() const override { return peekahead_ratio_; }
+  OptRef<const envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm>
+  adaptivePrewarm() const override {
+    return makeOptRefFromPtr<
+        const envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm>(
+        adaptive_prewarm_.get());
+  }
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
   }
@@ -1103,6 +1109,9 @@ private:
   OptionalTimeouts optional_timeouts_;
   const float per_upstream_preconnect_ratio_;
   const float peekahead_ratio_;
+  const std::unique_ptr<
+      const envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm>
+      adaptive_prewarm_;
   TransportSocketMatcherPtr socket_matcher_;
   Stats::ScopeSharedPtr stats_scope_;
   mutable DeferredCreationCompatibleClusterTrafficStats traffic_stats_;
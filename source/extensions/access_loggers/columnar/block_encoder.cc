@@ -0,0 +1,177 @@
+#include "source/extensions/access_loggers/columnar/block_encoder.h"
+
+#include <cmath>
+#include <limits>
+
+#include "envoy/common/exception.h"
+
+#include "source/common/common/fmt.h"
+#include "source/common/formatter/substitution_formatter.h"
+
+#include "absl/strings/numbers.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+ColumnarSchema::ColumnarSchema(const Protobuf::RepeatedPtrField<ColumnConfig>& columns) {
+  columns_.reserve(columns.size());
+  for (const ColumnConfig& config : columns) {
+    Column column{config.name(), config.type(),
+                  Formatter::SubstitutionFormatParser::parse(config.format())};
+    if (column.type_ != ColumnConfig::STRING && column.providers_.size() != 1) {
+      throwEnvoyExceptionOrPanic(fmt::format(
+          "columnar access log: integer column '{}' must consist of a single command, got '{}'",
+          config.name(), config.format()));
+    }
+    columns_.push_back(std::move(column));
+  }
+}
+
+ColumnarBlockEncoder::ColumnarBlockEncoder(ColumnarSchemaConstSharedPtr schema)
+    : schema_(std::move(schema)), builders_(schema_->columns().size()) {}
+
+void ColumnarBlockEncoder::appendVarint(std::string& output, uint64_t value) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+void ColumnarBlockEncoder::add(const Formatter::HttpFormatterContext& context,
+                               const StreamInfo::StreamInfo& stream_info) {
+  const std::vector<ColumnarSchema::Column>& columns = schema_->columns();
+  for (size_t i = 0; i < columns.size(); i++) {
+    ColumnBuilder& builder = builders_[i];
+    if (entries_ % 8 == 0) {
+      builder.validity_.push_back(0);
+    }
+    if (columns[i].type_ == ColumnConfig::STRING) {
+      addString(columns[i], builder, context, stream_info);
+    } else {
+      addInteger(columns[i], builder, context, stream_info);
+    }
+  }
+  entries_++;
+}
+
+void ColumnarBlockEncoder::setValid(ColumnBuilder& builder) const {
+  builder.validity_.back() |= static_cast<char>(1 << (entries_ % 8));
+}
+
+void ColumnarBlockEncoder::addString(const ColumnarSchema::Column& column, ColumnBuilder& builder,
+                                     const Formatter::HttpFormatterContext& context,
+                                     const StreamInfo::StreamInfo& stream_info) {
+  value_.clear();
+  if (column.providers_.size() == 1) {
+    if (!column.providers_[0]->appendWithContext(context, stream_info, value_)) {
+      return;
+    }
+  } else {
+    // Commands without a value are empty within a longer format.
+    for (const Formatter::FormatterProviderPtr& provider : column.providers_) {
+      provider->appendWithContext(context, stream_info, value_);
+    }
+  }
+
+  setValid(builder);
+  // The value is only copied the first time it is seen in the block.
+  auto it = builder.dictionary_.find(value_);
+  if (it == builder.dictionary_.end()) {
+    it = builder.dictionary_.emplace(value_, builder.dictionary_.size()).first;
+  }
+  appendVarint(builder.data_, it->second);
+}
+
+void ColumnarBlockEncoder::addInteger(const ColumnarSchema::Column& column, ColumnBuilder& builder,
+                                      const Formatter::HttpFormatterContext& context,
+                                      const StreamInfo::StreamInfo& stream_info) {
+  const ProtobufWkt::Value value =
+      column.providers_[0]->formatValueWithContext(context, stream_info);
+  int64_t integer;
+  switch (value.kind_case()) {
+  case ProtobufWkt::Value::kNumberValue: {
+    const double number = value.number_value();
+    // The range check is exclusive, as 2^63 is representable as a double but not as an int64.
+    if (number != std::trunc(number) ||
+        std::abs(number) >= static_cast<double>(std::numeric_limits<int64_t>::max())) {
+      return;
+    }
+    integer = static_cast<int64_t>(number);
+    break;
+  }
+  case ProtobufWkt::Value::kStringValue:
+    if (!absl::SimpleAtoi(value.string_value(), &integer)) {
+      return;
+    }
+    break;
+  default:
+    return;
+  }
+
+  setValid(builder);
+  if (column.type_ == ColumnConfig::DELTA_INT64) {
+    // Wrapping arithmetic, so that any pair of values has a delta the reader can add back.
+    const int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(integer) -
+                                               static_cast<uint64_t>(builder.previous_));
+    builder.previous_ = integer;
+    integer = delta;
+  }
+  appendVarint(builder.data_, zigzag(integer));
+}
+
+void ColumnarBlockEncoder::encode(std::string& output) {
+  if (entries_ == 0) {
+    return;
+  }
+
+  const std::vector<ColumnarSchema::Column>& columns = schema_->columns();
+  std::string payload;
+  appendVarint(payload, entries_);
+  appendVarint(payload, columns.size());
+  std::vector<const std::string*> values;
+  std::string dictionary;
+  for (size_t i = 0; i < columns.size(); i++) {
+    ColumnBuilder& builder = builders_[i];
+    appendVarint(payload, columns[i].name_.size());
+    payload.append(columns[i].name_);
+    payload.push_back(static_cast<char>(columns[i].type_));
+    payload.append(builder.validity_);
+
+    if (columns[i].type_ == ColumnConfig::STRING) {
+      values.assign(builder.dictionary_.size(), nullptr);
+      for (const auto& [value, index] : builder.dictionary_) {
+        values[index] = &value;
+      }
+      dictionary.clear();
+      appendVarint(dictionary, values.size());
+      for (const std::string* value : values) {
+        appendVarint(dictionary, value->size());
+        dictionary.append(*value);
+      }
+      appendVarint(payload, dictionary.size() + builder.data_.size());
+      payload.append(dictionary);
+    } else {
+      appendVarint(payload, builder.data_.size());
+    }
+    payload.append(builder.data_);
+
+    builder.validity_.clear();
+    builder.data_.clear();
+    builder.dictionary_.clear();
+    builder.previous_ = 0;
+  }
+  entries_ = 0;
+
+  output.append(Magic);
+  output.push_back(static_cast<char>(Version));
+  appendVarint(output, payload.size());
+  output.append(payload);
+}
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
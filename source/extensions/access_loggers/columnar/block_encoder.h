@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.h"
+#include "envoy/formatter/substitution_formatter.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "source/common/protobuf/protobuf.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+using ColumnConfig = envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog::Column;
+using ColumnType = ColumnConfig::Type;
+
+/**
+ * The columns of a columnar access log, parsed once and shared by the encoders of all workers.
+ */
+class ColumnarSchema {
+public:
+  struct Column {
+    std::string name_;
+    ColumnType type_;
+    std::vector<Formatter::FormatterProviderPtr> providers_;
+  };
+
+  /**
+   * @param columns supplies the configuration of the columns.
+   * @throw EnvoyException if a format is invalid, or if an integer column does not consist of a
+   *        single command.
+   */
+  explicit ColumnarSchema(const Protobuf::RepeatedPtrField<ColumnConfig>& columns);
+
+  const std::vector<Column>& columns() const { return columns_; }
+
+private:
+  std::vector<Column> columns_;
+};
+
+using ColumnarSchemaConstSharedPtr = std::shared_ptr<const ColumnarSchema>;
+
+/**
+ * Encodes access log entries into self-describing columnar blocks. A block is:
+ *
+ *   "ENVC" | version (1 byte) | varint length of the rest of the block
+ *   varint number of entries | varint number of columns
+ *   for each column:
+ *     varint length of the name | name | type (1 byte, the value of ColumnType)
+ *     validity bitmap, one bit per entry, least significant bit first, set if the entry has a value
+ *     varint length of the data | data
+ *
+ * For STRING columns, the data is the number of distinct values, each value as its varint length
+ * and bytes, then the varint index of the value of each entry with a value. For INT64 columns, the
+ * data is the zigzag varint of the value of each entry with a value, and for DELTA_INT64 columns
+ * that of the difference with the previous value of the block.
+ *
+ * Values are encoded as entries are added, so that a block is only assembled when it is flushed.
+ * Encoders are not thread safe, and are meant to be owned by a single worker.
+ */
+class ColumnarBlockEncoder {
+public:
+  static constexpr absl::string_view Magic = "ENVC";
+  static constexpr uint8_t Version = 1;
+
+  explicit ColumnarBlockEncoder(ColumnarSchemaConstSharedPtr schema);
+
+  /**
+   * Adds an entry to the current block.
+   */
+  void add(const Formatter::HttpFormatterContext& context,
+           const StreamInfo::StreamInfo& stream_info);
+
+  /**
+   * @return the number of entries of the current block.
+   */
+  uint32_t entries() const { return entries_; }
+
+  /**
+   * Appends the current block to the output, and starts a new block. Does nothing if the block is
+   * empty.
+   */
+  void encode(std::string& output);
+
+  static void appendVarint(std::string& output, uint64_t value);
+  static uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  }
+
+private:
+  struct ColumnBuilder {
+    std::string validity_;
+    std::string data_;
+    // For STRING columns, the index of each distinct value.
+    absl::flat_hash_map<std::string, uint32_t> dictionary_;
+    // For DELTA_INT64 columns, the last value of the block.
+    int64_t previous_{};
+  };
+
+  void addString(const ColumnarSchema::Column& column, ColumnBuilder& builder,
+                 const Formatter::HttpFormatterContext& context,
+                 const StreamInfo::StreamInfo& stream_info);
+  void addInteger(const ColumnarSchema::Column& column, ColumnBuilder& builder,
+                  const Formatter::HttpFormatterContext& context,
+                  const StreamInfo::StreamInfo& stream_info);
+  void setValid(ColumnBuilder& builder) const;
+
+  const ColumnarSchemaConstSharedPtr schema_;
+  std::vector<ColumnBuilder> builders_;
+  uint32_t entries_{};
+  // Reused to format the values of string columns.
+  std::string value_;
+};
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,91 @@
+#include "source/extensions/access_loggers/columnar/columnar_access_log_impl.h"
+
+#include "source/common/network/socket_interface.h"
+#include "source/common/network/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+DatagramBlockSink::DatagramBlockSink(Network::Address::InstanceConstSharedPtr address,
+                                     DatagramBlockSinkStatsSharedPtr stats)
+    : address_(std::move(address)),
+      io_handle_(Network::ioHandleForAddr(Network::Socket::Type::Datagram, address_, {})),
+      stats_(std::move(stats)) {}
+
+DatagramBlockSinkStatsSharedPtr DatagramBlockSink::generateStats(Stats::Scope& scope) {
+  const std::string prefix = "access_logs.columnar.";
+  return std::make_shared<DatagramBlockSinkStats>(
+      DatagramBlockSinkStats{ALL_DATAGRAM_BLOCK_SINK_STATS(POOL_COUNTER_PREFIX(scope, prefix))});
+}
+
+void DatagramBlockSink::write(absl::string_view block) {
+  Buffer::RawSlice slice{const_cast<char*>(block.data()), block.size()};
+  const Api::IoCallUint64Result result =
+      Network::Utility::writeToSocket(*io_handle_, &slice, 1, nullptr, *address_);
+  if (result.ok()) {
+    stats_->blocks_sent_.inc();
+    return;
+  }
+
+  stats_->blocks_dropped_.inc();
+  if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::MessageTooBig) {
+    stats_->blocks_too_large_.inc();
+  }
+  ENVOY_LOG_EVERY_POW_2(warn, "columnar access log: dropped a block of {} bytes sent to {}: {}",
+                        block.size(), address_->asStringView(), result.err_->getErrorDetails());
+}
+
+ColumnarAccessLog::ColumnarAccessLog(AccessLog::FilterPtr&& filter,
+                                     ColumnarSchemaConstSharedPtr schema,
+                                     BlockSinkFactory sink_factory, uint32_t max_block_entries,
+                                     std::chrono::milliseconds flush_interval,
+                                     ThreadLocal::SlotAllocator& tls)
+    : ImplBase(std::move(filter)), tls_slot_(tls) {
+  tls_slot_.set([schema = std::move(schema), sink_factory = std::move(sink_factory),
+                 max_block_entries, flush_interval](Event::Dispatcher& dispatcher) {
+    return std::make_shared<ThreadLocalLogger>(schema, sink_factory(), max_block_entries,
+                                               flush_interval, dispatcher);
+  });
+}
+
+void ColumnarAccessLog::emitLog(const Formatter::HttpFormatterContext& context,
+                                const StreamInfo::StreamInfo& stream_info) {
+  tls_slot_->log(context, stream_info);
+}
+
+ColumnarAccessLog::ThreadLocalLogger::ThreadLocalLogger(ColumnarSchemaConstSharedPtr schema,
+                                                        BlockSinkSharedPtr sink,
+                                                        uint32_t max_block_entries,
+                                                        std::chrono::milliseconds flush_interval,
+                                                        Event::Dispatcher& dispatcher)
+    : encoder_(std::move(schema)), sink_(std::move(sink)), max_block_entries_(max_block_entries),
+      flush_interval_(flush_interval), flush_timer_(dispatcher.createTimer([this]() { flush(); })) {
+}
+
+ColumnarAccessLog::ThreadLocalLogger::~ThreadLocalLogger() { flush(); }
+
+void ColumnarAccessLog::ThreadLocalLogger::log(const Formatter::HttpFormatterContext& context,
+                                               const StreamInfo::StreamInfo& stream_info) {
+  encoder_.add(context, stream_info);
+  if (encoder_.entries() >= max_block_entries_) {
+    flush();
+  } else if (encoder_.entries() == 1) {
+    flush_timer_->enableTimer(flush_interval_);
+  }
+}
+
+void ColumnarAccessLog::ThreadLocalLogger::flush() {
+  flush_timer_->disableTimer();
+  block_.clear();
+  encoder_.encode(block_);
+  if (!block_.empty()) {
+    sink_->write(block_);
+  }
+}
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
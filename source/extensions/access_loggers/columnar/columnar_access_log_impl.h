@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "envoy/access_log/access_log.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/address.h"
+#include "envoy/network/io_handle.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "source/common/common/logger.h"
+#include "source/extensions/access_loggers/columnar/block_encoder.h"
+#include "source/extensions/access_loggers/common/access_log_base.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+/**
+ * A destination of encoded blocks.
+ */
+class BlockSink {
+public:
+  virtual ~BlockSink() = default;
+
+  /**
+   * Writes a block. Blocks which cannot be written are dropped.
+   */
+  virtual void write(absl::string_view block) PURE;
+};
+
+using BlockSinkSharedPtr = std::shared_ptr<BlockSink>;
+
+/**
+ * Appends blocks to an access log file, shared by all workers.
+ */
+class FileBlockSink : public BlockSink {
+public:
+  explicit FileBlockSink(AccessLog::AccessLogFileSharedPtr file) : file_(std::move(file)) {}
+
+  // BlockSink
+  void write(absl::string_view block) override { file_->write(block); }
+
+private:
+  const AccessLog::AccessLogFileSharedPtr file_;
+};
+
+/**
+ * All stats for the datagram destination of the columnar access log. @see stats_macros.h
+ */
+#define ALL_DATAGRAM_BLOCK_SINK_STATS(COUNTER)                                                     \
+  COUNTER(blocks_sent)                                                                             \
+  COUNTER(blocks_dropped)                                                                          \
+  COUNTER(blocks_too_large)
+
+/**
+ * Struct definition for the stats of the datagram destination. @see stats_macros.h
+ */
+struct DatagramBlockSinkStats {
+  ALL_DATAGRAM_BLOCK_SINK_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+using DatagramBlockSinkStatsSharedPtr = std::shared_ptr<DatagramBlockSinkStats>;
+
+/**
+ * Sends each block as a datagram to a local socket, from a socket owned by a single worker.
+ */
+class DatagramBlockSink : public BlockSink, Logger::Loggable<Logger::Id::misc> {
+public:
+  DatagramBlockSink(Network::Address::InstanceConstSharedPtr address,
+                    DatagramBlockSinkStatsSharedPtr stats);
+
+  static DatagramBlockSinkStatsSharedPtr generateStats(Stats::Scope& scope);
+
+  // BlockSink
+  void write(absl::string_view block) override;
+
+private:
+  const Network::Address::InstanceConstSharedPtr address_;
+  const Network::IoHandlePtr io_handle_;
+  // Shared by the sinks of all workers.
+  const DatagramBlockSinkStatsSharedPtr stats_;
+};
+
+/**
+ * Creates the sink of a worker.
+ */
+using BlockSinkFactory = std::function<BlockSinkSharedPtr()>;
+
+/**
+ * Access log Instance that batches the entries of each worker into columnar blocks. A block is
+ * flushed once it holds max_block_entries entries, or flush_interval after its first entry.
+ */
+class ColumnarAccessLog : public Common::ImplBase {
+public:
+  ColumnarAccessLog(AccessLog::FilterPtr&& filter, ColumnarSchemaConstSharedPtr schema,
+                    BlockSinkFactory sink_factory, uint32_t max_block_entries,
+                    std::chrono::milliseconds flush_interval, ThreadLocal::SlotAllocator& tls);
+
+private:
+  // The block of a worker. It does not refer to the access log, which may be destroyed first.
+  class ThreadLocalLogger : public ThreadLocal::ThreadLocalObject {
+  public:
+    ThreadLocalLogger(ColumnarSchemaConstSharedPtr schema, BlockSinkSharedPtr sink,
+                      uint32_t max_block_entries, std::chrono::milliseconds flush_interval,
+                      Event::Dispatcher& dispatcher);
+    ~ThreadLocalLogger() override;
+
+    void log(const Formatter::HttpFormatterContext& context,
+             const StreamInfo::StreamInfo& stream_info);
+
+  private:
+    void flush();
+
+    ColumnarBlockEncoder encoder_;
+    const BlockSinkSharedPtr sink_;
+    const uint32_t max_block_entries_;
+    const std::chrono::milliseconds flush_interval_;
+    const Event::TimerPtr flush_timer_;
+    // Reused across blocks.
+    std::string block_;
+  };
+
+  // Common::ImplBase
+  void emitLog(const Formatter::HttpFormatterContext& context,
+               const StreamInfo::StreamInfo& stream_info) override;
+
+  ThreadLocal::TypedSlot<ThreadLocalLogger> tls_slot_;
+};
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
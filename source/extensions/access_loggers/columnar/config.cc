@@ -0,0 +1,75 @@
+#include "source/extensions/access_loggers/columnar/config.h"
+
+#include <memory>
+
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.h"
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/filter_config.h"
+
+#include "source/common/network/resolver_impl.h"
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/access_loggers/columnar/columnar_access_log_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+AccessLog::InstanceSharedPtr
+ColumnarAccessLogFactory::createAccessLogInstance(const Protobuf::Message& config,
+                                                  AccessLog::FilterPtr&& filter,
+                                                  Server::Configuration::FactoryContext& context) {
+  const auto& proto_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog&>(
+      config, context.messageValidationVisitor());
+  Server::Configuration::ServerFactoryContext& server_context = context.serverFactoryContext();
+
+  BlockSinkFactory sink_factory;
+  switch (proto_config.destination_case()) {
+  case envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog::DestinationCase::kPath: {
+    // The file is shared by all workers, which write whole blocks to it.
+    auto sink = std::make_shared<FileBlockSink>(server_context.accessLogManager().createAccessLog(
+        Filesystem::FilePathAndType{Filesystem::DestinationType::File, proto_config.path()}));
+    sink_factory = [sink]() { return sink; };
+    break;
+  }
+  case envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog::DestinationCase::
+      kSocketAddress: {
+    Network::Address::InstanceConstSharedPtr address =
+        Network::Address::resolveProtoAddress(proto_config.socket_address());
+    DatagramBlockSinkStatsSharedPtr stats =
+        DatagramBlockSink::generateStats(server_context.serverScope());
+    sink_factory = [address, stats]() {
+      return std::make_shared<DatagramBlockSink>(address, stats);
+    };
+    break;
+  }
+  case envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog::DestinationCase::
+      DESTINATION_NOT_SET:
+    PANIC_DUE_TO_PROTO_UNSET;
+  }
+
+  return std::make_shared<ColumnarAccessLog>(
+      std::move(filter), std::make_shared<const ColumnarSchema>(proto_config.columns()),
+      std::move(sink_factory),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_block_entries, 1024),
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, flush_interval, 1000)),
+      server_context.threadLocal());
+}
+
+ProtobufTypes::MessagePtr ColumnarAccessLogFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog>();
+}
+
+std::string ColumnarAccessLogFactory::name() const { return "envoy.access_loggers.columnar"; }
+
+/**
+ * Static registration for the columnar access log. @see RegisterFactory.
+ */
+REGISTER_FACTORY(ColumnarAccessLogFactory, AccessLog::AccessLogInstanceFactory);
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
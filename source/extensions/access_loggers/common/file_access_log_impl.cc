@@ -7,9 +7,12 @@ namespace File {
 
 FileAccessLog::FileAccessLog(const Filesystem::FilePathAndType& access_log_file_info,
                              AccessLog::FilterPtr&& filter, Formatter::FormatterPtr&& formatter,
-                             AccessLog::AccessLogManager& log_manager)
+                             AccessLog::AccessLogManager& log_manager,
+                             uint64_t write_ring_size)
     : ImplBase(std::move(filter)), formatter_(std::move(formatter)) {
-  log_file_ = log_manager.createAccessLog(access_log_file_info);
+  log_file_ = write_ring_size > 0
+                  ? log_manager.createAccessLog(access_log_file_info, write_ring_size)
+                  : log_manager.createAccessLog(access_log_file_info);
 }
 
 void FileAccessLog::emitLog(const Formatter::HttpFormatterContext& context,
@@ -15,7 +15,7 @@ class FileAccessLog : public Common::ImplBase {
 public:
   FileAccessLog(const Filesystem::FilePathAndType& access_log_file_info,
                 AccessLog::FilterPtr&& filter, Formatter::FormatterPtr&& formatter,
-                AccessLog::AccessLogManager& log_manager);
+                AccessLog::AccessLogManager& log_manager, uint64_t write_ring_size = 0);
 
 private:
   // Common::ImplBase
@@ -61,7 +61,8 @@ FileAccessLogFactory::createAccessLogInstance(const Protobuf::Message& config,
 
   Filesystem::FilePathAndType file_info{Filesystem::DestinationType::File, fal_config.path()};
   return std::make_shared<FileAccessLog>(file_info, std::move(filter), std::move(formatter),
-                                         context.serverFactoryContext().accessLogManager());
+                                         context.serverFactoryContext().accessLogManager(),
+                                         fal_config.write_ring_size());
 }
 
 ProtobufTypes::MessagePtr FileAccessLogFactory::createEmptyConfigProto() {
@@ -6,6 +6,7 @@
 #include "source/common/common/stl_helpers.h"
 #include "source/common/config/utility.h"
 #include "source/common/http/utility.h"
+#include "source/common/network/dns_resolver/coalescing_dns_resolver.h"
 #include "source/common/network/dns_resolver/dns_factory_util.h"
 #include "source/common/network/resolver_impl.h"
 #include "source/common/network/utility.h"
@@ -89,8 +90,9 @@ Network::DnsResolverSharedPtr DnsCacheImpl::selectDnsResolver(
   envoy::config::core::v3::TypedExtensionConfig typed_dns_resolver_config;
   Network::DnsResolverFactory& dns_resolver_factory =
       Network::createDnsResolverFactoryFromProto(config, typed_dns_resolver_config);
-  return dns_resolver_factory.createDnsResolver(main_thread_dispatcher, context.api(),
-                                                typed_dns_resolver_config);
+  return Network::createCoalescingDnsResolver(dns_resolver_factory, typed_dns_resolver_config,
+                                              main_thread_dispatcher, context.api(),
+                                              context.singletonManager(), context.serverScope());
 }
 
 DnsCacheStats DnsCacheImpl::generateDnsCacheStats(Stats::Scope& scope) {
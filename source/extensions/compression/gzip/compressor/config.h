@@ -46,6 +46,8 @@ public:
   const std::string& contentEncoding() const override {
     return Http::CustomHeaders::get().ContentEncodingValues.Gzip;
   }
+  // Gzip streams may consist of multiple members.
+  bool supportsConcatenatedStreams() const override { return true; }
 
 private:
   static ZlibCompressorImpl::CompressionLevel
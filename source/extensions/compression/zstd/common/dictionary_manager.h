@@ -7,6 +7,8 @@
 
 #include "source/common/config/datasource.h"
 
+#include "absl/strings/string_view.h"
+
 #include "zstd.h"
 
 namespace Envoy {
@@ -80,13 +82,58 @@ public:
 
   T* getFirstDictionary() { return getDictionary(true, 0); };
 
+  /**
+   * Returns a reference-counted handle to the trained dictionary if there is one, or else to the
+   * first dictionary, so that a stream can keep using it even if the dictionary is replaced on
+   * this thread in the meantime.
+   */
+  std::shared_ptr<T> getPreferredDictionaryShared() {
+    auto dictionary_map = tls_slot_->get();
+    auto it = dictionary_map->trained_id_ != 0 ? dictionary_map->find(dictionary_map->trained_id_)
+                                               : dictionary_map->begin();
+    if (it != dictionary_map->end()) {
+      return it->second;
+    }
+    return nullptr;
+  }
+
+  /**
+   * Builds a dictionary from the given content and installs it on all threads, next to the
+   * configured dictionaries and in place of the previously trained one. Must be called on the
+   * main thread.
+   * @return the id of the new dictionary, or 0 if the content is not a legal dictionary, in
+   *         which case the existing dictionaries are kept.
+   */
+  unsigned replaceTrainedDictionary(absl::string_view data) {
+    if (data.empty()) {
+      return 0;
+    }
+    auto dictionary = DictionarySharedPtr(builder_(data.data(), data.length()));
+    const auto id = getDictId(dictionary.get());
+    if (id != 0) {
+      tls_slot_->runOnAllThreads([dictionary = std::move(dictionary),
+                                  id](OptRef<DictionaryThreadLocalMap> dictionary_map) {
+        if (dictionary_map->trained_id_ != 0) {
+          dictionary_map->erase(dictionary_map->trained_id_);
+        }
+        // A configured dictionary with the same id is kept, and used instead.
+        dictionary_map->trained_id_ = dictionary_map->emplace(id, dictionary).second ? id : 0;
+      });
+    }
+    return id;
+  }
+
 private:
   class DictionarySharedPtr : public std::shared_ptr<T> {
   public:
     DictionarySharedPtr(T* object) : std::shared_ptr<T>(object, deleter) {}
   };
   class DictionaryThreadLocalMap : public absl::flat_hash_map<unsigned, DictionarySharedPtr>,
-                                   public ThreadLocal::ThreadLocalObject {};
+                                   public ThreadLocal::ThreadLocalObject {
+  public:
+    // The id of the trained dictionary, or 0 if there is none.
+    unsigned trained_id_{0};
+  };
 
   void onDictionaryUpdate(unsigned origin_id, const std::string& filename) {
     auto file_or_error = api_.fileSystem().fileReadToEnd(filename);
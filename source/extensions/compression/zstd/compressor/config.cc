@@ -1,32 +1,48 @@
 #include "source/extensions/compression/zstd/compressor/config.h"
 
+#include "envoy/singleton/manager.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Compression {
 namespace Zstd {
 namespace Compressor {
 
+// The thread training the dictionaries of all the zstd compressor libraries. It is not pinned, so
+// it is destroyed with the last library training a dictionary.
+SINGLETON_MANAGER_REGISTRATION(zstd_dictionary_training_thread);
+
 ZstdCompressorFactory::ZstdCompressorFactory(
     const envoy::extensions::compression::zstd::compressor::v3::Zstd& zstd,
-    Event::Dispatcher& dispatcher, Api::Api& api, ThreadLocal::SlotAllocator& tls)
+    Event::Dispatcher& dispatcher, Api::Api& api, ThreadLocal::SlotAllocator& tls,
+    Stats::Scope& scope, ZstdDictionaryTrainingThreadSharedPtr training_thread)
     : compression_level_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, compression_level, ZSTD_CLEVEL_DEFAULT)),
       enable_checksum_(zstd.enable_checksum()), strategy_(zstd.strategy()),
       chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, chunk_size, ZSTD_CStreamOutSize())) {
-  if (zstd.has_dictionary()) {
+  if (zstd.has_dictionary() || zstd.has_dictionary_training()) {
     Protobuf::RepeatedPtrField<envoy::config::core::v3::DataSource> dictionaries;
-    dictionaries.Add()->CopyFrom(zstd.dictionary());
+    if (zstd.has_dictionary()) {
+      dictionaries.Add()->CopyFrom(zstd.dictionary());
+    }
     cdict_manager_ = std::make_unique<ZstdCDictManager>(
         dictionaries, dispatcher, api, tls, true,
         [this](const void* dict_buffer, size_t dict_size) -> ZSTD_CDict* {
           return ZSTD_createCDict(dict_buffer, dict_size, compression_level_);
         });
   }
+  if (zstd.has_dictionary_training()) {
+    ASSERT(training_thread != nullptr);
+    dictionary_trainer_ = std::make_unique<ZstdDictionaryTrainer>(
+        zstd.dictionary_training(), *cdict_manager_, dispatcher, api, std::move(training_thread),
+        scope);
+  }
 }
 
 Envoy::Compression::Compressor::CompressorPtr ZstdCompressorFactory::createCompressor() {
   return std::make_unique<ZstdCompressorImpl>(compression_level_, enable_checksum_, strategy_,
-                                              cdict_manager_, chunk_size_);
+                                              cdict_manager_, chunk_size_,
+                                              dictionary_trainer_.get());
 }
 
 Envoy::Compression::Compressor::CompressorFactoryPtr
@@ -34,9 +50,17 @@ ZstdCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
     const envoy::extensions::compression::zstd::compressor::v3::Zstd& proto_config,
     Server::Configuration::FactoryContext& context) {
   auto& server_context = context.serverFactoryContext();
+  ZstdDictionaryTrainingThreadSharedPtr training_thread;
+  if (proto_config.has_dictionary_training()) {
+    training_thread = server_context.singletonManager().getTyped<ZstdDictionaryTrainingThread>(
+        SINGLETON_MANAGER_REGISTERED_NAME(zstd_dictionary_training_thread), [&server_context] {
+          return std::make_shared<ZstdDictionaryTrainingThread>(
+              server_context.api().threadFactory());
+        });
+  }
   return std::make_unique<ZstdCompressorFactory>(
       proto_config, server_context.mainThreadDispatcher(), server_context.api(),
-      server_context.threadLocal());
+      server_context.threadLocal(), context.scope(), std::move(training_thread));
 }
 
 /**
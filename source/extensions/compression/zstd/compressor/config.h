@@ -27,7 +27,8 @@ class ZstdCompressorFactory : public Envoy::Compression::Compressor::CompressorF
 public:
   ZstdCompressorFactory(const envoy::extensions::compression::zstd::compressor::v3::Zstd& zstd,
                         Event::Dispatcher& dispatcher, Api::Api& api,
-                        ThreadLocal::SlotAllocator& tls);
+                        ThreadLocal::SlotAllocator& tls, Stats::Scope& scope,
+                        ZstdDictionaryTrainingThreadSharedPtr training_thread = nullptr);
 
   // Envoy::Compression::Compressor::CompressorFactory
   Envoy::Compression::Compressor::CompressorPtr createCompressor() override;
@@ -35,6 +36,8 @@ public:
   const std::string& contentEncoding() const override {
     return Http::CustomHeaders::get().ContentEncodingValues.Zstd;
   }
+  // Zstd streams may consist of multiple frames.
+  bool supportsConcatenatedStreams() const override { return true; }
 
 private:
   const uint32_t compression_level_;
@@ -42,6 +45,8 @@ private:
   const uint32_t strategy_;
   const uint32_t chunk_size_;
   ZstdCDictManagerPtr cdict_manager_{nullptr};
+  // Declared after the CDict manager, which it refers to.
+  ZstdDictionaryTrainerPtr dictionary_trainer_{nullptr};
 };
 
 class ZstdCompressorLibraryFactory
@@ -0,0 +1,198 @@
+#include "source/extensions/compression/zstd/compressor/dictionary_trainer.h"
+
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zdict.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+namespace {
+
+// Defaults to the dictionary size used by the zstd command line trainer.
+constexpr uint32_t DefaultDictionarySize = 112640;
+constexpr uint32_t DefaultMaxSampleSize = 4096;
+constexpr uint32_t DefaultSamplesPerTraining = 1000;
+constexpr uint64_t DefaultTrainingIntervalMs = 3600 * 1000;
+
+} // namespace
+
+ZstdDictionaryTrainingThread::ZstdDictionaryTrainingThread(Thread::ThreadFactory& thread_factory)
+    : thread_(thread_factory.createThread([this]() { work(); },
+                                          Thread::Options{"zstd_dicttrain"})) {}
+
+ZstdDictionaryTrainingThread::~ZstdDictionaryTrainingThread() {
+  {
+    absl::MutexLock lock(&mu_);
+    terminating_ = true;
+  }
+  thread_->join();
+}
+
+void ZstdDictionaryTrainingThread::post(Job job) {
+  absl::MutexLock lock(&mu_);
+  jobs_.push_back(std::move(job));
+}
+
+void ZstdDictionaryTrainingThread::work() {
+  while (true) {
+    Job job;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &ZstdDictionaryTrainingThread::hasJobOrTerminating));
+      if (terminating_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+ZstdDictionaryTrainer::ZstdDictionaryTrainer(
+    const envoy::extensions::compression::zstd::compressor::v3::Zstd::DictionaryTraining& config,
+    ZstdCDictManager& cdict_manager, Event::Dispatcher& main_dispatcher, Api::Api& api,
+    ZstdDictionaryTrainingThreadSharedPtr training_thread, Stats::Scope& scope)
+    : max_sample_size_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_sample_size, DefaultMaxSampleSize)),
+      samples_per_training_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, samples_per_training, DefaultSamplesPerTraining)),
+      dictionary_size_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, dictionary_size, DefaultDictionarySize)),
+      training_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, training_interval,
+                                                    DefaultTrainingIntervalMs)),
+      dictionary_output_path_(config.dictionary_output_path()), cdict_manager_(cdict_manager),
+      main_dispatcher_(main_dispatcher), api_(api), training_thread_(std::move(training_thread)),
+      stats_(generateStats(config.stat_prefix().empty()
+                               ? "zstd.dictionary_training."
+                               : absl::StrCat("zstd.dictionary_training.", config.stat_prefix(),
+                                              "."),
+                           scope)),
+      training_timer_(main_dispatcher.createTimer([this]() { onTrainingTimer(); })) {
+  samples_.reserve(samples_per_training_);
+  training_timer_->enableTimer(training_interval_);
+}
+
+void ZstdDictionaryTrainer::addSample(std::string&& sample) {
+  if (sample.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  if (samples_.size() >= samples_per_training_) {
+    return;
+  }
+  samples_.push_back(std::move(sample));
+  stats_.samples_collected_.inc();
+  if (samples_.size() >= samples_per_training_) {
+    collecting_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void ZstdDictionaryTrainer::onTrainingTimer() {
+  training_timer_->enableTimer(training_interval_);
+  if (training_) {
+    return;
+  }
+  std::vector<std::string> samples;
+  {
+    absl::MutexLock lock(&mu_);
+    if (samples_.size() < samples_per_training_) {
+      return;
+    }
+    samples.swap(samples_);
+    samples_.reserve(samples_per_training_);
+  }
+
+  // The job only refers to the trainer through the main thread callback, as the trainer may be
+  // destroyed while it is queued or running.
+  training_ = true;
+  training_thread_->post([samples = std::move(samples), dictionary_size = dictionary_size_,
+                          path = dictionary_output_path_, &file_system = api_.fileSystem(),
+                          &main_dispatcher = main_dispatcher_,
+                          still_alive = std::weak_ptr<bool>(still_alive_), this]() mutable {
+    std::string dictionary = train(std::move(samples), dictionary_size);
+    if (!dictionary.empty() && !path.empty()) {
+      writeDictionary(file_system, dictionary, path);
+    }
+    main_dispatcher.post([this, still_alive, dictionary = std::move(dictionary)]() {
+      if (!still_alive.expired()) {
+        onTrainingDone(dictionary);
+      }
+    });
+  });
+}
+
+std::string ZstdDictionaryTrainer::train(std::vector<std::string>&& samples,
+                                         uint32_t dictionary_size) {
+  std::string samples_buffer;
+  std::vector<size_t> sample_sizes;
+  sample_sizes.reserve(samples.size());
+  for (const auto& sample : samples) {
+    samples_buffer.append(sample);
+    sample_sizes.push_back(sample.size());
+  }
+
+  std::string dictionary(dictionary_size, '\0');
+  const size_t result =
+      ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples_buffer.data(),
+                            sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+  if (ZDICT_isError(result)) {
+    ENVOY_LOG(debug, "zstd dictionary training failed: {}", ZDICT_getErrorName(result));
+    return "";
+  }
+  dictionary.resize(result);
+  ENVOY_LOG(debug, "trained zstd dictionary of {} bytes from {} samples", result,
+            sample_sizes.size());
+  return dictionary;
+}
+
+void ZstdDictionaryTrainer::writeDictionary(Filesystem::Instance& file_system,
+                                            const std::string& dictionary,
+                                            const std::string& path) {
+  static constexpr Filesystem::FlagSet DefaultFlags{1 << Filesystem::File::Operation::Write |
+                                                    1 << Filesystem::File::Operation::Create};
+  // Write to a temporary file first and rename it, so that watchers of the output path never
+  // observe a partially written dictionary.
+  const std::string tmp_path = absl::StrCat(path, ".tmp");
+  Filesystem::FilePathAndType file_info{Filesystem::DestinationType::File, tmp_path};
+  auto file = file_system.createFile(file_info);
+  if (!file || !file->open(DefaultFlags).return_value_) {
+    ENVOY_LOG(error, "failed to write zstd dictionary to {}", tmp_path);
+    return;
+  }
+  file->write(dictionary);
+  file->close();
+  const Api::IoCallBoolResult result = file_system.rename(tmp_path, path);
+  if (!result.return_value_) {
+    ENVOY_LOG(error, "failed to move zstd dictionary to {}: {}", path,
+              result.err_->getErrorDetails());
+  }
+}
+
+void ZstdDictionaryTrainer::onTrainingDone(const std::string& dictionary) {
+  training_ = false;
+  // Start collecting samples for the next training only once this one is done, so that the next
+  // dictionary is trained from payloads compressed with the current one in place.
+  collecting_.store(true, std::memory_order_relaxed);
+  const unsigned id = dictionary.empty() ? 0 : cdict_manager_.replaceTrainedDictionary(dictionary);
+  if (id == 0) {
+    stats_.training_failed_.inc();
+    return;
+  }
+  ENVOY_LOG(info, "installed trained zstd dictionary with id {}", id);
+  stats_.training_succeeded_.inc();
+  stats_.dictionary_id_.set(id);
+}
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
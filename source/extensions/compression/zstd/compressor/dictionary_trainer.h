@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/compression/zstd/compressor/v3/zstd.pb.h"
+#include "envoy/filesystem/filesystem.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+#include "source/extensions/compression/zstd/common/dictionary_manager.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Compression {
+namespace Zstd {
+namespace Compressor {
+
+using ZstdCDictManager =
+    Common::DictionaryManager<ZSTD_CDict, ZSTD_freeCDict, ZSTD_getDictID_fromCDict>;
+using ZstdCDictManagerPtr = std::unique_ptr<ZstdCDictManager>;
+
+/**
+ * All zstd dictionary training stats. @see stats_macros.h
+ * "dictionary_uncompressed_bytes" and "dictionary_compressed_bytes" only account for payloads
+ * compressed with a dictionary, so that their ratio can be compared with the overall ratio
+ * reported by the compressor filter.
+ */
+#define ALL_ZSTD_DICTIONARY_TRAINING_STATS(COUNTER, GAUGE)                                         \
+  COUNTER(samples_collected)                                                                       \
+  COUNTER(training_succeeded)                                                                      \
+  COUNTER(training_failed)                                                                         \
+  COUNTER(dictionary_uncompressed_bytes)                                                           \
+  COUNTER(dictionary_compressed_bytes)                                                             \
+  GAUGE(dictionary_id, NeverImport)
+
+/**
+ * Struct definition for zstd dictionary training stats. @see stats_macros.h
+ */
+struct ZstdDictionaryTrainingStats {
+  ALL_ZSTD_DICTIONARY_TRAINING_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * The thread training the dictionaries of all the zstd compressor libraries, one at a time. It is
+ * shared as a singleton, so that a configuration with many trainers, e.g. one per route, does not
+ * start as many threads.
+ */
+class ZstdDictionaryTrainingThread final : public Singleton::Instance {
+public:
+  using Job = std::function<void()>;
+
+  explicit ZstdDictionaryTrainingThread(Thread::ThreadFactory& thread_factory);
+
+  /**
+   * Jobs that haven't started yet are dropped. The destructor blocks until the running one
+   * completes.
+   */
+  ~ZstdDictionaryTrainingThread() override;
+
+  /**
+   * Queues a job to be run on the thread. Thread-safe.
+   */
+  void post(Job job);
+
+private:
+  void work();
+  bool hasJobOrTerminating() const ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return terminating_ || !jobs_.empty();
+  }
+
+  absl::Mutex mu_;
+  std::deque<Job> jobs_ ABSL_GUARDED_BY(mu_);
+  bool terminating_ ABSL_GUARDED_BY(mu_) = false;
+
+  // It is important that thread_ be last, as the new thread runs with 'this' and
+  // may access any other members.
+  Thread::ThreadPtr thread_;
+};
+using ZstdDictionaryTrainingThreadSharedPtr = std::shared_ptr<ZstdDictionaryTrainingThread>;
+
+/**
+ * Samples payloads handed in by compressors on the worker threads and periodically trains a
+ * zstd dictionary from them on the shared training thread. A successfully trained dictionary is
+ * installed on all threads through the CDict manager, next to the configured dictionary and in
+ * place of the previously trained one.
+ */
+class ZstdDictionaryTrainer : public Logger::Loggable<Logger::Id::misc> {
+public:
+  ZstdDictionaryTrainer(
+      const envoy::extensions::compression::zstd::compressor::v3::Zstd::DictionaryTraining& config,
+      ZstdCDictManager& cdict_manager, Event::Dispatcher& main_dispatcher, Api::Api& api,
+      ZstdDictionaryTrainingThreadSharedPtr training_thread, Stats::Scope& scope);
+
+  /**
+   * @return true if the trainer is still collecting samples. Cheap enough to be called for every
+   *         payload on the worker threads.
+   */
+  bool collecting() const { return collecting_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the maximum number of bytes to sample from the beginning of a payload.
+   */
+  uint32_t maxSampleSize() const { return max_sample_size_; }
+
+  /**
+   * Adds a sample for the next training. Thread-safe.
+   */
+  void addSample(std::string&& sample);
+
+  ZstdDictionaryTrainingStats& stats() { return stats_; }
+
+private:
+  static ZstdDictionaryTrainingStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return ZstdDictionaryTrainingStats{ALL_ZSTD_DICTIONARY_TRAINING_STATS(
+        POOL_COUNTER_PREFIX(scope, prefix), POOL_GAUGE_PREFIX(scope, prefix))};
+  }
+
+  // Runs on the main thread at every training interval.
+  void onTrainingTimer();
+  // Run on the training thread. train() returns an empty dictionary if the training failed.
+  static std::string train(std::vector<std::string>&& samples, uint32_t dictionary_size);
+  static void writeDictionary(Filesystem::Instance& file_system, const std::string& dictionary,
+                              const std::string& path);
+  // Runs on the main thread once a training is done.
+  void onTrainingDone(const std::string& dictionary);
+
+  const uint32_t max_sample_size_;
+  const uint32_t samples_per_training_;
+  const uint32_t dictionary_size_;
+  const std::chrono::milliseconds training_interval_;
+  const std::string dictionary_output_path_;
+  ZstdCDictManager& cdict_manager_;
+  Event::Dispatcher& main_dispatcher_;
+  Api::Api& api_;
+  const ZstdDictionaryTrainingThreadSharedPtr training_thread_;
+  ZstdDictionaryTrainingStats stats_;
+  Event::TimerPtr training_timer_;
+  std::atomic<bool> collecting_{true};
+  // Whether a training job is queued or running. Only accessed on the main thread.
+  bool training_{false};
+  // The trainings outliving the trainer drop their dictionary.
+  const std::shared_ptr<bool> still_alive_{std::make_shared<bool>(true)};
+
+  absl::Mutex mu_;
+  std::vector<std::string> samples_ ABSL_GUARDED_BY(mu_);
+};
+using ZstdDictionaryTrainerPtr = std::unique_ptr<ZstdDictionaryTrainer>;
+
+} // namespace Compressor
+} // namespace Zstd
+} // namespace Compression
+} // namespace Extensions
+} // namespace Envoy
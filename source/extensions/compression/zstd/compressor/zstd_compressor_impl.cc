@@ -10,9 +10,11 @@ namespace Compressor {
 
 ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum,
                                        uint32_t strategy, const ZstdCDictManagerPtr& cdict_manager,
-                                       uint32_t chunk_size)
+                                       uint32_t chunk_size,
+                                       ZstdDictionaryTrainer* dictionary_trainer)
     : Common::Base(chunk_size), cctx_(ZSTD_createCCtx(), &ZSTD_freeCCtx),
-      cdict_manager_(cdict_manager), compression_level_(compression_level) {
+      cdict_manager_(cdict_manager), compression_level_(compression_level),
+      dictionary_trainer_(dictionary_trainer) {
   size_t result;
   result = ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_checksumFlag, enable_checksum);
   RELEASE_ASSERT(!ZSTD_isError(result), "");
@@ -21,16 +23,27 @@ ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, bool enable_c
   RELEASE_ASSERT(!ZSTD_isError(result), "");
 
   if (cdict_manager_) {
-    ZSTD_CDict* cdict = cdict_manager_->getFirstDictionary();
-    result = ZSTD_CCtx_refCDict(cctx_.get(), cdict);
+    cdict_ = cdict_manager_->getPreferredDictionaryShared();
+  }
+  if (cdict_ != nullptr) {
+    result = ZSTD_CCtx_refCDict(cctx_.get(), cdict_.get());
   } else {
     result = ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_compressionLevel, compression_level_);
   }
   RELEASE_ASSERT(!ZSTD_isError(result), "");
+
+  if (dictionary_trainer_ != nullptr && dictionary_trainer_->collecting()) {
+    sample_.emplace();
+  }
 }
 
 void ZstdCompressorImpl::compress(Buffer::Instance& buffer,
                                   Envoy::Compression::Compressor::State state) {
+  if (sample_.has_value()) {
+    sample(buffer);
+  }
+  const uint64_t uncompressed_length = buffer.length();
+
   Buffer::OwnedImpl accumulation_buffer;
   for (const Buffer::RawSlice& input_slice : buffer.getRawSlices()) {
     if (input_slice.len_ > 0) {
@@ -45,6 +58,25 @@ void ZstdCompressorImpl::compress(Buffer::Instance& buffer,
 
   if (state == Envoy::Compression::Compressor::State::Finish) {
     process(buffer, ZSTD_e_end);
+    if (sample_.has_value()) {
+      dictionary_trainer_->addSample(std::move(sample_.value()));
+      sample_.reset();
+    }
+  }
+
+  if (dictionary_trainer_ != nullptr && cdict_ != nullptr) {
+    dictionary_trainer_->stats().dictionary_uncompressed_bytes_.add(uncompressed_length);
+    dictionary_trainer_->stats().dictionary_compressed_bytes_.add(buffer.length());
+  }
+}
+
+void ZstdCompressorImpl::sample(const Buffer::Instance& buffer) {
+  const uint64_t remaining = dictionary_trainer_->maxSampleSize() - sample_->size();
+  const uint64_t length = std::min<uint64_t>(remaining, buffer.length());
+  if (length > 0) {
+    const size_t offset = sample_->size();
+    sample_->resize(offset + length);
+    buffer.copyOut(0, length, sample_->data() + offset);
   }
 }
 
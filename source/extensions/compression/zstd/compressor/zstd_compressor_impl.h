@@ -4,6 +4,9 @@
 
 #include "source/extensions/compression/zstd/common/base.h"
 #include "source/extensions/compression/zstd/common/dictionary_manager.h"
+#include "source/extensions/compression/zstd/compressor/dictionary_trainer.h"
+
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -11,10 +14,6 @@ namespace Compression {
 namespace Zstd {
 namespace Compressor {
 
-using ZstdCDictManager =
-    Common::DictionaryManager<ZSTD_CDict, ZSTD_freeCDict, ZSTD_getDictID_fromCDict>;
-using ZstdCDictManagerPtr = std::unique_ptr<ZstdCDictManager>;
-
 /**
  * Implementation of compressor's interface.
  */
@@ -23,17 +22,25 @@ class ZstdCompressorImpl : public Common::Base,
                            NonCopyable {
 public:
   ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum, uint32_t strategy,
-                     const ZstdCDictManagerPtr& cdict_manager, uint32_t chunk_size);
+                     const ZstdCDictManagerPtr& cdict_manager, uint32_t chunk_size,
+                     ZstdDictionaryTrainer* dictionary_trainer = nullptr);
 
   // Compression::Compressor::Compressor
   void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
 
 private:
   void process(Buffer::Instance& output_buffer, ZSTD_EndDirective mode);
+  void sample(const Buffer::Instance& buffer);
 
   std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx_;
   const ZstdCDictManagerPtr& cdict_manager_;
   const uint32_t compression_level_;
+  // Held for the lifetime of the stream, as the dictionary may be replaced by the trainer while
+  // the stream is still being compressed.
+  std::shared_ptr<ZSTD_CDict> cdict_;
+  ZstdDictionaryTrainer* const dictionary_trainer_;
+  // Head of the payload, collected only if the trainer was collecting when the stream started.
+  absl::optional<std::string> sample_;
 };
 
 } // namespace Compressor
@@ -46,13 +46,16 @@ using BufferFilterConfigSharedPtr = std::shared_ptr<BufferFilterConfig>;
 /**
  * A filter that is capable of buffering an entire request before dispatching it upstream.
  */
-class BufferFilter : public Http::StreamDecoderFilter {
+class BufferFilter : public Http::StreamDecoderFilter, public Http::ResettableFilter {
 public:
   BufferFilter(BufferFilterConfigSharedPtr config);
 
   // Http::StreamFilterBase
   void onDestroy() override {}
 
+  // Http::ResettableFilter
+  void resetForReuse() override;
+
   // Http::StreamDecoderFilter
   Http::FilterHeadersStatus decodeHeaders(Http::RequestHeaderMap& headers,
                                           bool end_stream) override;
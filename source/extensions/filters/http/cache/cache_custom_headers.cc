@@ -21,12 +21,15 @@ const RequestHeaderHandle CacheCustomHeaders::ifNoneMatch() { return custom_head
 const RequestHeaderHandle CacheCustomHeaders::ifModifiedSince() { return custom_headers.if_modified_since_.handle(); }
 const RequestHeaderHandle CacheCustomHeaders::ifUnmodifiedSince() { return custom_headers.if_unmodified_since_.handle(); }
 const RequestHeaderHandle CacheCustomHeaders::ifRange() { return custom_headers.if_range_.handle(); }
+const RequestHeaderHandle CacheCustomHeaders::acceptEncoding() { return custom_headers.accept_encoding_.handle(); }
 
 const ResponseHeaderHandle CacheCustomHeaders::responseCacheControl() { return custom_headers.response_cache_control_.handle(); }
 const ResponseHeaderHandle CacheCustomHeaders::lastModified() { return custom_headers.last_modified_.handle(); }
 const ResponseHeaderHandle CacheCustomHeaders::age() { return custom_headers.age_.handle(); }
 const ResponseHeaderHandle CacheCustomHeaders::etag() { return custom_headers.etag_.handle(); }
 const ResponseHeaderHandle CacheCustomHeaders::expires() { return custom_headers.expires_.handle(); }
+const ResponseHeaderHandle CacheCustomHeaders::contentEncoding() { return custom_headers.content_encoding_.handle(); }
+const ResponseHeaderHandle CacheCustomHeaders::vary() { return custom_headers.vary_.handle(); }
 // clang-format on
 
 // clang-format off
@@ -39,11 +42,14 @@ CacheCustomHeaders::CacheCustomHeaders()
       if_modified_since_(Http::CustomHeaders::get().IfModifiedSince),
       if_unmodified_since_(Http::CustomHeaders::get().IfUnmodifiedSince),
       if_range_(Http::CustomHeaders::get().IfRange),
+      accept_encoding_(Http::CustomHeaders::get().AcceptEncoding),
       response_cache_control_(Http::CustomHeaders::get().CacheControl),
       last_modified_(Http::CustomHeaders::get().LastModified),
       etag_(Http::CustomHeaders::get().Etag),
       age_(Http::CustomHeaders::get().Age),
-      expires_(Http::CustomHeaders::get().Expires) {}
+      expires_(Http::CustomHeaders::get().Expires),
+      content_encoding_(Http::CustomHeaders::get().ContentEncoding),
+      vary_(Http::CustomHeaders::get().Vary) {}
 // clang-format on
 
 } // namespace Cache
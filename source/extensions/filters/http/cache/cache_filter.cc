@@ -2,7 +2,9 @@
 
 #include "envoy/http/header_map.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/enum_to_int.h"
+#include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
 #include "source/common/http/utility.h"
 #include "source/extensions/filters/http/cache/cache_custom_headers.h"
@@ -33,8 +35,10 @@ using CacheResponseCodeDetails = ConstSingleton<CacheResponseCodeDetailValues>;
 
 CacheFilter::CacheFilter(const envoy::extensions::filters::http::cache::v3::CacheConfig& config,
                          const std::string&, Stats::Scope&, TimeSource& time_source,
-                         std::shared_ptr<HttpCache> http_cache)
+                         std::shared_ptr<HttpCache> http_cache,
+                         CompressedVariantsConstSharedPtr compressed_variants)
     : time_source_(time_source), cache_(http_cache),
+      compressed_variants_(std::move(compressed_variants)),
       vary_allow_list_(config.allowed_vary_headers()) {}
 
 void CacheFilter::onDestroy() {
@@ -91,6 +95,14 @@ Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& hea
   LookupRequest lookup_request(headers, time_source_.systemTime(), vary_allow_list_);
   request_allows_inserts_ = !lookup_request.requestCacheControl().no_store_;
   is_head_request_ = headers.getMethodValue() == Http::Headers::get().MethodValues.Head;
+  // Byte ranges of a compressed variant don't match those of the origin response, so range
+  // requests are always looked up in the uncompressed entry.
+  if (compressed_variants_ != nullptr && !RangeUtils::getRangeHeader(headers).has_value()) {
+    variant_compressor_factory_ = compressed_variants_->select(headers);
+    if (variant_compressor_factory_ != nullptr) {
+      lookup_request.setVariantContentEncoding(variant_compressor_factory_->contentEncoding());
+    }
+  }
   lookup_ = cache_->makeLookupContext(std::move(lookup_request), *decoder_callbacks_);
 
   ASSERT(lookup_);
@@ -156,7 +168,19 @@ Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::ResponseHeaderMap& he
                                              });
       // Add metadata associated with the cached response. Right now this is only response_time;
       const ResponseMetadata metadata = {time_source_.systemTime()};
-      insert_queue_->insertHeaders(headers, metadata, end_stream);
+      if (variant_compressor_factory_ != nullptr && !end_stream &&
+          compressed_variants_->isCompressible(headers)) {
+        // The origin response is compressed once here, as it is inserted, so that later hits
+        // are served already compressed. The response passed downstream is left untouched.
+        Http::ResponseHeaderMapPtr variant_headers =
+            Http::createHeaderMap<Http::ResponseHeaderMapImpl>(headers);
+        CompressedVariants::setVariantHeaders(*variant_headers,
+                                              variant_compressor_factory_->contentEncoding());
+        variant_compressor_ = variant_compressor_factory_->createCompressor();
+        insert_queue_->insertHeaders(*variant_headers, metadata, end_stream);
+      } else {
+        insert_queue_->insertHeaders(headers, metadata, end_stream);
+      }
     }
     if (end_stream) {
       insert_status_ = InsertStatus::InsertSucceeded;
@@ -182,7 +206,11 @@ Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_
   }
   if (insert_queue_ != nullptr) {
     ENVOY_STREAM_LOG(debug, "CacheFilter::encodeData inserting body", *encoder_callbacks_);
-    insert_queue_->insertBody(data, end_stream);
+    if (variant_compressor_ != nullptr) {
+      insertCompressedBody(data, end_stream);
+    } else {
+      insert_queue_->insertBody(data, end_stream);
+    }
     if (end_stream) {
       // We don't actually know if the insert succeeded, but as far as the
       // filter is concerned it has been fully handed off to the cache
@@ -206,6 +234,11 @@ Http::FilterTrailersStatus CacheFilter::encodeTrailers(Http::ResponseTrailerMap&
   response_has_trailers_ = !trailers.empty();
   if (insert_queue_ != nullptr) {
     ENVOY_STREAM_LOG(debug, "CacheFilter::encodeTrailers inserting trailers", *encoder_callbacks_);
+    if (variant_compressor_ != nullptr) {
+      // The presence of trailers means the body has ended, so the compressed body must be
+      // finished before the trailers are inserted.
+      insertCompressedBody(Buffer::OwnedImpl(), false);
+    }
     insert_queue_->insertTrailers(trailers);
   }
   insert_status_ = InsertStatus::InsertSucceeded;
@@ -573,6 +606,13 @@ void CacheFilter::processSuccessfulValidation(Http::ResponseHeaderMap& response_
     insert_status_ = InsertStatus::HeaderUpdate;
   }
 
+  if (variant_compressor_factory_ != nullptr) {
+    // As when serving from the cache while decoding, the validated entry depends on the request's
+    // accept-encoding. This is added after the cached headers are updated, so that it is not
+    // stored with them.
+    CompressedVariants::insertVaryHeader(response_headers);
+  }
+
   // A cache entry was successfully validated -> encode cached body and trailers.
   encodeCachedResponse();
 }
@@ -648,6 +688,11 @@ void CacheFilter::encodeCachedResponse() {
   // If the filter is encoding, 304 response headers and cached headers are merged in encodeHeaders.
   // If the filter is decoding, we need to serve response headers from cache directly.
   if (filter_state_ == FilterState::DecodeServingFromCache) {
+    if (variant_compressor_factory_ != nullptr) {
+      // Entries looked up by encoding depend on the request's accept-encoding, even if the
+      // origin response was stored uncompressed.
+      CompressedVariants::insertVaryHeader(*lookup_result_->headers_);
+    }
     decoder_callbacks_->encodeHeaders(std::move(lookup_result_->headers_), end_stream,
                                       CacheResponseCodeDetails::get().ResponseFromCacheFilter);
   }
@@ -666,6 +711,16 @@ void CacheFilter::encodeCachedResponse() {
   }
 }
 
+void CacheFilter::insertCompressedBody(const Buffer::Instance& data, bool end_stream) {
+  ASSERT(variant_compressor_ != nullptr);
+  Buffer::OwnedImpl compressed;
+  compressed.add(data);
+  variant_compressor_->compress(compressed, end_stream || response_has_trailers_
+                                                ? Compression::Compressor::State::Finish
+                                                : Compression::Compressor::State::Flush);
+  insert_queue_->insertBody(compressed, end_stream);
+}
+
 void CacheFilter::finalizeEncodingCachedResponse() {
   if (filter_state_ == FilterState::EncodeServingFromCache) {
     // encodeHeaders returned StopIteration waiting for finishing encoding the cached response --
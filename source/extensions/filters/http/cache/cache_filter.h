@@ -5,12 +5,14 @@
 #include <string>
 #include <vector>
 
+#include "envoy/compression/compressor/compressor.h"
 #include "envoy/extensions/filters/http/cache/v3/cache.pb.h"
 
 #include "source/common/common/logger.h"
 #include "source/extensions/filters/http/cache/cache_filter_logging_info.h"
 #include "source/extensions/filters/http/cache/cache_headers_utils.h"
 #include "source/extensions/filters/http/cache/cache_insert_queue.h"
+#include "source/extensions/filters/http/cache/compressed_variants.h"
 #include "source/extensions/filters/http/cache/http_cache.h"
 #include "source/extensions/filters/http/common/pass_through_filter.h"
 
@@ -55,7 +57,8 @@ class CacheFilter : public Http::PassThroughFilter,
 public:
   CacheFilter(const envoy::extensions::filters::http::cache::v3::CacheConfig& config,
               const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source,
-              std::shared_ptr<HttpCache> http_cache);
+              std::shared_ptr<HttpCache> http_cache,
+              CompressedVariantsConstSharedPtr compressed_variants = nullptr);
   // Http::StreamFilterBase
   void onDestroy() override;
   void onStreamComplete() override;
@@ -115,6 +118,11 @@ private:
   // or during encoding if a cache entry was validated successfully.
   void encodeCachedResponse();
 
+  // Compresses a response body fragment for insertion as a compressed variant. This runs inline
+  // on the worker, not on the thread pool of the compressor filter: the fragments are passed to the
+  // insert queue in order, while the response is being sent downstream.
+  void insertCompressedBody(const Buffer::Instance& data, bool end_stream);
+
   // Precondition: finished adding a response from cache to the response encoding stream.
   // Updates filter_state_ and continues the encoding stream if necessary.
   void finalizeEncodingCachedResponse();
@@ -133,6 +141,11 @@ private:
   std::unique_ptr<CacheInsertQueue> insert_queue_;
   TimeSource& time_source_;
   std::shared_ptr<HttpCache> cache_;
+  const CompressedVariantsConstSharedPtr compressed_variants_;
+  // Set if the lookup (and insertion) is for the variant compressed by this factory.
+  Compression::Compressor::CompressorFactory* variant_compressor_factory_ = nullptr;
+  // Set while a response is being compressed for insertion as a compressed variant.
+  Compression::Compressor::CompressorPtr variant_compressor_;
   LookupContextPtr lookup_;
   LookupResultPtr lookup_result_;
 
@@ -0,0 +1,118 @@
+#include "source/extensions/filters/http/cache/compressed_variants.h"
+
+#include "source/common/common/utility.h"
+#include "source/common/http/headers.h"
+#include "source/extensions/filters/http/cache/cache_custom_headers.h"
+#include "source/extensions/filters/http/common/compressor_content_types.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+CompressedVariants::CompressedVariants(
+    std::vector<Compression::Compressor::CompressorFactoryPtr>&& compressor_factories,
+    const std::vector<std::string>& content_types)
+    : compressor_factories_(std::move(compressor_factories)),
+      content_types_(content_types.empty()
+                         ? StringUtil::CaseUnorderedSet(
+                               Common::defaultCompressorContentTypes().begin(),
+                               Common::defaultCompressorContentTypes().end())
+                         : StringUtil::CaseUnorderedSet(content_types.begin(),
+                                                        content_types.end())) {}
+
+Compression::Compressor::CompressorFactory*
+CompressedVariants::select(const Http::RequestHeaderMap& request_headers) const {
+  const absl::string_view accept_encoding =
+      request_headers.getInlineValue(CacheCustomHeaders::acceptEncoding());
+  if (accept_encoding.empty()) {
+    return nullptr;
+  }
+
+  Compression::Compressor::CompressorFactory* selected = nullptr;
+  float selected_q = 0;
+  float wildcard_q = -1;
+  std::vector<float> factory_q(compressor_factories_.size(), -1);
+  for (absl::string_view token : StringUtil::splitToken(accept_encoding, ",", false, true)) {
+    const std::vector<absl::string_view> params = StringUtil::splitToken(token, ";", false, true);
+    if (params.empty()) {
+      continue;
+    }
+    const absl::string_view coding = params[0];
+    float q = 1;
+    for (size_t i = 1; i < params.size(); i++) {
+      const absl::string_view param = params[i];
+      if (absl::StartsWithIgnoreCase(param, "q=") && !absl::SimpleAtof(param.substr(2), &q)) {
+        q = 0;
+      }
+    }
+    if (coding == "*") {
+      wildcard_q = q;
+      continue;
+    }
+    for (size_t i = 0; i < compressor_factories_.size(); i++) {
+      if (absl::EqualsIgnoreCase(coding, compressor_factories_[i]->contentEncoding())) {
+        factory_q[i] = q;
+      }
+    }
+  }
+
+  // Codings not listed explicitly are acceptable with the wildcard's weight.
+  for (size_t i = 0; i < compressor_factories_.size(); i++) {
+    const float q = factory_q[i] >= 0 ? factory_q[i] : wildcard_q;
+    if (q > selected_q) {
+      selected = compressor_factories_[i].get();
+      selected_q = q;
+    }
+  }
+  return selected;
+}
+
+bool CompressedVariants::isCompressible(const Http::ResponseHeaderMap& response_headers) const {
+  if (response_headers.getInline(CacheCustomHeaders::contentEncoding()) != nullptr) {
+    return false;
+  }
+  const Http::HeaderEntry* content_type = response_headers.ContentType();
+  if (content_type != nullptr &&
+      !content_types_.contains(StringUtil::trim(
+          StringUtil::cropRight(content_type->value().getStringView(), ";")))) {
+    return false;
+  }
+  return !StringUtil::caseFindToken(
+      response_headers.getInlineValue(CacheCustomHeaders::responseCacheControl()), ",",
+      Http::CustomHeaders::get().CacheControlValues.NoTransform);
+}
+
+void CompressedVariants::setVariantHeaders(Http::ResponseHeaderMap& response_headers,
+                                           absl::string_view content_encoding) {
+  response_headers.setInline(CacheCustomHeaders::contentEncoding(), content_encoding);
+  response_headers.removeContentLength();
+  // Strong entity tags are byte-exact, so they must not be served with a transformed body; weak
+  // ones are kept, as the compressor filter does.
+  const absl::string_view etag = response_headers.getInlineValue(CacheCustomHeaders::etag());
+  if (etag.length() > 2 && !((etag[0] == 'w' || etag[0] == 'W') && etag[1] == '/')) {
+    response_headers.removeInline(CacheCustomHeaders::etag());
+  }
+}
+
+void CompressedVariants::insertVaryHeader(Http::ResponseHeaderMap& response_headers) {
+  const absl::string_view vary = response_headers.getInlineValue(CacheCustomHeaders::vary());
+  if (vary.empty()) {
+    response_headers.setReferenceInline(CacheCustomHeaders::vary(),
+                                        Http::CustomHeaders::get().VaryValues.AcceptEncoding);
+  } else if (!StringUtil::caseFindToken(vary, ",",
+                                        Http::CustomHeaders::get().VaryValues.AcceptEncoding)) {
+    response_headers.setInline(
+        CacheCustomHeaders::vary(),
+        absl::StrCat(vary, ", ", Http::CustomHeaders::get().VaryValues.AcceptEncoding));
+  }
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
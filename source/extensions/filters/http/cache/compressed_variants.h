@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/compression/compressor/factory.h"
+#include "envoy/http/header_map.h"
+
+#include "source/common/common/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Compressor libraries used by the cache filter to keep pre-compressed variants of cached
+ * responses, in configuration order.
+ */
+class CompressedVariants {
+public:
+  /**
+   * @param compressor_factories supplies the compressor libraries, in configuration order.
+   * @param content_types supplies the content types of the responses which may be compressed, or
+   *        an empty list for the content types compressed by default by the compressor filter.
+   */
+  CompressedVariants(
+      std::vector<Compression::Compressor::CompressorFactoryPtr>&& compressor_factories,
+      const std::vector<std::string>& content_types = {});
+
+  /**
+   * @return the compressor factory of the configured encoding most preferred by the request's
+   *         accept-encoding header, or nullptr if none of them is acceptable. Ties are broken by
+   *         configuration order.
+   */
+  Compression::Compressor::CompressorFactory*
+  select(const Http::RequestHeaderMap& request_headers) const;
+
+  /**
+   * @return true if a response with these headers may be stored compressed.
+   */
+  bool isCompressible(const Http::ResponseHeaderMap& response_headers) const;
+
+  /**
+   * Adjusts response headers for a variant compressed with the given content-coding: sets
+   * content-encoding, and drops content-length and strong entity tags, which no longer describe
+   * the stored body. Vary is left alone, as variants are keyed by encoding rather than through
+   * the vary allow list; it is added by insertVaryHeader() when the entry is served.
+   */
+  static void setVariantHeaders(Http::ResponseHeaderMap& response_headers,
+                                absl::string_view content_encoding);
+
+  /**
+   * Adds accept-encoding to the vary header, unless already present.
+   */
+  static void insertVaryHeader(Http::ResponseHeaderMap& response_headers);
+
+private:
+  const std::vector<Compression::Compressor::CompressorFactoryPtr> compressor_factories_;
+  const StringUtil::CaseUnorderedSet content_types_;
+};
+
+using CompressedVariantsConstSharedPtr = std::shared_ptr<const CompressedVariants>;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
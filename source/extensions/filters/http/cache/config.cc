@@ -1,5 +1,8 @@
 #include "source/extensions/filters/http/cache/config.h"
 
+#include "envoy/compression/compressor/config.h"
+
+#include "source/common/config/utility.h"
 #include "source/extensions/filters/http/cache/cache_filter.h"
 
 namespace Envoy {
@@ -26,10 +29,35 @@ Http::FilterFactoryCb CacheFilterFactory::createFilterFactoryFromProtoTyped(
     cache = http_cache_factory->getCache(config, context);
   }
 
-  return [config, stats_prefix, &context,
-          cache](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+  CompressedVariantsConstSharedPtr compressed_variants;
+  if (!config.compressed_variants().empty()) {
+    std::vector<Compression::Compressor::CompressorFactoryPtr> compressor_factories;
+    for (const auto& compressor_library : config.compressed_variants()) {
+      const std::string type{
+          TypeUtil::typeUrlToDescriptorFullName(compressor_library.typed_config().type_url())};
+      Compression::Compressor::NamedCompressorLibraryConfigFactory* const config_factory =
+          Registry::FactoryRegistry<
+              Compression::Compressor::NamedCompressorLibraryConfigFactory>::getFactoryByType(type);
+      if (config_factory == nullptr) {
+        throw EnvoyException(
+            fmt::format("Didn't find a registered implementation for type: '{}'", type));
+      }
+      ProtobufTypes::MessagePtr message = Config::Utility::translateAnyToFactoryConfig(
+          compressor_library.typed_config(), context.messageValidationVisitor(), *config_factory);
+      compressor_factories.push_back(
+          config_factory->createCompressorFactoryFromProto(*message, context));
+    }
+    compressed_variants = std::make_shared<CompressedVariants>(
+        std::move(compressor_factories),
+        std::vector<std::string>(config.compressed_variants_content_type().begin(),
+                                 config.compressed_variants_content_type().end()));
+  }
+
+  return [config, stats_prefix, &context, cache,
+          compressed_variants](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<CacheFilter>(
-        config, stats_prefix, context.scope(), context.serverFactoryContext().timeSource(), cache));
+        config, stats_prefix, context.scope(), context.serverFactoryContext().timeSource(), cache,
+        compressed_variants));
   };
 }
 
@@ -86,6 +86,12 @@ public:
   // taken to ensure that meaningfully distinct responses have distinct keys.
   const Key& key() const { return key_; }
 
+  // Restricts the lookup to the variant of the response that the cache filter
+  // stores compressed with the given content-coding.
+  void setVariantContentEncoding(absl::string_view content_encoding) {
+    key_.set_content_encoding(std::string(content_encoding));
+  }
+
   // WARNING: Incomplete--do not use in production (yet).
   // Returns a LookupResult suitable for sending to the cache filter's
   // LookupHeadersCallback. Specifically,
@@ -0,0 +1,36 @@
+#include "source/extensions/filters/http/common/compressor_content_types.h"
+
+#include "source/common/common/macros.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Common {
+
+const std::vector<std::string>& defaultCompressorContentTypes() {
+  CONSTRUCT_ON_FIRST_USE(std::vector<std::string>, {"text/html",
+                                                    "text/plain",
+                                                    "text/css",
+                                                    "application/javascript",
+                                                    "application/x-javascript",
+                                                    "text/javascript",
+                                                    "text/x-javascript",
+                                                    "text/ecmascript",
+                                                    "text/js",
+                                                    "text/jscript",
+                                                    "text/x-js",
+                                                    "application/ecmascript",
+                                                    "application/x-json",
+                                                    "application/xml",
+                                                    "application/json",
+                                                    "image/svg+xml",
+                                                    "text/xml",
+                                                    "application/xhtml+xml",
+                                                    "application/grpc-web",
+                                                    "application/grpc-web+proto"});
+}
+
+} // namespace Common
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
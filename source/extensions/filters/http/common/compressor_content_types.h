@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Common {
+
+/**
+ * @return the content types compressed by the filters compressing responses, i.e. the compressor
+ *         filter and the compressed variants of the cache filter, if their configuration lists
+ *         none.
+ */
+const std::vector<std::string>& defaultCompressorContentTypes();
+
+} // namespace Common
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
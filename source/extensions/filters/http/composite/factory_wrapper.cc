@@ -42,6 +42,11 @@ void FactoryCallbacksWrapper::addStreamFilter(Http::StreamFilterSharedPtr filter
 void FactoryCallbacksWrapper::addAccessLogHandler(AccessLog::InstanceSharedPtr access_log) {
   access_loggers_.push_back(std::move(access_log));
 }
+
+void FactoryCallbacksWrapper::addFilterReleaseCallbacks(Http::FilterReleaseCallbacks&) {
+  // The filters are owned by the composite filter, which is destroyed with its stream.
+  errors_.push_back(absl::InvalidArgumentError("cannot recycle the filters of a composite filter"));
+}
 } // namespace Composite
 } // namespace HttpFilters
 } // namespace Extensions
@@ -22,6 +22,10 @@ struct FactoryCallbacksWrapper : public Http::FilterChainFactoryCallbacks {
   void addStreamFilter(Http::StreamFilterSharedPtr filter) override;
   void addAccessLogHandler(AccessLog::InstanceSharedPtr) override;
   Event::Dispatcher& dispatcher() override { return dispatcher_; }
+  // The filters are created when the composite filter matches, and are owned by it, which may not
+  // be allocated from the arena of the stream.
+  OptRef<Arena> streamArena() override { return {}; }
+  void addFilterReleaseCallbacks(Http::FilterReleaseCallbacks&) override;
 
   Filter& filter_;
   Event::Dispatcher& dispatcher_;
@@ -3,6 +3,8 @@
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/utility.h"
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/common/compressor_content_types.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -30,29 +32,10 @@ Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::Respons
 // Default minimum length of an upstream response that allows compression.
 const uint64_t DefaultMinimumContentLength = 30;
 
-// Default content types will be used if any is provided by the user.
-const std::vector<std::string>& defaultContentEncoding() {
-  CONSTRUCT_ON_FIRST_USE(std::vector<std::string>, {"text/html",
-                                                    "text/plain",
-                                                    "text/css",
-                                                    "application/javascript",
-                                                    "application/x-javascript",
-                                                    "text/javascript",
-                                                    "text/x-javascript",
-                                                    "text/ecmascript",
-                                                    "text/js",
-                                                    "text/jscript",
-                                                    "text/x-js",
-                                                    "application/ecmascript",
-                                                    "application/x-json",
-                                                    "application/xml",
-                                                    "application/json",
-                                                    "image/svg+xml",
-                                                    "text/xml",
-                                                    "application/xhtml+xml",
-                                                    "application/grpc-web",
-                                                    "application/grpc-web+proto"});
-}
+// Defaults for parallel compression of large responses.
+const uint64_t DefaultParallelMinContentLength = 1024 * 1024;
+const uint32_t DefaultParallelBlockSize = 128 * 1024;
+const uint32_t DefaultParallelMaxBlocksInFlight = 8;
 
 // List of CompressorFilterConfig objects registered for a stream.
 struct CompressorRegistry : public StreamInfo::FilterState::Object {
@@ -86,7 +69,8 @@ CompressorFilterConfig::DirectionConfig::DirectionConfig(
 CompressorFilterConfig::CompressorFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
     const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-    Compression::Compressor::CompressorFactoryPtr compressor_factory)
+    Compression::Compressor::CompressorFactoryPtr compressor_factory,
+    CompressionThreadPoolSharedPtr thread_pool)
     : common_stats_prefix_(fmt::format("{}compressor.{}.{}", stats_prefix,
                                        proto_config.compressor_library().name(),
                                        compressor_factory->statsPrefix())),
@@ -94,13 +78,13 @@ CompressorFilterConfig::CompressorFilterConfig(
       response_direction_config_(proto_config, common_stats_prefix_, scope, runtime),
       content_encoding_(compressor_factory->contentEncoding()),
       compressor_factory_(std::move(compressor_factory)),
-      choose_first_(proto_config.choose_first()) {}
+      choose_first_(proto_config.choose_first()), thread_pool_(std::move(thread_pool)) {}
 
 StringUtil::CaseUnorderedSet CompressorFilterConfig::DirectionConfig::contentTypeSet(
     const Protobuf::RepeatedPtrField<std::string>& types) {
-  const auto& default_content_encodings = defaultContentEncoding();
-  return types.empty() ? StringUtil::CaseUnorderedSet(default_content_encodings.begin(),
-                                                      default_content_encodings.end())
+  const auto& default_content_types = Common::defaultCompressorContentTypes();
+  return types.empty() ? StringUtil::CaseUnorderedSet(default_content_types.begin(),
+                                                      default_content_types.end())
                        : StringUtil::CaseUnorderedSet(types.cbegin(), types.cend());
 }
 
@@ -130,6 +114,17 @@ CompressorFilterConfig::ResponseDirectionConfig::ResponseDirectionConfig(
           proto_config.has_response_direction_config()
               ? proto_config.response_direction_config().remove_accept_encoding_header()
               : proto_config.remove_accept_encoding_header()),
+      parallel_compression_enabled_(
+          proto_config.response_direction_config().has_parallel_compression()),
+      parallel_min_content_length_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          proto_config.response_direction_config().parallel_compression(), min_content_length,
+          DefaultParallelMinContentLength)),
+      parallel_block_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          proto_config.response_direction_config().parallel_compression(), block_size,
+          DefaultParallelBlockSize)),
+      parallel_max_blocks_in_flight_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          proto_config.response_direction_config().parallel_compression(), max_blocks_in_flight,
+          DefaultParallelMaxBlocksInFlight)),
       response_stats_{generateResponseStats(stats_prefix, scope)} {}
 
 const envoy::extensions::filters::http::compressor::v3::Compressor::CommonDirectionConfig
@@ -163,9 +158,34 @@ Envoy::Compression::Compressor::CompressorPtr CompressorFilterConfig::makeCompre
   return compressor_factory_->createCompressor();
 }
 
+ParallelCompressorPtr
+CompressorFilterConfig::makeParallelCompressor(const Http::ResponseHeaderMap& headers,
+                                               Event::Dispatcher& dispatcher,
+                                               ParallelCompressor::Callbacks& callbacks) {
+  if (thread_pool_ == nullptr || !response_direction_config_.parallelCompressionEnabled()) {
+    return nullptr;
+  }
+  const Http::HeaderEntry* content_length = headers.ContentLength();
+  uint64_t length;
+  if (content_length == nullptr ||
+      !absl::SimpleAtoi(content_length->value().getStringView(), &length) ||
+      length < response_direction_config_.parallelMinContentLength()) {
+    return nullptr;
+  }
+  return std::make_unique<ParallelCompressor>(
+      *compressor_factory_, *thread_pool_, dispatcher, callbacks,
+      response_direction_config_.parallelBlockSize(),
+      response_direction_config_.parallelMaxBlocksInFlight());
+}
+
 CompressorFilter::CompressorFilter(const CompressorFilterConfigSharedPtr config)
     : config_(std::move(config)) {}
 
+void CompressorFilter::onDestroy() {
+  // Blocks still being compressed are discarded.
+  parallel_response_compressor_.reset();
+}
+
 CompressorPerRouteFilterConfig::CompressorPerRouteFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::CompressorPerRoute& config) {
   switch (config.override_case()) {
@@ -282,18 +302,31 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
   const bool isEnabledAndContentLengthBigEnough =
       compressionEnabled(config, per_route_config) && config.isMinimumContentLength(headers);
 
+  // Evaluated on its own so that already encoded responses are counted even when compression
+  // is skipped for another reason.
+  const bool contentEncodingAllowed = isContentEncodingAllowed(headers);
   const bool isCompressible =
       isEnabledAndContentLengthBigEnough && !Http::Utility::isUpgrade(headers) &&
       config.isContentTypeAllowed(headers) && !hasCacheControlNoTransform(headers) &&
-      isEtagAllowed(headers) && !headers.getInline(response_content_encoding_handle.handle());
+      isEtagAllowed(headers) && contentEncodingAllowed;
   if (!end_stream && isAcceptEncodingAllowed(isEnabledAndContentLengthBigEnough, headers) &&
       isCompressible && isTransferEncodingAllowed(headers)) {
+    // Large bodies are compressed off the worker thread, if configured. This has to be decided
+    // before the content length is removed.
+    if (config.parallelCompressionEnabled()) {
+      parallel_response_compressor_ =
+          config_->makeParallelCompressor(headers, encoder_callbacks_->dispatcher(), *this);
+    }
     sanitizeEtagHeader(headers);
     headers.removeContentLength();
     headers.setInline(response_content_encoding_handle.handle(), config_->contentEncoding());
     config.stats().compressed_.inc();
-    // Finally instantiate the compressor.
-    response_compressor_ = config_->makeCompressor();
+    if (parallel_response_compressor_ != nullptr) {
+      config.responseStats().parallel_compressed_.inc();
+    } else {
+      // Finally instantiate the compressor.
+      response_compressor_ = config_->makeCompressor();
+    }
   } else {
     config.stats().not_compressed_.inc();
   }
@@ -309,6 +342,12 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
 }
 
 Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (parallel_response_compressor_ != nullptr) {
+    config_->responseDirectionConfig().stats().total_uncompressed_bytes_.add(data.length());
+    parallel_response_compressor_->compress(data, end_stream);
+    // The compressed blocks are injected into the filter chain as they are ready.
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
   if (response_compressor_ != nullptr) {
     compressAndUpdateStats(response_compressor_, config_->responseDirectionConfig().stats(), data,
                            end_stream);
@@ -317,6 +356,13 @@ Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool
 }
 
 Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTrailerMap&) {
+  if (parallel_response_compressor_ != nullptr) {
+    response_has_trailers_ = true;
+    Buffer::OwnedImpl empty_buffer;
+    parallel_response_compressor_->compress(empty_buffer, true);
+    // The trailers are held back until the last block has been sent.
+    return Http::FilterTrailersStatus::StopIteration;
+  }
   if (response_compressor_ != nullptr) {
     Buffer::OwnedImpl empty_buffer;
     // The presence of trailers means the stream is ended, but encodeData()
@@ -329,6 +375,27 @@ Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTraile
   return Http::FilterTrailersStatus::Continue;
 }
 
+void CompressorFilter::onCompressedBlock(Buffer::Instance& data, bool end_stream) {
+  const auto& config = config_->responseDirectionConfig();
+  config.stats().total_compressed_bytes_.add(data.length());
+  config.responseStats().parallel_blocks_.inc();
+  if (end_stream && response_has_trailers_) {
+    encoder_callbacks_->injectEncodedDataToFilterChain(data, false);
+    encoder_callbacks_->continueEncoding();
+    return;
+  }
+  encoder_callbacks_->injectEncodedDataToFilterChain(data, end_stream);
+}
+
+void CompressorFilter::onAboveHighWatermark() {
+  config_->responseDirectionConfig().responseStats().parallel_high_watermark_.inc();
+  encoder_callbacks_->onEncoderFilterAboveWriteBufferHighWatermark();
+}
+
+void CompressorFilter::onBelowLowWatermark() {
+  encoder_callbacks_->onEncoderFilterBelowWriteBufferLowWatermark();
+}
+
 bool CompressorFilter::hasCacheControlNoTransform(Http::ResponseHeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.getInline(cache_control_handle.handle());
   if (cache_control) {
@@ -565,6 +632,16 @@ bool CompressorFilter::isEtagAllowed(Http::ResponseHeaderMap& headers) const {
   return is_etag_allowed;
 }
 
+bool CompressorFilter::isContentEncodingAllowed(Http::ResponseHeaderMap& headers) const {
+  // Responses already encoded upstream, e.g. pre-compressed variants served by a cache, pass
+  // through without being compressed again.
+  if (headers.getInline(response_content_encoding_handle.handle()) != nullptr) {
+    config_->responseDirectionConfig().responseStats().already_encoded_.inc();
+    return false;
+  }
+  return true;
+}
+
 bool CompressorFilterConfig::DirectionConfig::isMinimumContentLength(
     const Http::RequestOrResponseHeaderMap& headers) const {
   const Http::HeaderEntry* content_length = headers.ContentLength();
@@ -7,6 +7,7 @@
 #include "source/common/protobuf/protobuf.h"
 #include "source/common/runtime/runtime_protos.h"
 #include "source/extensions/filters/http/common/pass_through_filter.h"
+#include "source/extensions/filters/http/compressor/parallel_compressor.h"
 
 #include "absl/types/optional.h"
 
@@ -39,6 +40,9 @@ namespace Compressor {
  *
  * "header_gzip" is specific to the gzip filter and is deprecated since it duplicates
  * "header_compressor_used".
+ *
+ * "parallel_compressed" is a number of responses compressed in blocks on the compression thread
+ * pool, out of "compressed".
  */
 #define RESPONSE_COMPRESSOR_STATS(COUNTER)                                                         \
   COUNTER(no_accept_header)                                                                        \
@@ -47,7 +51,11 @@ namespace Compressor {
   COUNTER(header_compressor_overshadowed)                                                          \
   COUNTER(header_wildcard)                                                                         \
   COUNTER(header_not_valid)                                                                        \
-  COUNTER(not_compressed_etag)
+  COUNTER(not_compressed_etag)                                                                     \
+  COUNTER(already_encoded)                                                                         \
+  COUNTER(parallel_compressed)                                                                     \
+  COUNTER(parallel_blocks)                                                                         \
+  COUNTER(parallel_high_watermark)
 
 /**
  * Struct definitions for compressor stats. @see stats_macros.h
@@ -121,6 +129,10 @@ public:
     const ResponseCompressorStats& responseStats() const { return response_stats_; }
     bool disableOnEtagHeader() const { return disable_on_etag_header_; }
     bool removeAcceptEncodingHeader() const { return remove_accept_encoding_header_; }
+    bool parallelCompressionEnabled() const { return parallel_compression_enabled_; }
+    uint64_t parallelMinContentLength() const { return parallel_min_content_length_; }
+    uint32_t parallelBlockSize() const { return parallel_block_size_; }
+    uint32_t parallelMaxBlocksInFlight() const { return parallel_max_blocks_in_flight_; }
 
   private:
     static ResponseCompressorStats generateResponseStats(const std::string& prefix,
@@ -135,6 +147,10 @@ public:
 
     const bool disable_on_etag_header_;
     const bool remove_accept_encoding_header_;
+    const bool parallel_compression_enabled_;
+    const uint64_t parallel_min_content_length_;
+    const uint32_t parallel_block_size_;
+    const uint32_t parallel_max_blocks_in_flight_;
     const ResponseCompressorStats response_stats_;
   };
 
@@ -142,10 +158,20 @@ public:
   CompressorFilterConfig(
       const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
       const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory);
+      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory,
+      CompressionThreadPoolSharedPtr thread_pool = nullptr);
 
   Envoy::Compression::Compressor::CompressorPtr makeCompressor();
 
+  /**
+   * @return a compressor compressing the response body in blocks on the thread pool, or nullptr
+   *         if parallel compression isn't configured or the response isn't known to be large
+   *         enough.
+   */
+  ParallelCompressorPtr makeParallelCompressor(const Http::ResponseHeaderMap& headers,
+                                               Event::Dispatcher& dispatcher,
+                                               ParallelCompressor::Callbacks& callbacks);
+
   const std::string contentEncoding() const { return content_encoding_; };
   bool chooseFirst() const { return choose_first_; };
   const RequestDirectionConfig& requestDirectionConfig() { return request_direction_config_; }
@@ -159,6 +185,7 @@ private:
   const std::string content_encoding_;
   const Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory_;
   const bool choose_first_;
+  const CompressionThreadPoolSharedPtr thread_pool_;
 };
 using CompressorFilterConfigSharedPtr = std::shared_ptr<CompressorFilterConfig>;
 
@@ -180,10 +207,13 @@ private:
 /**
  * A filter that compresses data dispatched from the upstream upon client request.
  */
-class CompressorFilter : public Http::PassThroughFilter {
+class CompressorFilter : public Http::PassThroughFilter, public ParallelCompressor::Callbacks {
 public:
   explicit CompressorFilter(const CompressorFilterConfigSharedPtr config);
 
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
   // Http::StreamDecoderFilter
   Http::FilterHeadersStatus decodeHeaders(Http::RequestHeaderMap& headers,
                                           bool end_stream) override;
@@ -197,6 +227,11 @@ public:
   Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
   Http::FilterTrailersStatus encodeTrailers(Http::ResponseTrailerMap&) override;
 
+  // ParallelCompressor::Callbacks
+  void onCompressedBlock(Buffer::Instance& data, bool end_stream) override;
+  void onAboveHighWatermark() override;
+  void onBelowLowWatermark() override;
+
 private:
   bool compressionEnabled(const CompressorFilterConfig::ResponseDirectionConfig& config,
                           const CompressorPerRouteFilterConfig* per_route_config) const;
@@ -205,6 +240,7 @@ private:
   bool hasCacheControlNoTransform(Http::ResponseHeaderMap& headers) const;
   bool isAcceptEncodingAllowed(bool maybe_compress, const Http::ResponseHeaderMap& headers) const;
   bool isEtagAllowed(Http::ResponseHeaderMap& headers) const;
+  bool isContentEncodingAllowed(Http::ResponseHeaderMap& headers) const;
   bool isTransferEncodingAllowed(Http::RequestOrResponseHeaderMap& headers) const;
 
   void sanitizeEtagHeader(Http::ResponseHeaderMap& headers);
@@ -232,9 +268,11 @@ private:
   bool shouldCompress(const EncodingDecision& decision) const;
 
   Envoy::Compression::Compressor::CompressorPtr response_compressor_;
+  ParallelCompressorPtr parallel_response_compressor_;
   Envoy::Compression::Compressor::CompressorPtr request_compressor_;
   const CompressorFilterConfigSharedPtr config_;
   std::unique_ptr<std::string> accept_encoding_;
+  bool response_has_trailers_{};
 };
 
 } // namespace Compressor
@@ -1,8 +1,12 @@
 #include "source/extensions/filters/http/compressor/config.h"
 
+#include <algorithm>
+
 #include "envoy/compression/compressor/config.h"
+#include "envoy/singleton/manager.h"
 
 #include "source/common/config/utility.h"
+#include "source/common/protobuf/utility.h"
 #include "source/extensions/filters/http/compressor/compressor_filter.h"
 
 namespace Envoy {
@@ -10,6 +14,24 @@ namespace Extensions {
 namespace HttpFilters {
 namespace Compressor {
 
+SINGLETON_MANAGER_REGISTRATION(compression_thread_pool);
+
+namespace {
+
+// The pool compressing large responses in parallel, shared by all the filter configs. It has one
+// thread for two workers, so that the compressions can't take more than half of the cores used by
+// the workers.
+CompressionThreadPoolSharedPtr
+getCompressionThreadPool(Server::Configuration::ServerFactoryContext& context) {
+  return context.singletonManager().getTyped<CompressionThreadPool>(
+      SINGLETON_MANAGER_REGISTERED_NAME(compression_thread_pool), [&context] {
+        return std::make_shared<CompressionThreadPool>(
+            context.api().threadFactory(), std::max(1U, context.options().concurrency() / 2));
+      });
+}
+
+} // namespace
+
 absl::StatusOr<Http::FilterFactoryCb> CompressorFilterFactory::createFilterFactoryFromProtoTyped(
     const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
     const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
@@ -27,9 +49,17 @@ absl::StatusOr<Http::FilterFactoryCb> CompressorFilterFactory::createFilterFacto
       *config_factory);
   Compression::Compressor::CompressorFactoryPtr compressor_factory =
       config_factory->createCompressorFactoryFromProto(*message, context);
+  CompressionThreadPoolSharedPtr thread_pool;
+  if (proto_config.response_direction_config().has_parallel_compression()) {
+    if (!compressor_factory->supportsConcatenatedStreams()) {
+      return absl::InvalidArgumentError(
+          fmt::format("Parallel compression isn't supported by the compressor library '{}'", type));
+    }
+    thread_pool = getCompressionThreadPool(context.serverFactoryContext());
+  }
   CompressorFilterConfigSharedPtr config = std::make_shared<CompressorFilterConfig>(
       proto_config, stats_prefix, context.scope(), context.serverFactoryContext().runtime(),
-      std::move(compressor_factory));
+      std::move(compressor_factory), std::move(thread_pool));
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<CompressorFilter>(config));
   };
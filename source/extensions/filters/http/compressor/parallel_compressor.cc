@@ -0,0 +1,147 @@
+#include "source/extensions/filters/http/compressor/parallel_compressor.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+CompressionThreadPool::CompressionThreadPool(Thread::ThreadFactory& thread_factory,
+                                             uint32_t num_threads) {
+  threads_.reserve(num_threads);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.push_back(
+        thread_factory.createThread([this]() { work(); }, Thread::Options{"compressor_pool"}));
+  }
+}
+
+CompressionThreadPool::~CompressionThreadPool() {
+  {
+    absl::MutexLock lock(&mu_);
+    terminating_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void CompressionThreadPool::post(Job job) {
+  absl::MutexLock lock(&mu_);
+  jobs_.push_back(std::move(job));
+}
+
+void CompressionThreadPool::work() {
+  while (true) {
+    Job job;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &CompressionThreadPool::hasJobOrTerminating));
+      if (terminating_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+ParallelCompressor::ParallelCompressor(
+    Envoy::Compression::Compressor::CompressorFactory& compressor_factory,
+    CompressionThreadPool& thread_pool, Event::Dispatcher& dispatcher, Callbacks& callbacks,
+    uint32_t block_size, uint32_t max_blocks_in_flight)
+    : compressor_factory_(compressor_factory), thread_pool_(thread_pool), dispatcher_(dispatcher),
+      callbacks_(callbacks), block_size_(block_size), max_blocks_in_flight_(max_blocks_in_flight) {
+  ASSERT(compressor_factory_.supportsConcatenatedStreams());
+}
+
+ParallelCompressor::~ParallelCompressor() {
+  absl::MutexLock lock(&shared_state_->mu_);
+  shared_state_->alive_ = false;
+}
+
+void ParallelCompressor::compress(Buffer::Instance& data, bool end_stream) {
+  ASSERT(!end_stream_);
+  pending_.move(data);
+  while (pending_.length() >= block_size_) {
+    submitBlock(block_size_);
+  }
+  if (end_stream) {
+    end_stream_ = true;
+    // The last block may be empty, which still yields a valid, empty, compressed stream.
+    submitBlock(pending_.length());
+  }
+}
+
+void ParallelCompressor::submitBlock(uint64_t length) {
+  auto block = std::make_shared<Block>(Block{next_sequence_++, {}, nullptr});
+  block->data_.move(pending_, length);
+  // Compressors are created on the dispatcher, as libraries may rely on thread local state, e.g.
+  // for dictionaries.
+  block->compressor_ = compressor_factory_.createCompressor();
+  thread_pool_.post([block, shared_state = shared_state_, &dispatcher = dispatcher_, this]() {
+    compressBlock(block, shared_state, dispatcher, this);
+  });
+
+  blocks_in_flight_++;
+  if (!above_high_watermark_ && blocks_in_flight_ >= max_blocks_in_flight_) {
+    above_high_watermark_ = true;
+    callbacks_.onAboveHighWatermark();
+  }
+}
+
+void ParallelCompressor::compressBlock(const BlockSharedPtr& block,
+                                       const SharedStateSharedPtr& shared_state,
+                                       Event::Dispatcher& dispatcher,
+                                       ParallelCompressor* compressor) {
+  {
+    // Skip the work if the stream has gone away in the meantime.
+    absl::MutexLock lock(&shared_state->mu_);
+    if (!shared_state->alive_) {
+      return;
+    }
+  }
+  block->compressor_->compress(block->data_, Envoy::Compression::Compressor::State::Finish);
+  block->compressor_.reset();
+
+  // The dispatcher outlives the streams it runs, so it is safe to post to while the stream is
+  // alive; holding the lock keeps the stream from going away until the post is done.
+  absl::MutexLock lock(&shared_state->mu_);
+  if (!shared_state->alive_) {
+    return;
+  }
+  dispatcher.post([block, shared_state, compressor]() mutable {
+    {
+      absl::MutexLock lock(&shared_state->mu_);
+      if (!shared_state->alive_) {
+        return;
+      }
+    }
+    compressor->onBlockCompressed(std::move(block));
+  });
+}
+
+void ParallelCompressor::onBlockCompressed(BlockSharedPtr&& block) {
+  compressed_blocks_.emplace(block->sequence_, std::move(block));
+  // Send all the blocks which are now in order.
+  for (auto it = compressed_blocks_.find(next_sequence_to_send_); it != compressed_blocks_.end();
+       it = compressed_blocks_.find(next_sequence_to_send_)) {
+    const BlockSharedPtr next = std::move(it->second);
+    compressed_blocks_.erase(it);
+    next_sequence_to_send_++;
+    blocks_in_flight_--;
+    const bool end_stream = end_stream_ && next_sequence_to_send_ == next_sequence_;
+    callbacks_.onCompressedBlock(next->data_, end_stream);
+  }
+
+  if (above_high_watermark_ && blocks_in_flight_ <= max_blocks_in_flight_ / 2) {
+    above_high_watermark_ = false;
+    callbacks_.onBelowLowWatermark();
+  }
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/compression/compressor/factory.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * A fixed number of threads compressing blocks of response bodies on behalf of the workers. A
+ * single pool is shared by all the filter configs of the server, as a singleton.
+ *
+ * The class is final, as the threads may still be running during the destructor.
+ */
+class CompressionThreadPool final : public Singleton::Instance,
+                                    public Logger::Loggable<Logger::Id::filter> {
+public:
+  using Job = std::function<void()>;
+
+  CompressionThreadPool(Thread::ThreadFactory& thread_factory, uint32_t num_threads);
+
+  /**
+   * Jobs that haven't started yet are dropped. The destructor blocks until the running ones
+   * complete.
+   */
+  ~CompressionThreadPool();
+
+  /**
+   * Queues a job to be run on one of the threads. Thread-safe.
+   */
+  void post(Job job);
+
+private:
+  void work();
+  bool hasJobOrTerminating() const ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return terminating_ || !jobs_.empty();
+  }
+
+  absl::Mutex mu_;
+  std::deque<Job> jobs_ ABSL_GUARDED_BY(mu_);
+  bool terminating_ ABSL_GUARDED_BY(mu_) = false;
+
+  // It is important that threads_ be last, as the new threads run with 'this' and
+  // may access any other members.
+  std::vector<Thread::ThreadPtr> threads_;
+};
+using CompressionThreadPoolSharedPtr = std::shared_ptr<CompressionThreadPool>;
+
+/**
+ * Compresses the body of a stream in independent blocks on a CompressionThreadPool. Each block is
+ * compressed into a finished stream of its own, and the compressed blocks are handed back on the
+ * stream's dispatcher in their original order. Must only be used with compressor factories
+ * supporting concatenated streams.
+ */
+class ParallelCompressor : public Logger::Loggable<Logger::Id::filter> {
+public:
+  class Callbacks {
+  public:
+    virtual ~Callbacks() = default;
+
+    /**
+     * Called on the dispatcher with the next compressed block.
+     * @param end_stream is true for the last block of the body.
+     */
+    virtual void onCompressedBlock(Buffer::Instance& data, bool end_stream) PURE;
+
+    /**
+     * Called once the maximum number of blocks in flight has been reached.
+     */
+    virtual void onAboveHighWatermark() PURE;
+
+    /**
+     * Called once half of the blocks in flight have been handed back after a call to
+     * onAboveHighWatermark().
+     */
+    virtual void onBelowLowWatermark() PURE;
+  };
+
+  ParallelCompressor(Envoy::Compression::Compressor::CompressorFactory& compressor_factory,
+                     CompressionThreadPool& thread_pool, Event::Dispatcher& dispatcher,
+                     Callbacks& callbacks, uint32_t block_size, uint32_t max_blocks_in_flight);
+
+  /**
+   * Blocks still being compressed are discarded.
+   */
+  ~ParallelCompressor();
+
+  /**
+   * Queues the data for compression, draining it. The body must be ended with end_stream set to
+   * true, which flushes the last, possibly empty, block.
+   */
+  void compress(Buffer::Instance& data, bool end_stream);
+
+private:
+  struct Block {
+    const uint64_t sequence_;
+    Buffer::OwnedImpl data_;
+    Envoy::Compression::Compressor::CompressorPtr compressor_;
+  };
+  using BlockSharedPtr = std::shared_ptr<Block>;
+
+  // State shared with the pool threads, which may still hold blocks of the stream after the
+  // ParallelCompressor is destroyed.
+  struct SharedState {
+    absl::Mutex mu_;
+    bool alive_ ABSL_GUARDED_BY(mu_) = true;
+  };
+  using SharedStateSharedPtr = std::shared_ptr<SharedState>;
+
+  void submitBlock(uint64_t length);
+  // Runs on a pool thread.
+  static void compressBlock(const BlockSharedPtr& block, const SharedStateSharedPtr& shared_state,
+                            Event::Dispatcher& dispatcher, ParallelCompressor* compressor);
+  // Runs on the dispatcher.
+  void onBlockCompressed(BlockSharedPtr&& block);
+
+  Envoy::Compression::Compressor::CompressorFactory& compressor_factory_;
+  CompressionThreadPool& thread_pool_;
+  Event::Dispatcher& dispatcher_;
+  Callbacks& callbacks_;
+  const uint64_t block_size_;
+  const uint32_t max_blocks_in_flight_;
+  const SharedStateSharedPtr shared_state_{std::make_shared<SharedState>()};
+  Buffer::OwnedImpl pending_;
+  uint64_t next_sequence_{};
+  uint64_t next_sequence_to_send_{};
+  uint32_t blocks_in_flight_{};
+  bool end_stream_{};
+  bool above_high_watermark_{};
+  // Blocks compressed ahead of the next one to send.
+  absl::flat_hash_map<uint64_t, BlockSharedPtr> compressed_blocks_;
+};
+using ParallelCompressorPtr = std::unique_ptr<ParallelCompressor>;
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
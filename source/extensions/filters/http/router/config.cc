@@ -3,6 +3,7 @@
 #include "envoy/extensions/filters/http/router/v3/router.pb.h"
 #include "envoy/extensions/filters/http/router/v3/router.pb.validate.h"
 
+#include "source/common/common/arena.h"
 #include "source/common/router/router.h"
 #include "source/common/router/shadow_writer_impl.h"
 
@@ -21,8 +22,10 @@ Http::FilterFactoryCb RouterFilterConfig::createFilterFactoryFromProtoTyped(
       proto_config));
 
   return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamDecoderFilter(
-        std::make_shared<Router::ProdFilter>(*filter_config, filter_config->default_stats_));
+    // The router is in every filter chain, and is not referenced beyond its stream: allocate it
+    // from the arena of the stream.
+    callbacks.addStreamDecoderFilter(makeArenaShared<Router::ProdFilter>(
+        callbacks.streamArena(), *filter_config, filter_config->default_stats_));
   };
 }
 
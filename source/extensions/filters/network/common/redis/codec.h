@@ -126,6 +126,21 @@ public:
   CompositeArray& asCompositeArray();
   const CompositeArray& asCompositeArray() const;
 
+  /**
+   * A BulkString may be backed by a buffer rather than by a string, e.g. by a portion of the
+   * decoded data, so that it is encoded without copying it. The buffer is copied into the string by
+   * the first call to asString(). The non-const asString() then releases the buffer, as the string
+   * may be modified.
+   * @return the buffer backing the BulkString, or nullptr.
+   */
+  const std::shared_ptr<const Buffer::Instance>& bulkStringBuffer() const;
+
+  /**
+   * Change the type of the RespValue to a BulkString backed by a buffer.
+   * @param buffer supplies the non empty buffer, which must no longer be modified.
+   */
+  void bulkStringBuffer(std::shared_ptr<const Buffer::Instance> buffer);
+
   /**
    * Get/set the type of the RespValue. A RespValue can only be a single type at a time. Each time
    * type() is called the type is changed and then the type specific as* methods can be used.
@@ -142,8 +157,11 @@ private:
   };
 
   void cleanup();
+  void copyStringFromBuffer() const;
 
   RespType type_{};
+  // The buffer backing a BulkString, if any. See bulkStringBuffer().
+  std::shared_ptr<const Buffer::Instance> string_buffer_;
 };
 
 using RespValuePtr = std::unique_ptr<RespValue>;
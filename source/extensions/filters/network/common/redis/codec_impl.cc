@@ -68,15 +68,41 @@ const std::vector<RespValue>& RespValue::asArray() const {
 std::string& RespValue::asString() {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  if (string_buffer_ != nullptr) {
+    copyStringFromBuffer();
+    string_buffer_.reset();
+  }
   return string_;
 }
 
 const std::string& RespValue::asString() const {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  if (string_buffer_ != nullptr) {
+    copyStringFromBuffer();
+  }
   return string_;
 }
 
+const std::shared_ptr<const Buffer::Instance>& RespValue::bulkStringBuffer() const {
+  ASSERT(type_ == RespType::BulkString);
+  return string_buffer_;
+}
+
+void RespValue::bulkStringBuffer(std::shared_ptr<const Buffer::Instance> buffer) {
+  ASSERT(buffer != nullptr && buffer->length() > 0);
+  type(RespType::BulkString);
+  string_buffer_ = std::move(buffer);
+}
+
+void RespValue::copyStringFromBuffer() const {
+  // The buffer is not empty, so the string is only empty until copied. The copy does not change the
+  // value, hence is allowed on const values.
+  if (string_.empty()) {
+    const_cast<std::string&>(string_) = string_buffer_->toString();
+  }
+}
+
 int64_t& RespValue::asInteger() {
   ASSERT(type_ == RespType::Integer);
   return integer_;
@@ -112,6 +138,7 @@ void RespValue::cleanup() {
   case RespType::BulkString:
   case RespType::Error: {
     string_.~basic_string<char>();
+    string_buffer_.reset();
     break;
   }
   case RespType::Null:
@@ -162,7 +189,11 @@ RespValue::RespValue(const RespValue& other) : type_(RespType::Null) {
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
-    asString() = other.asString();
+    // Share the buffer backing the string, if any, rather than copying it.
+    string_buffer_ = other.string_buffer_;
+    if (string_buffer_ == nullptr) {
+      string_ = other.string_;
+    }
     break;
   }
   case RespType::Integer: {
@@ -188,6 +219,7 @@ RespValue::RespValue(RespValue&& other) noexcept : type_(other.type_) {
   case RespType::BulkString:
   case RespType::Error: {
     new (&string_) std::string(std::move(other.string_));
+    string_buffer_ = std::move(other.string_buffer_);
     break;
   }
   case RespType::Integer: {
@@ -216,7 +248,11 @@ RespValue& RespValue::operator=(const RespValue& other) {
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
-    asString() = other.asString();
+    // Share the buffer backing the string, if any, rather than copying it.
+    string_buffer_ = other.string_buffer_;
+    if (string_buffer_ == nullptr) {
+      string_ = other.string_;
+    }
     break;
   }
   case RespType::Integer: {
@@ -248,6 +284,7 @@ RespValue& RespValue::operator=(RespValue&& other) noexcept {
   case RespType::BulkString:
   case RespType::Error: {
     string_ = std::move(other.string_);
+    string_buffer_ = std::move(other.string_buffer_);
     break;
   }
   case RespType::Integer: {
@@ -330,14 +367,41 @@ RespValue::CompositeArray::CompositeArrayConstIterator::empty() {
 }
 
 void DecoderImpl::decode(Buffer::Instance& data) {
-  for (const Buffer::RawSlice& slice : data.getRawSlices()) {
-    parseSlice(slice);
+  while (data.length() > 0) {
+    uint64_t parsed = 0;
+    for (const Buffer::RawSlice& slice : data.getRawSlices()) {
+      parsed += parseSlice(slice);
+      if (state_ == State::BufferedBulkStringBody) {
+        break;
+      }
+    }
+    data.drain(parsed);
+
+    if (state_ == State::BufferedBulkStringBody) {
+      parseBufferedBulkString(data);
+    }
+  }
+}
+
+void DecoderImpl::parseBufferedBulkString(Buffer::Instance& data) {
+  if (pending_string_buffer_ == nullptr) {
+    pending_string_buffer_ = std::make_shared<Buffer::OwnedImpl>();
   }
+  // The whole slices of the data are moved rather than copied. The data may be the read buffer of
+  // a connection, whose accounting does not apply to the value.
+  const uint64_t length = std::min(pending_integer_.integer_, data.length());
+  pending_string_buffer_->move(data, length, true);
+  pending_integer_.integer_ -= length;
 
-  data.drain(data.length());
+  if (pending_integer_.integer_ == 0) {
+    ENVOY_LOG(trace, "parse slice: BufferedBulkStringBody complete: {} bytes",
+              pending_string_buffer_->length());
+    pending_value_stack_.front().value_->bulkStringBuffer(std::move(pending_string_buffer_));
+    state_ = State::CR;
+  }
 }
 
-void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
+uint64_t DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
   const char* buffer = reinterpret_cast<const char*>(slice.mem_);
   uint64_t remaining = slice.len_;
 
@@ -457,19 +521,27 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
         state_ = State::ValueComplete;
       } else {
         ASSERT(current_value.value_->type() == RespType::BulkString);
-        if (!pending_integer_.negative_) {
-          // TODO(mattklein123): reserve and define max length since we don't stream currently.
-          state_ = State::BulkStringBody;
-        } else {
+        if (pending_integer_.negative_) {
           // Null bulk string. Switch type to null and move to value complete.
           current_value.value_->type(RespType::Null);
           state_ = State::ValueComplete;
+        } else if (pending_integer_.integer_ >= buffered_bulk_string_min_size_) {
+          // Large bulk strings are moved out of the data by decode() rather than copied.
+          state_ = State::BufferedBulkStringBody;
+        } else {
+          // TODO(mattklein123): reserve and define max length since we don't stream currently.
+          state_ = State::BulkStringBody;
         }
       }
 
       break;
     }
 
+    case State::BufferedBulkStringBody: {
+      // Stop parsing, for decode() to move the string out of the data.
+      return slice.len_ - remaining;
+    }
+
     case State::BulkStringBody: {
       ASSERT(!pending_integer_.negative_);
       uint64_t length_to_copy =
@@ -547,6 +619,8 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
     }
     }
   }
+
+  return slice.len_;
 }
 
 void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
@@ -564,7 +638,11 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
     break;
   }
   case RespType::BulkString: {
-    encodeBulkString(value.asString(), out);
+    if (value.bulkStringBuffer() != nullptr) {
+      encodeBulkStringBuffer(value.bulkStringBuffer(), out);
+    } else {
+      encodeBulkString(value.asString(), out);
+    }
     break;
   }
   case RespType::Error: {
@@ -621,6 +699,27 @@ void EncoderImpl::encodeBulkString(const std::string& string, Buffer::Instance&
   out.add("\r\n", 2);
 }
 
+void EncoderImpl::encodeBulkStringBuffer(const std::shared_ptr<const Buffer::Instance>& buffer,
+                                         Buffer::Instance& out) {
+  char header[32];
+  char* current = header;
+  *current++ = '$';
+  current += StringUtil::itoa(current, 21, buffer->length());
+  *current++ = '\r';
+  *current++ = '\n';
+  out.add(header, current - header);
+  // Reference the slices of the buffer rather than copying them. The fragments share the ownership
+  // of the buffer, as they may outlive the value.
+  for (const Buffer::RawSlice& slice : buffer->getRawSlices()) {
+    out.addBufferFragment(*new Buffer::BufferFragmentImpl(
+        slice.mem_, slice.len_,
+        [buffer](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        }));
+  }
+  out.add("\r\n", 2);
+}
+
 void EncoderImpl::encodeError(const std::string& string, Buffer::Instance& out) {
   out.add("-", 1);
   out.add(string);
@@ -2,9 +2,11 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/logger.h"
 #include "source/extensions/filters/network/common/redis/codec.h"
 
@@ -21,7 +23,19 @@ namespace Redis {
  */
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::redis> {
 public:
-  DecoderImpl(DecoderCallbacks& callbacks) : callbacks_(callbacks) {}
+  // The minimum size of the bulk strings backed by a buffer, see RespValue::bulkStringBuffer().
+  static constexpr uint64_t DefaultBufferedBulkStringMinSize = 16 * 1024;
+
+  /**
+   * @param callbacks supplies the callbacks of the decoded values.
+   * @param buffered_bulk_string_min_size supplies the minimum size of the bulk strings which are
+   *        moved out of the decoded data into a buffer rather than copied into a string.
+   */
+  DecoderImpl(DecoderCallbacks& callbacks,
+              uint64_t buffered_bulk_string_min_size = DefaultBufferedBulkStringMinSize)
+      : callbacks_(callbacks), buffered_bulk_string_min_size_(buffered_bulk_string_min_size) {
+    ASSERT(buffered_bulk_string_min_size_ > 0);
+  }
 
   // RedisProxy::Decoder
   void decode(Buffer::Instance& data) override;
@@ -34,6 +48,7 @@ private:
     Integer,
     IntegerLF,
     BulkStringBody,
+    BufferedBulkStringBody,
     CR,
     LF,
     SimpleString,
@@ -55,13 +70,18 @@ private:
     uint64_t current_array_element_;
   };
 
-  void parseSlice(const Buffer::RawSlice& slice);
+  // Parses a slice of the data, up to the body of a bulk string backed by a buffer, if any.
+  // Returns the number of bytes parsed.
+  uint64_t parseSlice(const Buffer::RawSlice& slice);
+  void parseBufferedBulkString(Buffer::Instance& data);
 
   DecoderCallbacks& callbacks_;
+  const uint64_t buffered_bulk_string_min_size_;
   State state_{State::ValueRootStart};
   PendingInteger pending_integer_;
   RespValuePtr pending_value_root_;
   std::forward_list<PendingValue> pending_value_stack_;
+  std::shared_ptr<Buffer::OwnedImpl> pending_string_buffer_;
 };
 
 /**
@@ -87,6 +107,8 @@ private:
   void encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out);
   void encodeCompositeArray(const RespValue::CompositeArray& array, Buffer::Instance& out);
   void encodeBulkString(const std::string& string, Buffer::Instance& out);
+  void encodeBulkStringBuffer(const std::shared_ptr<const Buffer::Instance>& buffer,
+                              Buffer::Instance& out);
   void encodeError(const std::string& string, Buffer::Instance& out);
   void encodeInteger(int64_t integer, Buffer::Instance& out);
   void encodeSimpleString(const std::string& string, Buffer::Instance& out);
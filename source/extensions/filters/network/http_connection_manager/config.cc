@@ -647,7 +647,8 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
   Http::FilterChainHelper<Server::Configuration::FactoryContext,
                           Server::Configuration::NamedHttpFilterConfigFactory>
       helper(filter_config_provider_manager_, context_.serverFactoryContext(),
-             context_.serverFactoryContext().clusterManager(), context_, stats_prefix_);
+             context_.serverFactoryContext().clusterManager(), context_, stats_prefix_,
+             config.recycled_filters_per_worker());
   THROW_IF_NOT_OK(helper.processFilters(config.http_filters(), "http", "http", filter_factories_));
 
   for (const auto& upgrade_config : config.upgrade_configs()) {
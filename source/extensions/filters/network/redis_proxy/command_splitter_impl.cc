@@ -163,6 +163,19 @@ SplitRequestPtr SimpleRequest::create(Router& router,
       new SimpleRequest(callbacks, command_stats, time_source, delay_command_latency)};
   const auto route = router.upstreamPool(incoming_request->asArray()[1].asString(), stream_info);
   if (route) {
+    const std::string& key = incoming_request->asArray()[1].asString();
+    OptRef<NearCache> near_cache = route->nearCache();
+    if (near_cache.has_value() && !callbacks.transaction().active_ &&
+        incoming_request->asArray().size() == 2 &&
+        absl::EqualsIgnoreCase(incoming_request->asArray()[0].asString(), "get")) {
+      Common::Redis::RespValuePtr value = near_cache->lookup(key);
+      if (value != nullptr) {
+        request_ptr->onResponse(std::move(value));
+        return nullptr;
+      }
+      request_ptr->near_cache_fill_ = near_cache->startFill(key);
+    }
+
     Common::Redis::RespValueSharedPtr base_request = std::move(incoming_request);
     request_ptr->handle_ = makeSingleServerRequest(
         route, base_request->asArray()[0].asString(), base_request->asArray()[1].asString(),
@@ -180,6 +193,14 @@ SplitRequestPtr SimpleRequest::create(Router& router,
   return request_ptr;
 }
 
+void SimpleRequest::onResponse(Common::Redis::RespValuePtr&& response) {
+  if (near_cache_fill_ != nullptr) {
+    near_cache_fill_->complete(*response);
+    near_cache_fill_.reset();
+  }
+  SingleServerRequest::onResponse(std::move(response));
+}
+
 SplitRequestPtr EvalRequest::create(Router& router, Common::Redis::RespValuePtr&& incoming_request,
                                     SplitCallbacks& callbacks, CommandStats& command_stats,
                                     TimeSource& time_source, bool delay_command_latency,
@@ -172,7 +172,8 @@ private:
 };
 
 /**
- * SimpleRequest hashes the first argument as the key.
+ * SimpleRequest hashes the first argument as the key. GET requests are served by the near cache of
+ * their route, if any.
  */
 class SimpleRequest : public SingleServerRequest {
 public:
@@ -181,10 +182,15 @@ public:
                                 TimeSource& time_source, bool delay_command_latency,
                                 const StreamInfo::StreamInfo& stream_info);
 
+  // ConnPool::PoolCallbacks
+  void onResponse(Common::Redis::RespValuePtr&& response) override;
+
 private:
   SimpleRequest(SplitCallbacks& callbacks, CommandStats& command_stats, TimeSource& time_source,
                 bool delay_command_latency)
       : SingleServerRequest(callbacks, command_stats, time_source, delay_command_latency) {}
+
+  NearCacheFillPtr near_cache_fill_;
 };
 
 /**
@@ -8,6 +8,7 @@
 #include "source/extensions/filters/network/common/redis/client_impl.h"
 #include "source/extensions/filters/network/common/redis/fault_impl.h"
 #include "source/extensions/filters/network/redis_proxy/command_splitter_impl.h"
+#include "source/extensions/filters/network/redis_proxy/near_cache_impl.h"
 #include "source/extensions/filters/network/redis_proxy/proxy_filter.h"
 #include "source/extensions/filters/network/redis_proxy/router_impl.h"
 
@@ -84,8 +85,22 @@ Network::FilterFactoryCb RedisProxyFilterConfigFactory::createFilterFactoryFromP
     upstreams.emplace(cluster, conn_pool_ptr);
   }
 
-  auto router =
-      std::make_unique<PrefixRoutes>(prefix_routes, std::move(upstreams), server_context.runtime());
+  const std::string stat_prefix = filter_config->stat_prefix_;
+  NearCacheFactory near_cache_factory =
+      [&context, &server_context, stat_prefix](
+          const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::
+              Route& route,
+          const ConnPool::InstanceSharedPtr& upstream,
+          const std::string& tracking_prefix) -> NearCacheSharedPtr {
+    const std::string name = route.prefix().empty() ? "catch_all" : route.prefix();
+    return std::make_shared<NearCacheImpl>(
+        route.near_cache(), upstream, tracking_prefix, server_context.threadLocal(),
+        context.scope().createScope(fmt::format("{}near_cache.{}.", stat_prefix, name)),
+        server_context.timeSource());
+  };
+
+  auto router = std::make_unique<PrefixRoutes>(prefix_routes, std::move(upstreams),
+                                               server_context.runtime(), near_cache_factory);
 
   auto fault_manager = std::make_unique<Common::Redis::FaultManagerImpl>(
       server_context.api().randomGenerator(), server_context.runtime(), proto_config.faults());
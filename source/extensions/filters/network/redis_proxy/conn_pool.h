@@ -9,6 +9,7 @@
 #include "source/extensions/filters/network/common/redis/client.h"
 #include "source/extensions/filters/network/common/redis/codec.h"
 
+#include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
 
 namespace Envoy {
@@ -36,6 +37,44 @@ public:
   virtual void onFailure() PURE;
 };
 
+/**
+ * Callbacks of the invalidations of the keys tracked on the upstream hosts of a connection pool.
+ */
+class InvalidationCallbacks {
+public:
+  virtual ~InvalidationCallbacks() = default;
+
+  /**
+   * Called when a tracked key is modified.
+   * @param key supplies the modified key.
+   */
+  virtual void onInvalidation(absl::string_view key) PURE;
+
+  /**
+   * Called when any tracked key may have been modified, e.g. when the database of an upstream host
+   * is flushed, or when the modifications of the keys are no longer tracked on all the upstream
+   * hosts.
+   */
+  virtual void onInvalidateAll() PURE;
+};
+
+/**
+ * A subscription to the invalidations of the keys starting with a prefix. The callbacks of the
+ * subscription are no longer called once it is destroyed.
+ */
+class InvalidationSubscription {
+public:
+  virtual ~InvalidationSubscription() = default;
+
+  /**
+   * @return whether the modifications of the keys are tracked on all the upstream hosts. Keys read
+   *         while the subscription is not active may be modified without notification.
+   */
+  virtual bool active() const PURE;
+};
+
+using InvalidationSubscriptionPtr = std::unique_ptr<InvalidationSubscription>;
+
 /**
  * A variant that either holds a shared pointer to a single server request or a composite array
  * resp value. This is for performance reason to avoid creating RespValueSharedPtr for each
@@ -64,6 +103,18 @@ public:
   virtual Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& hash_key, RespVariant&& request, PoolCallbacks& callbacks,
               Common::Redis::Client::Transaction& transaction) PURE;
+
+  /**
+   * Subscribes to the invalidations of the keys starting with a prefix, tracked on a dedicated
+   * connection to each upstream host with the server-assisted client side caching of Redis 6, in
+   * broadcasting mode. Must be called on a worker thread, on which the callbacks are called.
+   * @param prefix supplies the prefix of the keys, which may be empty to track all the keys.
+   * @param callbacks supplies the callbacks of the invalidations.
+   * @return InvalidationSubscriptionPtr the subscription.
+   */
+  virtual InvalidationSubscriptionPtr subscribeToInvalidations(const std::string& prefix,
+                                                               InvalidationCallbacks& callbacks)
+      PURE;
 };
 
 using InstanceSharedPtr = std::shared_ptr<Instance>;
@@ -16,6 +16,8 @@
 #include "source/common/stats/utility.h"
 #include "source/extensions/filters/network/redis_proxy/config.h"
 
+#include "absl/strings/match.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -53,6 +55,29 @@ bool isClusterProvidedLb(const Upstream::ClusterInfo& info) {
   return cluster_provided_lb;
 }
 
+// Returns the key of a single key GET request, or nullptr for other requests.
+const Common::Redis::RespValue* singleKeyGet(const Common::Redis::RespValue& request) {
+  const Common::Redis::RespValue* command = nullptr;
+  const Common::Redis::RespValue* key = nullptr;
+  if (request.type() == Common::Redis::RespType::Array && request.asArray().size() == 2) {
+    command = &request.asArray()[0];
+    key = &request.asArray()[1];
+  } else if (request.type() == Common::Redis::RespType::CompositeArray &&
+             request.asCompositeArray().size() == 2) {
+    auto it = request.asCompositeArray().begin();
+    command = &*it;
+    key = &*(++it);
+  } else {
+    return nullptr;
+  }
+  if (command->type() != Common::Redis::RespType::BulkString ||
+      key->type() != Common::Redis::RespType::BulkString ||
+      !absl::EqualsIgnoreCase(command->asString(), "get")) {
+    return nullptr;
+  }
+  return key;
+}
+
 } // namespace
 
 InstanceImpl::InstanceImpl(
@@ -67,9 +92,16 @@ InstanceImpl::InstanceImpl(
     : cluster_name_(cluster_name), cm_(cm), client_factory_(client_factory),
       tls_(tls.allocateSlot()), config_(new Common::Redis::Client::ConfigImpl(config)), api_(api),
       stats_scope_(std::move(stats_scope)),
-      redis_command_stats_(redis_command_stats), redis_cluster_stats_{REDIS_CLUSTER_STATS(
-                                                     POOL_COUNTER(*stats_scope_))},
-      refresh_manager_(std::move(refresh_manager)), dns_cache_(dns_cache) {}
+      redis_command_stats_(redis_command_stats),
+      redis_cluster_stats_{REDIS_CLUSTER_STATS(POOL_COUNTER(*stats_scope_),
+                                               POOL_HISTOGRAM(*stats_scope_))},
+      refresh_manager_(std::move(refresh_manager)), dns_cache_(dns_cache),
+      get_coalescing_max_batch_size_(
+          config.has_get_coalescing()
+              ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.get_coalescing(), max_batch_size, 64)
+              : 0),
+      get_coalescing_window_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config.get_coalescing(), window, 0)) {}
 
 void InstanceImpl::init() {
   // Note: `this` and `cluster_name` have a a lifetime of the filter.
@@ -104,6 +136,12 @@ InstanceImpl::makeRequestToHost(const std::string& host_address,
   return tls_->getTyped<ThreadLocalPool>().makeRequestToHost(host_address, request, callbacks);
 }
 
+InvalidationSubscriptionPtr
+InstanceImpl::subscribeToInvalidations(const std::string& prefix,
+                                       InvalidationCallbacks& callbacks) {
+  return tls_->getTyped<ThreadLocalPool>().subscribeToInvalidations(prefix, callbacks);
+}
+
 InstanceImpl::ThreadLocalPool::ThreadLocalPool(
     std::shared_ptr<InstanceImpl> parent, Event::Dispatcher& dispatcher, std::string cluster_name,
     const Extensions::Common::DynamicForwardProxy::DnsCacheSharedPtr& dns_cache)
@@ -113,7 +151,19 @@ InstanceImpl::ThreadLocalPool::ThreadLocalPool(
       client_factory_(parent->client_factory_), config_(parent->config_),
       stats_scope_(parent->stats_scope_), redis_command_stats_(parent->redis_command_stats_),
       redis_cluster_stats_(parent->redis_cluster_stats_),
-      refresh_manager_(parent->refresh_manager_) {
+      refresh_manager_(parent->refresh_manager_),
+      get_coalescing_max_batch_size_(parent->get_coalescing_max_batch_size_),
+      get_coalescing_window_(parent->get_coalescing_window_) {
+  if (get_coalescing_max_batch_size_ > 0) {
+    // Without a window, the batches are sent at the end of the current event loop iteration.
+    // Otherwise, only the full batches are, and the open ones at the end of the window.
+    const bool flush_open_batches = get_coalescing_window_.count() == 0;
+    get_batches_flush_cb_ = dispatcher.createSchedulableCallback(
+        [this, flush_open_batches]() { flushBatches(flush_open_batches); });
+    if (!flush_open_batches) {
+      get_batches_flush_timer_ = dispatcher.createTimer([this]() { flushBatches(true); });
+    }
+  }
   cluster_update_handle_ = parent->cm_.addThreadLocalClusterUpdateCallbacks(*this);
   Upstream::ThreadLocalCluster* cluster = parent->cm_.getThreadLocalCluster(cluster_name_);
   if (cluster != nullptr) {
@@ -128,6 +178,9 @@ InstanceImpl::ThreadLocalPool::~ThreadLocalPool() {
   while (!pending_requests_.empty()) {
     pending_requests_.pop_front();
   }
+  open_get_batches_.clear();
+  full_get_batches_.clear();
+  get_batches_.clear();
   while (!client_map_.empty()) {
     client_map_.begin()->second->redis_client_->close();
   }
@@ -182,6 +235,7 @@ void InstanceImpl::ThreadLocalPool::onClusterAddOrUpdateNonVirtual(
       info->clusterType();
   is_redis_cluster_ = isClusterProvidedLb(*info) && cluster_type.has_value() &&
                       cluster_type->name() == "envoy.clusters.redis";
+  updateInvalidationTracker();
 }
 
 void InstanceImpl::ThreadLocalPool::onClusterRemoval(const std::string& cluster_name) {
@@ -202,6 +256,7 @@ void InstanceImpl::ThreadLocalPool::onClusterRemoval(const std::string& cluster_
   cluster_ = nullptr;
   host_address_map_.clear();
   cx_rate_limiter_map_.clear();
+  updateInvalidationTracker();
 }
 
 void InstanceImpl::ThreadLocalPool::onHostsAdded(
@@ -219,6 +274,7 @@ void InstanceImpl::ThreadLocalPool::onHostsAdded(
       }
     }
   }
+  updateInvalidationTracker();
 }
 
 void InstanceImpl::ThreadLocalPool::onHostsRemoved(
@@ -250,6 +306,28 @@ void InstanceImpl::ThreadLocalPool::onHostsRemoved(
       host_address_map_.erase(it2);
     }
   }
+  updateInvalidationTracker();
+}
+
+InvalidationSubscriptionPtr
+InstanceImpl::ThreadLocalPool::subscribeToInvalidations(const std::string& prefix,
+                                                        InvalidationCallbacks& callbacks) {
+  if (invalidation_tracker_ == nullptr) {
+    invalidation_tracker_ = std::make_shared<InvalidationTracker>(dispatcher_);
+    updateInvalidationTracker();
+  }
+  return invalidation_tracker_->subscribe(prefix, callbacks);
+}
+
+void InstanceImpl::ThreadLocalPool::updateInvalidationTracker() {
+  if (invalidation_tracker_ == nullptr) {
+    return;
+  }
+  std::vector<Upstream::HostConstSharedPtr> hosts;
+  for (const auto& host : host_address_map_) {
+    hosts.push_back(host.second);
+  }
+  invalidation_tracker_->updateHosts(hosts, auth_username_, auth_password_);
 }
 
 void InstanceImpl::ThreadLocalPool::drainClients() {
@@ -319,6 +397,14 @@ InstanceImpl::ThreadLocalPool::makeRequest(const std::string& key, RespVariant&&
   pending_requests_.emplace_back(*this, std::move(request), callbacks, host);
   PendingRequest& pending_request = pending_requests_.back();
 
+  if (get_coalescing_max_batch_size_ > 0 && !transaction.active_ &&
+      singleKeyGet(getRequest(pending_request.incoming_request_)) != nullptr) {
+    // Requests to different slots of a host may not be coalesced, as the slots may be moving.
+    const uint64_t slot =
+        is_redis_cluster_ ? lb_context.computeHashKey().value_or(0) % Clusters::Redis::MaxSlot : 0;
+    return batchGet(pending_request, {host, slot});
+  }
+
   if (!transaction.active_) {
     ThreadLocalActiveClientPtr& client = this->threadLocalActiveClient(host);
     if (!client) {
@@ -404,6 +490,8 @@ Common::Redis::Client::PoolRequest* InstanceImpl::ThreadLocalPool::makeRequestTo
     host_address_map_[host_address_map_key] = new_host;
     created_via_redirect_hosts_.push_back(new_host);
     it = host_address_map_.find(host_address_map_key);
+    // The keys of the host are tracked as well, as it may own some of the slots.
+    updateInvalidationTracker();
   }
 
   ThreadLocalActiveClientPtr& client = threadLocalActiveClient(it->second);
@@ -416,6 +504,50 @@ Common::Redis::Client::PoolRequest* InstanceImpl::ThreadLocalPool::makeRequestTo
   return client->redis_client_->makeRequest(request, callbacks);
 }
 
+Common::Redis::Client::PoolRequest*
+InstanceImpl::ThreadLocalPool::batchGet(PendingRequest& request, const GetBatchKey& batch_key) {
+  GetBatch*& batch = open_get_batches_[batch_key];
+  if (batch == nullptr) {
+    get_batches_.push_back(std::make_unique<GetBatch>(*this, batch_key.first));
+    batch = get_batches_.back().get();
+    batch->self_ = std::prev(get_batches_.end());
+    if (get_batches_flush_timer_ == nullptr) {
+      get_batches_flush_cb_->scheduleCallbackCurrentIteration();
+    } else if (!get_batches_flush_timer_->enabled()) {
+      get_batches_flush_timer_->enableTimer(get_coalescing_window_);
+    }
+  }
+
+  batch->requests_.emplace_back(request);
+  request.request_handler_ = &batch->requests_.back();
+  if (batch->requests_.size() >= get_coalescing_max_batch_size_) {
+    // Full batches are sent without waiting for the end of the window.
+    full_get_batches_.push_back(batch);
+    open_get_batches_.erase(batch_key);
+    get_batches_flush_cb_->scheduleCallbackCurrentIteration();
+  }
+  return &request;
+}
+
+void InstanceImpl::ThreadLocalPool::flushBatches(bool open_batches) {
+  // Sending the requests may add new batches, which are sent on the next flush.
+  std::vector<GetBatch*> batches;
+  batches.swap(full_get_batches_);
+  if (open_batches) {
+    for (const auto& open_batch : open_get_batches_) {
+      batches.push_back(open_batch.second);
+    }
+    open_get_batches_.clear();
+  }
+  for (GetBatch* batch : batches) {
+    batch->flush();
+  }
+}
+
+void InstanceImpl::ThreadLocalPool::removeBatch(GetBatch& batch) {
+  get_batches_.erase(batch.self_);
+}
+
 void InstanceImpl::ThreadLocalPool::onRequestCompleted() {
   ASSERT(!pending_requests_.empty());
 
@@ -571,6 +703,154 @@ void InstanceImpl::PendingRequest::doRedirection(Common::Redis::RespValuePtr&& v
   }
 }
 
+InstanceImpl::GetBatch::GetBatch(ThreadLocalPool& parent, Upstream::HostConstSharedPtr host)
+    : parent_(parent), host_(std::move(host)),
+      created_(parent.dispatcher_.timeSource().monotonicTime()) {}
+
+InstanceImpl::GetBatch::~GetBatch() {
+  if (request_handler_) {
+    request_handler_->cancel();
+  }
+}
+
+void InstanceImpl::GetBatch::flush() {
+  requests_.remove_if([](const BatchedGet& get) { return get.request_ == nullptr; });
+  if (requests_.empty()) {
+    parent_.removeBatch(*this);
+    return;
+  }
+
+  parent_.redis_cluster_stats_.get_coalescing_batch_size_.recordValue(requests_.size());
+  parent_.redis_cluster_stats_.get_coalescing_delay_.recordValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          parent_.dispatcher_.timeSource().monotonicTime() - created_)
+          .count());
+  if (requests_.size() == 1) {
+    sendIndividually();
+    return;
+  }
+
+  if (parent_.cluster_ == nullptr) {
+    // The cluster was removed during the window of the batch.
+    onFailure();
+    return;
+  }
+
+  mget_.type(Common::Redis::RespType::Array);
+  std::vector<Common::Redis::RespValue>& mget = mget_.asArray();
+  mget.reserve(requests_.size() + 1);
+  mget.emplace_back();
+  mget.back().type(Common::Redis::RespType::BulkString);
+  mget.back().asString() = "mget";
+  for (const BatchedGet& get : requests_) {
+    mget.push_back(*singleKeyGet(getRequest(get.request_->incoming_request_)));
+  }
+
+  ThreadLocalActiveClientPtr& client = parent_.threadLocalActiveClient(host_);
+  if (!client) {
+    ENVOY_LOG(debug, "redis connection is rate limited, erasing empty client");
+    parent_.client_map_.erase(host_);
+    onFailure();
+    return;
+  }
+  request_handler_ = client->redis_client_->makeRequest(mget_, *this);
+  if (!request_handler_) {
+    onFailure();
+  }
+}
+
+void InstanceImpl::GetBatch::sendIndividually() {
+  for (BatchedGet& get : requests_) {
+    if (get.request_ == nullptr) {
+      continue;
+    }
+    PendingRequest& request = *get.request_;
+    get.request_ = nullptr;
+    if (parent_.cluster_ == nullptr) {
+      request.onFailure();
+      continue;
+    }
+    ThreadLocalActiveClientPtr& client = parent_.threadLocalActiveClient(host_);
+    if (!client) {
+      ENVOY_LOG(debug, "redis connection is rate limited, erasing empty client");
+      parent_.client_map_.erase(host_);
+      request.onFailure();
+      continue;
+    }
+    request.request_handler_ =
+        client->redis_client_->makeRequest(getRequest(request.incoming_request_), request);
+    if (!request.request_handler_) {
+      request.onFailure();
+    }
+  }
+  parent_.removeBatch(*this);
+}
+
+void InstanceImpl::GetBatch::onResponse(Common::Redis::RespValuePtr&& response) {
+  request_handler_ = nullptr;
+  if (response->type() == Common::Redis::RespType::Error) {
+    // The keys of a batch are served by the same host, and in the same hash slot for Redis Cluster,
+    // so the error of the MGET request is the error of each GET request. Retrying them would only
+    // multiply the load of a failing host.
+    parent_.redis_cluster_stats_.get_coalescing_error_.inc();
+    for (BatchedGet& get : requests_) {
+      PendingRequest* request = get.request_;
+      get.request_ = nullptr;
+      if (request != nullptr) {
+        request->onResponse(std::make_unique<Common::Redis::RespValue>(*response));
+      }
+    }
+    parent_.removeBatch(*this);
+    return;
+  }
+  if (response->type() != Common::Redis::RespType::Array ||
+      response->asArray().size() != requests_.size()) {
+    parent_.redis_cluster_stats_.get_coalescing_error_.inc();
+    onFailure();
+    return;
+  }
+
+  auto value = response->asArray().begin();
+  for (BatchedGet& get : requests_) {
+    PendingRequest* request = get.request_;
+    get.request_ = nullptr;
+    if (request != nullptr) {
+      request->onResponse(std::make_unique<Common::Redis::RespValue>(std::move(*value)));
+    }
+    ++value;
+  }
+  parent_.removeBatch(*this);
+}
+
+void InstanceImpl::GetBatch::onFailure() {
+  request_handler_ = nullptr;
+  for (BatchedGet& get : requests_) {
+    PendingRequest* request = get.request_;
+    get.request_ = nullptr;
+    if (request != nullptr) {
+      request->onFailure();
+    }
+  }
+  parent_.removeBatch(*this);
+}
+
+void InstanceImpl::GetBatch::onRedirection(Common::Redis::RespValuePtr&& value,
+                                           const std::string& host_address, bool ask_redirection) {
+  request_handler_ = nullptr;
+  parent_.redis_cluster_stats_.get_coalescing_error_.inc();
+  // The hash slot of the batch moved, so each GET request follows the redirection, as it would
+  // have without coalescing.
+  for (BatchedGet& get : requests_) {
+    PendingRequest* request = get.request_;
+    get.request_ = nullptr;
+    if (request != nullptr) {
+      request->onRedirection(std::make_unique<Common::Redis::RespValue>(*value), host_address,
+                             ask_redirection);
+    }
+  }
+  parent_.removeBatch(*this);
+}
+
 void InstanceImpl::PendingRequest::cancel() {
   request_handler_->cancel();
   request_handler_ = nullptr;
@@ -28,7 +28,9 @@
 #include "source/extensions/filters/network/common/redis/codec_impl.h"
 #include "source/extensions/filters/network/common/redis/utility.h"
 #include "source/extensions/filters/network/redis_proxy/conn_pool.h"
+#include "source/extensions/filters/network/redis_proxy/invalidation_tracker.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
@@ -40,13 +42,16 @@ namespace ConnPool {
 // TODO(mattklein123): Circuit breaking
 // TODO(rshriram): Fault injection
 
-#define REDIS_CLUSTER_STATS(COUNTER)                                                               \
+#define REDIS_CLUSTER_STATS(COUNTER, HISTOGRAM)                                                    \
   COUNTER(upstream_cx_drained)                                                                     \
   COUNTER(max_upstream_unknown_connections_reached)                                                \
-  COUNTER(connection_rate_limited)
+  COUNTER(connection_rate_limited)                                                                 \
+  COUNTER(get_coalescing_error)                                                                    \
+  HISTOGRAM(get_coalescing_batch_size, Unspecified)                                                \
+  HISTOGRAM(get_coalescing_delay, Microseconds)
 
 struct RedisClusterStats {
-  REDIS_CLUSTER_STATS(GENERATE_COUNTER_STRUCT)
+  REDIS_CLUSTER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class DoNothingPoolCallbacks : public PoolCallbacks {
@@ -70,6 +75,8 @@ public:
   Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& key, RespVariant&& request, PoolCallbacks& callbacks,
               Common::Redis::Client::Transaction& transaction) override;
+  InvalidationSubscriptionPtr subscribeToInvalidations(const std::string& prefix,
+                                                       InvalidationCallbacks& callbacks) override;
   /**
    * Makes a redis request based on IP address and TCP port of the upstream host (e.g.,
    * moved/ask cluster redirection). This is now only kept mostly for testing.
@@ -107,6 +114,48 @@ private:
 
   using ThreadLocalActiveClientPtr = std::unique_ptr<ThreadLocalActiveClient>;
 
+  struct PendingRequest;
+
+  // A GET request of a batch. Canceling it removes it from the batch.
+  struct BatchedGet : public Common::Redis::Client::PoolRequest {
+    BatchedGet(PendingRequest& request) : request_(&request) {}
+
+    // PoolRequest
+    void cancel() override { request_ = nullptr; }
+
+    PendingRequest* request_;
+  };
+
+  // GET requests to the same host, and to the same hash slot for Redis Cluster, coalesced into a
+  // MGET request whose results are fanned out to the GET requests.
+  struct GetBatch : public Common::Redis::Client::ClientCallbacks,
+                    public Logger::Loggable<Logger::Id::redis> {
+    GetBatch(ThreadLocalPool& parent, Upstream::HostConstSharedPtr host);
+    ~GetBatch() override;
+
+    // Sends the requests of the batch, as a MGET request if there are several.
+    void flush();
+    // Sends the requests of the batch individually, e.g. when there is a single one.
+    void sendIndividually();
+
+    // Common::Redis::Client::ClientCallbacks
+    void onResponse(Common::Redis::RespValuePtr&& response) override;
+    void onFailure() override;
+    void onRedirection(Common::Redis::RespValuePtr&& value, const std::string& host_address,
+                       bool ask_redirection) override;
+
+    ThreadLocalPool& parent_;
+    const Upstream::HostConstSharedPtr host_;
+    const MonotonicTime created_;
+    std::list<BatchedGet> requests_;
+    Common::Redis::RespValue mget_;
+    Common::Redis::Client::PoolRequest* request_handler_{};
+    std::list<std::unique_ptr<GetBatch>>::iterator self_;
+  };
+
+  using GetBatchPtr = std::unique_ptr<GetBatch>;
+  using GetBatchKey = std::pair<Upstream::HostConstSharedPtr, uint64_t>;
+
   struct PendingRequest
       : public Common::Redis::Client::ClientCallbacks,
         public Common::Redis::Client::PoolRequest,
@@ -158,6 +207,10 @@ private:
     Common::Redis::Client::PoolRequest*
     makeRequestToHost(const std::string& host_address, const Common::Redis::RespValue& request,
                       Common::Redis::Client::ClientCallbacks& callbacks);
+    InvalidationSubscriptionPtr subscribeToInvalidations(const std::string& prefix,
+                                                         InvalidationCallbacks& callbacks);
+    // Updates the hosts tracked by the invalidation tracker, if any.
+    void updateInvalidationTracker();
 
     void onClusterAddOrUpdateNonVirtual(absl::string_view cluster_name,
                                         Upstream::ThreadLocalClusterCommand& get_cluster);
@@ -174,6 +227,13 @@ private:
 
     void onRequestCompleted();
 
+    // Adds a GET request to the open batch of its host and hash slot.
+    Common::Redis::Client::PoolRequest* batchGet(PendingRequest& request,
+                                                 const GetBatchKey& batch_key);
+    // Sends the full batches, and the open ones if requested.
+    void flushBatches(bool open_batches);
+    void removeBatch(GetBatch& batch);
+
     std::weak_ptr<InstanceImpl> parent_;
     Event::Dispatcher& dispatcher_;
     const std::string cluster_name_;
@@ -188,7 +248,17 @@ private:
     std::string auth_password_;
     std::list<Upstream::HostSharedPtr> created_via_redirect_hosts_;
     std::list<ThreadLocalActiveClientPtr> clients_to_drain_;
+    const uint32_t get_coalescing_max_batch_size_;
+    const std::chrono::milliseconds get_coalescing_window_;
+    absl::flat_hash_map<GetBatchKey, GetBatch*> open_get_batches_;
+    std::vector<GetBatch*> full_get_batches_;
+    Event::SchedulableCallbackPtr get_batches_flush_cb_;
+    Event::TimerPtr get_batches_flush_timer_;
+    // The batches of GET requests, before the pending requests which refer to them.
+    std::list<GetBatchPtr> get_batches_;
     std::list<PendingRequest> pending_requests_;
+    // Created on the first subscription to the invalidations of keys.
+    InvalidationTrackerSharedPtr invalidation_tracker_;
 
     /* This timer is used to poll the active clients in clients_to_drain_ to determine whether they
      * have been drained (have no active requests) or not. It is only enabled after a client has
@@ -217,6 +287,9 @@ private:
   RedisClusterStats redis_cluster_stats_;
   const Extensions::Common::Redis::ClusterRefreshManagerSharedPtr refresh_manager_;
   const Extensions::Common::DynamicForwardProxy::DnsCacheSharedPtr dns_cache_{nullptr};
+  // The maximum size of the batches of coalesced GET requests, or 0 if they are not coalesced.
+  const uint32_t get_coalescing_max_batch_size_;
+  const std::chrono::milliseconds get_coalescing_window_;
 };
 
 } // namespace ConnPool
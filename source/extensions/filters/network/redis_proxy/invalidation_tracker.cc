@@ -0,0 +1,313 @@
+#include "source/extensions/filters/network/redis_proxy/invalidation_tracker.h"
+
+#include <algorithm>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+#include "source/extensions/filters/network/common/redis/utility.h"
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+namespace {
+
+// The channel of the invalidation messages redirected to a client in RESP2.
+const std::string& invalidationChannel() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "__redis__:invalidate");
+}
+
+Common::Redis::RespValue makeCommand(const std::vector<std::string>& arguments) {
+  Common::Redis::RespValue command;
+  command.type(Common::Redis::RespType::Array);
+  std::vector<Common::Redis::RespValue>& values = command.asArray();
+  values.reserve(arguments.size());
+  for (const std::string& argument : arguments) {
+    values.emplace_back();
+    values.back().type(Common::Redis::RespType::BulkString);
+    values.back().asString() = argument;
+  }
+  return command;
+}
+
+} // namespace
+
+InvalidationTracker::InvalidationTracker(Event::Dispatcher& dispatcher)
+    : dispatcher_(dispatcher),
+      reconnect_timer_(dispatcher.createTimer([this]() { connectMissingHosts(); })) {}
+
+InvalidationTracker::~InvalidationTracker() { host_trackers_.clear(); }
+
+InvalidationSubscriptionPtr InvalidationTracker::subscribe(const std::string& prefix,
+                                                           InvalidationCallbacks& callbacks) {
+  auto subscription = std::make_unique<Subscription>(weak_from_this(), prefix, callbacks);
+  subscriptions_.push_front(subscription.get());
+  subscription->entry_ = subscriptions_.begin();
+
+  std::vector<std::string> prefixes;
+  for (const Subscription* other : subscriptions_) {
+    prefixes.push_back(other->prefix_);
+  }
+  std::vector<std::string> tracked_prefixes = trackedPrefixes(prefixes);
+  if (subscriptions_.size() == 1 || tracked_prefixes != tracked_prefixes_) {
+    // The prefixes tracked on a connection may not be changed once it subscribed to the
+    // invalidation channel.
+    tracked_prefixes_ = std::move(tracked_prefixes);
+    reconnectAll();
+  }
+  return subscription;
+}
+
+void InvalidationTracker::updateHosts(const std::vector<Upstream::HostConstSharedPtr>& hosts,
+                                      const std::string& auth_username,
+                                      const std::string& auth_password) {
+  auth_username_ = auth_username;
+  auth_password_ = auth_password;
+  hosts_ = hosts;
+  for (auto it = host_trackers_.begin(); it != host_trackers_.end();) {
+    if (std::find(hosts_.begin(), hosts_.end(), it->first) == hosts_.end()) {
+      host_trackers_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  connectMissingHosts();
+}
+
+std::vector<std::string>
+InvalidationTracker::trackedPrefixes(const std::vector<std::string>& prefixes) {
+  std::vector<std::string> sorted_prefixes = prefixes;
+  std::sort(sorted_prefixes.begin(), sorted_prefixes.end());
+  // Redis rejects overlapping prefixes, so only the shortest ones are tracked. As the prefixes
+  // starting with a prefix are sorted right after it, only the last tracked one needs to be
+  // compared.
+  std::vector<std::string> tracked_prefixes;
+  for (const std::string& prefix : sorted_prefixes) {
+    if (prefix.empty()) {
+      return {};
+    }
+    if (tracked_prefixes.empty() || !absl::StartsWith(prefix, tracked_prefixes.back())) {
+      tracked_prefixes.push_back(prefix);
+    }
+  }
+  return tracked_prefixes;
+}
+
+void InvalidationTracker::connectMissingHosts() {
+  if (!subscriptions_.empty()) {
+    for (const Upstream::HostConstSharedPtr& host : hosts_) {
+      HostTrackerPtr& host_tracker = host_trackers_[host];
+      if (host_tracker == nullptr) {
+        host_tracker = std::make_unique<HostTracker>(*this, host);
+      }
+    }
+  }
+  updateActive();
+}
+
+void InvalidationTracker::reconnectAll() {
+  host_trackers_.clear();
+  connectMissingHosts();
+}
+
+void InvalidationTracker::onHostTrackerSubscribed() { updateActive(); }
+
+void InvalidationTracker::onHostTrackerClosed(HostTracker& host_tracker) {
+  for (auto it = host_trackers_.begin(); it != host_trackers_.end(); ++it) {
+    if (it->second.get() == &host_tracker) {
+      dispatcher_.deferredDelete(std::move(it->second));
+      host_trackers_.erase(it);
+      break;
+    }
+  }
+  updateActive();
+  if (!reconnect_timer_->enabled()) {
+    reconnect_timer_->enableTimer(std::chrono::seconds(1));
+  }
+}
+
+void InvalidationTracker::onInvalidation(absl::string_view key) {
+  for (Subscription* subscription : subscriptions_) {
+    if (absl::StartsWith(key, subscription->prefix_)) {
+      subscription->callbacks_.onInvalidation(key);
+    }
+  }
+}
+
+void InvalidationTracker::invalidateAll() {
+  for (Subscription* subscription : subscriptions_) {
+    subscription->callbacks_.onInvalidateAll();
+  }
+}
+
+void InvalidationTracker::updateActive() {
+  bool active = !hosts_.empty() && host_trackers_.size() == hosts_.size();
+  for (const auto& host_tracker : host_trackers_) {
+    active = active && host_tracker.second->subscribed();
+  }
+  if (active_ && !active) {
+    // The keys may be modified without notification until all the hosts track them again.
+    ENVOY_LOG(debug, "invalidation tracking is no longer active on all hosts");
+    invalidateAll();
+  }
+  active_ = active;
+}
+
+InvalidationTracker::Subscription::~Subscription() {
+  std::shared_ptr<InvalidationTracker> parent = parent_.lock();
+  if (parent != nullptr) {
+    parent->subscriptions_.erase(entry_);
+  }
+}
+
+bool InvalidationTracker::Subscription::active() const {
+  std::shared_ptr<InvalidationTracker> parent = parent_.lock();
+  return parent != nullptr && parent->active_;
+}
+
+InvalidationTracker::HostTracker::HostTracker(InvalidationTracker& parent,
+                                              Upstream::HostConstSharedPtr host)
+    : parent_(parent), host_(std::move(host)),
+      connect_timer_(parent_.dispatcher_.createTimer([this]() { onConnectTimeout(); })),
+      decoder_(*this) {
+  connection_ = host_->createConnection(parent_.dispatcher_, nullptr, nullptr).connection_;
+  connection_->addConnectionCallbacks(*this);
+  connection_->addReadFilter(Network::ReadFilterSharedPtr{new UpstreamReadFilter(*this)});
+  connection_->connect();
+  connection_->noDelay(true);
+  connect_timer_->enableTimer(host_->cluster().connectTimeout());
+
+  if (!parent_.auth_username_.empty()) {
+    send(Common::Redis::Utility::AuthRequest(parent_.auth_username_, parent_.auth_password_),
+         Reply::Auth);
+  } else if (!parent_.auth_password_.empty()) {
+    send(Common::Redis::Utility::AuthRequest(parent_.auth_password_), Reply::Auth);
+  }
+  send(makeCommand({"client", "id"}), Reply::ClientId);
+}
+
+InvalidationTracker::HostTracker::~HostTracker() {
+  if (!closed_) {
+    closed_ = true;
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void InvalidationTracker::HostTracker::onEvent(Network::ConnectionEvent event) {
+  if (event == Network::ConnectionEvent::Connected) {
+    connect_timer_->disableTimer();
+    return;
+  }
+  if ((event == Network::ConnectionEvent::RemoteClose ||
+       event == Network::ConnectionEvent::LocalClose) &&
+      !closed_) {
+    ENVOY_LOG(debug, "invalidation tracking connection to {} closed", host_->address()->asString());
+    closed_ = true;
+    connect_timer_->disableTimer();
+    parent_.onHostTrackerClosed(*this);
+  }
+}
+
+void InvalidationTracker::HostTracker::onData(Buffer::Instance& data) {
+  TRY_NEEDS_AUDIT { decoder_.decode(data); }
+  END_TRY catch (Common::Redis::ProtocolError&) {
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void InvalidationTracker::HostTracker::onConnectTimeout() {
+  ENVOY_LOG(debug, "invalidation tracking connection to {} timed out",
+            host_->address()->asString());
+  connection_->close(Network::ConnectionCloseType::NoFlush);
+}
+
+void InvalidationTracker::HostTracker::send(const Common::Redis::RespValue& request, Reply reply) {
+  Buffer::OwnedImpl buffer;
+  encoder_.encode(request, buffer);
+  connection_->write(buffer, false);
+  replies_.push_back(reply);
+}
+
+void InvalidationTracker::HostTracker::onRespValue(Common::Redis::RespValuePtr&& value) {
+  if (closed_) {
+    return;
+  }
+  if (subscribed_) {
+    onInvalidationMessage(*value);
+    return;
+  }
+  if (replies_.empty() || value->type() == Common::Redis::RespType::Error) {
+    ENVOY_LOG(debug, "invalidation tracking failed on {}: {}", host_->address()->asString(),
+              value->toString());
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+    return;
+  }
+
+  const Reply reply = replies_.front();
+  replies_.pop_front();
+  switch (reply) {
+  case Reply::Auth:
+  case Reply::Tracking:
+    return;
+  case Reply::ClientId: {
+    if (value->type() != Common::Redis::RespType::Integer) {
+      connection_->close(Network::ConnectionCloseType::NoFlush);
+      return;
+    }
+    // The invalidation messages are redirected to the connection itself, which may only receive
+    // them once subscribed to the invalidation channel in RESP2.
+    std::vector<std::string> tracking{
+        "client", "tracking", "on", "redirect", std::to_string(value->asInteger()), "bcast"};
+    for (const std::string& prefix : parent_.tracked_prefixes_) {
+      tracking.push_back("prefix");
+      tracking.push_back(prefix);
+    }
+    send(makeCommand(tracking), Reply::Tracking);
+    send(makeCommand({"subscribe", invalidationChannel()}), Reply::Subscribe);
+    return;
+  }
+  case Reply::Subscribe:
+    subscribed_ = true;
+    parent_.onHostTrackerSubscribed();
+    return;
+  }
+}
+
+void InvalidationTracker::HostTracker::onInvalidationMessage(
+    const Common::Redis::RespValue& message) {
+  // The invalidation messages are published as ["message", "__redis__:invalidate", keys], the keys
+  // being null when the database is flushed.
+  if (message.type() != Common::Redis::RespType::Array || message.asArray().size() != 3 ||
+      message.asArray()[0].type() != Common::Redis::RespType::BulkString ||
+      message.asArray()[0].asString() != "message") {
+    return;
+  }
+  const Common::Redis::RespValue& keys = message.asArray()[2];
+  switch (keys.type()) {
+  case Common::Redis::RespType::Array:
+    for (const Common::Redis::RespValue& key : keys.asArray()) {
+      if (key.type() == Common::Redis::RespType::BulkString) {
+        parent_.onInvalidation(key.asString());
+      }
+    }
+    break;
+  case Common::Redis::RespType::BulkString:
+    parent_.onInvalidation(keys.asString());
+    break;
+  case Common::Redis::RespType::Null:
+    parent_.invalidateAll();
+    break;
+  default:
+    break;
+  }
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
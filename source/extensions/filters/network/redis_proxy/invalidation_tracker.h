@@ -0,0 +1,163 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/connection.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/network/filter_impl.h"
+#include "source/extensions/filters/network/common/redis/codec_impl.h"
+#include "source/extensions/filters/network/redis_proxy/conn_pool.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+/**
+ * Tracks the modifications of keys on the upstream hosts of a connection pool, on a worker. Each
+ * upstream host has a dedicated connection, on which the broadcasting mode of the server-assisted
+ * client side caching of Redis 6 is enabled for the prefixes of the subscriptions, and redirected
+ * to the invalidation channel the connection subscribes to:
+ *
+ *   CLIENT ID
+ *   CLIENT TRACKING ON REDIRECT <id> BCAST [PREFIX <prefix> ...]
+ *   SUBSCRIBE __redis__:invalidate
+ *
+ * The connections to the hosts are reestablished when they are closed, and when the prefixes of
+ * the subscriptions change.
+ */
+class InvalidationTracker : public std::enable_shared_from_this<InvalidationTracker>,
+                            public Logger::Loggable<Logger::Id::redis> {
+public:
+  InvalidationTracker(Event::Dispatcher& dispatcher);
+  ~InvalidationTracker();
+
+  /**
+   * Subscribes to the invalidations of the keys starting with a prefix.
+   * @see ConnPool::Instance::subscribeToInvalidations().
+   */
+  InvalidationSubscriptionPtr subscribe(const std::string& prefix,
+                                        InvalidationCallbacks& callbacks);
+
+  /**
+   * Updates the upstream hosts whose keys are tracked.
+   * @param hosts supplies the upstream hosts.
+   * @param auth_username supplies the username to authenticate with, if any.
+   * @param auth_password supplies the password to authenticate with, if any.
+   */
+  void updateHosts(const std::vector<Upstream::HostConstSharedPtr>& hosts,
+                   const std::string& auth_username, const std::string& auth_password);
+
+  /**
+   * @return the prefixes tracked on the upstream hosts: the shortest ones of the subscriptions,
+   *         or none if all the keys are tracked.
+   */
+  static std::vector<std::string> trackedPrefixes(const std::vector<std::string>& prefixes);
+
+private:
+  class Subscription : public InvalidationSubscription {
+  public:
+    Subscription(std::weak_ptr<InvalidationTracker> parent, std::string prefix,
+                 InvalidationCallbacks& callbacks)
+        : parent_(std::move(parent)), prefix_(std::move(prefix)), callbacks_(callbacks) {}
+    ~Subscription() override;
+
+    // ConnPool::InvalidationSubscription
+    bool active() const override;
+
+    const std::weak_ptr<InvalidationTracker> parent_;
+    const std::string prefix_;
+    InvalidationCallbacks& callbacks_;
+    std::list<Subscription*>::iterator entry_;
+  };
+
+  // The dedicated connection to an upstream host.
+  class HostTracker : public Network::ConnectionCallbacks,
+                      public Common::Redis::DecoderCallbacks,
+                      public Event::DeferredDeletable,
+                      public Logger::Loggable<Logger::Id::redis> {
+  public:
+    HostTracker(InvalidationTracker& parent, Upstream::HostConstSharedPtr host);
+    ~HostTracker() override;
+
+    bool subscribed() const { return subscribed_; }
+
+    // Network::ConnectionCallbacks
+    void onEvent(Network::ConnectionEvent event) override;
+    void onAboveWriteBufferHighWatermark() override {}
+    void onBelowWriteBufferLowWatermark() override {}
+
+    // Common::Redis::DecoderCallbacks
+    void onRespValue(Common::Redis::RespValuePtr&& value) override;
+
+  private:
+    struct UpstreamReadFilter : public Network::ReadFilterBaseImpl {
+      UpstreamReadFilter(HostTracker& parent) : parent_(parent) {}
+
+      // Network::ReadFilter
+      Network::FilterStatus onData(Buffer::Instance& data, bool) override {
+        parent_.onData(data);
+        return Network::FilterStatus::Continue;
+      }
+
+      HostTracker& parent_;
+    };
+
+    // The replies expected on the connection, in order.
+    enum class Reply { Auth, ClientId, Tracking, Subscribe };
+
+    void onData(Buffer::Instance& data);
+    void onConnectTimeout();
+    void send(const Common::Redis::RespValue& request, Reply reply);
+    void onInvalidationMessage(const Common::Redis::RespValue& message);
+
+    InvalidationTracker& parent_;
+    const Upstream::HostConstSharedPtr host_;
+    Network::ClientConnectionPtr connection_;
+    const Event::TimerPtr connect_timer_;
+    Common::Redis::EncoderImpl encoder_;
+    Common::Redis::DecoderImpl decoder_;
+    std::list<Reply> replies_;
+    bool subscribed_{};
+    bool closed_{};
+  };
+
+  using HostTrackerPtr = std::unique_ptr<HostTracker>;
+
+  void connectMissingHosts();
+  void reconnectAll();
+  void onHostTrackerSubscribed();
+  void onHostTrackerClosed(HostTracker& host_tracker);
+  void onInvalidation(absl::string_view key);
+  void invalidateAll();
+  void updateActive();
+
+  Event::Dispatcher& dispatcher_;
+  const Event::TimerPtr reconnect_timer_;
+  std::string auth_username_;
+  std::string auth_password_;
+  std::list<Subscription*> subscriptions_;
+  std::vector<std::string> tracked_prefixes_;
+  std::vector<Upstream::HostConstSharedPtr> hosts_;
+  absl::flat_hash_map<Upstream::HostConstSharedPtr, HostTrackerPtr> host_trackers_;
+  bool active_{};
+};
+
+using InvalidationTrackerSharedPtr = std::shared_ptr<InvalidationTracker>;
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/common/pure.h"
+
+#include "source/extensions/filters/network/common/redis/codec.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+/**
+ * The filling of a near cache with the value of a key read from upstream.
+ */
+class NearCacheFill {
+public:
+  virtual ~NearCacheFill() = default;
+
+  /**
+   * Caches the value read from upstream, unless the key was invalidated since the start of the
+   * fill.
+   * @param value supplies the value of the key.
+   */
+  virtual void complete(const Common::Redis::RespValue& value) PURE;
+};
+
+using NearCacheFillPtr = std::unique_ptr<NearCacheFill>;
+
+/**
+ * A cache of the values of keys, kept by each worker and invalidated when the keys are modified
+ * upstream.
+ */
+class NearCache {
+public:
+  virtual ~NearCache() = default;
+
+  /**
+   * Looks up the value of a key in the cache of the current worker.
+   * @param key supplies the key.
+   * @return RespValuePtr a copy of the cached value, or nullptr if the key is not cached.
+   */
+  virtual Common::Redis::RespValuePtr lookup(const std::string& key) PURE;
+
+  /**
+   * Starts filling the cache of the current worker with the value of a key, read from upstream.
+   * @param key supplies the key.
+   * @return NearCacheFillPtr the fill, or nullptr if the value may not be cached, e.g. while the
+   *         modifications of the keys are not tracked.
+   */
+  virtual NearCacheFillPtr startFill(const std::string& key) PURE;
+};
+
+using NearCacheSharedPtr = std::shared_ptr<NearCache>;
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
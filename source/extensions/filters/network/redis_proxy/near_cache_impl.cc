@@ -0,0 +1,175 @@
+#include "source/extensions/filters/network/redis_proxy/near_cache_impl.h"
+
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace {
+
+// The default maximum number of bytes cached by each worker.
+constexpr uint64_t DefaultMaxBytes = 16 * 1024 * 1024;
+// The default maximum time a value is cached.
+constexpr uint64_t DefaultTtlMs = 60 * 1000;
+
+uint64_t valueSize(const Common::Redis::RespValue& value) {
+  if (value.type() != Common::Redis::RespType::BulkString) {
+    return 0;
+  }
+  // Avoids copying the bulk strings backed by a buffer.
+  return value.bulkStringBuffer() != nullptr ? value.bulkStringBuffer()->length()
+                                             : value.asString().size();
+}
+
+} // namespace
+
+NearCacheImpl::NearCacheImpl(const envoy::extensions::filters::network::redis_proxy::v3::
+                                 RedisProxy::PrefixRoutes::Route::NearCache& config,
+                             ConnPool::InstanceSharedPtr upstream, std::string tracking_prefix,
+                             ThreadLocal::SlotAllocator& tls, Stats::ScopeSharedPtr scope,
+                             TimeSource& time_source)
+    : tls_(ThreadLocal::TypedSlot<ThreadLocalCache>::makeUnique(tls)) {
+  NearCacheStats stats = generateStats(*scope);
+  auto shared_config = std::make_shared<const SharedConfig>(SharedConfig{
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_bytes, DefaultMaxBytes),
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, ttl, DefaultTtlMs)),
+      std::move(upstream), std::move(tracking_prefix), std::move(scope), stats, time_source});
+  tls_->set([shared_config](Event::Dispatcher&) {
+    return std::make_shared<ThreadLocalCache>(shared_config);
+  });
+}
+
+Common::Redis::RespValuePtr NearCacheImpl::lookup(const std::string& key) {
+  return (*tls_)->lookup(key);
+}
+
+NearCacheFillPtr NearCacheImpl::startFill(const std::string& key) {
+  return (*tls_)->startFill(key);
+}
+
+NearCacheStats NearCacheImpl::generateStats(Stats::Scope& scope) {
+  return NearCacheStats{ALL_NEAR_CACHE_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
+}
+
+NearCacheImpl::ThreadLocalCache::~ThreadLocalCache() { config_->stats_.bytes_.sub(bytes_); }
+
+Common::Redis::RespValuePtr NearCacheImpl::ThreadLocalCache::lookup(const std::string& key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    config_->stats_.miss_.inc();
+    return nullptr;
+  }
+  EntryList::iterator entry = it->second;
+  if (entry->expiry_ <= config_->time_source_.monotonicTime()) {
+    remove(entry);
+    config_->stats_.miss_.inc();
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, entry);
+  config_->stats_.hit_.inc();
+  return std::make_unique<Common::Redis::RespValue>(entry->value_);
+}
+
+NearCacheFillPtr NearCacheImpl::ThreadLocalCache::startFill(const std::string& key) {
+  if (subscription_ == nullptr) {
+    subscription_ =
+        config_->upstream_->subscribeToInvalidations(config_->tracking_prefix_, *this);
+  }
+  if (!subscription_->active()) {
+    return nullptr;
+  }
+  pending_fills_[key].fills_++;
+  return std::make_unique<Fill>(weak_from_this(), key, epoch_);
+}
+
+void NearCacheImpl::ThreadLocalCache::completeFill(const std::string& key,
+                                                   const Common::Redis::RespValue& value,
+                                                   uint64_t start_epoch) {
+  // The value may be stale if the key was invalidated since the start of the fill, or if its
+  // modifications may not have been notified.
+  auto pending_fill = pending_fills_.find(key);
+  if (!subscription_->active() || invalidate_all_epoch_ > start_epoch ||
+      (pending_fill != pending_fills_.end() &&
+       pending_fill->second.invalidation_epoch_ > start_epoch)) {
+    return;
+  }
+  // Errors are not cached, but the absence of a key is.
+  if (value.type() != Common::Redis::RespType::BulkString &&
+      value.type() != Common::Redis::RespType::Null) {
+    return;
+  }
+  const uint64_t size = sizeof(Entry) + key.size() + valueSize(value);
+  if (size > config_->max_bytes_) {
+    return;
+  }
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    remove(it->second);
+  }
+  while (bytes_ + size > config_->max_bytes_) {
+    remove(std::prev(entries_.end()));
+    config_->stats_.eviction_.inc();
+  }
+  entries_.push_front(
+      Entry{key, value, config_->time_source_.monotonicTime() + config_->ttl_, size});
+  index_.emplace(entries_.front().key_, entries_.begin());
+  bytes_ += size;
+  config_->stats_.bytes_.add(size);
+}
+
+void NearCacheImpl::ThreadLocalCache::endFill(const std::string& key) {
+  auto pending_fill = pending_fills_.find(key);
+  ASSERT(pending_fill != pending_fills_.end());
+  if (--pending_fill->second.fills_ == 0) {
+    pending_fills_.erase(pending_fill);
+  }
+}
+
+void NearCacheImpl::ThreadLocalCache::onInvalidation(absl::string_view key) {
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    remove(it->second);
+    config_->stats_.invalidation_.inc();
+  }
+  auto pending_fill = pending_fills_.find(key);
+  if (pending_fill != pending_fills_.end()) {
+    pending_fill->second.invalidation_epoch_ = ++epoch_;
+  }
+}
+
+void NearCacheImpl::ThreadLocalCache::onInvalidateAll() {
+  config_->stats_.invalidation_.add(entries_.size());
+  config_->stats_.bytes_.sub(bytes_);
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+  invalidate_all_epoch_ = ++epoch_;
+}
+
+void NearCacheImpl::ThreadLocalCache::remove(EntryList::iterator entry) {
+  index_.erase(entry->key_);
+  bytes_ -= entry->size_;
+  config_->stats_.bytes_.sub(entry->size_);
+  entries_.erase(entry);
+}
+
+NearCacheImpl::Fill::~Fill() {
+  std::shared_ptr<ThreadLocalCache> parent = parent_.lock();
+  if (parent != nullptr) {
+    parent->endFill(key_);
+  }
+}
+
+void NearCacheImpl::Fill::complete(const Common::Redis::RespValue& value) {
+  std::shared_ptr<ThreadLocalCache> parent = parent_.lock();
+  if (parent != nullptr) {
+    parent->completeFill(key_, value, start_epoch_);
+  }
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
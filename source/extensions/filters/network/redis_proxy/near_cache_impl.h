@@ -0,0 +1,152 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "source/extensions/filters/network/redis_proxy/conn_pool.h"
+#include "source/extensions/filters/network/redis_proxy/near_cache.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+/**
+ * All near cache stats. @see stats_macros.h
+ */
+#define ALL_NEAR_CACHE_STATS(COUNTER, GAUGE)                                                       \
+  COUNTER(eviction)                                                                                \
+  COUNTER(hit)                                                                                     \
+  COUNTER(invalidation)                                                                            \
+  COUNTER(miss)                                                                                    \
+  GAUGE(bytes, Accumulate)
+
+/**
+ * Struct definition for all near cache stats. @see stats_macros.h
+ */
+struct NearCacheStats {
+  ALL_NEAR_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A near cache of the values read by GET commands, with a per-worker LRU cache bounded by memory
+ * and TTL. The values are only cached while the modifications of the keys starting with the
+ * tracking prefix are tracked on all the hosts of the upstream, and invalidated once notified.
+ */
+class NearCacheImpl : public NearCache {
+public:
+  /**
+   * @param config supplies the configuration of the cache.
+   * @param upstream supplies the connection pool the keys are read from.
+   * @param tracking_prefix supplies the prefix of the keys of the cache, which may be empty.
+   * @param tls supplies the allocator of the slot of the per-worker caches.
+   * @param scope supplies the scope of the stats of the cache.
+   * @param time_source supplies the time source of the expiration of the values.
+   */
+  NearCacheImpl(const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::
+                    PrefixRoutes::Route::NearCache& config,
+                ConnPool::InstanceSharedPtr upstream, std::string tracking_prefix,
+                ThreadLocal::SlotAllocator& tls, Stats::ScopeSharedPtr scope,
+                TimeSource& time_source);
+
+  // RedisProxy::NearCache
+  Common::Redis::RespValuePtr lookup(const std::string& key) override;
+  NearCacheFillPtr startFill(const std::string& key) override;
+
+  static NearCacheStats generateStats(Stats::Scope& scope);
+
+private:
+  // The configuration shared by the per-worker caches, which may outlive the cache.
+  struct SharedConfig {
+    const uint64_t max_bytes_;
+    const std::chrono::milliseconds ttl_;
+    const ConnPool::InstanceSharedPtr upstream_;
+    const std::string tracking_prefix_;
+    const Stats::ScopeSharedPtr scope_;
+    NearCacheStats stats_;
+    TimeSource& time_source_;
+  };
+
+  using SharedConfigConstSharedPtr = std::shared_ptr<const SharedConfig>;
+
+  class ThreadLocalCache : public ThreadLocal::ThreadLocalObject,
+                           public ConnPool::InvalidationCallbacks,
+                           public std::enable_shared_from_this<ThreadLocalCache> {
+  public:
+    ThreadLocalCache(SharedConfigConstSharedPtr config) : config_(std::move(config)) {}
+    ~ThreadLocalCache() override;
+
+    Common::Redis::RespValuePtr lookup(const std::string& key);
+    NearCacheFillPtr startFill(const std::string& key);
+    void completeFill(const std::string& key, const Common::Redis::RespValue& value,
+                      uint64_t start_epoch);
+    void endFill(const std::string& key);
+
+    // ConnPool::InvalidationCallbacks
+    void onInvalidation(absl::string_view key) override;
+    void onInvalidateAll() override;
+
+  private:
+    struct Entry {
+      std::string key_;
+      Common::Redis::RespValue value_;
+      MonotonicTime expiry_;
+      uint64_t size_;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    // The fills of a key in progress, and the epoch of the last invalidation of the key since.
+    struct PendingFill {
+      uint32_t fills_{};
+      uint64_t invalidation_epoch_{};
+    };
+
+    void remove(EntryList::iterator entry);
+
+    const SharedConfigConstSharedPtr config_;
+    // The entries, the most recently used first.
+    EntryList entries_;
+    absl::flat_hash_map<absl::string_view, EntryList::iterator> index_;
+    uint64_t bytes_{};
+    absl::flat_hash_map<std::string, PendingFill> pending_fills_;
+    // Incremented on each invalidation of a key being filled, and on each invalidation of all
+    // the keys, so that the fills started before are not cached.
+    uint64_t epoch_{};
+    uint64_t invalidate_all_epoch_{};
+    ConnPool::InvalidationSubscriptionPtr subscription_;
+  };
+
+  class Fill : public NearCacheFill {
+  public:
+    Fill(std::weak_ptr<ThreadLocalCache> parent, const std::string& key, uint64_t start_epoch)
+        : parent_(std::move(parent)), key_(key), start_epoch_(start_epoch) {}
+    ~Fill() override;
+
+    // RedisProxy::NearCacheFill
+    void complete(const Common::Redis::RespValue& value) override;
+
+  private:
+    const std::weak_ptr<ThreadLocalCache> parent_;
+    const std::string key_;
+    const uint64_t start_epoch_;
+  };
+
+  const ThreadLocal::TypedSlotPtr<ThreadLocalCache> tls_;
+};
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
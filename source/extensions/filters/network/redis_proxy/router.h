@@ -4,10 +4,12 @@
 #include <string>
 #include <vector>
 
+#include "envoy/common/optref.h"
 #include "envoy/common/pure.h"
 #include "envoy/stream_info/stream_info.h"
 
 #include "source/extensions/filters/network/redis_proxy/conn_pool.h"
+#include "source/extensions/filters/network/redis_proxy/near_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -49,6 +51,11 @@ public:
   virtual ConnPool::InstanceSharedPtr upstream(const std::string& command) const PURE;
 
   virtual const MirrorPolicies& mirrorPolicies() const PURE;
+
+  /**
+   * @return the near cache of the values of the keys of the route, if any.
+   */
+  virtual OptRef<NearCache> nearCache() const PURE;
 };
 
 using RouteSharedPtr = std::shared_ptr<Route>;
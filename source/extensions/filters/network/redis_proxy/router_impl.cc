@@ -3,6 +3,7 @@
 #include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
 #include "envoy/type/v3/percent.pb.h"
 
+#include "source/common/common/empty_string.h"
 #include "source/common/formatter/substitution_formatter.h"
 #include "source/common/http/header_map_impl.h"
 
@@ -46,9 +47,10 @@ bool MirrorPolicyImpl::shouldMirror(const std::string& command) const {
 Prefix::Prefix(
     const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::Route
         route,
-    Upstreams& upstreams, Runtime::Loader& runtime)
+    Upstreams& upstreams, Runtime::Loader& runtime, NearCacheSharedPtr near_cache)
     : prefix_(route.prefix()), key_formatter_(route.key_formatter()),
-      remove_prefix_(route.remove_prefix()), upstream_(upstreams.at(route.cluster())) {
+      remove_prefix_(route.remove_prefix()), upstream_(upstreams.at(route.cluster())),
+      near_cache_(std::move(near_cache)) {
   for (auto const& mirror_policy : route.request_mirror_policy()) {
     mirror_policies_.emplace_back(std::make_shared<MirrorPolicyImpl>(
         mirror_policy, upstreams.at(mirror_policy.cluster()), runtime));
@@ -72,10 +74,10 @@ ConnPool::InstanceSharedPtr Prefix::upstream(const std::string& command) const {
 
 PrefixRoutes::PrefixRoutes(
     const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes& config,
-    Upstreams&& upstreams, Runtime::Loader& runtime)
+    Upstreams&& upstreams, Runtime::Loader& runtime, const NearCacheFactory& near_cache_factory)
     : case_insensitive_(config.case_insensitive()), upstreams_(std::move(upstreams)),
       catch_all_route_(config.has_catch_all_route()
-                           ? std::make_shared<Prefix>(config.catch_all_route(), upstreams_, runtime)
+                           ? makePrefix(config.catch_all_route(), true, runtime, near_cache_factory)
                            : nullptr) {
 
   for (auto const& route : config.routes()) {
@@ -86,13 +88,32 @@ PrefixRoutes::PrefixRoutes(
     }
 
     auto success = prefix_lookup_table_.add(
-        copy.c_str(), std::make_shared<Prefix>(route, upstreams_, runtime), false);
+        copy.c_str(), makePrefix(route, false, runtime, near_cache_factory), false);
     if (!success) {
       throw EnvoyException(fmt::format("prefix `{}` already exists.", route.prefix()));
     }
   }
 }
 
+PrefixSharedPtr PrefixRoutes::makePrefix(
+    const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::Route&
+        route,
+    bool catch_all, Runtime::Loader& runtime, const NearCacheFactory& near_cache_factory) {
+  NearCacheSharedPtr near_cache;
+  if (route.has_near_cache() && near_cache_factory) {
+    // The keys sent upstream only start with the prefix of the route if it matched them as is.
+    const bool prefixed_keys = !catch_all && !case_insensitive_ && !route.remove_prefix() &&
+                               route.key_formatter().empty();
+    // The values are read from the upstream of the read commands.
+    const std::string& cluster = route.has_read_command_policy()
+                                     ? route.read_command_policy().cluster()
+                                     : route.cluster();
+    near_cache = near_cache_factory(route, upstreams_.at(cluster),
+                                    prefixed_keys ? route.prefix() : EMPTY_STRING);
+  }
+  return std::make_shared<Prefix>(route, upstreams_, runtime, std::move(near_cache));
+}
+
 RouteSharedPtr PrefixRoutes::upstreamPool(std::string& key,
                                           const StreamInfo::StreamInfo& stream_info) {
   PrefixSharedPtr value = nullptr;
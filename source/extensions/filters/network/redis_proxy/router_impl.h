@@ -26,6 +26,18 @@ namespace RedisProxy {
 
 using Upstreams = std::map<std::string, ConnPool::InstanceSharedPtr>;
 
+/**
+ * Creates the near cache of a route.
+ * @param route supplies the configuration of the route.
+ * @param upstream supplies the connection pool the keys of the route are read from.
+ * @param tracking_prefix supplies the prefix of the keys whose modifications are tracked, which may
+ *        be empty to track all the keys.
+ */
+using NearCacheFactory = std::function<NearCacheSharedPtr(
+    const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::Route&
+        route,
+    const ConnPool::InstanceSharedPtr& upstream, const std::string& tracking_prefix)>;
+
 class MirrorPolicyImpl : public MirrorPolicy {
 public:
   MirrorPolicyImpl(const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::
@@ -48,10 +60,11 @@ class Prefix : public Route {
 public:
   Prefix(const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::Route
              route,
-         Upstreams& upstreams, Runtime::Loader& runtime);
+         Upstreams& upstreams, Runtime::Loader& runtime, NearCacheSharedPtr near_cache = nullptr);
 
   ConnPool::InstanceSharedPtr upstream(const std::string& command) const override;
   const MirrorPolicies& mirrorPolicies() const override { return mirror_policies_; };
+  OptRef<NearCache> nearCache() const override { return makeOptRefFromPtr(near_cache_.get()); }
   const std::string& prefix() const { return prefix_; }
   bool removePrefix() const { return remove_prefix_; }
   const std::string& keyFormatter() const { return key_formatter_; }
@@ -63,6 +76,7 @@ private:
   const ConnPool::InstanceSharedPtr upstream_;
   MirrorPolicies mirror_policies_;
   ConnPool::InstanceSharedPtr read_upstream_;
+  const NearCacheSharedPtr near_cache_;
 };
 
 using PrefixSharedPtr = std::shared_ptr<Prefix>;
@@ -71,7 +85,8 @@ class PrefixRoutes : public Router, public Logger::Loggable<Logger::Id::redis> {
 public:
   PrefixRoutes(const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes&
                    prefix_routes,
-               Upstreams&& upstreams, Runtime::Loader& runtime);
+               Upstreams&& upstreams, Runtime::Loader& runtime,
+               const NearCacheFactory& near_cache_factory = nullptr);
 
   RouteSharedPtr upstreamPool(std::string& key, const StreamInfo::StreamInfo& stream_info) override;
 
@@ -85,6 +100,11 @@ public:
                  const StreamInfo::StreamInfo& stream_info);
 
 private:
+  PrefixSharedPtr
+  makePrefix(const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::
+                 Route& route,
+             bool catch_all, Runtime::Loader& runtime, const NearCacheFactory& near_cache_factory);
+
   TrieLookupTable<PrefixSharedPtr> prefix_lookup_table_;
   const bool case_insensitive_;
   Upstreams upstreams_;
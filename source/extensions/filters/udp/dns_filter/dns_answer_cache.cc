@@ -0,0 +1,242 @@
+#include "source/extensions/filters/udp/dns_filter/dns_answer_cache.h"
+
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace DnsFilter {
+namespace {
+
+constexpr uint32_t DEFAULT_MAX_ENTRIES{1024};
+constexpr std::chrono::seconds DEFAULT_NEGATIVE_TTL{30};
+
+// The offsets of the fields of the DNS header rewritten or read by the cache.
+constexpr size_t FLAGS_OFFSET = 2;
+constexpr size_t QUESTIONS_OFFSET = 4;
+constexpr size_t ANSWERS_OFFSET = 6;
+constexpr size_t AUTHORITY_RRS_OFFSET = 8;
+constexpr size_t ADDITIONAL_RRS_OFFSET = 10;
+constexpr size_t HEADER_SIZE = 12;
+
+// The opcode and recursion desired bits of the first byte of the flags.
+constexpr uint8_t OPCODE_MASK = 0x78;
+constexpr uint8_t OPCODE_SHIFT = 3;
+constexpr uint8_t RD_MASK = 0x01;
+
+uint16_t readUint16(absl::string_view data, size_t offset) {
+  return static_cast<uint16_t>(static_cast<uint8_t>(data[offset]) << 8 |
+                               static_cast<uint8_t>(data[offset + 1]));
+}
+
+void writeUint16(char* data, uint16_t value) {
+  data[0] = static_cast<char>(value >> 8);
+  data[1] = static_cast<char>(value);
+}
+
+void writeUint32(char* data, uint32_t value) {
+  writeUint16(data, value >> 16);
+  writeUint16(data + 2, value);
+}
+
+// Returns the offset following the name at an offset, or 0 if the name is truncated.
+size_t skipName(absl::string_view response, size_t offset) {
+  while (offset < response.size()) {
+    const uint8_t length = response[offset];
+    if (length == 0) {
+      return offset + 1;
+    }
+    // A compression pointer ends the name.
+    if ((length & 0xc0) == 0xc0) {
+      return offset + 2 <= response.size() ? offset + 2 : 0;
+    }
+    offset += length + 1;
+  }
+  return 0;
+}
+
+// Finds the offsets of the TTLs of all the records of a serialized response. Returns false if
+// the response is malformed.
+bool findTtlOffsets(absl::string_view response, std::vector<uint16_t>& ttl_offsets) {
+  if (response.size() < HEADER_SIZE) {
+    return false;
+  }
+  const uint16_t questions = readUint16(response, QUESTIONS_OFFSET);
+  const uint32_t records = readUint16(response, ANSWERS_OFFSET) +
+                           readUint16(response, AUTHORITY_RRS_OFFSET) +
+                           readUint16(response, ADDITIONAL_RRS_OFFSET);
+
+  size_t offset = HEADER_SIZE;
+  for (uint16_t i = 0; i < questions; i++) {
+    // The name is followed by the type and the class.
+    offset = skipName(response, offset);
+    if (offset == 0) {
+      return false;
+    }
+    offset += 2 * sizeof(uint16_t);
+  }
+  for (uint32_t i = 0; i < records; i++) {
+    // The name is followed by the type, the class, the TTL and the length of the data.
+    offset = skipName(response, offset);
+    if (offset == 0 || offset + 10 > response.size()) {
+      return false;
+    }
+    ttl_offsets.push_back(offset + 4);
+    offset += 10 + readUint16(response, offset + 8);
+  }
+  return offset == response.size();
+}
+
+} // namespace
+
+DnsAnswerCacheConfig::DnsAnswerCacheConfig(
+    const envoy::extensions::filters::udp::dns_filter::v3::DnsFilterConfig::AnswerCacheConfig&
+        config,
+    const std::string& stat_prefix, Stats::Scope& scope)
+    : max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, DEFAULT_MAX_ENTRIES)),
+      negative_ttl_(std::chrono::seconds(PROTOBUF_GET_SECONDS_OR_DEFAULT(
+          config, negative_ttl, DEFAULT_NEGATIVE_TTL.count()))),
+      max_stale_ttl_(
+          std::chrono::seconds(PROTOBUF_GET_SECONDS_OR_DEFAULT(config, max_stale_ttl, 0))),
+      prefetch_min_hits_(config.prefetch_min_hits()), stats_(generateStats(stat_prefix, scope)) {}
+
+DnsAnswerCacheStats DnsAnswerCacheConfig::generateStats(const std::string& stat_prefix,
+                                                        Stats::Scope& scope) {
+  const auto final_prefix = absl::StrCat("dns_filter.", stat_prefix, ".answer_cache.");
+  return {ALL_DNS_ANSWER_CACHE_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                                     POOL_GAUGE_PREFIX(scope, final_prefix))};
+}
+
+DnsAnswerCache::DnsAnswerCache(const DnsAnswerCacheConfig& config, TimeSource& time_source)
+    : config_(config), time_source_(time_source) {}
+
+DnsAnswerCache::~DnsAnswerCache() { config_.stats().entries_.sub(entries_.size()); }
+
+DnsAnswerCache::LookupStatus DnsAnswerCache::lookup(const DnsQueryContext& context,
+                                                    Buffer::Instance& response) {
+  const auto entry = find(context);
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (entry == entries_.end() || entry->expiry_ <= now) {
+    config_.stats().misses_.inc();
+    return LookupStatus::Miss;
+  }
+
+  config_.stats().hits_.inc();
+  if (entry->negative_) {
+    config_.stats().negative_hits_.inc();
+  }
+  const auto remaining =
+      std::chrono::duration_cast<std::chrono::milliseconds>(entry->expiry_ - now);
+  write(*entry, context, std::chrono::duration_cast<std::chrono::seconds>(remaining), response);
+
+  // The popular answers are refreshed in the last tenth of their lifetime.
+  ++entry->hits_;
+  if (config_.prefetchMinHits() == 0 || entry->prefetching_ ||
+      entry->hits_ < config_.prefetchMinHits() || remaining * 10 > entry->ttl_) {
+    return LookupStatus::Hit;
+  }
+  ENVOY_LOG(trace, "prefetching the answer to [{}]", entry->name_);
+  config_.stats().prefetches_.inc();
+  entry->prefetching_ = true;
+  return LookupStatus::HitAndPrefetch;
+}
+
+bool DnsAnswerCache::lookupStale(const DnsQueryContext& context, Buffer::Instance& response) {
+  const auto entry = find(context);
+  if (entry == entries_.end()) {
+    return false;
+  }
+
+  // The answer may have been refreshed since the query missed the cache.
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (entry->expiry_ > now) {
+    config_.stats().hits_.inc();
+    write(*entry, context, std::chrono::duration_cast<std::chrono::seconds>(entry->expiry_ - now),
+          response);
+    return true;
+  }
+  ENVOY_LOG(debug, "returning the stale answer to [{}]", entry->name_);
+  config_.stats().stale_hits_.inc();
+  write(*entry, context, StaleAnswerTtl, response);
+  return true;
+}
+
+void DnsAnswerCache::insert(const DnsQueryRecord& query, std::chrono::seconds ttl,
+                            const Buffer::Instance& response) {
+  const auto existing = index_.find(key(query));
+  if (existing != index_.end()) {
+    erase(existing->second);
+  }
+
+  Entry entry{std::string(query.name_), query.type_, query.class_, response.toString(), {},
+              false, ttl, {}};
+  if (!findTtlOffsets(entry.response_, entry.ttl_offsets_)) {
+    ENVOY_LOG(debug, "unable to cache the malformed response to [{}]", query.name_);
+    return;
+  }
+  // A response without any answer is a negative answer, cached as specified by RFC 2308.
+  entry.negative_ = readUint16(entry.response_, ANSWERS_OFFSET) == 0;
+  if (entry.negative_) {
+    entry.ttl_ = config_.negativeTtl();
+  }
+  if (entry.ttl_.count() <= 0) {
+    return;
+  }
+  entry.expiry_ = time_source_.monotonicTime() + entry.ttl_;
+
+  if (entries_.size() >= config_.maxEntries()) {
+    config_.stats().evictions_.inc();
+    erase(std::prev(entries_.end()));
+  }
+  entries_.push_front(std::move(entry));
+  index_.emplace(key(entries_.front()), entries_.begin());
+  config_.stats().entries_.inc();
+}
+
+void DnsAnswerCache::onPrefetchFailure(const DnsQueryRecord& query) {
+  const auto entry = index_.find(key(query));
+  if (entry != index_.end()) {
+    entry->second->prefetching_ = false;
+  }
+}
+
+DnsAnswerCache::EntryList::iterator DnsAnswerCache::find(const DnsQueryContext& context) {
+  ASSERT(context.queries_.size() == 1);
+  const auto iter = index_.find(key(*context.queries_.front()));
+  if (iter == index_.end()) {
+    return entries_.end();
+  }
+
+  const EntryList::iterator entry = iter->second;
+  if (entry->expiry_ + config_.maxStaleTtl() <= time_source_.monotonicTime()) {
+    erase(entry);
+    return entries_.end();
+  }
+  entries_.splice(entries_.begin(), entries_, entry);
+  return entry;
+}
+
+void DnsAnswerCache::erase(EntryList::iterator entry) {
+  index_.erase(key(*entry));
+  entries_.erase(entry);
+  config_.stats().entries_.dec();
+}
+
+void DnsAnswerCache::write(Entry& entry, const DnsQueryContext& context, std::chrono::seconds ttl,
+                           Buffer::Instance& response) {
+  // The ID, the opcode and the recursion desired flag are copied from the query.
+  char* data = entry.response_.data();
+  writeUint16(data, context.header_.id);
+  data[FLAGS_OFFSET] = static_cast<char>(
+      (data[FLAGS_OFFSET] & ~(OPCODE_MASK | RD_MASK)) |
+      ((context.header_.flags.opcode << OPCODE_SHIFT) & OPCODE_MASK) | context.header_.flags.rd);
+  for (const uint16_t offset : entry.ttl_offsets_) {
+    writeUint32(data + offset, ttl.count());
+  }
+  response.add(entry.response_);
+}
+
+} // namespace DnsFilter
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/time.h"
+#include "envoy/extensions/filters/udp/dns_filter/v3/dns_filter.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/common/logger.h"
+#include "source/extensions/filters/udp/dns_filter/dns_parser.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace DnsFilter {
+
+/**
+ * All DNS answer cache stats. @see stats_macros.h
+ */
+#define ALL_DNS_ANSWER_CACHE_STATS(COUNTER, GAUGE)                                                 \
+  COUNTER(evictions)                                                                               \
+  COUNTER(hits)                                                                                    \
+  COUNTER(misses)                                                                                  \
+  COUNTER(negative_hits)                                                                           \
+  COUNTER(prefetches)                                                                              \
+  COUNTER(stale_hits)                                                                              \
+  GAUGE(entries, Accumulate)
+
+/**
+ * Struct definition for all DNS answer cache stats. @see stats_macros.h
+ */
+struct DnsAnswerCacheStats {
+  ALL_DNS_ANSWER_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Configuration of the answer caches of the workers, shared by all of them.
+ */
+class DnsAnswerCacheConfig {
+public:
+  DnsAnswerCacheConfig(
+      const envoy::extensions::filters::udp::dns_filter::v3::DnsFilterConfig::AnswerCacheConfig&
+          config,
+      const std::string& stat_prefix, Stats::Scope& scope);
+
+  uint32_t maxEntries() const { return max_entries_; }
+  std::chrono::seconds negativeTtl() const { return negative_ttl_; }
+  std::chrono::seconds maxStaleTtl() const { return max_stale_ttl_; }
+  uint32_t prefetchMinHits() const { return prefetch_min_hits_; }
+  DnsAnswerCacheStats& stats() const { return stats_; }
+
+private:
+  static DnsAnswerCacheStats generateStats(const std::string& stat_prefix, Stats::Scope& scope);
+
+  const uint32_t max_entries_;
+  const std::chrono::seconds negative_ttl_;
+  const std::chrono::seconds max_stale_ttl_;
+  const uint32_t prefetch_min_hits_;
+  mutable DnsAnswerCacheStats stats_;
+};
+
+/**
+ * A cache of the responses to the queries resolved by the external resolvers, owned by the DNS
+ * filter of a worker. The responses are cached as serialized by the DnsMessageParser, so that the
+ * responses to the following queries for the same name, type and class are copied from the cache
+ * with their ID, flags and TTLs rewritten, without building and serializing their records again.
+ * The least recently used responses are evicted when the cache is full.
+ */
+class DnsAnswerCache : Logger::Loggable<Logger::Id::filter> {
+public:
+  DnsAnswerCache(const DnsAnswerCacheConfig& config, TimeSource& time_source);
+  ~DnsAnswerCache();
+
+  // The TTL of the records of the expired responses returned when the external resolution of
+  // their query fails, as recommended by RFC 8767.
+  static constexpr std::chrono::seconds StaleAnswerTtl{30};
+
+  enum class LookupStatus {
+    // No response is cached for the query, or the cached response expired.
+    Miss,
+    // The response was written from the cache.
+    Hit,
+    // The response was written from the cache, and the query should be resolved again to refresh
+    // the response before it expires.
+    HitAndPrefetch
+  };
+
+  /**
+   * Writes the cached response to a query, unless it expired.
+   * @param context supplies the parsed query.
+   * @param response supplies the buffer the response is written to.
+   * @return LookupStatus whether the response was written, and whether it should be prefetched.
+   */
+  LookupStatus lookup(const DnsQueryContext& context, Buffer::Instance& response);
+
+  /**
+   * Writes the cached response to a query whose external resolution failed, if it expired for
+   * less than the maximum stale TTL.
+   * @param context supplies the parsed query.
+   * @param response supplies the buffer the response is written to.
+   * @return bool whether the response was written.
+   */
+  bool lookupStale(const DnsQueryContext& context, Buffer::Instance& response);
+
+  /**
+   * Caches the response to a query. A response without any answer is cached for the negative TTL
+   * instead of the supplied TTL.
+   * @param query supplies the query the response answers.
+   * @param ttl supplies how long the answers of the response are valid.
+   * @param response supplies the serialized response.
+   */
+  void insert(const DnsQueryRecord& query, std::chrono::seconds ttl,
+              const Buffer::Instance& response);
+
+  /**
+   * Allows the response to a query to be prefetched again after its prefetch failed.
+   * @param query supplies the query that was prefetched.
+   */
+  void onPrefetchFailure(const DnsQueryRecord& query);
+
+  /**
+   * @return size_t the number of cached responses.
+   */
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    std::string name_;
+    uint16_t type_;
+    uint16_t class_;
+    // The serialized response, whose ID, flags and TTLs are rewritten in place on each hit.
+    std::string response_;
+    // The offsets of the TTLs of the records in the response.
+    std::vector<uint16_t> ttl_offsets_;
+    bool negative_;
+    std::chrono::seconds ttl_;
+    MonotonicTime expiry_;
+    uint32_t hits_{};
+    bool prefetching_{};
+  };
+  using EntryList = std::list<Entry>;
+
+  // The name of the key is owned by the entry, or by the query being looked up.
+  struct Key {
+    bool operator==(const Key& rhs) const {
+      return type_ == rhs.type_ && class_ == rhs.class_ && name_ == rhs.name_;
+    }
+
+    template <typename H> friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.name_, key.type_, key.class_);
+    }
+
+    absl::string_view name_;
+    uint16_t type_;
+    uint16_t class_;
+  };
+
+  static Key key(const DnsQueryRecord& query) { return {query.name_, query.type_, query.class_}; }
+  static Key key(const Entry& entry) { return {entry.name_, entry.type_, entry.class_}; }
+
+  // Finds the entry of a query, which is not expired for more than the maximum stale TTL.
+  EntryList::iterator find(const DnsQueryContext& context);
+  void erase(EntryList::iterator entry);
+  void write(Entry& entry, const DnsQueryContext& context, std::chrono::seconds ttl,
+             Buffer::Instance& response);
+
+  const DnsAnswerCacheConfig& config_;
+  TimeSource& time_source_;
+  // The entries, from the most to the least recently used.
+  EntryList entries_;
+  absl::flat_hash_map<Key, EntryList::iterator> index_;
+};
+
+using DnsAnswerCachePtr = std::unique_ptr<DnsAnswerCache>;
+
+} // namespace DnsFilter
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -169,6 +169,10 @@ DnsFilterEnvoyConfig::DnsFilterEnvoyConfig(
     resolver_timeout_ = std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(
         client_config, resolver_timeout, DEFAULT_RESOLVER_TIMEOUT.count()));
     max_pending_lookups_ = client_config.max_pending_lookups();
+    if (client_config.has_answer_cache()) {
+      answer_cache_config_ = std::make_unique<const DnsAnswerCacheConfig>(
+          client_config.answer_cache(), config.stat_prefix(), root_scope_);
+    }
   } else {
     // In case client_config doesn't exist, create default DNS resolver factory and save it.
     dns_resolver_factory_ = &Network::createDefaultDnsResolverFactory(typed_dns_resolver_config_);
@@ -241,6 +245,19 @@ DnsFilter::DnsFilter(Network::UdpReadFilterCallbacks& callbacks,
       return;
     }
 
+    // Only the answers of the resolutions completed by the resolver are cached. If the resolution
+    // failed, the client is answered from the cache if an answer did not expire for too long.
+    const bool cacheable =
+        context->in_callback_ &&
+        context->resolution_status_ == Network::DnsResolver::ResolutionStatus::Success;
+    if (answer_cache_ != nullptr && !cacheable && !context->prefetch_) {
+      Buffer::OwnedImpl response;
+      if (answer_cache_->lookupStale(*context, response)) {
+        sendDnsResponse(*context, response);
+        return;
+      }
+    }
+
     config_->stats().externally_resolved_queries_.inc();
     if (iplist.empty()) {
       config_->stats().unanswered_queries_.inc();
@@ -252,9 +269,29 @@ DnsFilter::DnsFilter(Network::UdpReadFilterCallbacks& callbacks,
       const std::chrono::seconds ttl = getDomainTTL(query->name_);
       message_parser_.storeDnsAnswerRecord(context, *query, ttl, std::move(ip));
     }
-    sendDnsResponse(std::move(context));
+
+    Buffer::OwnedImpl response;
+    message_parser_.buildResponseBuffer(context, response);
+    if (answer_cache_ != nullptr) {
+      if (cacheable) {
+        // The answers expire with the first of the resolved addresses.
+        answer_cache_->insert(
+            *query, std::min(context->resolved_ttl_, getDomainTTL(query->name_)), response);
+      } else if (context->prefetch_) {
+        answer_cache_->onPrefetchFailure(*query);
+      }
+    }
+    // The client was already answered from the cache if the query was prefetched.
+    if (!context->prefetch_) {
+      sendDnsResponse(*context, response);
+    }
   };
 
+  if (config_->answerCacheConfig() != nullptr) {
+    answer_cache_ = std::make_unique<DnsAnswerCache>(*config_->answerCacheConfig(),
+                                                     listener_.dispatcher().timeSource());
+  }
+
   resolver_ = std::make_unique<DnsFilterResolver>(
       resolver_callback_, config->resolverTimeout(), listener_.dispatcher(),
       config->maxPendingLookups(), config->typedDnsResolverConfig(), config->dnsResolverFactory(),
@@ -282,8 +319,11 @@ Network::FilterStatus DnsFilter::onData(Network::UdpRecvData& client_request) {
   }
 
   // Resolve the requested name and respond to the client. If the return code is
-  // External, we will respond to the client when the upstream resolver returns
-  if (getResponseForQuery(query_context) == DnsLookupResponseCode::External) {
+  // External, we will respond to the client when the upstream resolver returns. If it is
+  // Cached, the client was already answered from the answer cache
+  const DnsLookupResponseCode response_code = getResponseForQuery(query_context);
+  if (response_code == DnsLookupResponseCode::External ||
+      response_code == DnsLookupResponseCode::Cached) {
     return Network::FilterStatus::StopIteration;
   }
 
@@ -299,10 +339,13 @@ void DnsFilter::sendDnsResponse(DnsQueryContextPtr query_context) {
   // Serializes the generated response to the parsed query from the client. If there is a
   // parsing error or the incoming query is invalid, we will still generate a valid DNS response
   message_parser_.buildResponseBuffer(query_context, response);
+  sendDnsResponse(*query_context, response);
+}
+
+void DnsFilter::sendDnsResponse(const DnsQueryContext& context, Buffer::Instance& response) {
   config_->stats().downstream_tx_responses_.inc();
   config_->stats().downstream_tx_bytes_.recordValue(response.length());
-  Network::UdpSendData response_data{query_context->local_->ip(), *(query_context->peer_),
-                                     response};
+  Network::UdpSendData response_data{context.local_->ip(), *(context.peer_), response};
   listener_.send(response_data);
 }
 
@@ -335,6 +378,20 @@ DnsLookupResponseCode DnsFilter::getResponseForQuery(DnsQueryContextPtr& context
     // Forwarding queries is enabled if the configuration contains a client configuration
     // for the dns_filter.
     if (forward_queries) {
+      if (answer_cache_ != nullptr) {
+        Buffer::OwnedImpl response;
+        const DnsAnswerCache::LookupStatus status = answer_cache_->lookup(*context, response);
+        if (status != DnsAnswerCache::LookupStatus::Miss) {
+          ENVOY_LOG(debug, "answering name [{}] from the answer cache", query->name_);
+          sendDnsResponse(*context, response);
+          if (status == DnsAnswerCache::LookupStatus::HitAndPrefetch) {
+            context->prefetch_ = true;
+            resolver_->resolveExternalQuery(std::move(context), query.get());
+          }
+          return DnsLookupResponseCode::Cached;
+        }
+      }
+
       ENVOY_LOG(debug, "resolving name [{}] via external resolvers", query->name_);
       resolver_->resolveExternalQuery(std::move(context), query.get());
 
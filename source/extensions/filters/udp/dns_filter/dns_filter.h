@@ -9,6 +9,7 @@
 #include "source/common/common/utility.h"
 #include "source/common/config/config_provider_impl.h"
 #include "source/common/network/utility.h"
+#include "source/extensions/filters/udp/dns_filter/dns_answer_cache.h"
 #include "source/extensions/filters/udp/dns_filter/dns_filter_resolver.h"
 #include "source/extensions/filters/udp/dns_filter/dns_parser.h"
 
@@ -100,6 +101,7 @@ public:
   const TrieLookupTable<DnsVirtualDomainConfigSharedPtr>& getDnsTrie() const {
     return dns_lookup_trie_;
   }
+  const DnsAnswerCacheConfig* answerCacheConfig() const { return answer_cache_config_.get(); }
 
 private:
   static DnsFilterStats generateStats(const std::string& stat_prefix, Stats::Scope& scope) {
@@ -132,11 +134,12 @@ private:
   uint64_t max_pending_lookups_;
   envoy::config::core::v3::TypedExtensionConfig typed_dns_resolver_config_;
   Network::DnsResolverFactory* dns_resolver_factory_;
+  std::unique_ptr<const DnsAnswerCacheConfig> answer_cache_config_;
 };
 
 using DnsFilterEnvoyConfigSharedPtr = std::shared_ptr<const DnsFilterEnvoyConfig>;
 
-enum class DnsLookupResponseCode { Success, Failure, External };
+enum class DnsLookupResponseCode { Success, Failure, External, Cached };
 
 /**
  * This class is responsible for handling incoming DNS datagrams and responding to the queries.
@@ -165,11 +168,19 @@ private:
    */
   void sendDnsResponse(DnsQueryContextPtr context);
 
+  /**
+   * Send a serialized response to the client
+   *
+   * @param context contains the addresses of the client and of the listener
+   * @param response the serialized response
+   */
+  void sendDnsResponse(const DnsQueryContext& context, Buffer::Instance& response);
+
   /**
    * @brief Encapsulates all of the logic required to find an answer for a DNS query
    *
-   * @return DnsLookupResponseCode indicating whether we were able to respond to the query or send
-   * the query to an external resolver
+   * @return DnsLookupResponseCode indicating whether we were able to respond to the query, send
+   * the query to an external resolver, or respond with a cached answer
    */
   DnsLookupResponseCode getResponseForQuery(DnsQueryContextPtr& context);
 
@@ -375,6 +386,7 @@ private:
   Network::UdpListener& listener_;
   Upstream::ClusterManager& cluster_manager_;
   DnsMessageParser message_parser_;
+  DnsAnswerCachePtr answer_cache_;
   DnsFilterResolverPtr resolver_;
   Network::Address::InstanceConstSharedPtr local_;
   Network::Address::InstanceConstSharedPtr peer_;
@@ -86,9 +86,9 @@ void DnsFilterResolver::resolveExternalQuery(DnsQueryContextPtr context,
                        ctx.query_context->resolution_status_ = status;
                        ctx.resolver_status = DnsFilterResolverStatus::Complete;
 
-                       // C-ares doesn't expose the TTL in the data available here.
                        if (status == Network::DnsResolver::ResolutionStatus::Success) {
                          ctx.resolved_hosts.reserve(response.size());
+                         ctx.query_context->resolved_ttl_ = std::chrono::seconds::max();
                          for (const auto& resp : response) {
                            const auto& addrinfo = resp.addrInfo();
                            ASSERT(addrinfo.address_ != nullptr);
@@ -96,6 +96,8 @@ void DnsFilterResolver::resolveExternalQuery(DnsQueryContextPtr context,
                                      addrinfo.address_->ip()->addressAsString(),
                                      ctx.query_rec->name_);
                            ctx.resolved_hosts.emplace_back(std::move(addrinfo.address_));
+                           ctx.query_context->resolved_ttl_ =
+                               std::min(ctx.query_context->resolved_ttl_, addrinfo.ttl_);
                          }
                        }
                        // Invoke the filter callback notifying it of resolved addresses
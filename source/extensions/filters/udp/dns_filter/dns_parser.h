@@ -192,6 +192,10 @@ public:
   DnsAnswerMap answers_;
   DnsAnswerMap additional_;
   bool in_callback_;
+  // The minimum TTL of the addresses returned by the external resolver.
+  std::chrono::seconds resolved_ttl_{};
+  // Whether the query is resolved to refresh its cached answer, without responding to a client.
+  bool prefetch_{};
 
   /**
    * @param context the query context for which we are querying the response code
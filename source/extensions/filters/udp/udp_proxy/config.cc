@@ -1,5 +1,6 @@
 #include "source/extensions/filters/udp/udp_proxy/config.h"
 
+#include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/formatter/substitution_format_string.h"
 
 namespace Envoy {
@@ -98,6 +99,11 @@ UdpProxyFilterConfigImpl::UdpProxyFilterConfigImpl(
       // Default prefer_gro to true for upstream client traffic.
       upstream_socket_config_(config.upstream_socket_config(), true),
       random_generator_(context.serverFactoryContext().api().randomGenerator()) {
+  if (upstream_socket_config_.prefer_gso_ &&
+      (!ENVOY_SOCKET_UDP_SEGMENT.hasValue() || !Api::OsSysCallsSingleton::get().supportsUdpGso())) {
+    throw EnvoyException("prefer_gso is set but GSO is not supported by the platform.");
+  }
+
   if (use_per_packet_load_balancing_ && config.has_tunneling_config()) {
     throw EnvoyException(
         "Only one of use_per_packet_load_balancing or tunneling_config can be used.");
@@ -108,6 +114,20 @@ UdpProxyFilterConfigImpl::UdpProxyFilterConfigImpl(
         "Only one of use_per_packet_load_balancing or session_filters can be used.");
   }
 
+  if (config.has_flow_table() &&
+      (use_original_src_ip_ || use_per_packet_load_balancing_ || !config.access_log().empty() ||
+       !config.session_filters().empty() || config.has_tunneling_config())) {
+    throw EnvoyException("The flow_table can't be used with use_original_src_ip, "
+                         "use_per_packet_load_balancing, access_log, session_filters or "
+                         "tunneling_config.");
+  }
+
+  if (config.has_flow_table()) {
+    flow_table_config_.emplace(FlowTableConfig{
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.flow_table(), max_flows, 1024 * 1024),
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.flow_table(), max_idle_sockets_per_host, 1024)});
+  }
+
   if (use_original_src_ip_ &&
       !Api::OsSysCallsSingleton::get().supportsIpTransparent(
           context.serverFactoryContext().options().localAddressIpVersion())) {
@@ -158,6 +158,9 @@ public:
     return access_log_flush_interval_;
   }
   Random::RandomGenerator& randomGenerator() const override { return random_generator_; }
+  const absl::optional<FlowTableConfig>& flowTableConfig() const override {
+    return flow_table_config_;
+  }
 
   // FilterChainFactory
   void createFilterChain(FilterChainFactoryCallbacks& callbacks) const override {
@@ -190,6 +193,7 @@ private:
   UdpTunnelingConfigPtr tunneling_config_;
   std::list<SessionFilters::FilterFactoryCb> filter_factories_;
   Random::RandomGenerator& random_generator_;
+  absl::optional<FlowTableConfig> flow_table_config_;
 };
 
 /**
@@ -0,0 +1,37 @@
+#include "source/extensions/filters/udp/udp_proxy/flow_table.h"
+
+#include <cstring>
+
+#include "envoy/common/platform.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+void copyIp(const Network::Address::Instance& address, std::array<uint32_t, 4>& ip) {
+  ASSERT(address.ip() != nullptr);
+  if (address.ip()->version() == Network::Address::IpVersion::v4) {
+    ip = {0, 0, htonl(0xffff), address.ip()->ipv4()->address()};
+  } else {
+    const absl::uint128 ipv6 = address.ip()->ipv6()->address();
+    static_assert(sizeof(ipv6) == sizeof(ip));
+    memcpy(ip.data(), &ipv6, sizeof(ip));
+  }
+}
+
+} // namespace
+
+FlowKey::FlowKey(const Network::Address::Instance& local_address,
+                 const Network::Address::Instance& peer_address) {
+  copyIp(peer_address, peer_ip_);
+  copyIp(local_address, local_ip_);
+  peer_port_ = peer_address.ip()->port();
+  local_port_ = local_address.ip()->port();
+}
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "envoy/network/address.h"
+
+#include "source/common/common/assert.h"
+
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+/**
+ * The key of a UDP flow: the IP addresses and ports of the downstream peer and of the local
+ * listener. IPv4 addresses are stored as IPv4-mapped IPv6 addresses.
+ */
+struct FlowKey {
+  FlowKey() = default;
+  FlowKey(const Network::Address::Instance& local_address,
+          const Network::Address::Instance& peer_address);
+
+  bool operator==(const FlowKey& rhs) const {
+    return peer_ip_ == rhs.peer_ip_ && local_ip_ == rhs.local_ip_ &&
+           peer_port_ == rhs.peer_port_ && local_port_ == rhs.local_port_;
+  }
+
+  template <typename H> friend H AbslHashValue(H h, const FlowKey& key) {
+    return H::combine(std::move(h), key.peer_ip_, key.local_ip_, key.peer_port_, key.local_port_);
+  }
+
+  std::array<uint32_t, 4> peer_ip_{};
+  std::array<uint32_t, 4> local_ip_{};
+  uint16_t peer_port_{};
+  uint16_t local_port_{};
+};
+
+/**
+ * A table of UDP flows, with the values stored in place in an open addressing hash table with
+ * linear probing, and the idle flows expired with a timer wheel. The time is measured in ticks,
+ * advanced by the owner of the table. A flow is not rescheduled when it is active: the wheel is
+ * only checked once per idle timeout, and the flows still active are rescheduled then.
+ *
+ * The wheel holds the keys of the flows rather than an Event::Timer per flow, which would take an
+ * allocation and a dispatcher timer for each flow, and a rescheduling on each datagram. The owner
+ * advances the table with a single coarse timer, @see Event::Dispatcher::createCoarseTimer().
+ */
+template <class Value> class FlowTable {
+public:
+  /**
+   * @param idle_timeout_ticks supplies the number of ticks a flow may be idle before it expires.
+   */
+  explicit FlowTable(uint32_t idle_timeout_ticks)
+      : idle_timeout_ticks_(idle_timeout_ticks), slots_(MinCapacity),
+        wheel_(wheelSize(idle_timeout_ticks)) {}
+
+  /**
+   * @return size_t the number of flows.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @return size_t the bytes allocated by the table, excluding the memory owned by the values.
+   */
+  size_t memoryUsage() const {
+    size_t bytes = slots_.capacity() * sizeof(Slot) + wheel_.capacity() * sizeof(wheel_[0]);
+    for (const std::vector<FlowKey>& bucket : wheel_) {
+      bytes += bucket.capacity() * sizeof(FlowKey);
+    }
+    return bytes;
+  }
+
+  /**
+   * Looks up a flow, and marks it active at the current tick.
+   * @param key supplies the key of the flow.
+   * @return Value* the value of the flow, or nullptr if there is no such flow.
+   */
+  Value* find(const FlowKey& key) {
+    const size_t index = findIndex(key, hash(key));
+    if (index == NotFound) {
+      return nullptr;
+    }
+    slots_[index].last_active_tick_ = now_;
+    return &slots_[index].value_;
+  }
+
+  /**
+   * Inserts a flow active at the current tick. The flow must not be in the table.
+   * @param key supplies the key of the flow.
+   * @param value supplies the value of the flow.
+   * @return Value& the value of the inserted flow, valid until the table is modified.
+   */
+  Value& insert(const FlowKey& key, Value&& value) {
+    const uint32_t key_hash = hash(key);
+    ASSERT(findIndex(key, key_hash) == NotFound);
+    if ((size_ + 1) * 4 > slots_.size() * 3) {
+      grow();
+    }
+    Slot& slot = slots_[emptyIndex(key_hash)];
+    slot.key_ = key;
+    slot.hash_ = key_hash;
+    slot.last_active_tick_ = now_;
+    slot.value_ = std::move(value);
+    schedule(slot);
+    ++size_;
+    return slot.value_;
+  }
+
+  /**
+   * Removes a flow.
+   * @param key supplies the key of the flow.
+   * @return bool whether the flow was in the table.
+   */
+  bool erase(const FlowKey& key) {
+    const size_t index = findIndex(key, hash(key));
+    if (index == NotFound) {
+      return false;
+    }
+    eraseIndex(index);
+    return true;
+  }
+
+  /**
+   * Removes the flows selected by a predicate.
+   * @param predicate supplies the function called with the key and the value of each flow, which
+   *        returns whether the flow is removed. It may take the value of the flows it removes, but
+   *        must not modify the table.
+   */
+  template <class Predicate> void eraseIf(Predicate predicate) {
+    std::vector<FlowKey> keys;
+    for (Slot& slot : slots_) {
+      if (slot.hash_ != 0 && predicate(slot.key_, slot.value_)) {
+        keys.push_back(slot.key_);
+      }
+    }
+    for (const FlowKey& key : keys) {
+      erase(key);
+    }
+  }
+
+  /**
+   * Advances the time by one tick, and removes the flows expired at the new tick.
+   * @param on_expired supplies the function called with the key and the value of each expired
+   *        flow before its removal. It may take the value, but must not modify the table.
+   */
+  template <class OnExpired> void advance(OnExpired on_expired) {
+    ++now_;
+    std::vector<FlowKey> keys;
+    keys.swap(wheel_[now_ % wheel_.size()]);
+    for (const FlowKey& key : keys) {
+      const size_t index = findIndex(key, hash(key));
+      // The flow may have been removed, or replaced by a flow scheduled at another tick.
+      if (index == NotFound || slots_[index].expiry_check_tick_ != now_) {
+        continue;
+      }
+      Slot& slot = slots_[index];
+      if (now_ - slot.last_active_tick_ > idle_timeout_ticks_) {
+        on_expired(slot.key_, slot.value_);
+        eraseIndex(index);
+      } else {
+        schedule(slot);
+      }
+    }
+    // Reuses the memory of the bucket on the next round of the wheel.
+    std::vector<FlowKey>& bucket = wheel_[now_ % wheel_.size()];
+    if (bucket.empty()) {
+      keys.clear();
+      bucket.swap(keys);
+    }
+  }
+
+private:
+  struct Slot {
+    FlowKey key_;
+    // The hash of the key, or 0 if the slot is empty.
+    uint32_t hash_{};
+    uint32_t last_active_tick_{};
+    // The tick the flow is scheduled to be checked for expiry at.
+    uint32_t expiry_check_tick_{};
+    Value value_{};
+  };
+
+  static constexpr size_t MinCapacity = 16;
+  static constexpr size_t NotFound = SIZE_MAX;
+
+  // The wheel covers the idle timeout. Its size is a power of two so that the buckets of the ticks
+  // are consecutive when the ticks wrap around.
+  static size_t wheelSize(uint32_t idle_timeout_ticks) {
+    size_t size = 1;
+    while (size < static_cast<size_t>(idle_timeout_ticks) + 2) {
+      size *= 2;
+    }
+    return size;
+  }
+
+  static uint32_t hash(const FlowKey& key) {
+    const uint32_t hash = static_cast<uint32_t>(absl::HashOf(key));
+    return hash == 0 ? 1 : hash;
+  }
+
+  size_t findIndex(const FlowKey& key, uint32_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t index = hash & mask;; index = (index + 1) & mask) {
+      const Slot& slot = slots_[index];
+      if (slot.hash_ == 0) {
+        return NotFound;
+      }
+      if (slot.hash_ == hash && slot.key_ == key) {
+        return index;
+      }
+    }
+  }
+
+  size_t emptyIndex(uint32_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    size_t index = hash & mask;
+    while (slots_[index].hash_ != 0) {
+      index = (index + 1) & mask;
+    }
+    return index;
+  }
+
+  // Removes the flow at an index, shifting back the following flows of the probe sequence rather
+  // than leaving a tombstone.
+  void eraseIndex(size_t hole) {
+    const size_t mask = slots_.size() - 1;
+    for (size_t index = (hole + 1) & mask; slots_[index].hash_ != 0; index = (index + 1) & mask) {
+      // The flow may fill the hole if the hole is between its home slot and its slot.
+      const size_t home = slots_[index].hash_ & mask;
+      if (((index - home) & mask) >= ((index - hole) & mask)) {
+        slots_[hole] = std::move(slots_[index]);
+        hole = index;
+      }
+    }
+    slots_[hole].hash_ = 0;
+    slots_[hole].value_ = Value{};
+    --size_;
+  }
+
+  void grow() {
+    std::vector<Slot> slots(slots_.size() * 2);
+    slots.swap(slots_);
+    for (Slot& slot : slots) {
+      if (slot.hash_ != 0) {
+        slots_[emptyIndex(slot.hash_)] = std::move(slot);
+      }
+    }
+  }
+
+  // Schedules the expiry check of a flow at the first tick it may be expired at.
+  void schedule(Slot& slot) {
+    slot.expiry_check_tick_ = slot.last_active_tick_ + idle_timeout_ticks_ + 1;
+    wheel_[slot.expiry_check_tick_ % wheel_.size()].push_back(slot.key_);
+  }
+
+  const uint32_t idle_timeout_ticks_;
+  std::vector<Slot> slots_;
+  size_t size_{};
+  // The keys of the flows to check for expiry, by tick modulo the number of buckets.
+  std::vector<std::vector<FlowKey>> wheel_;
+  uint32_t now_{};
+};
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -9,6 +9,26 @@ namespace Envoy {
 namespace Extensions {
 namespace UdpFilters {
 namespace UdpProxy {
+namespace {
+
+// The maximum number of segments of a GSO send, see UDP_MAX_SEGMENTS in the Linux kernel.
+constexpr uint64_t MaxGsoSegments = 64;
+// The maximum size of a GSO send, which is the maximum payload of an IPv4 UDP datagram.
+constexpr uint64_t MaxGsoBatchSize = 65507;
+// The number of ticks of the idle timeout of the flows. The flows expire between the idle timeout
+// and the idle timeout plus one tick.
+constexpr uint32_t FlowIdleTimeoutTicks = 8;
+
+std::chrono::milliseconds flowExpiryTick(std::chrono::milliseconds idle_timeout) {
+  return std::max(idle_timeout / FlowIdleTimeoutTicks, std::chrono::milliseconds(1));
+}
+
+uint32_t flowIdleTimeoutTicks(std::chrono::milliseconds idle_timeout) {
+  const std::chrono::milliseconds tick = flowExpiryTick(idle_timeout);
+  return static_cast<uint32_t>((idle_timeout + tick - std::chrono::milliseconds(1)) / tick);
+}
+
+} // namespace
 
 UdpProxyFilter::UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
                                const UdpProxyFilterConfigSharedPtr& config)
@@ -39,6 +59,24 @@ UdpProxyFilter::~UdpProxyFilter() {
   }
 }
 
+void UdpProxyFilter::scheduleUpstreamFlush(UdpActiveSession& session) {
+  if (upstream_flush_cb_ == nullptr) {
+    upstream_flush_cb_ = read_callbacks_->udpListener().dispatcher().createSchedulableCallback(
+        [this]() { onUpstreamFlush(); });
+  }
+  sessions_pending_upstream_flush_.insert(&session);
+  // The datagrams received from downstream in the same read event are sent together.
+  upstream_flush_cb_->scheduleCallbackCurrentIteration();
+}
+
+void UdpProxyFilter::onUpstreamFlush() {
+  absl::flat_hash_set<UdpActiveSession*> sessions;
+  sessions.swap(sessions_pending_upstream_flush_);
+  for (UdpActiveSession* session : sessions) {
+    session->flushUpstream();
+  }
+}
+
 void UdpProxyFilter::onClusterAddOrUpdate(absl::string_view cluster_name,
                                           Upstream::ThreadLocalClusterCommand& get_cluster) {
   ENVOY_LOG(debug, "udp proxy: attaching to cluster {}", cluster_name);
@@ -47,7 +85,9 @@ void UdpProxyFilter::onClusterAddOrUpdate(absl::string_view cluster_name,
   ASSERT((!cluster_infos_.contains(cluster_name)) ||
          &cluster_infos_[cluster_name]->cluster_ != &cluster);
 
-  if (config_->usingPerPacketLoadBalancing()) {
+  if (config_->flowTableConfig().has_value()) {
+    cluster_infos_.emplace(cluster_name, std::make_unique<FlowTableClusterInfo>(*this, cluster));
+  } else if (config_->usingPerPacketLoadBalancing()) {
     cluster_infos_.emplace(cluster_name,
                            std::make_unique<PerPacketLoadBalancingClusterInfo>(*this, cluster));
   } else {
@@ -274,6 +314,246 @@ UdpProxyFilter::PerPacketLoadBalancingClusterInfo::onData(Network::UdpRecvData&
   return Network::FilterStatus::StopIteration;
 }
 
+UdpProxyFilter::FlowTableClusterInfo::FlowTableClusterInfo(UdpProxyFilter& filter,
+                                                           Upstream::ThreadLocalCluster& cluster)
+    : ClusterInfo(filter, cluster,
+                  SessionStorageType(1, HeterogeneousActiveSessionHash(false),
+                                     HeterogeneousActiveSessionEqual(false))),
+      config_(filter.config_->flowTableConfig().value()),
+      tick_(flowExpiryTick(filter.config_->sessionTimeout())),
+      flows_(flowIdleTimeoutTicks(filter.config_->sessionTimeout())),
+      expiry_timer_(filter.read_callbacks_->udpListener().dispatcher().createCoarseTimer(
+          [this] { onExpiryTimer(); })),
+      host_removal_cb_handle_(cluster.prioritySet().addMemberUpdateCb(
+          [this](const Upstream::HostVector&, const Upstream::HostVector& hosts_removed) {
+            for (const auto& host : hosts_removed) {
+              // The flows of the host are removed, as are the sessions, and its sockets closed.
+              flows_.eraseIf([this, &host](const FlowKey&, FlowSocketPtr& socket) {
+                if (socket->host() != host) {
+                  return false;
+                }
+                releaseFlow(std::move(socket), false);
+                return true;
+              });
+              idle_sockets_.erase(host.get());
+            }
+          })) {}
+
+UdpProxyFilter::FlowTableClusterInfo::~FlowTableClusterInfo() {
+  flows_.eraseIf([this](const FlowKey&, FlowSocketPtr& socket) {
+    releaseFlow(std::move(socket), false);
+    return true;
+  });
+}
+
+Network::FilterStatus UdpProxyFilter::FlowTableClusterInfo::onData(Network::UdpRecvData& data) {
+  const FlowKey key(*data.addresses_.local_, *data.addresses_.peer_);
+  FlowSocketPtr* socket = flows_.find(key);
+  if (socket != nullptr &&
+      (*socket)->host()->coarseHealth() == Upstream::Host::Health::Unhealthy) {
+    // As for the sessions, the flow is moved to a healthy host if there is one.
+    auto host = chooseHost(data.addresses_.peer_, nullptr);
+    if (host != nullptr && host->coarseHealth() != Upstream::Host::Health::Unhealthy &&
+        host != (*socket)->host()) {
+      ENVOY_LOG(debug, "upstream flow unhealthy, recreating the flow");
+      releaseFlow(std::move(*socket), true);
+      flows_.erase(key);
+      socket = createFlow(key, data.addresses_, std::move(host));
+    }
+  } else if (socket == nullptr) {
+    socket = createFlow(key, data.addresses_, nullptr);
+  }
+  if (socket == nullptr) {
+    return Network::FilterStatus::StopIteration;
+  }
+
+  const uint64_t rx_buffer_length = data.buffer_->length();
+  filter_.config_->stats().downstream_sess_rx_bytes_.add(rx_buffer_length);
+  filter_.config_->stats().downstream_sess_rx_datagrams_.inc();
+  (*socket)->send(*data.buffer_);
+
+  return Network::FilterStatus::StopIteration;
+}
+
+UdpProxyFilter::FlowTableClusterInfo::FlowSocketPtr*
+UdpProxyFilter::FlowTableClusterInfo::createFlow(
+    const FlowKey& key, const Network::UdpRecvData::LocalPeerAddresses& addresses,
+    Upstream::HostConstSharedPtr host) {
+  if (flows_.size() >= config_.max_flows_) {
+    ENVOY_LOG(debug, "cannot create new flow, the flow table is full.");
+    filter_.config_->stats().downstream_sess_flow_table_full_.inc();
+    return nullptr;
+  }
+
+  if (!cluster_.info()
+           ->resourceManager(Upstream::ResourcePriority::Default)
+           .connections()
+           .canCreate()) {
+    ENVOY_LOG(debug, "cannot create new connection.");
+    cluster_.info()->trafficStats()->upstream_cx_overflow_.inc();
+    return nullptr;
+  }
+
+  if (host == nullptr) {
+    host = chooseHost(addresses.peer_, nullptr);
+    if (host == nullptr) {
+      ENVOY_LOG(debug, "cannot find any valid host.");
+      cluster_.info()->trafficStats()->upstream_cx_none_healthy_.inc();
+      return nullptr;
+    }
+  }
+
+  FlowSocketPtr socket = acquireSocket(host);
+  if (socket == nullptr) {
+    return nullptr;
+  }
+  socket->attach(key, addresses);
+
+  filter_.config_->stats().downstream_sess_total_.inc();
+  filter_.config_->stats().downstream_sess_active_.inc();
+  cluster_.info()->resourceManager(Upstream::ResourcePriority::Default).connections().inc();
+  if (!expiry_timer_->enabled()) {
+    expiry_timer_->enableTimer(tick_);
+  }
+  return &flows_.insert(key, std::move(socket));
+}
+
+void UdpProxyFilter::FlowTableClusterInfo::releaseFlow(FlowSocketPtr&& socket, bool reuse_socket) {
+  socket->detach();
+  filter_.config_->stats().downstream_sess_active_.dec();
+  cluster_.info()->resourceManager(Upstream::ResourcePriority::Default).connections().dec();
+
+  if (!reuse_socket) {
+    return;
+  }
+  std::vector<FlowSocketPtr>& sockets = idle_sockets_[socket->host().get()];
+  if (sockets.size() < config_.max_idle_sockets_per_host_) {
+    sockets.push_back(std::move(socket));
+  }
+}
+
+UdpProxyFilter::FlowTableClusterInfo::FlowSocketPtr
+UdpProxyFilter::FlowTableClusterInfo::acquireSocket(const Upstream::HostConstSharedPtr& host) {
+  auto it = idle_sockets_.find(host.get());
+  if (it != idle_sockets_.end() && !it->second.empty()) {
+    FlowSocketPtr socket = std::move(it->second.back());
+    it->second.pop_back();
+    cluster_stats_.sess_socket_reused_.inc();
+    return socket;
+  }
+
+  // The socket is connected when created, as it is written to right away.
+  Network::SocketPtr socket = filter_.createUdpSocket(host);
+  const Api::SysCallIntResult rc = socket->ioHandle().connect(host->address());
+  if (SOCKET_FAILURE(rc.return_value_)) {
+    ENVOY_LOG(debug, "cannot connect: ({}) {}", rc.errno_, errorDetails(rc.errno_));
+    cluster_stats_.sess_tx_errors_.inc();
+    return nullptr;
+  }
+  if (filter_.config_->upstreamSocketConfig().prefer_gro_ &&
+      Api::OsSysCallsSingleton::get().supportsUdpGro()) {
+    Network::Socket::applyOptions(Network::SocketOptionFactory::buildUdpGroOptions(), *socket,
+                                  envoy::config::core::v3::SocketOption::STATE_BOUND);
+  }
+  ENVOY_LOG(debug, "creating new flow socket: upstream={}", host->address()->asStringView());
+  return std::make_unique<FlowSocket>(*this, host, std::move(socket));
+}
+
+void UdpProxyFilter::FlowTableClusterInfo::onExpiryTimer() {
+  flows_.advance([this](const FlowKey&, FlowSocketPtr& socket) {
+    filter_.config_->stats().idle_timeout_.inc();
+    releaseFlow(std::move(socket), true);
+  });
+  if (flows_.size() > 0) {
+    expiry_timer_->enableTimer(tick_);
+  }
+}
+
+UdpProxyFilter::FlowTableClusterInfo::FlowSocket::FlowSocket(
+    FlowTableClusterInfo& parent, const Upstream::HostConstSharedPtr& host,
+    Network::SocketPtr&& socket)
+    : parent_(parent), host_(host), socket_(std::move(socket)) {
+  socket_->ioHandle().initializeFileEvent(
+      parent_.filter_.read_callbacks_->udpListener().dispatcher(),
+      [this](uint32_t) { onReadReady(); }, Event::PlatformDefaultTriggerType,
+      Event::FileReadyType::Read);
+}
+
+void UdpProxyFilter::FlowTableClusterInfo::FlowSocket::attach(
+    const FlowKey& key, const Network::UdpRecvData::LocalPeerAddresses& addresses) {
+  key_ = key;
+  addresses_ = addresses;
+}
+
+void UdpProxyFilter::FlowTableClusterInfo::FlowSocket::detach() {
+  addresses_.local_.reset();
+  addresses_.peer_.reset();
+}
+
+void UdpProxyFilter::FlowTableClusterInfo::FlowSocket::send(const Buffer::Instance& buffer) {
+  const uint64_t tx_buffer_length = buffer.length();
+  ENVOY_LOG(trace, "writing {} byte datagram upstream: downstream={} local={} upstream={}",
+            tx_buffer_length, addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
+            host_->address()->asStringView());
+
+  const Api::IoCallUint64Result rc =
+      Network::Utility::writeToSocket(socket_->ioHandle(), buffer, nullptr, *host_->address());
+  if (!rc.ok()) {
+    parent_.cluster_stats_.sess_tx_errors_.inc();
+  } else {
+    parent_.cluster_stats_.sess_tx_datagrams_.inc();
+    parent_.cluster_.info()->trafficStats()->upstream_cx_tx_bytes_total_.add(tx_buffer_length);
+  }
+}
+
+void UdpProxyFilter::FlowTableClusterInfo::FlowSocket::onReadReady() {
+  // The upstream datagrams mark the flow active, as for the sessions.
+  if (addresses_.peer_ != nullptr) {
+    parent_.flows_.find(key_);
+  }
+
+  // The local address of the received datagrams is not used.
+  uint32_t packets_dropped = 0;
+  const Api::IoErrorPtr result = Network::Utility::readPacketsFromSocket(
+      socket_->ioHandle(), *host_->address(), *this, parent_.filter_.config_->timeSource(),
+      parent_.filter_.config_->upstreamSocketConfig().prefer_gro_, packets_dropped);
+  if (result == nullptr) {
+    socket_->ioHandle().activateFileEvents(Event::FileReadyType::Read);
+    return;
+  }
+  if (result->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+    parent_.cluster_stats_.sess_rx_errors_.inc();
+  }
+  // Flush out buffered data at the end of IO event.
+  parent_.filter_.read_callbacks_->udpListener().flush();
+}
+
+void UdpProxyFilter::FlowTableClusterInfo::FlowSocket::processPacket(
+    Network::Address::InstanceConstSharedPtr, Network::Address::InstanceConstSharedPtr,
+    Buffer::InstancePtr buffer, MonotonicTime) {
+  if (addresses_.peer_ == nullptr) {
+    // The datagrams received while the socket is idle belong to an expired flow.
+    parent_.cluster_stats_.sess_rx_datagrams_dropped_.inc();
+    return;
+  }
+
+  const uint64_t rx_buffer_length = buffer->length();
+  ENVOY_LOG(trace, "received {} byte datagram from upstream: downstream={} local={} upstream={}",
+            rx_buffer_length, addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
+            host_->address()->asStringView());
+  parent_.cluster_stats_.sess_rx_datagrams_.inc();
+  parent_.cluster_.info()->trafficStats()->upstream_cx_rx_bytes_total_.add(rx_buffer_length);
+
+  Network::UdpSendData data{addresses_.local_->ip(), *addresses_.peer_, *buffer};
+  const Api::IoCallUint64Result rc = parent_.filter_.read_callbacks_->udpListener().send(data);
+  if (!rc.ok()) {
+    parent_.filter_.config_->stats().downstream_sess_tx_errors_.inc();
+  } else {
+    parent_.filter_.config_->stats().downstream_sess_tx_bytes_.add(rx_buffer_length);
+    parent_.filter_.config_->stats().downstream_sess_tx_datagrams_.inc();
+  }
+}
+
 std::atomic<uint64_t> UdpProxyFilter::ActiveSession::next_global_session_id_;
 
 UdpProxyFilter::ActiveSession::ActiveSession(ClusterInfo& cluster,
@@ -300,6 +580,13 @@ UdpProxyFilter::UdpActiveSession::UdpActiveSession(
     : ActiveSession(cluster, std::move(addresses), std::move(host)),
       use_original_src_ip_(cluster.filter_.config_->usingOriginalSrcIp()) {}
 
+UdpProxyFilter::UdpActiveSession::~UdpActiveSession() {
+  // The datagrams not sent yet are dropped with the session.
+  if (!pending_upstream_sizes_.empty()) {
+    cluster_.filter_.sessions_pending_upstream_flush_.erase(this);
+  }
+}
+
 UdpProxyFilter::ActiveSession::~ActiveSession() {
   ENVOY_BUG(on_session_complete_called_, "onSessionComplete() not called");
 }
@@ -491,19 +778,97 @@ void UdpProxyFilter::UdpActiveSession::writeUpstream(Network::UdpRecvData& data)
 
   ASSERT((connected_ || use_original_src_ip_) && udp_socket_ && host_);
 
-  const uint64_t tx_buffer_length = data.buffer_->length();
-  ENVOY_LOG(trace, "writing {} byte datagram upstream: downstream={} local={} upstream={}",
-            tx_buffer_length, addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
-            host_->address()->asStringView());
+  if (use_gso_) {
+    // The datagram is moved without copy, and sent at the end of the event loop iteration.
+    if (pending_upstream_sizes_.empty()) {
+      cluster_.filter_.scheduleUpstreamFlush(*this);
+    }
+    pending_upstream_sizes_.push_back(data.buffer_->length());
+    pending_upstream_datagrams_.move(*data.buffer_);
+    return;
+  }
+
+  sendUpstream(*data.buffer_, 1);
+}
+
+void UdpProxyFilter::UdpActiveSession::flushUpstream() {
+  size_t next = 0;
+  while (next < pending_upstream_sizes_.size()) {
+    // Consecutive datagrams of the same size may be sent in a single GSO batch.
+    const uint64_t datagram_size = pending_upstream_sizes_[next];
+    uint64_t num_datagrams = 1;
+    while (next + num_datagrams < pending_upstream_sizes_.size() &&
+           pending_upstream_sizes_[next + num_datagrams] == datagram_size &&
+           num_datagrams < MaxGsoSegments &&
+           (num_datagrams + 1) * datagram_size <= MaxGsoBatchSize) {
+      ++num_datagrams;
+    }
+    next += num_datagrams;
+
+    Buffer::OwnedImpl batch;
+    batch.move(pending_upstream_datagrams_, num_datagrams * datagram_size);
+    // A single datagram is only segmented if it is larger than the segment size.
+    const uint64_t segment_size =
+        num_datagrams > 1 || datagram_size > gso_segment_size_ ? datagram_size : gso_segment_size_;
+    if (use_gso_ && setGsoSegmentSize(segment_size)) {
+      sendUpstream(batch, num_datagrams);
+      continue;
+    }
+    while (batch.length() > 0) {
+      Buffer::OwnedImpl datagram;
+      datagram.move(batch, datagram_size);
+      sendUpstream(datagram, 1);
+    }
+  }
+  ASSERT(pending_upstream_datagrams_.length() == 0);
+  pending_upstream_sizes_.clear();
+}
+
+bool UdpProxyFilter::UdpActiveSession::setGsoSegmentSize(uint64_t segment_size) {
+  if (segment_size == gso_segment_size_) {
+    return true;
+  }
+  // GSO is only used where the platform supports it, see UdpProxyFilterConfigImpl.
+  ASSERT(ENVOY_SOCKET_UDP_SEGMENT.hasValue());
+  const int value = static_cast<int>(segment_size);
+  const Api::SysCallIntResult rc =
+      udp_socket_->ioHandle().setOption(ENVOY_SOCKET_UDP_SEGMENT.level(),
+                                        ENVOY_SOCKET_UDP_SEGMENT.option(), &value, sizeof(value));
+  if (SOCKET_FAILURE(rc.return_value_)) {
+    ENVOY_LOG(debug, "cannot set the GSO segment size, disabling GSO: ({}) {}", rc.errno_,
+              errorDetails(rc.errno_));
+    use_gso_ = false;
+    return false;
+  }
+  gso_segment_size_ = segment_size;
+  return true;
+}
+
+void UdpProxyFilter::UdpActiveSession::sendUpstream(const Buffer::Instance& buffer,
+                                                    uint64_t num_datagrams) {
+  const uint64_t tx_buffer_length = buffer.length();
+  ENVOY_LOG(trace,
+            "writing {} byte(s) in {} datagram(s) upstream: downstream={} local={} upstream={}",
+            tx_buffer_length, num_datagrams, addresses_.peer_->asStringView(),
+            addresses_.local_->asStringView(), host_->address()->asStringView());
 
   const Network::Address::Ip* local_ip = use_original_src_ip_ ? addresses_.peer_->ip() : nullptr;
-  Api::IoCallUint64Result rc = Network::Utility::writeToSocket(
-      udp_socket_->ioHandle(), *data.buffer_, local_ip, *host_->address());
+  Api::IoCallUint64Result rc =
+      Network::Utility::writeToSocket(udp_socket_->ioHandle(), buffer, local_ip, *host_->address());
 
   if (!rc.ok()) {
-    cluster_.cluster_stats_.sess_tx_errors_.inc();
+    cluster_.cluster_stats_.sess_tx_errors_.add(num_datagrams);
+    if (num_datagrams > 1 && rc.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+      // The egress device may not support the segmentation of the datagrams.
+      ENVOY_LOG(debug, "GSO send failed, disabling GSO: {}", rc.err_->getErrorDetails());
+      setGsoSegmentSize(0);
+      use_gso_ = false;
+    }
   } else {
-    cluster_.cluster_stats_.sess_tx_datagrams_.inc();
+    cluster_.cluster_stats_.sess_tx_datagrams_.add(num_datagrams);
+    if (num_datagrams > 1) {
+      cluster_.cluster_stats_.sess_tx_gso_batches_.inc();
+    }
     cluster_.cluster_.info()->trafficStats()->upstream_cx_tx_bytes_total_.add(tx_buffer_length);
   }
 }
@@ -567,6 +932,15 @@ void UdpProxyFilter::UdpActiveSession::createUdpSocket(const Upstream::HostConst
             addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
             host->address()->asStringView());
 
+  const Network::ResolvedUdpSocketConfig& socket_config =
+      cluster_.filter_.config_->upstreamSocketConfig();
+  if (socket_config.prefer_gro_ && Api::OsSysCallsSingleton::get().supportsUdpGro()) {
+    // Without the socket option, the GRO reads of the upstream datagrams read them one at a time.
+    Network::Socket::applyOptions(Network::SocketOptionFactory::buildUdpGroOptions(), *udp_socket_,
+                                  envoy::config::core::v3::SocketOption::STATE_BOUND);
+  }
+  use_gso_ = socket_config.prefer_gso_;
+
   if (use_original_src_ip_) {
     const Network::Socket::OptionsSharedPtr socket_options =
         Network::SocketOptionFactory::buildIpTransparentOptions();
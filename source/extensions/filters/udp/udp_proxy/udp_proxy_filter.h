@@ -3,6 +3,7 @@
 #include "envoy/access_log/access_log.h"
 #include "envoy/config/accesslog/v3/accesslog.pb.h"
 #include "envoy/event/file_event.h"
+#include "envoy/event/schedulable_cb.h"
 #include "envoy/event/timer.h"
 #include "envoy/extensions/filters/udp/udp_proxy/v3/udp_proxy.pb.h"
 #include "envoy/http/header_evaluator.h"
@@ -13,6 +14,7 @@
 
 #include "source/common/access_log/access_log_impl.h"
 #include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/common/linked_object.h"
 #include "source/common/common/random_generator.h"
@@ -27,6 +29,7 @@
 #include "source/common/router/header_parser.h"
 #include "source/common/stream_info/stream_info_impl.h"
 #include "source/common/upstream/load_balancer_impl.h"
+#include "source/extensions/filters/udp/udp_proxy/flow_table.h"
 #include "source/extensions/filters/udp/udp_proxy/hash_policy_impl.h"
 #include "source/extensions/filters/udp/udp_proxy/router/router_impl.h"
 #include "source/extensions/filters/udp/udp_proxy/session_filters/filter.h"
@@ -46,6 +49,7 @@ using namespace UdpProxy::SessionFilters;
  * All UDP proxy downstream stats. @see stats_macros.h
  */
 #define ALL_UDP_PROXY_DOWNSTREAM_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(downstream_sess_flow_table_full)                                                         \
   COUNTER(downstream_sess_no_route)                                                                \
   COUNTER(downstream_sess_rx_bytes)                                                                \
   COUNTER(downstream_sess_rx_datagrams)                                                            \
@@ -71,7 +75,9 @@ struct UdpProxyDownstreamStats {
   COUNTER(sess_rx_datagrams)                                                                       \
   COUNTER(sess_rx_datagrams_dropped)                                                               \
   COUNTER(sess_rx_errors)                                                                          \
+  COUNTER(sess_socket_reused)                                                                      \
   COUNTER(sess_tx_datagrams)                                                                       \
+  COUNTER(sess_tx_gso_batches)                                                                     \
   COUNTER(sess_tunnel_success)                                                                     \
   COUNTER(sess_tunnel_failure)                                                                     \
   COUNTER(sess_tunnel_buffer_overflow)                                                             \
@@ -114,6 +120,16 @@ public:
 
 using UdpTunnelingConfigPtr = std::unique_ptr<const UdpTunnelingConfig>;
 
+/**
+ * Configuration for tracking the downstream flows in a flow table instead of sessions.
+ */
+struct FlowTableConfig {
+  // The maximum number of flows of each worker.
+  const uint32_t max_flows_;
+  // The maximum number of idle upstream sockets kept by each worker for each upstream host.
+  const uint32_t max_idle_sockets_per_host_;
+};
+
 class UdpProxyFilterConfig {
 public:
   virtual ~UdpProxyFilterConfig() = default;
@@ -137,6 +153,7 @@ public:
   virtual bool flushAccessLogOnTunnelConnected() const PURE;
   virtual const absl::optional<std::chrono::milliseconds>& accessLogFlushInterval() const PURE;
   virtual Random::RandomGenerator& randomGenerator() const PURE;
+  virtual const absl::optional<FlowTableConfig>& flowTableConfig() const PURE;
 };
 
 using UdpProxyFilterConfigSharedPtr = std::shared_ptr<const UdpProxyFilterConfig>;
@@ -473,6 +490,7 @@ public:
 private:
   class ActiveSession;
   class ClusterInfo;
+  class UdpActiveSession;
 
   struct ActiveReadFilter : public virtual ReadFilterCallbacks, LinkedObject<ActiveReadFilter> {
     ActiveReadFilter(ActiveSession& parent, ReadFilterSharedPtr filter)
@@ -626,7 +644,7 @@ private:
   public:
     UdpActiveSession(ClusterInfo& parent, Network::UdpRecvData::LocalPeerAddresses&& addresses,
                      const Upstream::HostConstSharedPtr& host);
-    ~UdpActiveSession() override = default;
+    ~UdpActiveSession() override;
 
     // ActiveSession
     bool createUpstream() override;
@@ -651,9 +669,17 @@ private:
       return Network::MAX_NUM_PACKETS_PER_EVENT_LOOP;
     }
 
+    /**
+     * Sends the datagrams written upstream since the last flush, the consecutive datagrams of the
+     * same size being sent with a single system call using GSO.
+     */
+    void flushUpstream();
+
   private:
     void onReadReady();
     void createUdpSocket(const Upstream::HostConstSharedPtr& host);
+    void sendUpstream(const Buffer::Instance& buffer, uint64_t num_datagrams);
+    bool setGsoSegmentSize(uint64_t segment_size);
 
     // The socket is used for writing packets to the selected upstream host as well as receiving
     // packets from the upstream host. Note that a a local ephemeral port is bound on the first
@@ -662,6 +688,14 @@ private:
     // The socket has been connected to avoid port exhaustion.
     bool connected_{};
     const bool use_original_src_ip_;
+    // Whether the datagrams written upstream are batched until the end of the event loop
+    // iteration, to be sent using GSO.
+    bool use_gso_{};
+    // The UDP_SEGMENT size set on the socket, or 0 if the sent datagrams are not segmented.
+    uint64_t gso_segment_size_{};
+    // The datagrams written upstream since the last flush, and their sizes.
+    Buffer::OwnedImpl pending_upstream_datagrams_;
+    std::vector<uint64_t> pending_upstream_sizes_;
   };
 
   /**
@@ -851,6 +885,81 @@ private:
     Network::FilterStatus onData(Network::UdpRecvData& data) override;
   };
 
+  /**
+   * Forwards the datagrams of the downstream flows without sessions, for proxies of very large
+   * numbers of short lived flows. The flows are kept in a flow table, and expired by a single
+   * coarse timer per cluster, which advances the table. Each flow is still mapped to a connected
+   * upstream socket, whose local port demultiplexes the datagrams of the upstream host, but the
+   * sockets of the expired flows are kept by upstream host and reused by the next flows to the
+   * host. This avoids the creation, the connection and the registration in the event loop of a
+   * socket for each flow.
+   */
+  class FlowTableClusterInfo : public ClusterInfo {
+  public:
+    FlowTableClusterInfo(UdpProxyFilter& filter, Upstream::ThreadLocalCluster& cluster);
+    ~FlowTableClusterInfo() override;
+
+    Network::FilterStatus onData(Network::UdpRecvData& data) override;
+
+  private:
+    /**
+     * A connected upstream socket, used by at most one flow at a time.
+     */
+    class FlowSocket : public Network::UdpPacketProcessor {
+    public:
+      FlowSocket(FlowTableClusterInfo& parent, const Upstream::HostConstSharedPtr& host,
+                 Network::SocketPtr&& socket);
+
+      const Upstream::HostConstSharedPtr& host() const { return host_; }
+      void attach(const FlowKey& key, const Network::UdpRecvData::LocalPeerAddresses& addresses);
+      void detach();
+      void send(const Buffer::Instance& buffer);
+
+      // Network::UdpPacketProcessor
+      void processPacket(Network::Address::InstanceConstSharedPtr local_address,
+                         Network::Address::InstanceConstSharedPtr peer_address,
+                         Buffer::InstancePtr buffer, MonotonicTime receive_time) override;
+      uint64_t maxDatagramSize() const override {
+        return parent_.filter_.config_->upstreamSocketConfig().max_rx_datagram_size_;
+      }
+      void onDatagramsDropped(uint32_t dropped) override {
+        parent_.cluster_stats_.sess_rx_datagrams_dropped_.add(dropped);
+      }
+      size_t numPacketsExpectedPerEventLoop() const final {
+        return Network::MAX_NUM_PACKETS_PER_EVENT_LOOP;
+      }
+
+    private:
+      void onReadReady();
+
+      FlowTableClusterInfo& parent_;
+      const Upstream::HostConstSharedPtr host_;
+      const Network::SocketPtr socket_;
+      // The flow using the socket. The addresses are null while the socket is idle.
+      FlowKey key_;
+      Network::UdpRecvData::LocalPeerAddresses addresses_;
+    };
+
+    using FlowSocketPtr = std::unique_ptr<FlowSocket>;
+
+    FlowSocketPtr* createFlow(const FlowKey& key,
+                              const Network::UdpRecvData::LocalPeerAddresses& addresses,
+                              Upstream::HostConstSharedPtr host);
+    // Releases the socket of a removed flow, which is kept for the next flows to the same host
+    // unless reuse_socket is false.
+    void releaseFlow(FlowSocketPtr&& socket, bool reuse_socket);
+    FlowSocketPtr acquireSocket(const Upstream::HostConstSharedPtr& host);
+    void onExpiryTimer();
+
+    const FlowTableConfig& config_;
+    const std::chrono::milliseconds tick_;
+    FlowTable<FlowSocketPtr> flows_;
+    const Event::TimerPtr expiry_timer_;
+    // The sockets of the expired flows, by upstream host.
+    absl::flat_hash_map<const Upstream::Host*, std::vector<FlowSocketPtr>> idle_sockets_;
+    const Envoy::Common::CallbackHandlePtr host_removal_cb_handle_;
+  };
+
   virtual Network::SocketPtr createUdpSocket(const Upstream::HostConstSharedPtr& host) {
     // Virtual so this can be overridden in unit tests.
     return std::make_unique<Network::SocketImpl>(Network::Socket::Type::Datagram, host->address(),
@@ -858,6 +967,8 @@ private:
   }
 
   void fillProxyStreamInfo();
+  void scheduleUpstreamFlush(UdpActiveSession& session);
+  void onUpstreamFlush();
 
   // Upstream::ClusterUpdateCallbacks
   void onClusterAddOrUpdate(absl::string_view cluster_name,
@@ -866,6 +977,10 @@ private:
 
   const UdpProxyFilterConfigSharedPtr config_;
   const Upstream::ClusterUpdateCallbacksHandlePtr cluster_update_callbacks_;
+  // The sessions with datagrams to send upstream at the end of the event loop iteration. Declared
+  // before the clusters so that the sessions may unregister themselves when destroyed.
+  absl::flat_hash_set<UdpActiveSession*> sessions_pending_upstream_flush_;
+  Event::SchedulableCallbackPtr upstream_flush_cb_;
   // Map for looking up cluster info with its name.
   absl::flat_hash_map<std::string, ClusterInfoPtr> cluster_infos_;
 
@@ -0,0 +1,313 @@
+#include "source/extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+#include "source/common/config/datasource.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+namespace {
+
+ThreadPoolPrivateKeyConnection* connectionFromSsl(SSL* ssl) {
+  return static_cast<ThreadPoolPrivateKeyConnection*>(
+      SSL_get_ex_data(ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex()));
+}
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t*, size_t*, size_t,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = connectionFromSsl(ssl);
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->start(OperationType::Sign, signature_algorithm, in, in_len);
+}
+
+ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t*, size_t*, size_t, const uint8_t* in,
+                                           size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = connectionFromSsl(ssl);
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->start(OperationType::Decrypt, 0, in, in_len);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  ThreadPoolPrivateKeyConnection* connection = connectionFromSsl(ssl);
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->complete(out, out_len, max_out);
+}
+
+} // namespace
+
+PrivateKeyOperationPool::PrivateKeyOperationPool(Thread::ThreadFactory& thread_factory,
+                                                 bssl::UniquePtr<EVP_PKEY> pkey,
+                                                 uint32_t num_threads, uint32_t max_batch_size,
+                                                 ThreadPoolPrivateKeyStats& stats)
+    : pkey_(std::move(pkey)), max_batch_size_(max_batch_size), stats_(stats) {
+  threads_.reserve(num_threads);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.push_back(
+        thread_factory.createThread([this]() { work(); }, Thread::Options{"private_key_pool"}));
+  }
+}
+
+PrivateKeyOperationPool::~PrivateKeyOperationPool() {
+  {
+    absl::MutexLock lock(&mu_);
+    terminating_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void PrivateKeyOperationPool::post(PrivateKeyOperationSharedPtr operation) {
+  stats_.queued_.inc();
+  absl::MutexLock lock(&mu_);
+  operations_.push_back(std::move(operation));
+}
+
+void PrivateKeyOperationPool::cancel(PrivateKeyOperation& operation) {
+  absl::MutexLock lock(&completion_mu_);
+  operation.connection_ = nullptr;
+}
+
+bool PrivateKeyOperationPool::cancelled(const PrivateKeyOperation& operation) {
+  absl::MutexLock lock(&completion_mu_);
+  return operation.connection_ == nullptr;
+}
+
+void PrivateKeyOperationPool::work() {
+  std::vector<PrivateKeyOperationSharedPtr> batch;
+  batch.reserve(max_batch_size_);
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &PrivateKeyOperationPool::hasOperationsOrTerminating));
+      if (terminating_) {
+        return;
+      }
+      while (!operations_.empty() && batch.size() < max_batch_size_) {
+        batch.push_back(std::move(operations_.front()));
+        operations_.pop_front();
+      }
+    }
+    stats_.queued_.sub(batch.size());
+    stats_.batches_.inc();
+
+    for (const PrivateKeyOperationSharedPtr& operation : batch) {
+      // Skip the work if the connection has gone away in the meantime.
+      if (!cancelled(*operation)) {
+        operation->succeeded_ = perform(pkey_.get(), *operation);
+      }
+    }
+    complete(batch);
+    batch.clear();
+  }
+}
+
+void PrivateKeyOperationPool::complete(std::vector<PrivateKeyOperationSharedPtr>& batch) {
+  absl::flat_hash_map<Event::Dispatcher*, std::vector<PrivateKeyOperationSharedPtr>> completions;
+  // The dispatchers outlive the connections they run, so they are safe to post to while a
+  // connection is alive; holding the lock keeps the connections from going away until the posts
+  // are done.
+  absl::MutexLock lock(&completion_mu_);
+  for (PrivateKeyOperationSharedPtr& operation : batch) {
+    if (operation->connection_ != nullptr) {
+      completions[&operation->dispatcher_].push_back(std::move(operation));
+    }
+  }
+  for (auto& [dispatcher, operations] : completions) {
+    dispatcher->post([operations = std::move(operations)]() {
+      for (const PrivateKeyOperationSharedPtr& operation : operations) {
+        // The connection is only cleared on this thread, so it can't go away while checking. It
+        // may have gone away while an earlier connection of the batch was resumed.
+        if (operation->connection_ != nullptr) {
+          operation->connection_->onOperationComplete();
+        }
+      }
+    });
+  }
+}
+
+bool PrivateKeyOperationPool::perform(EVP_PKEY* pkey, PrivateKeyOperation& operation) {
+  std::vector<uint8_t>& output = operation.output_;
+  output.resize(EVP_PKEY_size(pkey));
+  size_t output_len = output.size();
+
+  if (operation.type_ == OperationType::Sign) {
+    const uint16_t signature_algorithm = operation.signature_algorithm_;
+    if (SSL_get_signature_algorithm_key_type(signature_algorithm) != EVP_PKEY_id(pkey)) {
+      return false;
+    }
+    // The digest is null for Ed25519, which signs the whole message.
+    const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm);
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    if (!EVP_DigestSignInit(ctx.get(), &pctx, md, nullptr, pkey)) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1 /* salt length is digest length */))) {
+      return false;
+    }
+    if (!EVP_DigestSign(ctx.get(), output.data(), &output_len, operation.input_.data(),
+                        operation.input_.size())) {
+      return false;
+    }
+  } else {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey);
+    if (rsa == nullptr ||
+        !RSA_decrypt(rsa, &output_len, output.data(), output.size(), operation.input_.data(),
+                     operation.input_.size(), RSA_NO_PADDING)) {
+      return false;
+    }
+  }
+  output.resize(output_len);
+  return true;
+}
+
+ThreadPoolPrivateKeyConnection::ThreadPoolPrivateKeyConnection(
+    Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher,
+    PrivateKeyOperationPool& pool, ThreadPoolPrivateKeyStats& stats)
+    : cb_(cb), dispatcher_(dispatcher), pool_(pool), stats_(stats) {}
+
+ThreadPoolPrivateKeyConnection::~ThreadPoolPrivateKeyConnection() {
+  if (operation_ != nullptr && !completed_) {
+    pool_.cancel(*operation_);
+  }
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::start(OperationType type,
+                                                               uint16_t signature_algorithm,
+                                                               const uint8_t* in, size_t in_len) {
+  if (operation_ != nullptr) {
+    // BoringSSL runs a single private key operation at a time.
+    return ssl_private_key_failure;
+  }
+  if (type == OperationType::Sign) {
+    stats_.sign_.inc();
+  } else {
+    stats_.decrypt_.inc();
+  }
+  operation_ = std::make_shared<PrivateKeyOperation>(type, signature_algorithm, in, in_len,
+                                                     dispatcher_, *this);
+  completed_ = false;
+  pool_.post(operation_);
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::complete(uint8_t* out, size_t* out_len,
+                                                                  size_t max_out) {
+  if (operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!completed_) {
+    // The handshake was driven before the operation was done.
+    return ssl_private_key_retry;
+  }
+  const PrivateKeyOperationSharedPtr operation = std::move(operation_);
+  operation_ = nullptr;
+  if (!operation->succeeded_ || operation->output_.size() > max_out) {
+    stats_.failure_.inc();
+    return ssl_private_key_failure;
+  }
+  std::copy(operation->output_.begin(), operation->output_.end(), out);
+  *out_len = operation->output_.size();
+  return ssl_private_key_success;
+}
+
+void ThreadPoolPrivateKeyConnection::onOperationComplete() {
+  ASSERT(dispatcher_.isThreadSafe());
+  completed_ = true;
+  cb_.onPrivateKeyMethodComplete();
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::extensions::private_key_providers::thread_pool::v3::
+        ThreadPoolPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    : stats_{ALL_THREAD_POOL_PRIVATE_KEY_STATS(
+          POOL_COUNTER_PREFIX(factory_context.statsScope(), "thread_pool_private_key."),
+          POOL_GAUGE_PREFIX(factory_context.statsScope(), "thread_pool_private_key."))} {
+  Api::Api& api = factory_context.serverFactoryContext().api();
+  const std::string private_key = Config::DataSource::read(config.private_key(), false, api);
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey_ == nullptr) {
+    throw EnvoyException("Failed to read private key.");
+  }
+  const int key_type = EVP_PKEY_id(pkey_.get());
+  if (key_type != EVP_PKEY_RSA && key_type != EVP_PKEY_EC && key_type != EVP_PKEY_ED25519) {
+    throw EnvoyException("Only RSA, ECDSA and Ed25519 private keys are supported.");
+  }
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method_->sign = privateKeySign;
+  method_->decrypt = privateKeyDecrypt;
+  method_->complete = privateKeyComplete;
+
+  pool_ = std::make_unique<PrivateKeyOperationPool>(
+      api.threadFactory(), bssl::UpRef(pkey_), PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, threads, 2),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_batch_size, 16), stats_);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  if (SSL_get_ex_data(ssl, connectionIndex()) != nullptr) {
+    throw EnvoyException("Not registering the thread pool provider twice for the same context");
+  }
+  SSL_set_ex_data(ssl, connectionIndex(),
+                  new ThreadPoolPrivateKeyConnection(cb, dispatcher, *pool_, stats_));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  ThreadPoolPrivateKeyConnection* connection = connectionFromSsl(ssl);
+  SSL_set_ex_data(ssl, connectionIndex(), nullptr);
+  delete connection;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  switch (EVP_PKEY_id(pkey_.get())) {
+  case EVP_PKEY_RSA: {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa != nullptr && RSA_check_fips(rsa);
+  }
+  case EVP_PKEY_EC: {
+    const EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+    return ec_key != nullptr && EC_KEY_check_fips(ec_key);
+  }
+  default:
+    return false;
+  }
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() {
+    const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+    return index;
+  }());
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
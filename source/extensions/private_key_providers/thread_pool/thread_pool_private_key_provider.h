@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+/**
+ * All thread pool private key provider stats. @see stats_macros.h
+ */
+#define ALL_THREAD_POOL_PRIVATE_KEY_STATS(COUNTER, GAUGE)                                          \
+  COUNTER(batches)                                                                                 \
+  COUNTER(decrypt)                                                                                 \
+  COUNTER(failure)                                                                                 \
+  COUNTER(sign)                                                                                    \
+  GAUGE(queued, NeverImport)
+
+/**
+ * Struct definition for all thread pool private key provider stats. @see stats_macros.h
+ */
+struct ThreadPoolPrivateKeyStats {
+  ALL_THREAD_POOL_PRIVATE_KEY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+class ThreadPoolPrivateKeyConnection;
+
+enum class OperationType { Sign, Decrypt };
+
+/**
+ * A private key operation, shared between the connection starting it and the pool thread
+ * performing it.
+ */
+struct PrivateKeyOperation {
+  PrivateKeyOperation(OperationType type, uint16_t signature_algorithm, const uint8_t* in,
+                      size_t in_len, Event::Dispatcher& dispatcher,
+                      ThreadPoolPrivateKeyConnection& connection)
+      : type_(type), signature_algorithm_(signature_algorithm), input_(in, in + in_len),
+        dispatcher_(dispatcher), connection_(&connection) {}
+
+  const OperationType type_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> input_;
+  // Written by the pool thread before the completion is posted to the dispatcher.
+  std::vector<uint8_t> output_;
+  bool succeeded_{};
+  Event::Dispatcher& dispatcher_;
+  // Cleared on the dispatcher, under the pool's completion lock, when the connection goes away.
+  ThreadPoolPrivateKeyConnection* connection_;
+};
+
+using PrivateKeyOperationSharedPtr = std::shared_ptr<PrivateKeyOperation>;
+
+/**
+ * Threads performing private key operations with a single key. Each thread takes up to
+ * max_batch_size queued operations at once, and hands their completions back to each dispatcher
+ * with a single post, so that a worker is woken up once per batch rather than once per handshake.
+ */
+class PrivateKeyOperationPool final : Logger::Loggable<Logger::Id::connection> {
+public:
+  PrivateKeyOperationPool(Thread::ThreadFactory& thread_factory, bssl::UniquePtr<EVP_PKEY> pkey,
+                          uint32_t num_threads, uint32_t max_batch_size,
+                          ThreadPoolPrivateKeyStats& stats);
+  ~PrivateKeyOperationPool();
+
+  void post(PrivateKeyOperationSharedPtr operation);
+
+  /**
+   * Keeps the completion of an operation from being delivered to its connection. Must be called on
+   * the dispatcher of the operation.
+   */
+  void cancel(PrivateKeyOperation& operation);
+
+  /**
+   * Performs an operation with a key, setting its output.
+   * @return whether the operation succeeded.
+   */
+  static bool perform(EVP_PKEY* pkey, PrivateKeyOperation& operation);
+
+private:
+  void work();
+  bool cancelled(const PrivateKeyOperation& operation);
+  void complete(std::vector<PrivateKeyOperationSharedPtr>& batch);
+  bool hasOperationsOrTerminating() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return terminating_ || !operations_.empty();
+  }
+
+  const bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint32_t max_batch_size_;
+  ThreadPoolPrivateKeyStats& stats_;
+  absl::Mutex mu_;
+  std::deque<PrivateKeyOperationSharedPtr> operations_ ABSL_GUARDED_BY(mu_);
+  bool terminating_ ABSL_GUARDED_BY(mu_){};
+  // Serializes the connections going away with the completions being posted to their dispatchers.
+  absl::Mutex completion_mu_;
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+/**
+ * The state of the private key operations of a single SSL connection, which runs one operation
+ * at a time.
+ */
+class ThreadPoolPrivateKeyConnection {
+public:
+  ThreadPoolPrivateKeyConnection(Ssl::PrivateKeyConnectionCallbacks& cb,
+                                 Event::Dispatcher& dispatcher, PrivateKeyOperationPool& pool,
+                                 ThreadPoolPrivateKeyStats& stats);
+  ~ThreadPoolPrivateKeyConnection();
+
+  ssl_private_key_result_t start(OperationType type, uint16_t signature_algorithm,
+                                 const uint8_t* in, size_t in_len);
+  ssl_private_key_result_t complete(uint8_t* out, size_t* out_len, size_t max_out);
+
+  /**
+   * Called on the dispatcher once the pool has performed the operation.
+   */
+  void onOperationComplete();
+
+private:
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  PrivateKeyOperationPool& pool_;
+  ThreadPoolPrivateKeyStats& stats_;
+  PrivateKeyOperationSharedPtr operation_;
+  bool completed_{};
+};
+
+/**
+ * A software private key provider offloading the private key operations of TLS handshakes from
+ * the worker threads to a pool of threads.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider,
+                                           public Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::extensions::private_key_providers::thread_pool::v3::
+          ThreadPoolPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context);
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  bool isAvailable() override { return true; }
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override {
+    return method_;
+  }
+
+  static int connectionIndex();
+
+private:
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  ThreadPoolPrivateKeyStats stats_;
+  // Declared last, so that the threads are joined before the stats go away.
+  std::unique_ptr<PrivateKeyOperationPool> pool_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -12,6 +12,7 @@
 #include "source/common/protobuf/utility.h"
 #include "source/common/secret/sds_api.h"
 #include "source/common/ssl/certificate_validation_context_config_impl.h"
+#include "source/extensions/transport_sockets/tls/session_resumption.h"
 #include "source/extensions/transport_sockets/tls/ssl_handshaker.h"
 
 #include "openssl/ssl.h"
@@ -185,7 +186,8 @@ ContextConfigImpl::ContextConfigImpl(
                                                 default_min_protocol_version)),
       max_protocol_version_(tlsVersionFromProto(config.tls_params().tls_maximum_protocol_version(),
                                                 default_max_protocol_version)),
-      factory_context_(factory_context), tls_keylog_path_(config.key_log().path()) {
+      factory_context_(factory_context), tls_keylog_path_(config.key_log().path()),
+      kernel_tls_offload_(config.kernel_tls_offload()) {
   auto list_or_error = Network::Address::IpList::create(config.key_log().local_address_range());
   THROW_IF_STATUS_NOT_OK(list_or_error, throw);
   tls_keylog_local_ = std::move(list_or_error.value());
@@ -440,6 +442,24 @@ ServerContextConfigImpl::ServerContextConfigImpl(
     session_timeout_ =
         std::chrono::seconds(DurationUtil::durationToSeconds(config.session_timeout()));
   }
+
+  if (config.session_cache().has_key_value_config() &&
+      !config.session_cache().allow_unencrypted_key_value_store()) {
+    throwEnvoyExceptionOrPanic("The TLS session cache key value store requires "
+                               "allow_unencrypted_key_value_store, as session secrets are stored "
+                               "unencrypted");
+  }
+  if ((config.has_session_cache() && !disable_stateful_session_resumption_) ||
+      config.has_session_ticket_key_rotation()) {
+    auto manager = SessionResumptionManager::get(factory_context.serverFactoryContext());
+    if (config.has_session_cache() && !disable_stateful_session_resumption_) {
+      session_cache_ = manager->getSessionCache(config.session_cache());
+    }
+    if (config.has_session_ticket_key_rotation()) {
+      session_ticket_key_provider_ =
+          manager->getSessionTicketKeyProvider(config.session_ticket_key_rotation());
+    }
+  }
 }
 
 void ServerContextConfigImpl::setSecretUpdateCallback(std::function<void()> callback) {
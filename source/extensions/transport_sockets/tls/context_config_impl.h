@@ -48,6 +48,7 @@ public:
   AccessLog::AccessLogManager& accessLogManager() const override {
     return factory_context_.serverFactoryContext().accessLogManager();
   }
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
 
   bool isReady() const override {
     const bool tls_is_ready =
@@ -113,6 +114,7 @@ private:
   const std::string tls_keylog_path_;
   std::unique_ptr<Network::Address::IpList> tls_keylog_local_;
   std::unique_ptr<Network::Address::IpList> tls_keylog_remote_;
+  const bool kernel_tls_offload_;
 };
 
 class ClientContextConfigImpl : public ContextConfigImpl, public Envoy::Ssl::ClientContextConfig {
@@ -170,6 +172,10 @@ public:
   }
 
   bool fullScanCertsOnSNIMismatch() const override { return full_scan_certs_on_sni_mismatch_; }
+  Ssl::SessionCacheSharedPtr sessionCache() const override { return session_cache_; }
+  Ssl::SessionTicketKeyProviderSharedPtr sessionTicketKeyProvider() const override {
+    return session_ticket_key_provider_;
+  }
 
 private:
   static const unsigned DEFAULT_MIN_VERSION;
@@ -195,6 +201,8 @@ private:
   const bool disable_stateless_session_resumption_;
   const bool disable_stateful_session_resumption_;
   bool full_scan_certs_on_sni_mismatch_;
+  Ssl::SessionCacheSharedPtr session_cache_;
+  Ssl::SessionTicketKeyProviderSharedPtr session_ticket_key_provider_;
 };
 
 } // namespace Tls
@@ -92,7 +92,8 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
       ssl_versions_(stat_name_set_->add("ssl.versions")),
       ssl_curves_(stat_name_set_->add("ssl.curves")),
       ssl_sigalgs_(stat_name_set_->add("ssl.sigalgs")), capabilities_(config.capabilities()),
-      tls_keylog_local_(config.tlsKeyLogLocal()), tls_keylog_remote_(config.tlsKeyLogRemote()) {
+      tls_keylog_local_(config.tlsKeyLogLocal()), tls_keylog_remote_(config.tlsKeyLogRemote()),
+      kernel_tls_offload_(config.kernelTlsOffload()) {
 
   auto cert_validator_name = getCertValidatorName(config.certificateValidationContext());
   auto cert_validator_factory =
@@ -785,7 +786,8 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
                                      const std::vector<std::string>& server_names,
                                      TimeSource& time_source)
     : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()),
-      ocsp_staple_policy_(config.ocspStaplePolicy()),
+      session_ticket_key_provider_(config.sessionTicketKeyProvider()),
+      session_cache_(config.sessionCache()), ocsp_staple_policy_(config.ocspStaplePolicy()),
       full_scan_certs_on_sni_mismatch_(config.fullScanCertsOnSNIMismatch()) {
   if (config.tlsCertificates().empty() && !config.capabilities().provides_certificates) {
     throwEnvoyExceptionOrPanic("Server TlsCertificates must have a certificate specified");
@@ -844,7 +846,8 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
     // `SSL_CTX_set_tlsext_ticket_key_cb`.
     if (config.disableStatelessSessionResumption()) {
       SSL_CTX_set_options(ctx.ssl_ctx_.get(), SSL_OP_NO_TICKET);
-    } else if (!session_ticket_keys_.empty() && !config.capabilities().handles_session_resumption) {
+    } else if ((!session_ticket_keys_.empty() || session_ticket_key_provider_ != nullptr) &&
+               !config.capabilities().handles_session_resumption) {
       SSL_CTX_set_tlsext_ticket_key_cb(
           ctx.ssl_ctx_.get(),
           [](SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx,
@@ -860,6 +863,26 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
 
     if (config.disableStatefulSessionResumption()) {
       SSL_CTX_set_session_cache_mode(ctx.ssl_ctx_.get(), SSL_SESS_CACHE_OFF);
+    } else if (session_cache_ != nullptr && !config.capabilities().handles_session_resumption) {
+      // Replace the cache internal to the SSL_CTX with the shared one.
+      SSL_CTX_set_session_cache_mode(ctx.ssl_ctx_.get(),
+                                     SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+      SSL_CTX_sess_set_new_cb(ctx.ssl_ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+        static_cast<ServerContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)))
+            ->insertSession(session);
+        return 0; // Tell BoringSSL that we didn't take ownership of the session.
+      });
+      SSL_CTX_sess_set_get_cb(
+          ctx.ssl_ctx_.get(),
+          [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+            // The returned session is a new reference, owned by BoringSSL.
+            *out_copy = 0;
+            return static_cast<ServerContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)))
+                ->lookupSession(ssl, id, id_len);
+          });
+      SSL_CTX_sess_set_remove_cb(ctx.ssl_ctx_.get(), [](SSL_CTX* ssl_ctx, SSL_SESSION* session) {
+        static_cast<ServerContextImpl*>(SSL_CTX_get_app_data(ssl_ctx))->removeSession(session);
+      });
     }
 
     if (config.sessionTimeout() && !config.capabilities().handles_session_resumption) {
@@ -1055,14 +1078,20 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   const EVP_MD* hmac = EVP_sha256();
   const EVP_CIPHER* cipher = EVP_aes_256_cbc();
 
+  // Hold a reference to the rotated keys, as they may be swapped at any time.
+  const Ssl::SessionTicketKeysConstSharedPtr rotated_keys =
+      session_ticket_key_provider_ != nullptr ? session_ticket_key_provider_->keys() : nullptr;
+  const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey>& keys =
+      rotated_keys != nullptr ? *rotated_keys : session_ticket_keys_;
+
   if (encrypt == 1) {
     // Encrypt
-    RELEASE_ASSERT(!session_ticket_keys_.empty(), "");
+    RELEASE_ASSERT(!keys.empty(), "");
     // TODO(ggreenway): validate in SDS that session_ticket_keys_ cannot be empty,
     // or if we allow it to be emptied, reconfigure the context so this callback
     // isn't set.
 
-    const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key = session_ticket_keys_.front();
+    const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key = keys.front();
 
     static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                   "Expected key.name length");
@@ -1086,7 +1115,7 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   } else {
     // Decrypt
     bool is_enc_key = true; // first element is the encryption key
-    for (const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key : session_ticket_keys_) {
+    for (const Envoy::Ssl::ServerContextConfig::SessionTicketKey& key : keys) {
       static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                     "Expected key.name length");
       if (std::equal(key.name_.begin(), key.name_.end(), key_name)) {
@@ -1100,6 +1129,9 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
         }
 
         // If our current encryption was not the decryption key, renew
+        if (!is_enc_key) {
+          stats_.session_ticket_renewed_.inc();
+        }
         return is_enc_key ? 1  // success; do not renew
                           : 2; // success: renew key
       }
@@ -1110,6 +1142,50 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   }
 }
 
+void ServerContextImpl::insertSession(SSL_SESSION* session) {
+  unsigned int id_len;
+  const uint8_t* id = SSL_SESSION_get_id(session, &id_len);
+  if (id_len == 0) {
+    return;
+  }
+  uint8_t* data;
+  size_t len;
+  if (!SSL_SESSION_to_bytes(session, &data, &len)) {
+    return;
+  }
+  std::string serialized(reinterpret_cast<const char*>(data), len);
+  OPENSSL_free(data);
+  session_cache_->insert(absl::string_view(reinterpret_cast<const char*>(id), id_len),
+                         std::move(serialized),
+                         std::chrono::seconds(SSL_SESSION_get_timeout(session)));
+  stats_.session_cache_insert_.inc();
+}
+
+SSL_SESSION* ServerContextImpl::lookupSession(SSL* ssl, const uint8_t* id, int id_len) {
+  const absl::optional<std::string> serialized =
+      session_cache_->lookup(absl::string_view(reinterpret_cast<const char*>(id), id_len));
+  if (!serialized.has_value()) {
+    stats_.session_cache_miss_.inc();
+    return nullptr;
+  }
+  // BoringSSL checks that the session belongs to the same session ID context before resuming it.
+  SSL_SESSION* session =
+      SSL_SESSION_from_bytes(reinterpret_cast<const uint8_t*>(serialized->data()),
+                             serialized->size(), SSL_get_SSL_CTX(ssl));
+  if (session == nullptr) {
+    stats_.session_cache_miss_.inc();
+    return nullptr;
+  }
+  stats_.session_cache_hit_.inc();
+  return session;
+}
+
+void ServerContextImpl::removeSession(SSL_SESSION* session) {
+  unsigned int id_len;
+  const uint8_t* id = SSL_SESSION_get_id(session, &id_len);
+  session_cache_->remove(absl::string_view(reinterpret_cast<const char*>(id), id_len));
+}
+
 bool ServerContextImpl::isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello) {
   CBS client_hello;
   CBS_init(&client_hello, ssl_client_hello->client_hello, ssl_client_hello->client_hello_len);
@@ -76,6 +76,12 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return whether the record protection of the connections is offloaded to the kernel after
+   *         their handshake.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -153,6 +159,7 @@ protected:
   const Ssl::HandshakerCapabilities capabilities_;
   const Network::Address::IpList tls_keylog_local_;
   const Network::Address::IpList tls_keylog_remote_;
+  const bool kernel_tls_offload_;
   AccessLog::AccessLogFileSharedPtr tls_keylog_file_;
 };
 
@@ -207,6 +214,10 @@ private:
                          unsigned int inlen);
   int sessionTicketProcess(SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
                            HMAC_CTX* hmac_ctx, int encrypt);
+  // Shared session cache callbacks.
+  void insertSession(SSL_SESSION* session);
+  SSL_SESSION* lookupSession(SSL* ssl, const uint8_t* id, int id_len);
+  void removeSession(SSL_SESSION* session);
   bool isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
   bool isClientOcspCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
   OcspStapleAction ocspStapleAction(const TlsContext& ctx, bool client_ocsp_capable);
@@ -214,6 +225,8 @@ private:
   SessionContextID generateHashForSessionContextId(const std::vector<std::string>& server_names);
 
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
+  const Ssl::SessionTicketKeyProviderSharedPtr session_ticket_key_provider_;
+  const Ssl::SessionCacheSharedPtr session_cache_;
   const Ssl::ServerContextConfig::OcspStaplePolicy ocsp_staple_policy_;
   ServerNamesMap server_names_map_;
   bool has_rsa_{false};
@@ -0,0 +1,393 @@
+#include "source/extensions/transport_sockets/tls/kernel_tls.h"
+
+#include <array>
+#include <cstring>
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/utility.h"
+#include "source/common/network/io_socket_error_impl.h"
+
+#include "absl/container/fixed_array.h"
+#include "absl/strings/str_cat.h"
+#include "openssl/hkdf.h"
+#include "openssl/mem.h"
+
+#ifdef __linux__
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+namespace {
+
+constexpr uint8_t AlertCloseNotify = 0;
+constexpr uint8_t AlertUserCanceled = 90;
+constexpr uint8_t HandshakeNewSessionTicket = 4;
+constexpr uint8_t HandshakeKeyUpdate = 24;
+constexpr size_t HandshakeHeaderLength = 4;
+// The nonce of all the supported ciphers.
+constexpr size_t NonceLength = 12;
+
+// @return the key length of a supported cipher, or 0 if the cipher can't be offloaded.
+size_t keyLength(int cipher_nid) {
+  switch (cipher_nid) {
+  case NID_aes_128_gcm:
+    return 16;
+  case NID_aes_256_gcm:
+  case NID_chacha20_poly1305:
+    return 32;
+  default:
+    return 0;
+  }
+}
+
+// @return the length of the IV derived along with the keys, which for TLS 1.2 AES-GCM is only the
+// implicit part of the nonce.
+size_t fixedIvLength(uint16_t version, int cipher_nid) {
+  return version == TLS1_2_VERSION && cipher_nid != NID_chacha20_poly1305 ? 4 : NonceLength;
+}
+
+// HKDF-Expand-Label with an empty context, from RFC 8446.
+std::vector<uint8_t> hkdfExpandLabel(const EVP_MD* digest, const std::vector<uint8_t>& secret,
+                                     absl::string_view label, size_t length) {
+  const std::string full_label = absl::StrCat("tls13 ", label);
+  std::vector<uint8_t> info;
+  info.push_back(length >> 8);
+  info.push_back(length & 0xff);
+  info.push_back(full_label.size());
+  info.insert(info.end(), full_label.begin(), full_label.end());
+  info.push_back(0);
+  std::vector<uint8_t> out(length);
+  if (!HKDF_expand(out.data(), out.size(), digest, secret.data(), secret.size(), info.data(),
+                   info.size())) {
+    return {};
+  }
+  return out;
+}
+
+void cleanse(std::vector<uint8_t>& secret) { OPENSSL_cleanse(secret.data(), secret.size()); }
+
+#ifdef __linux__
+union CryptoInfo {
+  tls_crypto_info info_;
+  tls12_crypto_info_aes_gcm_128 aes_gcm_128_;
+  tls12_crypto_info_aes_gcm_256 aes_gcm_256_;
+  tls12_crypto_info_chacha20_poly1305 chacha20_poly1305_;
+};
+
+// The kernel takes the nonce split in a salt and an IV.
+template <class T>
+socklen_t fillCryptoInfo(T& info, uint16_t version, uint16_t cipher_type,
+                         absl::Span<const uint8_t> key,
+                         const std::array<uint8_t, NonceLength>& nonce, uint64_t sequence) {
+  static_assert(sizeof(info.salt) + sizeof(info.iv) == NonceLength);
+  ASSERT(key.size() == sizeof(info.key));
+  info.info.version = version;
+  info.info.cipher_type = cipher_type;
+  memcpy(info.key, key.data(), sizeof(info.key));
+  memcpy(info.salt, nonce.data(), sizeof(info.salt));
+  memcpy(info.iv, nonce.data() + sizeof(info.salt), sizeof(info.iv));
+  for (size_t i = 0; i < sizeof(info.rec_seq); i++) {
+    info.rec_seq[i] = sequence >> (8 * (sizeof(info.rec_seq) - 1 - i));
+  }
+  return sizeof(T);
+}
+#endif
+
+} // namespace
+
+KernelTlsOffload::KernelTlsOffload(Network::IoHandle& io_handle, uint16_t version,
+                                   const SSL_CIPHER* cipher, bool is_server, SslStats& stats)
+    : io_handle_(io_handle), version_(version), cipher_nid_(SSL_CIPHER_get_cipher_nid(cipher)),
+      digest_(SSL_CIPHER_get_handshake_digest(cipher)), is_server_(is_server), stats_(stats) {}
+
+KernelTlsOffload::~KernelTlsOffload() {
+  cleanse(read_secret_);
+  cleanse(write_secret_);
+}
+
+std::unique_ptr<KernelTlsOffload> KernelTlsOffload::create(SSL* ssl, Network::IoHandle& io_handle,
+                                                           SslStats& stats) {
+#ifdef __linux__
+  const uint16_t version = SSL_version(ssl);
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  // Records already buffered by BoringSSL must be read through it.
+  if ((version != TLS1_2_VERSION && version != TLS1_3_VERSION) || cipher == nullptr ||
+      keyLength(SSL_CIPHER_get_cipher_nid(cipher)) == 0 || SSL_has_pending(ssl)) {
+    stats.kernel_tls_unsupported_.inc();
+    return nullptr;
+  }
+  // This fails if the kernel TLS module is not loaded. The socket then remains a plain TCP socket.
+  if (io_handle.setOption(SOL_TCP, TCP_ULP, "tls", sizeof("tls")).return_value_ != 0) {
+    stats.kernel_tls_unavailable_.inc();
+    return nullptr;
+  }
+  std::unique_ptr<KernelTlsOffload> offload(
+      new KernelTlsOffload(io_handle, version, cipher, SSL_is_server(ssl), stats));
+  if (!offload->installKeys(ssl, Direction::Read)) {
+    stats.kernel_tls_unavailable_.inc();
+    return nullptr;
+  }
+  offload->write_offloaded_ = offload->installKeys(ssl, Direction::Write);
+  stats.kernel_tls_offload_.inc();
+  return offload;
+#else
+  UNREFERENCED_PARAMETER(ssl);
+  UNREFERENCED_PARAMETER(io_handle);
+  stats.kernel_tls_unavailable_.inc();
+  return nullptr;
+#endif
+}
+
+bool KernelTlsOffload::installKeys(SSL* ssl, Direction direction) {
+  const uint64_t sequence =
+      direction == Direction::Read ? SSL_get_read_sequence(ssl) : SSL_get_write_sequence(ssl);
+  if (version_ == TLS1_3_VERSION) {
+    bssl::Span<const uint8_t> read_secret;
+    bssl::Span<const uint8_t> write_secret;
+    if (!bssl::SSL_get_traffic_secrets(ssl, &read_secret, &write_secret)) {
+      return false;
+    }
+    std::vector<uint8_t>& secret = direction == Direction::Read ? read_secret_ : write_secret_;
+    const bssl::Span<const uint8_t> current =
+        direction == Direction::Read ? read_secret : write_secret;
+    secret.assign(current.begin(), current.end());
+    return installTrafficSecret(direction, secret, sequence);
+  }
+
+  // The TLS 1.2 key block of AEAD ciphers is the client key, the server key, the client IV and the
+  // server IV.
+  const size_t key_length = keyLength(cipher_nid_);
+  const size_t iv_length = fixedIvLength(version_, cipher_nid_);
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (key_block.size() != 2 * (key_length + iv_length) ||
+      !SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return false;
+  }
+  const bool client_keys = (direction == Direction::Write) != is_server_;
+  const bool installed = setCryptoInfo(
+      direction, absl::MakeConstSpan(key_block.data() + (client_keys ? 0 : key_length), key_length),
+      absl::MakeConstSpan(key_block.data() + 2 * key_length + (client_keys ? 0 : iv_length),
+                          iv_length),
+      sequence);
+  cleanse(key_block);
+  return installed;
+}
+
+bool KernelTlsOffload::installTrafficSecret(Direction direction,
+                                            const std::vector<uint8_t>& secret,
+                                            uint64_t sequence) {
+  std::vector<uint8_t> key = hkdfExpandLabel(digest_, secret, "key", keyLength(cipher_nid_));
+  std::vector<uint8_t> iv = hkdfExpandLabel(digest_, secret, "iv", NonceLength);
+  const bool installed = !key.empty() && !iv.empty() && setCryptoInfo(direction, key, iv, sequence);
+  cleanse(key);
+  cleanse(iv);
+  return installed;
+}
+
+bool KernelTlsOffload::setCryptoInfo(Direction direction, absl::Span<const uint8_t> key,
+                                     absl::Span<const uint8_t> iv, uint64_t sequence) {
+#ifdef __linux__
+  std::array<uint8_t, NonceLength> nonce;
+  memcpy(nonce.data(), iv.data(), iv.size());
+  if (iv.size() < NonceLength) {
+    // The explicit part of TLS 1.2 AES-GCM nonces is the sequence number of the record.
+    ASSERT(iv.size() + sizeof(uint64_t) == NonceLength);
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      nonce[iv.size() + i] = sequence >> (8 * (sizeof(uint64_t) - 1 - i));
+    }
+  }
+  const uint16_t version = version_ == TLS1_3_VERSION ? TLS_1_3_VERSION : TLS_1_2_VERSION;
+  CryptoInfo info{};
+  socklen_t size;
+  switch (cipher_nid_) {
+  case NID_aes_128_gcm:
+    size = fillCryptoInfo(info.aes_gcm_128_, version, TLS_CIPHER_AES_GCM_128, key, nonce, sequence);
+    break;
+  case NID_aes_256_gcm:
+    size = fillCryptoInfo(info.aes_gcm_256_, version, TLS_CIPHER_AES_GCM_256, key, nonce, sequence);
+    break;
+  case NID_chacha20_poly1305:
+    size = fillCryptoInfo(info.chacha20_poly1305_, version, TLS_CIPHER_CHACHA20_POLY1305, key,
+                          nonce, sequence);
+    break;
+  default:
+    return false;
+  }
+  const Api::SysCallIntResult result = io_handle_.setOption(
+      SOL_TLS, direction == Direction::Read ? TLS_RX : TLS_TX, &info, size);
+  OPENSSL_cleanse(&info, sizeof(info));
+  OPENSSL_cleanse(nonce.data(), nonce.size());
+  if (result.return_value_ != 0) {
+    ENVOY_LOG(debug, "failed to install kernel TLS {} keys: {}",
+              direction == Direction::Read ? "read" : "write", errorDetails(result.errno_));
+    return false;
+  }
+  return true;
+#else
+  UNREFERENCED_PARAMETER(direction);
+  UNREFERENCED_PARAMETER(key);
+  UNREFERENCED_PARAMETER(iv);
+  UNREFERENCED_PARAMETER(sequence);
+  return false;
+#endif
+}
+
+Api::IoCallUint64Result KernelTlsOffload::read(Buffer::RawSlice* slices, uint64_t num_slices,
+                                               uint8_t& record_type) {
+#ifdef __linux__
+  absl::FixedArray<iovec> iov(num_slices);
+  for (uint64_t i = 0; i < num_slices; i++) {
+    iov[i].iov_base = slices[i].mem_;
+    iov[i].iov_len = slices[i].len_;
+  }
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr message{};
+  message.msg_iov = iov.begin();
+  message.msg_iovlen = num_slices;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  // The kernel returns the records of a single type at a time, along with their type.
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().recvmsg(io_handle_.fdDoNotUse(), &message, 0);
+  if (result.return_value_ < 0) {
+    return {0, result.errno_ == SOCKET_ERROR_AGAIN
+                   ? Network::IoSocketError::getIoSocketEagainError()
+                   : Network::IoSocketError::create(result.errno_)};
+  }
+  record_type = RecordTypeApplicationData;
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&message, cmsg)) {
+    if (cmsg->cmsg_level == SOL_TLS && cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+      record_type = *CMSG_DATA(cmsg);
+    }
+  }
+  return {static_cast<uint64_t>(result.return_value_), Api::IoError::none()};
+#else
+  UNREFERENCED_PARAMETER(slices);
+  UNREFERENCED_PARAMETER(num_slices);
+  UNREFERENCED_PARAMETER(record_type);
+  return {0, Network::IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+#endif
+}
+
+KernelTlsOffload::ControlRecordAction
+KernelTlsOffload::onControlRecord(uint8_t record_type, absl::string_view payload) {
+  switch (record_type) {
+  case RecordTypeAlert:
+    if (payload.size() == 2 && static_cast<uint8_t>(payload[1]) == AlertCloseNotify) {
+      return ControlRecordAction::EndStream;
+    }
+    if (payload.size() == 2 && static_cast<uint8_t>(payload[1]) == AlertUserCanceled) {
+      return ControlRecordAction::Continue;
+    }
+    ENVOY_LOG(debug, "kernel TLS connection received alert {}",
+              payload.size() == 2 ? static_cast<uint8_t>(payload[1]) : -1);
+    return ControlRecordAction::Close;
+  case RecordTypeHandshake:
+    while (!payload.empty()) {
+      // Messages split across records are not expected after the handshake.
+      if (payload.size() < HandshakeHeaderLength) {
+        return ControlRecordAction::Close;
+      }
+      const uint8_t type = payload[0];
+      const size_t length = (static_cast<uint8_t>(payload[1]) << 16) |
+                            (static_cast<uint8_t>(payload[2]) << 8) |
+                            static_cast<uint8_t>(payload[3]);
+      if (payload.size() < HandshakeHeaderLength + length || version_ != TLS1_3_VERSION) {
+        // TLS 1.2 renegotiation is not supported.
+        return ControlRecordAction::Close;
+      }
+      if (type == HandshakeKeyUpdate && length == 1) {
+        if (!onKeyUpdate(payload[HandshakeHeaderLength] != 0)) {
+          return ControlRecordAction::Close;
+        }
+      } else if (type != HandshakeNewSessionTicket) {
+        // Session tickets are dropped: they can't be handed to BoringSSL any more.
+        return ControlRecordAction::Close;
+      }
+      payload.remove_prefix(HandshakeHeaderLength + length);
+    }
+    return ControlRecordAction::Continue;
+  default:
+    return ControlRecordAction::Close;
+  }
+}
+
+bool KernelTlsOffload::onKeyUpdate(bool update_requested) {
+  stats_.kernel_tls_key_update_.inc();
+  // The read sequence numbers restart from zero with the new keys. Older kernels can't change the
+  // keys of a socket, in which case the connection is closed.
+  std::vector<uint8_t> read_secret =
+      hkdfExpandLabel(digest_, read_secret_, "traffic upd", read_secret_.size());
+  cleanse(read_secret_);
+  read_secret_ = std::move(read_secret);
+  if (read_secret_.empty() || !installTrafficSecret(Direction::Read, read_secret_, 0)) {
+    return false;
+  }
+  if (!update_requested) {
+    return true;
+  }
+  if (!write_offloaded_) {
+    // BoringSSL owns the write keys, but never saw the key update.
+    return false;
+  }
+  // Answer with a key update under the current keys, then switch to the new ones.
+  static constexpr std::array<uint8_t, 5> KeyUpdateNotRequested{HandshakeKeyUpdate, 0, 0, 1, 0};
+  if (!sendRecord(RecordTypeHandshake, KeyUpdateNotRequested)) {
+    return false;
+  }
+  std::vector<uint8_t> write_secret =
+      hkdfExpandLabel(digest_, write_secret_, "traffic upd", write_secret_.size());
+  cleanse(write_secret_);
+  write_secret_ = std::move(write_secret);
+  return !write_secret_.empty() && installTrafficSecret(Direction::Write, write_secret_, 0);
+}
+
+bool KernelTlsOffload::sendCloseNotify() {
+  ASSERT(write_offloaded_);
+  static constexpr std::array<uint8_t, 2> CloseNotify{1 /* warning */, AlertCloseNotify};
+  return sendRecord(RecordTypeAlert, CloseNotify);
+}
+
+bool KernelTlsOffload::sendRecord(uint8_t record_type, absl::Span<const uint8_t> payload) {
+#ifdef __linux__
+  iovec iov{const_cast<uint8_t*>(payload.data()), payload.size()};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint8_t))]{};
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = record_type;
+  // Control records are tiny, so a short write only happens if the socket is full.
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().sendmsg(io_handle_.fdDoNotUse(), &message, 0);
+  return result.return_value_ == static_cast<ssize_t>(payload.size());
+#else
+  UNREFERENCED_PARAMETER(record_type);
+  UNREFERENCED_PARAMETER(payload);
+  return false;
+#endif
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/api/io_error.h"
+#include "envoy/buffer/buffer.h"
+#include "envoy/network/io_handle.h"
+
+#include "source/common/common/logger.h"
+#include "source/extensions/transport_sockets/tls/stats.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Offloads the record protection of an established TLS connection to the kernel (Linux kernel
+ * TLS). Once offloaded, the application data of the connection is read and written as plaintext
+ * on the socket, and the other records, i.e. alerts and post-handshake messages, are handled here
+ * rather than by BoringSSL.
+ */
+class KernelTlsOffload : Logger::Loggable<Logger::Id::connection> {
+public:
+  enum class ControlRecordAction { Continue, EndStream, Close };
+
+  static constexpr uint8_t RecordTypeAlert = 21;
+  static constexpr uint8_t RecordTypeHandshake = 22;
+  static constexpr uint8_t RecordTypeApplicationData = 23;
+
+  /**
+   * Offloads a connection whose handshake just completed. Reading is offloaded first, and writing
+   * only if reading was, so that BoringSSL never processes a post-handshake message it would need
+   * to answer with keys it no longer owns.
+   * @param ssl the connection.
+   * @param io_handle the socket of the connection.
+   * @param stats the stats of the context of the connection.
+   * @return the offload, or nullptr if nothing could be offloaded, e.g. for an unsupported cipher
+   *         or if the kernel lacks TLS support, in which case the connection stays in user space.
+   */
+  static std::unique_ptr<KernelTlsOffload> create(SSL* ssl, Network::IoHandle& io_handle,
+                                                  SslStats& stats);
+
+  ~KernelTlsOffload();
+
+  /**
+   * @return whether the records written are protected by the kernel. If not, writes still go
+   *         through BoringSSL.
+   */
+  bool writeOffloaded() const { return write_offloaded_; }
+
+  /**
+   * Reads the plaintext of the next records of a single type.
+   * @param slices the slices to read into.
+   * @param num_slices the number of slices.
+   * @param record_type supplies the type of the records read.
+   * @return the number of bytes read, or the error.
+   */
+  Api::IoCallUint64Result read(Buffer::RawSlice* slices, uint64_t num_slices,
+                               uint8_t& record_type);
+
+  /**
+   * Handles the plaintext of an alert or handshake record, answering key updates.
+   * @param record_type the type of the record.
+   * @param payload the plaintext of the record.
+   * @return what the connection should do next.
+   */
+  ControlRecordAction onControlRecord(uint8_t record_type, absl::string_view payload);
+
+  /**
+   * Sends a close_notify alert. Only valid if writing is offloaded.
+   * @return whether the alert was sent.
+   */
+  bool sendCloseNotify();
+
+private:
+  enum class Direction { Read, Write };
+
+  KernelTlsOffload(Network::IoHandle& io_handle, uint16_t version, const SSL_CIPHER* cipher,
+                   bool is_server, SslStats& stats);
+
+  bool installKeys(SSL* ssl, Direction direction);
+  bool installTrafficSecret(Direction direction, const std::vector<uint8_t>& secret,
+                            uint64_t sequence);
+  bool setCryptoInfo(Direction direction, absl::Span<const uint8_t> key,
+                     absl::Span<const uint8_t> iv, uint64_t sequence);
+  bool onKeyUpdate(bool update_requested);
+  bool sendRecord(uint8_t record_type, absl::Span<const uint8_t> payload);
+
+  Network::IoHandle& io_handle_;
+  const uint16_t version_;
+  const int cipher_nid_;
+  const EVP_MD* const digest_;
+  const bool is_server_;
+  SslStats& stats_;
+  bool write_offloaded_{};
+  // The current TLS 1.3 traffic secrets, from which the keys are derived again on key updates.
+  std::vector<uint8_t> read_secret_;
+  std::vector<uint8_t> write_secret_;
+};
+
+using KernelTlsOffloadPtr = std::unique_ptr<KernelTlsOffload>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
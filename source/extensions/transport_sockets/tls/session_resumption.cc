@@ -0,0 +1,302 @@
+#include "source/extensions/transport_sockets/tls/session_resumption.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/hex.h"
+#include "source/common/config/utility.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/hash/hash.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "openssl/rand.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+SINGLETON_MANAGER_REGISTRATION(tls_session_resumption_manager);
+
+namespace {
+
+// Removes an entry of the manager, unless it was replaced by a new one since its last reference
+// was released.
+template <class T>
+void eraseIfExpired(absl::flat_hash_map<uint64_t, std::weak_ptr<T>>& entries,
+                    uint64_t config_hash) {
+  auto it = entries.find(config_hash);
+  if (it != entries.end() && it->second.expired()) {
+    entries.erase(it);
+  }
+}
+
+// Destroys an entry on the main thread, which created its timers and key value store. The last
+// reference to an entry may be released on a worker, by a socket owning its TLS context.
+template <class T> void deleteOnMainThread(Event::Dispatcher& main_dispatcher, T* object) {
+  if (main_dispatcher.isThreadSafe()) {
+    delete object;
+    return;
+  }
+  // Destroyed with the callback, should the dispatcher exit before running it.
+  main_dispatcher.post([object = std::unique_ptr<T>(object)]() mutable { object.reset(); });
+}
+
+} // namespace
+
+ShardedSessionCache::ShardedSessionCache(uint32_t max_entries, uint32_t num_shards,
+                                         TimeSource& time_source,
+                                         Event::Dispatcher& main_dispatcher,
+                                         KeyValueStorePtr&& store)
+    : max_entries_per_shard_(std::max<uint32_t>(1, max_entries / num_shards)),
+      time_source_(time_source), main_dispatcher_(main_dispatcher), store_(std::move(store)),
+      shards_(num_shards) {
+  if (store_ != nullptr) {
+    loadFromStore();
+  }
+}
+
+ShardedSessionCache::Shard& ShardedSessionCache::shardFor(absl::string_view session_id) {
+  return shards_[absl::Hash<absl::string_view>{}(session_id) % shards_.size()];
+}
+
+void ShardedSessionCache::insert(absl::string_view session_id, std::string&& session,
+                                 std::chrono::seconds timeout) {
+  const SystemTime expiry = time_source_.systemTime() + timeout;
+  if (store_ != nullptr) {
+    updateStore(session_id, session, timeout);
+  }
+  Shard& shard = shardFor(session_id);
+  absl::MutexLock lock(&shard.mu_);
+  insertIntoShard(shard, session_id, std::move(session), expiry);
+}
+
+void ShardedSessionCache::insertIntoShard(Shard& shard, absl::string_view session_id,
+                                          std::string&& session, SystemTime expiry) {
+  auto it = shard.entries_.find(session_id);
+  if (it != shard.entries_.end()) {
+    eraseFromShard(shard, it);
+  } else if (shard.entries_.size() >= max_entries_per_shard_) {
+    eraseFromShard(shard, shard.entries_.find(shard.ages_.front()));
+  }
+  shard.ages_.emplace_back(session_id);
+  shard.entries_.emplace(session_id,
+                         Entry{std::move(session), expiry, std::prev(shard.ages_.end())});
+}
+
+void ShardedSessionCache::eraseFromShard(Shard& shard,
+                                         absl::flat_hash_map<std::string, Entry>::iterator it) {
+  ASSERT(it != shard.entries_.end());
+  shard.ages_.erase(it->second.age_it_);
+  shard.entries_.erase(it);
+}
+
+absl::optional<std::string> ShardedSessionCache::lookup(absl::string_view session_id) {
+  Shard& shard = shardFor(session_id);
+  absl::MutexLock lock(&shard.mu_);
+  auto it = shard.entries_.find(session_id);
+  if (it == shard.entries_.end()) {
+    return absl::nullopt;
+  }
+  if (it->second.expiry_ <= time_source_.systemTime()) {
+    // The store expires the entry by itself.
+    eraseFromShard(shard, it);
+    return absl::nullopt;
+  }
+  return it->second.session_;
+}
+
+void ShardedSessionCache::remove(absl::string_view session_id) {
+  {
+    Shard& shard = shardFor(session_id);
+    absl::MutexLock lock(&shard.mu_);
+    auto it = shard.entries_.find(session_id);
+    if (it == shard.entries_.end()) {
+      return;
+    }
+    eraseFromShard(shard, it);
+  }
+  if (store_ != nullptr) {
+    updateStore(session_id, "", absl::nullopt);
+  }
+}
+
+void ShardedSessionCache::updateStore(absl::string_view session_id, std::string session,
+                                      absl::optional<std::chrono::seconds> timeout) {
+  std::string key = Hex::encode(reinterpret_cast<const uint8_t*>(session_id.data()),
+                                session_id.size());
+  std::string value;
+  if (!session.empty()) {
+    // The expiry is stored along with the session, as the store only supports relative timeouts.
+    const SystemTime expiry = time_source_.systemTime() + timeout.value();
+    value = absl::StrCat(
+        std::chrono::duration_cast<std::chrono::seconds>(expiry.time_since_epoch()).count(), "\n",
+        session);
+  }
+  main_dispatcher_.post([this, weak_alive = std::weak_ptr<bool>(still_alive_), key = std::move(key),
+                         value = std::move(value), timeout]() {
+    if (weak_alive.expired()) {
+      return;
+    }
+    if (value.empty()) {
+      store_->remove(key);
+    } else {
+      store_->addOrUpdate(key, value, timeout);
+    }
+  });
+}
+
+void ShardedSessionCache::loadFromStore() {
+  const SystemTime now = time_source_.systemTime();
+  uint64_t loaded = 0;
+  store_->iterate([this, now, &loaded](const std::string& key, const std::string& value) {
+    const std::vector<uint8_t> session_id = Hex::decode(key);
+    const size_t separator = value.find('\n');
+    int64_t expiry_seconds;
+    if (session_id.empty() || separator == std::string::npos ||
+        !absl::SimpleAtoi(absl::string_view(value).substr(0, separator), &expiry_seconds)) {
+      ENVOY_LOG(warn, "Unable to parse TLS session cache entry '{}'", key);
+      return KeyValueStore::Iterate::Continue;
+    }
+    const SystemTime expiry{std::chrono::seconds(expiry_seconds)};
+    if (expiry <= now) {
+      return KeyValueStore::Iterate::Continue;
+    }
+    const absl::string_view id(reinterpret_cast<const char*>(session_id.data()), session_id.size());
+    Shard& shard = shardFor(id);
+    absl::MutexLock lock(&shard.mu_);
+    insertIntoShard(shard, id, value.substr(separator + 1), expiry);
+    loaded++;
+    return KeyValueStore::Iterate::Continue;
+  });
+  ENVOY_LOG(debug, "loaded {} TLS sessions from the key value store", loaded);
+}
+
+RotatingSessionTicketKeyProvider::RotatingSessionTicketKeyProvider(
+    std::chrono::milliseconds rotation_interval, uint32_t max_keys,
+    Event::Dispatcher& main_dispatcher)
+    : rotation_interval_(rotation_interval), max_keys_(max_keys),
+      rotation_timer_(main_dispatcher.createTimer([this]() {
+        rotate();
+        rotation_timer_->enableTimer(rotation_interval_);
+      })),
+      keys_(std::make_shared<const std::vector<Ssl::ServerContextConfig::SessionTicketKey>>(
+          1, generateKey())) {
+  rotation_timer_->enableTimer(rotation_interval_);
+}
+
+Ssl::SessionTicketKeysConstSharedPtr RotatingSessionTicketKeyProvider::keys() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return keys_;
+}
+
+void RotatingSessionTicketKeyProvider::rotate() {
+  auto keys = std::make_shared<std::vector<Ssl::ServerContextConfig::SessionTicketKey>>();
+  keys->reserve(max_keys_);
+  keys->push_back(generateKey());
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    for (const auto& key : *keys_) {
+      if (keys->size() == max_keys_) {
+        break;
+      }
+      keys->push_back(key);
+    }
+  }
+  absl::MutexLock lock(&mu_);
+  keys_ = std::move(keys);
+  ENVOY_LOG(debug, "rotated the TLS session ticket keys");
+}
+
+Ssl::ServerContextConfig::SessionTicketKey RotatingSessionTicketKeyProvider::generateKey() {
+  Ssl::ServerContextConfig::SessionTicketKey key;
+  RELEASE_ASSERT(RAND_bytes(key.name_.data(), key.name_.size()) == 1, "");
+  RELEASE_ASSERT(RAND_bytes(key.hmac_key_.data(), key.hmac_key_.size()) == 1, "");
+  RELEASE_ASSERT(RAND_bytes(key.aes_key_.data(), key.aes_key_.size()) == 1, "");
+  return key;
+}
+
+Ssl::SessionCacheSharedPtr SessionResumptionManager::getSessionCache(
+    const envoy::extensions::transport_sockets::tls::v3::TlsSessionCache& config) {
+  const uint64_t config_hash = MessageUtil::hash(config);
+  absl::MutexLock lock(&mu_);
+  std::weak_ptr<Ssl::SessionCache>& entry = session_caches_[config_hash];
+  Ssl::SessionCacheSharedPtr cache = entry.lock();
+  if (cache == nullptr) {
+    KeyValueStorePtr store;
+    if (config.has_key_value_config()) {
+      auto& factory = Config::Utility::getAndCheckFactory<KeyValueStoreFactory>(
+          config.key_value_config().config());
+      store = factory.createStore(config.key_value_config(),
+                                  server_context_.messageValidationVisitor(),
+                                  server_context_.mainThreadDispatcher(),
+                                  server_context_.api().fileSystem());
+    }
+    cache = Ssl::SessionCacheSharedPtr(
+        new ShardedSessionCache(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 100000),
+                                PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, shards, 16),
+                                server_context_.timeSource(),
+                                server_context_.mainThreadDispatcher(), std::move(store)),
+        [manager = weak_from_this(), &main_dispatcher = server_context_.mainThreadDispatcher(),
+         config_hash](Ssl::SessionCache* cache) {
+          deleteOnMainThread(main_dispatcher, cache);
+          std::shared_ptr<SessionResumptionManager> locked_manager = manager.lock();
+          if (locked_manager != nullptr) {
+            locked_manager->removeSessionCache(config_hash);
+          }
+        });
+    entry = cache;
+  }
+  return cache;
+}
+
+Ssl::SessionTicketKeyProviderSharedPtr SessionResumptionManager::getSessionTicketKeyProvider(
+    const envoy::extensions::transport_sockets::tls::v3::TlsSessionTicketKeyRotation& config) {
+  const uint64_t config_hash = MessageUtil::hash(config);
+  absl::MutexLock lock(&mu_);
+  std::weak_ptr<Ssl::SessionTicketKeyProvider>& entry = ticket_key_providers_[config_hash];
+  Ssl::SessionTicketKeyProviderSharedPtr provider = entry.lock();
+  if (provider == nullptr) {
+    provider = Ssl::SessionTicketKeyProviderSharedPtr(
+        new RotatingSessionTicketKeyProvider(
+            std::chrono::milliseconds(
+                PROTOBUF_GET_MS_OR_DEFAULT(config, rotation_interval, 60 * 60 * 1000)),
+            PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_keys, 3),
+            server_context_.mainThreadDispatcher()),
+        [manager = weak_from_this(), &main_dispatcher = server_context_.mainThreadDispatcher(),
+         config_hash](Ssl::SessionTicketKeyProvider* provider) {
+          deleteOnMainThread(main_dispatcher, provider);
+          std::shared_ptr<SessionResumptionManager> locked_manager = manager.lock();
+          if (locked_manager != nullptr) {
+            locked_manager->removeSessionTicketKeyProvider(config_hash);
+          }
+        });
+    entry = provider;
+  }
+  return provider;
+}
+
+void SessionResumptionManager::removeSessionCache(uint64_t config_hash) {
+  absl::MutexLock lock(&mu_);
+  eraseIfExpired(session_caches_, config_hash);
+}
+
+void SessionResumptionManager::removeSessionTicketKeyProvider(uint64_t config_hash) {
+  absl::MutexLock lock(&mu_);
+  eraseIfExpired(ticket_key_providers_, config_hash);
+}
+
+std::shared_ptr<SessionResumptionManager>
+SessionResumptionManager::get(Server::Configuration::ServerFactoryContext& server_context) {
+  // Pinned, so that the contexts created later share the caches and keys still in use.
+  return server_context.singletonManager().getTyped<SessionResumptionManager>(
+      SINGLETON_MANAGER_REGISTERED_NAME(tls_session_resumption_manager),
+      [&server_context] { return std::make_shared<SessionResumptionManager>(server_context); },
+      /* pin = */ true);
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/key_value_store.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/transport_sockets/tls/v3/tls.pb.h"
+#include "envoy/server/factory_context.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/ssl/context_config.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * A session cache split into shards, each with its own lock and capacity, so that workers resuming
+ * sessions concurrently rarely contend. When full, a shard evicts its oldest session.
+ *
+ * If a key value store is supplied, sessions are loaded from it on construction and written
+ * through to it on the main thread, so that they survive restarts. The stored sessions include
+ * their master secrets unencrypted, which is why the config requires an explicit opt-in.
+ */
+class ShardedSessionCache : public Ssl::SessionCache, Logger::Loggable<Logger::Id::connection> {
+public:
+  ShardedSessionCache(uint32_t max_entries, uint32_t num_shards, TimeSource& time_source,
+                      Event::Dispatcher& main_dispatcher, KeyValueStorePtr&& store);
+
+  // Ssl::SessionCache
+  void insert(absl::string_view session_id, std::string&& session,
+              std::chrono::seconds timeout) override;
+  absl::optional<std::string> lookup(absl::string_view session_id) override;
+  void remove(absl::string_view session_id) override;
+
+private:
+  struct Entry {
+    std::string session_;
+    SystemTime expiry_;
+    std::list<std::string>::iterator age_it_;
+  };
+
+  struct Shard {
+    absl::Mutex mu_;
+    absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+    // Session IDs from oldest to newest.
+    std::list<std::string> ages_ ABSL_GUARDED_BY(mu_);
+  };
+
+  Shard& shardFor(absl::string_view session_id);
+  void insertIntoShard(Shard& shard, absl::string_view session_id, std::string&& session,
+                       SystemTime expiry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu_);
+  void eraseFromShard(Shard& shard, absl::flat_hash_map<std::string, Entry>::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu_);
+  void loadFromStore();
+  // Schedules a store update on the main thread. An empty session removes the entry.
+  void updateStore(absl::string_view session_id, std::string session,
+                   absl::optional<std::chrono::seconds> timeout);
+
+  const uint32_t max_entries_per_shard_;
+  TimeSource& time_source_;
+  Event::Dispatcher& main_dispatcher_;
+  // Only accessed on the main thread.
+  const KeyValueStorePtr store_;
+  std::vector<Shard> shards_;
+  const std::shared_ptr<bool> still_alive_{std::make_shared<bool>(true)};
+};
+
+/**
+ * Generates a new session ticket key at every rotation interval, keeping the previous keys for
+ * decrypting tickets issued before the rotation. The whole set of keys is swapped at once, so
+ * all the contexts sharing the provider see the same keys.
+ */
+class RotatingSessionTicketKeyProvider : public Ssl::SessionTicketKeyProvider,
+                                         Logger::Loggable<Logger::Id::connection> {
+public:
+  RotatingSessionTicketKeyProvider(std::chrono::milliseconds rotation_interval, uint32_t max_keys,
+                                   Event::Dispatcher& main_dispatcher);
+
+  // Ssl::SessionTicketKeyProvider
+  Ssl::SessionTicketKeysConstSharedPtr keys() const override;
+
+  /**
+   * Makes a new key the encryption key, dropping the oldest one if there are too many.
+   */
+  void rotate();
+
+private:
+  static Ssl::ServerContextConfig::SessionTicketKey generateKey();
+
+  const std::chrono::milliseconds rotation_interval_;
+  const uint32_t max_keys_;
+  Event::TimerPtr rotation_timer_;
+  mutable absl::Mutex mu_;
+  Ssl::SessionTicketKeysConstSharedPtr keys_ ABSL_GUARDED_BY(mu_);
+};
+
+/**
+ * Hands out the session caches and rotating ticket key providers, sharing them between all the
+ * server contexts with an equal config. They are kept as long as a context uses them, so that
+ * sessions survive the context updates, which create the new context before destroying the old
+ * one, and are removed with the last context using them. They are handed out on the main thread.
+ */
+class SessionResumptionManager : public Singleton::Instance,
+                                 public std::enable_shared_from_this<SessionResumptionManager> {
+public:
+  explicit SessionResumptionManager(Server::Configuration::ServerFactoryContext& server_context)
+      : server_context_(server_context) {}
+
+  Ssl::SessionCacheSharedPtr
+  getSessionCache(const envoy::extensions::transport_sockets::tls::v3::TlsSessionCache& config);
+  Ssl::SessionTicketKeyProviderSharedPtr getSessionTicketKeyProvider(
+      const envoy::extensions::transport_sockets::tls::v3::TlsSessionTicketKeyRotation& config);
+
+  static std::shared_ptr<SessionResumptionManager>
+  get(Server::Configuration::ServerFactoryContext& server_context);
+
+private:
+  friend class SessionResumptionManagerPeer;
+
+  // Called when the last reference to an entry is released, possibly off the main thread.
+  void removeSessionCache(uint64_t config_hash);
+  void removeSessionTicketKeyProvider(uint64_t config_hash);
+
+  Server::Configuration::ServerFactoryContext& server_context_;
+  absl::Mutex mu_;
+  // Keyed by the hash of the config.
+  absl::flat_hash_map<uint64_t, std::weak_ptr<Ssl::SessionCache>>
+      session_caches_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64_t, std::weak_ptr<Ssl::SessionTicketKeyProvider>>
+      ticket_key_providers_ ABSL_GUARDED_BY(mu_);
+};
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -110,6 +110,10 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
     }
   }
 
+  if (kernel_tls_ != nullptr) {
+    return doKernelTlsRead(read_buffer);
+  }
+
   bool keep_reading = true;
   bool end_stream = false;
   PostIoAction action = PostIoAction::KeepOpen;
@@ -165,6 +169,64 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
   return {action, bytes_read, end_stream};
 }
 
+Network::IoResult SslSocket::doKernelTlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  do {
+    Buffer::Reservation reservation = read_buffer.reserveForRead();
+    uint8_t record_type;
+    Api::IoCallUint64Result result =
+        kernel_tls_->read(reservation.slices(), reservation.numSlices(), record_type);
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "kernel TLS read error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+    if (result.return_value_ == 0) {
+      // Non-graceful shutdown by closing the underlying socket.
+      end_stream = true;
+      break;
+    }
+    if (record_type != KernelTlsOffload::RecordTypeApplicationData) {
+      // Control records are consumed here rather than committed to the read buffer.
+      std::string payload;
+      for (uint64_t i = 0; payload.size() < result.return_value_; i++) {
+        payload.append(static_cast<const char*>(reservation.slices()[i].mem_),
+                       std::min<uint64_t>(reservation.slices()[i].len_,
+                                          result.return_value_ - payload.size()));
+      }
+      const KernelTlsOffload::ControlRecordAction control_action =
+          kernel_tls_->onControlRecord(record_type, payload);
+      if (control_action == KernelTlsOffload::ControlRecordAction::Continue) {
+        continue;
+      }
+      if (control_action == KernelTlsOffload::ControlRecordAction::EndStream) {
+        // Graceful shutdown using close_notify TLS alert.
+        end_stream = true;
+      } else {
+        ENVOY_CONN_LOG(debug, "unexpected kernel TLS record of type {}", callbacks_->connection(),
+                       record_type);
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+    reservation.commit(result.return_value_);
+    bytes_read += result.return_value_;
+    if (callbacks_->shouldDrainReadBuffer()) {
+      callbacks_->setTransportSocketIsReadable();
+      break;
+    }
+  } while (true);
+
+  ENVOY_CONN_LOG(trace, "kernel TLS read {} bytes", callbacks_->connection(), bytes_read);
+
+  return {action, bytes_read, end_stream};
+}
+
 void SslSocket::onPrivateKeyMethodComplete() { resumeHandshake(); }
 
 void SslSocket::resumeHandshake() {
@@ -194,6 +256,9 @@ void SslSocket::onSuccess(SSL* ssl) {
     callbacks_->connection().streamInfo().downstreamTiming().onDownstreamHandshakeComplete(
         callbacks_->connection().dispatcher().timeSource());
   }
+  if (ctx_->kernelTlsOffload()) {
+    kernel_tls_ = KernelTlsOffload::create(ssl, callbacks_->ioHandle(), ctx_->stats());
+  }
   callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 }
 
@@ -256,6 +321,10 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_ != nullptr && kernel_tls_->writeOffloaded()) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
@@ -306,6 +375,29 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  uint64_t bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    // The kernel splits the plaintext in records, so the whole buffer is written at once.
+    Api::IoCallUint64Result result = callbacks_->ioHandle().write(write_buffer);
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "kernel TLS write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+        return {PostIoAction::Close, bytes_written, false};
+      }
+      break;
+    }
+    bytes_written += result.return_value_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(info_->state() == Ssl::SocketState::PreHandshake); }
 
 Ssl::ConnectionInfoConstSharedPtr SslSocket::ssl() const { return info_; }
@@ -314,6 +406,13 @@ void SslSocket::shutdownSsl() {
   ASSERT(info_->state() != Ssl::SocketState::PreHandshake);
   if (info_->state() != Ssl::SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_ != nullptr && kernel_tls_->writeOffloaded()) {
+      // BoringSSL no longer owns the write keys, so the close_notify is sent by the kernel.
+      const bool sent = kernel_tls_->sendCloseNotify();
+      ENVOY_CONN_LOG(debug, "kernel TLS shutdown: sent={}", callbacks_->connection(), sent);
+      info_->setState(Ssl::SocketState::ShutdownSent);
+      return;
+    }
     int rc = SSL_shutdown(rawSsl());
     if constexpr (Event::PlatformDefaultTriggerType == Event::FileTriggerType::EmulatedEdge) {
       // Windows operate under `EmulatedEdge`. These are level events that are artificially
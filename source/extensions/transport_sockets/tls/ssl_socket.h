@@ -16,6 +16,7 @@
 #include "source/common/common/logger.h"
 #include "source/common/network/transport_socket_options_impl.h"
 #include "source/extensions/transport_sockets/tls/context_impl.h"
+#include "source/extensions/transport_sockets/tls/kernel_tls.h"
 #include "source/extensions/transport_sockets/tls/ssl_handshaker.h"
 #include "source/extensions/transport_sockets/tls/utility.h"
 
@@ -84,6 +85,8 @@ private:
     absl::optional<int> error_;
   };
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
+  Network::IoResult doKernelTlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
 
   Network::PostIoAction doHandshake();
   void drainErrorQueue();
@@ -98,6 +101,8 @@ private:
   std::string failure_reason_;
 
   SslHandshakerImplSharedPtr info_;
+  // Set once the record protection of the connection is offloaded to the kernel.
+  KernelTlsOffloadPtr kernel_tls_;
 };
 
 class ClientSslSocketFactory : public Network::CommonUpstreamTransportSocketFactory,
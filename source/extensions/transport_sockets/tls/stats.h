@@ -11,7 +11,15 @@ namespace Tls {
 #define ALL_SSL_STATS(COUNTER, GAUGE, HISTOGRAM)                                                   \
   COUNTER(connection_error)                                                                        \
   COUNTER(handshake)                                                                               \
+  COUNTER(kernel_tls_key_update)                                                                   \
+  COUNTER(kernel_tls_offload)                                                                      \
+  COUNTER(kernel_tls_unavailable)                                                                  \
+  COUNTER(kernel_tls_unsupported)                                                                  \
   COUNTER(session_reused)                                                                          \
+  COUNTER(session_cache_hit)                                                                       \
+  COUNTER(session_cache_miss)                                                                      \
+  COUNTER(session_cache_insert)                                                                    \
+  COUNTER(session_ticket_renewed)                                                                  \
   COUNTER(no_certificate)                                                                          \
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
@@ -56,6 +56,9 @@ void ActiveUdpListenerBase::onData(Network::UdpRecvData&& data) {
   if (dest == worker_index_) {
     onDataWorker(std::move(data));
   } else {
+    // The datagram was delivered by the kernel to the socket of another worker than the one which
+    // owns its flow, and costs a hop across threads.
+    udp_stats_.downstream_rx_datagram_forwarded_.inc();
     udp_listener_worker_router_.deliver(dest, std::move(data));
   }
 }
@@ -0,0 +1,54 @@
+#include <string>
+#include <vector>
+
+#include "source/common/access_log/access_log_manager_impl.h"
+#include "source/common/common/thread.h"
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace AccessLog {
+
+// Measures how fast threads write lines to the same access log file, with the write lock shared
+// by all threads (ring size 0) or with a write ring per thread.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_AccessLogFileWrite(benchmark::State& state) {
+  const uint32_t num_threads = state.range(0);
+  const uint64_t ring_size = state.range(1);
+  constexpr uint32_t LinesPerThread = 10000;
+
+  Stats::IsolatedStoreImpl store;
+  Api::ApiPtr api = Api::createApiForTest(store);
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  Thread::MutexBasicLockable lock;
+  AccessLogManagerImpl access_log_manager(std::chrono::milliseconds(1000), *api, *dispatcher,
+                                          lock, store);
+  AccessLogFileSharedPtr log_file = access_log_manager.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "/dev/null"}, ring_size);
+  const std::string line = std::string(200, 'a') + "\n";
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    std::vector<Thread::ThreadPtr> threads;
+    for (uint32_t i = 0; i < num_threads; i++) {
+      threads.push_back(api->threadFactory().createThread([&log_file, &line]() {
+        for (uint32_t j = 0; j < LinesPerThread; j++) {
+          log_file->write(line);
+        }
+      }));
+    }
+    for (Thread::ThreadPtr& thread : threads) {
+      thread->join();
+    }
+    log_file->flush();
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * LinesPerThread);
+}
+BENCHMARK(BM_AccessLogFileWrite)
+    ->ArgsProduct({{1, 4, 16}, {0, 1 << 20}})
+    ->Unit(::benchmark::kMillisecond);
+
+} // namespace AccessLog
+} // namespace Envoy
@@ -1,4 +1,6 @@
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "source/common/access_log/access_log_manager_impl.h"
 #include "source/common/filesystem/file_shared_impl.h"
@@ -11,6 +13,8 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -25,6 +29,15 @@ using testing::Sequence;
 
 namespace Envoy {
 namespace AccessLog {
+
+class AccessLogFileImplPeer {
+public:
+  static uint64_t numWriteRings(AccessLogFileImpl& file) {
+    Thread::LockGuard lock(file.write_lock_);
+    return file.rings_.size();
+  }
+};
+
 namespace {
 
 class AccessLogManagerImplTest : public testing::Test {
@@ -501,6 +514,107 @@ TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
       .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+TEST(AccessLogWriteRingTest, PushAndRead) {
+  AccessLogWriteRing ring(6);
+  EXPECT_EQ(8U, ring.capacity());
+  EXPECT_EQ(0U, ring.size());
+
+  EXPECT_TRUE(ring.push("abcde"));
+  EXPECT_FALSE(ring.push("fghi"));
+  EXPECT_EQ(5U, ring.size());
+
+  char output[8];
+  ring.read(output, 3);
+  EXPECT_EQ("abc", absl::string_view(output, 3));
+
+  // This wraps around the end of the ring.
+  EXPECT_TRUE(ring.push("fghijk"));
+  EXPECT_FALSE(ring.push("l"));
+  ring.read(output, ring.size());
+  EXPECT_EQ("defghijk", absl::string_view(output, 8));
+  EXPECT_EQ(0U, ring.size());
+}
+
+// With write rings, the lines of each thread are written in order, the lines of all threads are
+// written at once, and the lines which do not fit in a ring go through the shared buffer.
+TEST_F(AccessLogManagerImplTest, WriteRings) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"}, 4096);
+
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        written.append(data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  constexpr uint32_t NumThreads = 4;
+  constexpr uint32_t LinesPerThread = 100;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < NumThreads; i++) {
+    threads.push_back(thread_factory_.createThread([&log_file, i]() {
+      for (uint32_t j = 0; j < LinesPerThread; j++) {
+        log_file->write(absl::StrCat(i, " ", j, "\n"));
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  log_file->flush();
+  EXPECT_EQ(1U, file_->num_writes_);
+  // The rings of the exited threads are removed once drained.
+  EXPECT_EQ(0U, AccessLogFileImplPeer::numWriteRings(dynamic_cast<AccessLogFileImpl&>(*log_file)));
+  EXPECT_EQ(NumThreads * LinesPerThread, store_.counter("filesystem.write_buffered").value());
+  EXPECT_EQ(0U, store_.counter("filesystem.write_blocked").value());
+
+  std::vector<uint32_t> next_line(NumThreads);
+  for (absl::string_view line : absl::StrSplit(written, '\n', absl::SkipEmpty())) {
+    std::pair<std::string, std::string> fields = absl::StrSplit(line, ' ');
+    const uint32_t thread = std::stoul(fields.first);
+    ASSERT_LT(thread, NumThreads);
+    EXPECT_EQ(next_line[thread]++, std::stoul(fields.second));
+  }
+  EXPECT_THAT(next_line, testing::Each(LinesPerThread));
+
+  written.clear();
+  const std::string big_line(5000, 'a');
+  log_file->write(big_line);
+  EXPECT_EQ(1U, store_.counter("filesystem.write_blocked").value());
+  EXPECT_EQ(1U, AccessLogFileImplPeer::numWriteRings(dynamic_cast<AccessLogFileImpl&>(*log_file)));
+  log_file->flush();
+  EXPECT_EQ(big_line, written);
+  waitForGaugeEq("filesystem.write_total_buffered", 0);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// A line which does not fit in the ring of its thread goes after the earlier lines of the thread,
+// and before its later lines.
+TEST_F(AccessLogManagerImplTest, WriteRingsSpillInOrder) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"}, 64);
+
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        written.append(data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  const std::string big_line = std::string(100, 'b') + "\n";
+  log_file->write("first\n");
+  log_file->write(big_line);
+  log_file->write("last\n");
+  EXPECT_EQ(1U, store_.counter("filesystem.write_blocked").value());
+  log_file->flush();
+  EXPECT_EQ(absl::StrCat("first\n", big_line, "last\n"), written);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 } // namespace
 } // namespace AccessLog
 } // namespace Envoy
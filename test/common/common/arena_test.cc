@@ -0,0 +1,103 @@
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "source/common/common/arena.h"
+#include "source/common/common/linked_object.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+TEST(ArenaTest, Allocate) {
+  InlineArena<64> arena;
+  void* first = arena.allocate(10, 1);
+  void* second = arena.allocate(8, 8);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(second) % 8);
+  EXPECT_EQ(static_cast<char*>(first) + 16, second);
+  EXPECT_EQ(2, arena.allocations());
+  EXPECT_EQ(18, arena.allocatedBytes());
+  EXPECT_EQ(0, arena.allocatedBlocks());
+
+  // Allocations beyond the inlined block take blocks, growing in size.
+  arena.allocate(64, 16);
+  EXPECT_EQ(1, arena.allocatedBlocks());
+  void* large = arena.allocate(4096, 64);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(large) % 64);
+  EXPECT_EQ(2, arena.allocatedBlocks());
+}
+
+TEST(ArenaTest, NoInlineBlock) {
+  ArenaImpl arena(nullptr, 512);
+  arena.allocate(1, 1);
+  EXPECT_EQ(1, arena.allocatedBlocks());
+  for (int i = 0; i < 100; i++) {
+    arena.allocate(1, 1);
+  }
+  EXPECT_EQ(1, arena.allocatedBlocks());
+}
+
+struct Object {
+  explicit Object(int& destroyed) : destroyed_(destroyed) {}
+  ~Object() { destroyed_++; }
+
+  int& destroyed_;
+  std::string value_{"a string too long to be stored inline"};
+};
+
+// Objects created from an arena are destroyed by their pointers, and the others deleted.
+TEST(ArenaTest, ArenaPtr) {
+  InlineArena<256> arena;
+  int destroyed = 0;
+  ArenaPtr<Object> in_arena = makeArenaPtr<Object>(arena, destroyed);
+  EXPECT_TRUE(in_arena.get_deleter().inArena());
+  ArenaPtr<Object> in_heap = makeArenaPtr<Object>({}, destroyed);
+  EXPECT_FALSE(in_heap.get_deleter().inArena());
+  ArenaPtr<Object> converted = std::make_unique<Object>(destroyed);
+  EXPECT_FALSE(converted.get_deleter().inArena());
+  EXPECT_EQ(sizeof(Object), arena.allocatedBytes());
+
+  in_arena.reset();
+  in_heap.reset();
+  converted.reset();
+  EXPECT_EQ(3, destroyed);
+}
+
+TEST(ArenaTest, ArenaShared) {
+  InlineArena<256> arena;
+  int destroyed = 0;
+  std::shared_ptr<Object> object = makeArenaShared<Object>(arena, destroyed);
+  std::weak_ptr<Object> weak = object;
+  EXPECT_GT(arena.allocatedBytes(), sizeof(Object));
+  object.reset();
+  EXPECT_EQ(1, destroyed);
+  EXPECT_TRUE(weak.expired());
+}
+
+struct LinkedItem;
+using LinkedItemList = std::list<ArenaPtr<LinkedItem>, ArenaAllocator<ArenaPtr<LinkedItem>>>;
+struct LinkedItem : LinkedObject<LinkedItem, LinkedItemList> {
+  explicit LinkedItem(int value) : value_(value) {}
+  int value_;
+};
+
+// LinkedObject supports lists of objects allocated from an arena.
+TEST(ArenaTest, LinkedList) {
+  InlineArena<1024> arena;
+  LinkedItemList list{ArenaAllocator<ArenaPtr<LinkedItem>>(arena)};
+  LinkedList::moveIntoListBack(makeArenaPtr<LinkedItem>(arena, 1), list);
+  LinkedList::moveIntoListBack(makeArenaPtr<LinkedItem>(arena, 2), list);
+  LinkedList::moveIntoList(makeArenaPtr<LinkedItem>(arena, 0), list);
+  EXPECT_EQ(3, list.size());
+  EXPECT_EQ(0, list.front()->value_);
+
+  ArenaPtr<LinkedItem> removed = (*std::next(list.begin()))->removeFromList(list);
+  EXPECT_EQ(1, removed->value_);
+  EXPECT_EQ(2, list.size());
+  EXPECT_EQ(0, arena.allocatedBlocks());
+}
+
+} // namespace
+} // namespace Envoy
@@ -13,9 +13,12 @@ namespace Envoy {
 namespace ConnectionPool {
 
 using testing::AnyNumber;
+using testing::AtLeast;
 using testing::HasSubstr;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
+using testing::Property;
+using testing::Ref;
 using testing::Return;
 
 class TestActiveClient : public ActiveClient {
@@ -82,6 +85,7 @@ public:
 class TestConnPoolImplBase : public ConnPoolImplBase {
 public:
   using ConnPoolImplBase::ConnPoolImplBase;
+  using ConnPoolImplBase::enableLeastLoadedClientSelection;
   ConnectionPool::Cancellable* newPendingStream(AttachContext& context,
                                                 bool can_send_early_data) override {
     auto entry = std::make_unique<TestPendingStream>(*this, context, can_send_early_data);
@@ -345,6 +349,143 @@ TEST_F(ConnPoolImplBaseTest, ExplicitPreconnect) {
   pool_.destructAllConnections();
 }
 
+// With least loaded client selection, streams are spread evenly over the Ready clients.
+TEST_F(ConnPoolImplBaseTest, LeastLoadedClientSelection) {
+  EXPECT_CALL(dispatcher_, createTimer_(_)).Times(AnyNumber());
+  pool_.enableLeastLoadedClientSelection();
+  concurrent_streams_ = 10;
+  EXPECT_CALL(cluster_->stats_store_, deliverHistogramToSinks(_, _)).Times(AnyNumber());
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_rq_cx_concurrency"),
+                                      _))
+      .Times(AtLeast(6));
+
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(3);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(pool_.maybePreconnectImpl(30));
+  }
+  for (TestActiveClient* client : clients_) {
+    client->onEvent(Network::ConnectionEvent::Connected);
+    EXPECT_EQ(ActiveClient::State::Ready, client->state());
+  }
+
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  }
+  for (TestActiveClient* client : clients_) {
+    EXPECT_EQ(2, client->active_streams_);
+  }
+  CHECK_STATE(6 /*active*/, 0 /*pending*/, 24 /*connecting capacity*/);
+
+  // The next stream goes to the client which just had a stream closed.
+  clients_[1]->active_streams_--;
+  pool_.onStreamClosed(*clients_[1], false);
+  EXPECT_CALL(pool_, onPoolReady(Ref(*clients_[1]), _))
+      .WillOnce(Invoke([](ActiveClient& client, AttachContext&) {
+        TestActiveClient::incrementActiveStreams(client);
+      }));
+  EXPECT_EQ(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  EXPECT_EQ(2, clients_[1]->active_streams_);
+
+  // Busy clients leave the index, and come back once they have capacity again.
+  pool_.transitionActiveClientState(*clients_[0], ActiveClient::State::Busy);
+  clients_[0]->active_streams_ = 0;
+  pool_.transitionActiveClientState(*clients_[0], ActiveClient::State::Ready);
+  EXPECT_CALL(pool_, onPoolReady(Ref(*clients_[0]), _))
+      .WillOnce(Invoke([](ActiveClient& client, AttachContext&) {
+        TestActiveClient::incrementActiveStreams(client);
+      }));
+  EXPECT_EQ(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+
+  pool_.destructAllConnections();
+}
+
+// The stream concurrency histogram is only recorded with least loaded client selection.
+TEST_F(ConnPoolImplBaseTest, NoConcurrencyHistogramWithoutLeastLoadedClientSelection) {
+  EXPECT_CALL(dispatcher_, createTimer_(_)).Times(AnyNumber());
+  concurrent_streams_ = 10;
+  EXPECT_CALL(cluster_->stats_store_, deliverHistogramToSinks(_, _)).Times(AnyNumber());
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_rq_cx_concurrency"),
+                                      _))
+      .Times(0);
+
+  EXPECT_CALL(pool_, instantiateActiveClient);
+  EXPECT_TRUE(pool_.maybePreconnectImpl(10));
+  clients_.back()->onEvent(Network::ConnectionEvent::Connected);
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  }
+  CHECK_STATE(2 /*active*/, 0 /*pending*/, 8 /*connecting capacity*/);
+
+  pool_.destructAllConnections();
+}
+
+// Prewarming creates connections until the pool has the requested unused capacity, without
+// creating more connections than allowed.
+TEST_F(ConnPoolImplBaseTest, Prewarm) {
+  concurrent_streams_ = 2;
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(3);
+
+  EXPECT_EQ(2, pool_.prewarmImpl(5, 2));
+  CHECK_STATE(0 /*active*/, 0 /*pending*/, 4 /*connecting capacity*/);
+  EXPECT_EQ(1, pool_.prewarmImpl(5, 3));
+  EXPECT_EQ(0, pool_.prewarmImpl(5, 10));
+  CHECK_STATE(0 /*active*/, 0 /*pending*/, 6 /*connecting capacity*/);
+  EXPECT_EQ(3, host_->stats().cx_prewarm_.value());
+  EXPECT_EQ(3, host_->stats().cx_warm_.value());
+
+  // A connection is no longer warm once it serves a stream or closes.
+  for (TestActiveClient* client : clients_) {
+    client->onEvent(Network::ConnectionEvent::Connected);
+  }
+  EXPECT_EQ(nullptr, pool_.newStreamImpl(context_, /*can_send_early_data=*/false));
+  EXPECT_EQ(2, host_->stats().cx_warm_.value());
+  for (TestActiveClient* client : clients_) {
+    if (client->active_streams_ == 0) {
+      client->close();
+      break;
+    }
+  }
+  EXPECT_EQ(1, host_->stats().cx_warm_.value());
+
+  pool_.destructAllConnections();
+  EXPECT_EQ(0, host_->stats().cx_warm_.value());
+  EXPECT_EQ(3, host_->stats().cx_prewarm_.value());
+}
+
+// Warm connections are not closed as excess when a pending stream is cancelled.
+TEST_F(ConnPoolImplBaseTest, PrewarmNotClosedAsExcess) {
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(2);
+  EXPECT_EQ(2, pool_.prewarmImpl(2, 2));
+  CHECK_STATE(0 /*active*/, 0 /*pending*/, 2 /*connecting capacity*/);
+
+  auto cancelable = pool_.newStreamImpl(context_, /*can_send_early_data=*/false);
+  CHECK_STATE(0 /*active*/, 1 /*pending*/, 2 /*connecting capacity*/);
+  cancelable->cancel(ConnectionPool::CancelPolicy::CloseExcess);
+  CHECK_STATE(0 /*active*/, 0 /*pending*/, 2 /*connecting capacity*/);
+  EXPECT_EQ(2, host_->stats().cx_warm_.value());
+
+  pool_.destructAllConnections();
+}
+
+// Prewarming stops at the connection circuit breaker, without counting an overflow.
+TEST_F(ConnPoolImplBaseTest, PrewarmCircuitBreaker) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1, 1);
+  EXPECT_CALL(pool_, instantiateActiveClient);
+  EXPECT_EQ(1, pool_.prewarmImpl(2, 2));
+  EXPECT_EQ(0, pool_.prewarmImpl(2, 2));
+  EXPECT_EQ(0, cluster_->traffic_stats_->upstream_cx_overflow_.value());
+
+  pool_.destructAllConnections();
+}
+
+TEST_F(ConnPoolImplBaseTest, PrewarmNotHealthy) {
+  host_->healthFlagSet(Upstream::Host::HealthFlag::FAILED_ACTIVE_HC);
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(0);
+  EXPECT_EQ(0, pool_.prewarmImpl(5, 2));
+}
+
 TEST_F(ConnPoolImplBaseTest, ExplicitPreconnectNotHealthy) {
   // Create more than one connection per new stream.
   ON_CALL(*cluster_, perUpstreamPreconnectRatio).WillByDefault(Return(1.5));
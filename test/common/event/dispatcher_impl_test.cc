@@ -1586,6 +1586,44 @@ TEST_F(DispatcherConnectionTest, CreateEnvoyInternalConnectionWhenFactoryNotExis
       "");
 }
 
+// The connection read budget of the dispatchers is configured by the bootstrap.
+TEST(DispatcherConnectionReadBudgetTest, FromBootstrap) {
+  envoy::config::bootstrap::v3::Bootstrap bootstrap;
+  Stats::IsolatedStoreImpl stats_store;
+  GlobalTimeSystem time_system;
+  NiceMock<Random::MockRandomGenerator> random;
+  {
+    Api::Impl api(Thread::threadFactoryForTest(), stats_store, time_system,
+                  Filesystem::fileSystemForTest(), random, bootstrap);
+    DispatcherPtr dispatcher = api.allocateDispatcher("test_thread");
+    EXPECT_EQ(0U, dispatcher->connectionReadBudget().max_bytes_);
+    EXPECT_EQ(0, dispatcher->connectionReadBudget().max_time_.count());
+  }
+
+  TestUtility::loadFromYaml(R"EOF(
+connection_read_budget:
+  max_bytes: 65536
+  max_time: 0.0005s
+)EOF",
+                            bootstrap);
+  Api::Impl api(Thread::threadFactoryForTest(), stats_store, time_system,
+                Filesystem::fileSystemForTest(), random, bootstrap);
+  DispatcherPtr dispatcher = api.allocateDispatcher("test_thread");
+  EXPECT_EQ(65536U, dispatcher->connectionReadBudget().max_bytes_);
+  EXPECT_EQ(std::chrono::microseconds(500), dispatcher->connectionReadBudget().max_time_);
+
+  // The time is rounded up to the microsecond.
+  TestUtility::loadFromYaml(R"EOF(
+connection_read_budget:
+  max_time: 0.0000015s
+)EOF",
+                            bootstrap);
+  Api::Impl rounded_api(Thread::threadFactoryForTest(), stats_store, time_system,
+                        Filesystem::fileSystemForTest(), random, bootstrap);
+  DispatcherPtr rounded_dispatcher = rounded_api.allocateDispatcher("test_thread");
+  EXPECT_EQ(std::chrono::microseconds(2), rounded_dispatcher->connectionReadBudget().max_time_);
+}
+
 } // namespace
 } // namespace Event
 } // namespace Envoy
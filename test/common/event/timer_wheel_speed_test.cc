@@ -0,0 +1,67 @@
+#include <chrono>
+#include <vector>
+
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+
+#include "source/common/api/api_impl.h"
+#include "source/common/common/random_generator.h"
+#include "source/common/event/dispatcher_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/test_common/test_time.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Measures arming and disabling timers among many armed ones, as timeouts of requests and
+// connections do, with the timers of libevent or with the coarse timers of the timer wheel. The
+// timeouts are long enough that the timers do not fire during the benchmark.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_TimerChurn(benchmark::State& state) {
+  const bool coarse = state.range(0) != 0;
+  const uint64_t num_timers = state.range(1);
+
+  envoy::config::bootstrap::v3::Bootstrap bootstrap;
+  bootstrap.set_use_timer_wheel(true);
+  Stats::IsolatedStoreImpl stats_store;
+  Event::GlobalTimeSystem time_system;
+  Random::RandomGeneratorImpl random;
+  Api::Impl api(Thread::threadFactoryForTest(), stats_store, time_system,
+                Filesystem::fileSystemForTest(), random, bootstrap);
+  DispatcherPtr dispatcher = api.allocateDispatcher("test_thread");
+  const auto random_timeout = [&random]() {
+    return std::chrono::milliseconds(60000 + random.random() % 60000);
+  };
+
+  std::vector<TimerPtr> timers;
+  timers.reserve(num_timers);
+  for (uint64_t i = 0; i < num_timers; i++) {
+    timers.push_back(coarse ? dispatcher->createCoarseTimer([]() {})
+                            : dispatcher->createTimer([]() {}));
+    timers.back()->enableTimer(random_timeout());
+  }
+
+  uint64_t operations = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    // Re-arm a timer, as on activity of a stream, and disable and re-arm another, as when a
+    // stream completes and a new one starts.
+    timers[random.random() % num_timers]->enableTimer(random_timeout());
+    Timer& timer = *timers[random.random() % num_timers];
+    timer.disableTimer();
+    timer.enableTimer(random_timeout());
+    operations += 3;
+  }
+  state.SetItemsProcessed(operations);
+}
+BENCHMARK(BM_TimerChurn)
+    ->ArgsProduct({{0, 1}, {1000, 500000}})
+    ->ArgNames({"coarse", "timers"})
+    ->Unit(::benchmark::kNanosecond);
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,237 @@
+#include <chrono>
+#include <vector>
+
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+
+#include "source/common/api/api_impl.h"
+#include "source/common/event/dispatcher_impl.h"
+#include "source/common/event/timer_wheel.h"
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/mocks/common.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+using testing::NiceMock;
+
+// Creates a dispatcher with the timer wheel enabled or not by the bootstrap.
+class TimerWheelDispatcher {
+public:
+  TimerWheelDispatcher(bool use_timer_wheel)
+      : bootstrap_(createBootstrap(use_timer_wheel)),
+        api_(Thread::threadFactoryForTest(), stats_store_, time_system_,
+             Filesystem::fileSystemForTest(), random_, bootstrap_),
+        dispatcher_(api_.allocateDispatcher("test_thread")) {}
+
+  static envoy::config::bootstrap::v3::Bootstrap createBootstrap(bool use_timer_wheel) {
+    envoy::config::bootstrap::v3::Bootstrap bootstrap;
+    bootstrap.set_use_timer_wheel(use_timer_wheel);
+    return bootstrap;
+  }
+
+  const envoy::config::bootstrap::v3::Bootstrap bootstrap_;
+  Stats::IsolatedStoreImpl stats_store_;
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Random::MockRandomGenerator> random_;
+  Api::Impl api_;
+  DispatcherPtr dispatcher_;
+};
+
+class TimerWheelTest : public testing::Test, public TimerWheelDispatcher {
+public:
+  TimerWheelTest() : TimerWheelDispatcher(true) {}
+
+  void advance(std::chrono::microseconds duration) {
+    time_system_.advanceTimeAndRun(duration, *dispatcher_, Dispatcher::RunType::NonBlock);
+  }
+
+  // Checks that a timer fires at the first millisecond after its timeout, and not before.
+  void expectFiresAfter(Timer& timer, bool& fired, std::chrono::milliseconds timeout) {
+    advance(timeout - std::chrono::milliseconds(1));
+    EXPECT_FALSE(fired);
+    EXPECT_TRUE(timer.enabled());
+    advance(std::chrono::milliseconds(1));
+    EXPECT_TRUE(fired);
+    EXPECT_FALSE(timer.enabled());
+    fired = false;
+  }
+};
+
+TEST_F(TimerWheelTest, FiresAtTimeout) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createCoarseTimer([&fired]() { fired = true; });
+  EXPECT_FALSE(timer->enabled());
+
+  // Timers of each level of the wheel.
+  for (const std::chrono::milliseconds timeout :
+       {std::chrono::milliseconds(1), std::chrono::milliseconds(10),
+        std::chrono::milliseconds(300), std::chrono::milliseconds(70000),
+        std::chrono::milliseconds(5 * 3600 * 1000)}) {
+    timer->enableTimer(timeout);
+    expectFiresAfter(*timer, fired, timeout);
+  }
+}
+
+// Timers armed between two ticks fire at the next tick after their timeout, never before it.
+TEST_F(TimerWheelTest, RoundedUpToTick) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createCoarseTimer([&fired]() { fired = true; });
+  advance(std::chrono::microseconds(300));
+  timer->enableTimer(std::chrono::milliseconds(5));
+  advance(std::chrono::microseconds(4999));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::microseconds(701));
+  EXPECT_TRUE(fired);
+}
+
+TEST_F(TimerWheelTest, DisableAndRearm) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createCoarseTimer([&fired]() { fired = true; });
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+  advance(std::chrono::milliseconds(20));
+  EXPECT_FALSE(fired);
+
+  // Re-arming moves the timeout.
+  timer->enableTimer(std::chrono::milliseconds(10));
+  advance(std::chrono::milliseconds(5));
+  timer->enableTimer(std::chrono::milliseconds(10));
+  expectFiresAfter(*timer, fired, std::chrono::milliseconds(10));
+
+  // Destroying an armed timer removes it from the wheel.
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer.reset();
+  advance(std::chrono::milliseconds(20));
+  EXPECT_FALSE(fired);
+}
+
+// The callback of a timer may disable or re-arm the other timers, and itself.
+TEST_F(TimerWheelTest, CallbacksUpdateOtherTimers) {
+  std::vector<int> fired;
+  TimerPtr timer2;
+  TimerPtr timer3;
+  TimerPtr timer1 = dispatcher_->createCoarseTimer([&]() {
+    fired.push_back(1);
+    timer2->disableTimer();
+    timer3->enableTimer(std::chrono::milliseconds(10));
+  });
+  timer2 = dispatcher_->createCoarseTimer([&]() { fired.push_back(2); });
+  timer3 = dispatcher_->createCoarseTimer([&]() { fired.push_back(3); });
+  timer1->enableTimer(std::chrono::milliseconds(10));
+  timer2->enableTimer(std::chrono::milliseconds(11));
+  timer3->enableTimer(std::chrono::milliseconds(11));
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::vector<int>({1}), fired);
+  advance(std::chrono::milliseconds(5));
+  EXPECT_EQ(std::vector<int>({1}), fired);
+  advance(std::chrono::milliseconds(5));
+  EXPECT_EQ(std::vector<int>({1, 3}), fired);
+
+  // A timer may re-arm itself from its callback.
+  uint32_t count = 0;
+  TimerPtr periodic;
+  periodic = dispatcher_->createCoarseTimer([&]() {
+    if (++count < 3) {
+      periodic->enableTimer(std::chrono::milliseconds(100));
+    }
+  });
+  periodic->enableTimer(std::chrono::milliseconds(100));
+  advance(std::chrono::milliseconds(1000));
+  EXPECT_EQ(3U, count);
+}
+
+// A time jump fires all the expired timers, in the order of their timeouts.
+TEST_F(TimerWheelTest, TimeJump) {
+  std::vector<int> fired;
+  std::vector<TimerPtr> timers;
+  for (const int timeout : {70000, 2, 300, 1000000}) {
+    timers.push_back(
+        dispatcher_->createCoarseTimer([&fired, timeout]() { fired.push_back(timeout); }));
+    timers.back()->enableTimer(std::chrono::milliseconds(timeout));
+  }
+  advance(std::chrono::seconds(100));
+  EXPECT_EQ(std::vector<int>({2, 300, 70000}), fired);
+  EXPECT_TRUE(timers.back()->enabled());
+}
+
+// Zero and high resolution timers keep their semantics, using a timer of the dispatcher.
+TEST_F(TimerWheelTest, ZeroAndHighResolution) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createCoarseTimer([&fired]() { fired = true; });
+  timer->enableTimer(std::chrono::milliseconds(0));
+  EXPECT_TRUE(timer->enabled());
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(fired);
+  EXPECT_FALSE(timer->enabled());
+
+  fired = false;
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer->enableHRTimer(std::chrono::microseconds(1500));
+  advance(std::chrono::microseconds(1499));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::microseconds(1));
+  EXPECT_TRUE(fired);
+  advance(std::chrono::milliseconds(20));
+  EXPECT_FALSE(timer->enabled());
+
+  // Arming in the wheel disables the timer of the dispatcher. The time is now half way between two
+  // ticks, so the timer fires at the second tick after its timeout.
+  fired = false;
+  timer->enableHRTimer(std::chrono::microseconds(1500));
+  timer->enableTimer(std::chrono::milliseconds(10));
+  advance(std::chrono::milliseconds(10));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::microseconds(500));
+  EXPECT_TRUE(fired);
+}
+
+// The idle timeouts, which are scaled timers, are kept in the wheel.
+TEST_F(TimerWheelTest, ScaledTimers) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createScaledTimer(
+      ScaledTimerType::HttpDownstreamIdleConnectionTimeout, [&fired]() { fired = true; });
+  advance(std::chrono::microseconds(300));
+  timer->enableTimer(std::chrono::milliseconds(5));
+  advance(std::chrono::microseconds(4999));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::microseconds(701));
+  // The elapsed minimum activates the zero scaled remainder, run by the next loop iteration.
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(fired);
+}
+
+// Only the coarse timers are kept in the wheel.
+TEST_F(TimerWheelTest, CoarseTimersOnly) {
+  TimerPtr timer = dispatcher_->createTimer([]() {});
+  EXPECT_EQ(nullptr, dynamic_cast<WheelTimer*>(timer.get()));
+  TimerPtr coarse_timer = dispatcher_->createCoarseTimer([]() {});
+  EXPECT_NE(nullptr, dynamic_cast<WheelTimer*>(coarse_timer.get()));
+}
+
+// Without the wheel, the coarse timers are regular timers, which fire at their exact timeout.
+TEST(TimerWheelDisabledTest, RegularTimers) {
+  TimerWheelDispatcher wheel_dispatcher(false);
+  bool fired = false;
+  TimerPtr timer = wheel_dispatcher.dispatcher_->createCoarseTimer([&fired]() { fired = true; });
+  EXPECT_EQ(nullptr, dynamic_cast<WheelTimer*>(timer.get()));
+  wheel_dispatcher.time_system_.advanceTimeAndRun(std::chrono::microseconds(300),
+                                                  *wheel_dispatcher.dispatcher_,
+                                                  Dispatcher::RunType::NonBlock);
+  timer->enableTimer(std::chrono::milliseconds(5));
+  wheel_dispatcher.time_system_.advanceTimeAndRun(std::chrono::milliseconds(5),
+                                                  *wheel_dispatcher.dispatcher_,
+                                                  Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(fired);
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -102,6 +102,23 @@ TEST_F(FileSystemImplTest, FileReadToEndSuccessBinary) {
   }
 }
 
+// Renaming replaces the destination file.
+TEST_F(FileSystemImplTest, Rename) {
+  const std::string old_path = TestEnvironment::writeStringToFileForTest("test_envoy_old", "new");
+  const std::string new_path = TestEnvironment::writeStringToFileForTest("test_envoy_new", "old");
+
+  const Api::IoCallBoolResult result = file_system_.rename(old_path, new_path);
+  EXPECT_TRUE(result.return_value_);
+  EXPECT_THAT(result.err_, ::testing::IsNull()) << result.err_->getErrorDetails();
+  EXPECT_FALSE(file_system_.fileExists(old_path));
+  EXPECT_EQ("new", file_system_.fileReadToEnd(new_path).value());
+
+  // The file no longer exists at its old path.
+  const Api::IoCallBoolResult failure = file_system_.rename(old_path, new_path);
+  EXPECT_FALSE(failure.return_value_);
+  EXPECT_NE(nullptr, failure.err_);
+}
+
 TEST_F(FileSystemImplTest, FileReadToEndPathDoesNotExist) {
   unlink(TestEnvironment::temporaryPath("envoy_this_not_exist").c_str());
   EXPECT_THAT(file_system_.fileReadToEnd(TestEnvironment::temporaryPath("envoy_this_not_exist"))
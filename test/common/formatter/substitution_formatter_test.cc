@@ -7,6 +7,7 @@
 #include "envoy/config/core/v3/base.pb.h"
 #include "envoy/stream_info/stream_info.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/logger.h"
 #include "source/common/common/utility.h"
 #include "source/common/formatter/http_specific_formatter.h"
@@ -3777,6 +3778,66 @@ TEST(SubstitutionFormatterTest, JsonFormatterWithOrderedPropertiesTest) {
   EXPECT_EQ(out_json, expected);
 }
 
+TEST(SubstitutionFormatterTest, JsonFormatterStreamTest) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{":method", "GET"}};
+  Http::TestResponseHeaderMapImpl response_header;
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body;
+
+  HttpFormatterContext formatter_context(&request_header, &response_header, &response_trailer,
+                                         body);
+
+  absl::optional<Http::Protocol> protocol = Http::Protocol::Http11;
+  EXPECT_CALL(stream_info, protocol()).WillRepeatedly(Return(protocol));
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    method: '%REQ(:METHOD)%'
+    missing: '%REQ(missing)%'
+    list: ['%PROTOCOL%', 'a%REQ(:METHOD)%', 3]
+    nested:
+      protocol: '%PROTOCOL%'
+      quoted: '"%REQ(:METHOD)%"'
+  )EOF",
+                            key_mapping);
+  JsonFormatterImpl formatter(key_mapping, true, false, false);
+
+  Buffer::OwnedImpl output;
+  formatter.streamWithContext(formatter_context, stream_info, output);
+  EXPECT_EQ("{\"list\":[\"HTTP/1.1\",\"aGET\",3],\"method\":\"GET\",\"missing\":null,"
+            "\"nested\":{\"protocol\":\"HTTP/1.1\",\"quoted\":\"\\\"GET\\\"\"}}\n",
+            output.toString());
+  EXPECT_TRUE(TestUtility::jsonStringEqual(
+      output.toString(), formatter.formatWithContext(formatter_context, stream_info)));
+}
+
+TEST(SubstitutionFormatterTest, JsonFormatterStreamOmitEmptyTest) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{":method", "GET"}};
+  Http::TestResponseHeaderMapImpl response_header;
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body;
+
+  HttpFormatterContext formatter_context(&request_header, &response_header, &response_trailer,
+                                         body);
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    method: '%REQ(:METHOD)%'
+    missing: '%REQ(missing)%'
+    nested:
+      missing: '%RESP(missing)%'
+    list: ['%REQ(missing)%', '%REQ(:METHOD)%']
+  )EOF",
+                            key_mapping);
+  JsonFormatterImpl formatter(key_mapping, false, true, false);
+
+  Buffer::OwnedImpl output;
+  formatter.streamWithContext(formatter_context, stream_info, output);
+  EXPECT_EQ("{\"list\":[\"GET\"],\"method\":\"GET\"}\n", output.toString());
+}
+
 TEST(SubstitutionFormatterTest, CompositeFormatterSuccess) {
   Http::TestRequestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
   Http::TestResponseHeaderMapImpl response_header{{"second", "PUT"}, {"test", "test"}};
@@ -4048,6 +4109,68 @@ TEST(SubstitutionFormatterTest, CompositeFormatterEmpty) {
   }
 }
 
+// Appending to a buffer produces the same text as formatting, after what the buffer held.
+TEST(SubstitutionFormatterTest, CompositeFormatterAppend) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{":method", "GET"}, {"user-agent", "curl/8.0"}};
+  Http::TestResponseHeaderMapImpl response_header{{":status", "200"}};
+  Http::TestResponseTrailerMapImpl response_trailer{};
+  std::string body;
+  HttpFormatterContext formatter_context(&request_header, &response_header, &response_trailer,
+                                         body);
+  stream_info.bytes_sent_ = 1234;
+  stream_info.protocol_ = Http::Protocol::Http11;
+
+  for (const bool omit_empty_values : {false, true}) {
+    const std::string format = "[%DOWNSTREAM_REMOTE_ADDRESS%] [%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_"
+                               "PORT%:%DOWNSTREAM_REMOTE_PORT%] %REQ(:METHOD)% %BYTES_SENT% "
+                               "%RESP(:STATUS)% \"%REQ(USER-AGENT):4%\" %REQ(NOT-THERE)% "
+                               "%TRAILER(NOT-THERE)% %PROTOCOL%\n";
+    FormatterImpl formatter(format, omit_empty_values);
+    const std::string expected =
+        omit_empty_values
+            ? "[127.0.0.1:0] [127.0.0.1:0] GET 1234 200 \"curl\"   HTTP/1.1\n"
+            : "[127.0.0.1:0] [127.0.0.1:0] GET 1234 200 \"curl\" - - HTTP/1.1\n";
+    EXPECT_EQ(expected, formatter.formatWithContext(formatter_context, stream_info));
+
+    std::string output = "prefix ";
+    formatter.appendWithContext(formatter_context, stream_info, output);
+    EXPECT_EQ("prefix " + expected, output);
+  }
+}
+
+// String values of struct formats are built in place, and keep the semantics of missing values.
+TEST(SubstitutionFormatterTest, StructFormatterAppendedValues) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{":method", "GET"}};
+  Http::TestResponseHeaderMapImpl response_header{};
+  Http::TestResponseTrailerMapImpl response_trailer{};
+  std::string body;
+  HttpFormatterContext formatter_context(&request_header, &response_header, &response_trailer,
+                                         body);
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    method: '%REQ(:METHOD)%'
+    missing: '%REQ(NOT-THERE)%'
+    multi: '%REQ(:METHOD)% %REQ(NOT-THERE)%'
+  )EOF",
+                            key_mapping);
+
+  {
+    StructFormatter formatter(key_mapping, false, false);
+    EXPECT_THAT(formatter.formatWithContext(formatter_context, stream_info),
+                ProtoEq(TestUtility::jsonToStruct(
+                    R"EOF({"method": "GET", "missing": "-", "multi": "GET -"})EOF")));
+  }
+
+  {
+    StructFormatter formatter(key_mapping, false, true);
+    EXPECT_THAT(formatter.formatWithContext(formatter_context, stream_info),
+                ProtoEq(TestUtility::jsonToStruct(R"EOF({"method": "GET", "multi": "GET "})EOF")));
+  }
+}
+
 TEST(SubstitutionFormatterTest, ParserFailures) {
   SubstitutionFormatParser parser;
 
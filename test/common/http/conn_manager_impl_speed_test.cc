@@ -0,0 +1,107 @@
+#include "source/common/common/arena.h"
+#include "source/extensions/filters/http/common/pass_through_filter.h"
+
+#include "test/common/http/conn_manager_impl_test_base.h"
+#include "test/test_common/test_runtime.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+// A filter created from the arena of its stream, continuing the iteration.
+class ArenaPassThroughFilter : public PassThroughFilter {};
+
+// The last filter of the chain, responding to the requests.
+class RespondingFilter : public PassThroughDecoderFilter {
+public:
+  RespondingFilter(OptRef<Arena> arena, uint64_t& arena_allocations)
+      : arena_(arena), arena_allocations_(arena_allocations) {}
+
+  // Http::StreamDecoderFilter
+  FilterHeadersStatus decodeHeaders(RequestHeaderMap&, bool) override {
+    decoder_callbacks_->sendLocalReply(Code::OK, "", nullptr, absl::nullopt, "details");
+    return FilterHeadersStatus::StopIteration;
+  }
+  void onDestroy() override {
+    if (arena_.has_value()) {
+      arena_allocations_ += static_cast<ArenaImpl&>(arena_.ref()).allocations();
+    }
+  }
+
+private:
+  const OptRef<Arena> arena_;
+  uint64_t& arena_allocations_;
+};
+
+class ConnManagerSpeedTest : public HttpConnectionManagerImplMixin {
+public:
+  explicit ConnManagerSpeedTest(uint32_t num_filters) {
+    setup(false, "envoy-custom-server", false);
+    EXPECT_CALL(filter_factory_, createFilterChain(_))
+        .WillRepeatedly(Invoke([this, num_filters](FilterChainManager& manager) -> bool {
+          FilterFactoryCb factory = [this, num_filters](FilterChainFactoryCallbacks& callbacks) {
+            for (uint32_t i = 0; i < num_filters; i++) {
+              callbacks.addStreamFilter(
+                  makeArenaShared<ArenaPassThroughFilter>(callbacks.streamArena()));
+            }
+            callbacks.addStreamDecoderFilter(makeArenaShared<RespondingFilter>(
+                callbacks.streamArena(), callbacks.streamArena(), arena_allocations_));
+          };
+          manager.applyFilterFactoryCb({}, factory);
+          return true;
+        }));
+    EXPECT_CALL(*codec_, dispatch(_)).WillRepeatedly(Invoke([this](Buffer::Instance&) -> Status {
+      RequestDecoder& decoder = conn_manager_->newStream(response_encoder_);
+      decoder.decodeHeaders(RequestHeaderMapPtr{new TestRequestHeaderMapImpl{
+                                {":authority", "host"}, {":path", "/"}, {":method", "GET"}}},
+                            true);
+      response_encoder_.stream_.codec_callbacks_->onCodecEncodeComplete();
+      return okStatus();
+    }));
+    EXPECT_CALL(response_encoder_, encodeHeaders(_, _)).Times(AnyNumber());
+    EXPECT_CALL(response_encoder_, encodeData(_, _)).Times(AnyNumber());
+  }
+
+  // Processes a request, from its headers to the destruction of its stream.
+  void request() {
+    Buffer::OwnedImpl input;
+    conn_manager_->onData(input, false);
+    filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+  }
+
+  uint64_t arena_allocations_{};
+};
+
+// Measures the lifecycle of requests through the connection manager and a chain of filters, with
+// the objects scoped to the streams allocated from their arena or from the heap. Reports the number
+// of allocations from the arenas per request, which are the heap allocations avoided.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_RequestLifecycle(benchmark::State& state) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.http_stream_arena", state.range(0) != 0 ? "true" : "false"}});
+  ConnManagerSpeedTest test(state.range(1));
+
+  uint64_t requests = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    test.request();
+    requests++;
+  }
+  state.SetItemsProcessed(requests);
+  state.counters["arena_allocations_per_request"] =
+      requests == 0 ? 0 : static_cast<double>(test.arena_allocations_) / requests;
+}
+BENCHMARK(BM_RequestLifecycle)
+    ->ArgsProduct({{0, 1}, {1, 10}})
+    ->ArgNames({"arena", "filters"})
+    ->Unit(::benchmark::kMicrosecond);
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
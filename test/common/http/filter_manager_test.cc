@@ -35,7 +35,7 @@ public:
     filter_manager_ = std::make_unique<DownstreamFilterManager>(
         filter_manager_callbacks_, dispatcher_, connection_, 0, nullptr, true, 10000,
         filter_factory_, local_reply_, protocol_, time_source_, filter_state_,
-        StreamInfo::FilterState::LifeSpan::Connection);
+        StreamInfo::FilterState::LifeSpan::Connection, arena_);
   }
 
   // Simple helper to wrapper filter to the factory function.
@@ -71,6 +71,8 @@ public:
     EXPECT_TRUE(MessageDifferencer::Equals(*(fs_value->serializeAsProto()), *expected));
   }
 
+  // The arena must outlive the filter manager, whose filters are allocated from it.
+  InlineArena<1024> arena_;
   std::unique_ptr<FilterManager> filter_manager_;
   NiceMock<MockFilterManagerCallbacks> filter_manager_callbacks_;
   NiceMock<Event::MockDispatcher> dispatcher_;
@@ -138,6 +140,71 @@ TEST_F(FilterManagerTest, RequestHeadersOrResponseHeadersAccess) {
   filter_manager_->destroyFilters();
 }
 
+// The filter wrappers are allocated from the arena of the stream, as are the filters which opt in
+// through the filter chain factory callbacks.
+TEST_F(FilterManagerTest, FiltersAllocatedFromArena) {
+  initialize();
+
+  std::shared_ptr<MockStreamFilter> stream_filter;
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainManager& manager) -> bool {
+        FilterFactoryCb factory = [&](FilterChainFactoryCallbacks& callbacks) {
+          EXPECT_EQ(&arena_, callbacks.streamArena().ptr());
+          stream_filter = makeArenaShared<NiceMock<MockStreamFilter>>(callbacks.streamArena());
+          callbacks.addStreamFilter(stream_filter);
+        };
+        manager.applyFilterFactoryCb({}, factory);
+        return true;
+      }));
+  filter_manager_->createFilterChain();
+  // The filter, its wrappers, and the nodes of the lists of the filter manager.
+  EXPECT_GT(arena_.allocatedBytes(),
+            sizeof(MockStreamFilter) + sizeof(ActiveStreamDecoderFilter) +
+                sizeof(ActiveStreamEncoderFilter));
+
+  RequestHeaderMapPtr headers{
+      new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+  ON_CALL(filter_manager_callbacks_, requestHeaders()).WillByDefault(Return(makeOptRef(*headers)));
+  filter_manager_->requestHeadersInitialized();
+  EXPECT_CALL(*stream_filter, decodeHeaders(_, true));
+  filter_manager_->decodeHeaders(*headers, true);
+
+  EXPECT_CALL(*stream_filter, onDestroy());
+  filter_manager_->destroyFilters();
+}
+
+class MockFilterReleaseCallbacks : public FilterReleaseCallbacks {
+public:
+  MOCK_METHOD(void, onFiltersReleased, ());
+};
+
+// The filter release callbacks are notified once the filter manager dropped its references to the
+// filters.
+TEST_F(FilterManagerTest, FilterReleaseCallbacks) {
+  initialize();
+
+  auto stream_filter = std::make_shared<NiceMock<MockStreamFilter>>();
+  MockFilterReleaseCallbacks release_callbacks;
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainManager& manager) -> bool {
+        FilterFactoryCb factory = [&](FilterChainFactoryCallbacks& callbacks) {
+          callbacks.addStreamFilter(stream_filter);
+          callbacks.addFilterReleaseCallbacks(release_callbacks);
+        };
+        manager.applyFilterFactoryCb({}, factory);
+        return true;
+      }));
+  filter_manager_->createFilterChain();
+  EXPECT_GT(stream_filter.use_count(), 1);
+
+  EXPECT_CALL(*stream_filter, onDestroy());
+  filter_manager_->destroyFilters();
+  EXPECT_CALL(release_callbacks, onFiltersReleased()).WillOnce(Invoke([&]() {
+    EXPECT_EQ(1, stream_filter.use_count());
+  }));
+  filter_manager_.reset();
+}
+
 // Verifies that the local reply persists the gRPC classification even if the request headers are
 // modified.
 TEST_F(FilterManagerTest, SendLocalReplyDuringDecodingGrpcClassiciation) {
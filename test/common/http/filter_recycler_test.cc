@@ -0,0 +1,157 @@
+#include <memory>
+
+#include "source/common/http/filter_recycler.h"
+#include "source/extensions/filters/http/common/pass_through_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::SaveArg;
+
+class TestFilter : public PassThroughFilter, public ResettableFilter {
+public:
+  // Http::ResettableFilter
+  void resetForReuse() override { resets_++; }
+
+  uint32_t resets_{};
+};
+
+class FilterRecyclerTest : public testing::Test {
+public:
+  FilterRecyclerTest() {
+    ON_CALL(callbacks_, addStreamFilter(_)).WillByDefault(SaveArg<0>(&added_filter_));
+    ON_CALL(callbacks_, addFilterReleaseCallbacks(_))
+        .WillByDefault(Invoke([this](FilterReleaseCallbacks& release_callbacks) {
+          release_callbacks_ = &release_callbacks;
+        }));
+  }
+
+  // Creates the filters of a stream, then destroys the stream.
+  StreamFilter* runStream(const FilterFactoryCb& factory) {
+    release_callbacks_ = nullptr;
+    factory(callbacks_);
+    StreamFilter* filter = added_filter_.get();
+    added_filter_.reset();
+    if (release_callbacks_ != nullptr) {
+      release_callbacks_->onFiltersReleased();
+    }
+    return filter;
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockFilterChainFactoryCallbacks> callbacks_;
+  StreamFilterSharedPtr added_filter_;
+  FilterReleaseCallbacks* release_callbacks_{};
+  uint32_t constructions_{};
+};
+
+// The filters released by a stream are reset and added to the next stream.
+TEST_F(FilterRecyclerTest, RecyclesReleasedFilters) {
+  FilterFactoryCb factory = FilterRecycler::createRecyclingFactoryCb(
+      tls_, 1, [this](FilterChainFactoryCallbacks& callbacks) {
+        constructions_++;
+        callbacks.addStreamFilter(std::make_shared<TestFilter>());
+      });
+
+  StreamFilter* filter1 = runStream(factory);
+  EXPECT_EQ(1U, constructions_);
+  StreamFilter* filter2 = runStream(factory);
+  EXPECT_EQ(1U, constructions_);
+  EXPECT_EQ(filter1, filter2);
+  EXPECT_EQ(1U, dynamic_cast<TestFilter*>(filter2)->resets_);
+
+  // A filter still referenced when its stream is released is not recycled.
+  factory(callbacks_);
+  StreamFilterSharedPtr reference = added_filter_;
+  added_filter_.reset();
+  release_callbacks_->onFiltersReleased();
+  EXPECT_EQ(1U, dynamic_cast<TestFilter*>(reference.get())->resets_);
+  runStream(factory);
+  EXPECT_EQ(2U, constructions_);
+}
+
+// The sets of filters kept by a worker are bounded.
+TEST_F(FilterRecyclerTest, MaxRecycledFilters) {
+  FilterFactoryCb factory = FilterRecycler::createRecyclingFactoryCb(
+      tls_, 1, [this](FilterChainFactoryCallbacks& callbacks) {
+        constructions_++;
+        callbacks.addStreamFilter(std::make_shared<TestFilter>());
+      });
+
+  // Two concurrent streams, of which only one set of filters is kept.
+  FilterReleaseCallbacks* release_callbacks[2];
+  for (FilterReleaseCallbacks*& stream_release_callbacks : release_callbacks) {
+    factory(callbacks_);
+    added_filter_.reset();
+    stream_release_callbacks = release_callbacks_;
+  }
+  EXPECT_EQ(2U, constructions_);
+  for (FilterReleaseCallbacks* stream_release_callbacks : release_callbacks) {
+    stream_release_callbacks->onFiltersReleased();
+  }
+
+  runStream(factory);
+  runStream(factory);
+  EXPECT_EQ(2U, constructions_);
+}
+
+// The filters which cannot be reset are created for each stream.
+TEST_F(FilterRecyclerTest, NotResettableFilters) {
+  FilterFactoryCb factory = FilterRecycler::createRecyclingFactoryCb(
+      tls_, 1, [this](FilterChainFactoryCallbacks& callbacks) {
+        constructions_++;
+        callbacks.addStreamFilter(std::make_shared<PassThroughFilter>());
+      });
+
+  EXPECT_CALL(callbacks_, addFilterReleaseCallbacks(_)).Times(0);
+  runStream(factory);
+  runStream(factory);
+  EXPECT_EQ(2U, constructions_);
+}
+
+// The filters adding access log handlers are created for each stream.
+TEST_F(FilterRecyclerTest, AccessLogHandler) {
+  FilterFactoryCb factory = FilterRecycler::createRecyclingFactoryCb(
+      tls_, 1, [this](FilterChainFactoryCallbacks& callbacks) {
+        constructions_++;
+        callbacks.addStreamFilter(std::make_shared<TestFilter>());
+        callbacks.addAccessLogHandler(nullptr);
+      });
+
+  EXPECT_CALL(callbacks_, addAccessLogHandler(_)).Times(2);
+  EXPECT_CALL(callbacks_, addFilterReleaseCallbacks(_)).Times(0);
+  runStream(factory);
+  runStream(factory);
+  EXPECT_EQ(2U, constructions_);
+}
+
+// The filters released after their worker shut down are destroyed.
+TEST_F(FilterRecyclerTest, ReleasedAfterShutdown) {
+  std::weak_ptr<StreamFilter> filter;
+  {
+    FilterFactoryCb factory = FilterRecycler::createRecyclingFactoryCb(
+        tls_, 1, [](FilterChainFactoryCallbacks& callbacks) {
+          callbacks.addStreamFilter(std::make_shared<TestFilter>());
+        });
+    factory(callbacks_);
+    filter = added_filter_;
+    added_filter_.reset();
+  }
+  tls_.shutdownThread();
+  release_callbacks_->onFiltersReleased();
+  EXPECT_TRUE(filter.expired());
+}
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
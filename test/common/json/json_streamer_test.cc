@@ -114,6 +114,16 @@ TEST_F(JsonStreamerTest, SubMap) {
   EXPECT_EQ(R"EOF({"a":{"one":1,"three.5":3.5}})EOF", buffer_.toString());
 }
 
+TEST_F(JsonStreamerTest, BoolsAndNull) {
+  {
+    Streamer::ArrayPtr array = streamer_.makeRootArray();
+    array->addBool(true);
+    array->addNull();
+    array->addBool(false);
+  }
+  EXPECT_EQ(R"EOF([true,null,false])EOF", buffer_.toString());
+}
+
 } // namespace
 } // namespace Json
 } // namespace Envoy
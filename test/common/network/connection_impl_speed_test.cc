@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+
+#include "source/common/api/api_impl.h"
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/hash.h"
+#include "source/common/common/random_generator.h"
+#include "source/common/network/connection_impl.h"
+#include "source/common/network/connection_socket_impl.h"
+#include "source/common/network/io_socket_handle_impl.h"
+#include "source/common/network/raw_buffer_socket.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/common/stream_info/stream_info_impl.h"
+
+#include "test/test_common/test_time.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+// Simulates processing the data of a connection, e.g. parsing it, at a cost proportional to its
+// size.
+class ProcessingFilter : public ReadFilter {
+public:
+  explicit ProcessingFilter(std::function<void()> on_data) : on_data_(std::move(on_data)) {}
+
+  // Network::ReadFilter
+  FilterStatus onData(Buffer::Instance& data, bool) override {
+    constexpr uint32_t ProcessingPasses = 16;
+    for (const Buffer::RawSlice& slice : data.getRawSlices()) {
+      for (uint32_t i = 0; i < ProcessingPasses; i++) {
+        benchmark::DoNotOptimize(
+            HashUtil::xxHash64({static_cast<const char*>(slice.mem_), slice.len_}, i));
+      }
+    }
+    received_ += data.length();
+    data.drain(data.length());
+    on_data_();
+    return FilterStatus::Continue;
+  }
+  FilterStatus onNewConnection() override { return FilterStatus::Continue; }
+  void initializeReadFilterCallbacks(ReadFilterCallbacks&) override {}
+
+  uint64_t received_{};
+
+private:
+  const std::function<void()> on_data_;
+};
+
+// Both ends of a TCP connection over the loopback. TCP rather than a socket pair, so that the
+// kernel buffers of the elephant hold many reads.
+struct ConnectionPair {
+  std::unique_ptr<ConnectionImpl> connection_;
+  os_fd_t peer_;
+};
+
+class ConnectionPairFactory {
+public:
+  ConnectionPairFactory() {
+    addr_.sin_family = AF_INET;
+    addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    listen_fd_ = os_sys_calls_.socket(AF_INET, SOCK_STREAM, 0).return_value_;
+    socklen_t addr_len = sizeof(addr_);
+    RELEASE_ASSERT(
+        os_sys_calls_.bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr_), addr_len)
+                    .return_value_ == 0 &&
+            os_sys_calls_.listen(listen_fd_, 128).return_value_ == 0 &&
+            os_sys_calls_.getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr_), &addr_len)
+                    .return_value_ == 0,
+        "");
+  }
+  ~ConnectionPairFactory() { os_sys_calls_.close(listen_fd_); }
+
+  ConnectionPair create(Event::Dispatcher& dispatcher, StreamInfo::StreamInfo& stream_info) {
+    const os_fd_t peer = os_sys_calls_.socket(AF_INET, SOCK_STREAM, 0).return_value_;
+    RELEASE_ASSERT(
+        os_sys_calls_.connect(peer, reinterpret_cast<sockaddr*>(&addr_), sizeof(addr_))
+                .return_value_ == 0,
+        "");
+    const os_fd_t fd = os_sys_calls_.accept(listen_fd_, nullptr, nullptr).return_value_;
+    os_sys_calls_.setsocketblocking(fd, false);
+    os_sys_calls_.setsocketblocking(peer, false);
+    auto connection = std::make_unique<ConnectionImpl>(
+        dispatcher,
+        std::make_unique<ConnectionSocketImpl>(std::make_unique<IoSocketHandleImpl>(fd), nullptr,
+                                               nullptr),
+        std::make_unique<RawBufferSocket>(), stream_info, true);
+    return {std::move(connection), peer};
+  }
+
+private:
+  Api::OsSysCalls& os_sys_calls_{Api::OsSysCallsSingleton::get()};
+  sockaddr_in addr_{};
+  os_fd_t listen_fd_;
+};
+
+// Sends as much as the kernel buffers of a connection take.
+uint64_t fill(os_fd_t fd, std::string& chunk) {
+  uint64_t sent = 0;
+  while (true) {
+    const Api::SysCallSizeResult result =
+        Api::OsSysCallsSingleton::get().send(fd, chunk.data(), chunk.size(), 0);
+    if (result.return_value_ <= 0) {
+      return sent;
+    }
+    sent += result.return_value_;
+  }
+}
+
+// Measures the latency of the requests of many connections (the mice) sharing a dispatcher with a
+// connection receiving a lot of data (the elephant), without or with a connection read budget. The
+// elephant fills its kernel buffers before the mice send their requests, so without a budget the
+// mice wait for the elephant to read and process all of its data. With a budget, they wait for a
+// single read of the elephant, 128KiB with the default buffers.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_ElephantAndMice(benchmark::State& state) {
+  const uint64_t read_budget = state.range(0);
+  constexpr uint32_t NumMice = 64;
+
+  envoy::config::bootstrap::v3::Bootstrap bootstrap;
+  if (read_budget > 0) {
+    bootstrap.mutable_connection_read_budget()->mutable_max_bytes()->set_value(read_budget);
+  }
+  Stats::IsolatedStoreImpl store;
+  Event::GlobalTimeSystem time_system;
+  Random::RandomGeneratorImpl random;
+  Api::Impl api(Thread::threadFactoryForTest(), store, time_system,
+                Filesystem::fileSystemForTest(), random, bootstrap);
+  Event::DispatcherPtr dispatcher = api.allocateDispatcher("test_thread");
+  StreamInfo::StreamInfoImpl stream_info(time_system, nullptr);
+  ConnectionPairFactory factory;
+
+  MonotonicTime start;
+  uint32_t pending_mice = 0;
+  std::vector<double> latencies_us;
+  auto elephant_filter = std::make_shared<ProcessingFilter>([]() {});
+  ConnectionPair elephant = factory.create(*dispatcher, stream_info);
+  elephant.connection_->addReadFilter(elephant_filter);
+  std::vector<ConnectionPair> mice;
+  for (uint32_t i = 0; i < NumMice; i++) {
+    mice.push_back(factory.create(*dispatcher, stream_info));
+    mice.back().connection_->addReadFilter(std::make_shared<ProcessingFilter>([&]() {
+      latencies_us.push_back(
+          std::chrono::duration<double, std::micro>(time_system.monotonicTime() - start).count());
+      pending_mice--;
+    }));
+  }
+
+  std::string chunk(64 * 1024, 'e');
+  std::string request(256, 'm');
+  uint64_t elephant_sent = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    elephant_sent += fill(elephant.peer_, chunk);
+    start = time_system.monotonicTime();
+    for (ConnectionPair& mouse : mice) {
+      Api::OsSysCallsSingleton::get().send(mouse.peer_, request.data(), request.size(), 0);
+    }
+    pending_mice = NumMice;
+    while (pending_mice > 0 || elephant_filter->received_ < elephant_sent) {
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  state.counters["mice_p50_us"] = latencies_us[latencies_us.size() / 2];
+  state.counters["mice_p99_us"] = latencies_us[latencies_us.size() * 99 / 100];
+  state.counters["elephant_bytes_per_iteration"] =
+      static_cast<double>(elephant_sent) / state.iterations();
+
+  elephant.connection_->close(ConnectionCloseType::NoFlush);
+  Api::OsSysCallsSingleton::get().close(elephant.peer_);
+  for (ConnectionPair& mouse : mice) {
+    mouse.connection_->close(ConnectionCloseType::NoFlush);
+    Api::OsSysCallsSingleton::get().close(mouse.peer_);
+  }
+}
+BENCHMARK(BM_ElephantAndMice)->Arg(0)->Arg(64 * 1024)->Unit(::benchmark::kMicrosecond);
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
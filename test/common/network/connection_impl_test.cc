@@ -2638,6 +2638,47 @@ TEST_F(MockTransportConnectionImplTest, ReadBufferReadyResumeAfterReadDisable) {
             connection_->readDisable(false));
 }
 
+// Verify that a connection which exhausts its read budget resumes reading at the next iteration of
+// the event loop rather than in the current one.
+TEST_F(MockTransportConnectionImplTest, ReadBudgetYieldsToNextIteration) {
+  InSequence s;
+
+  dispatcher_.connection_read_budget_.max_bytes_ = 4;
+  std::shared_ptr<MockReadFilter> read_filter(new NiceMock<MockReadFilter>());
+  connection_->addReadFilter(read_filter);
+  auto* read_resume_cb = new Event::MockSchedulableCallback(&dispatcher_);
+
+  // The budget is accounted from the start of each read.
+  auto read = [this](Buffer::Instance& buffer) -> IoResult {
+    buffer.add("01");
+    EXPECT_FALSE(transport_socket_callbacks_->shouldDrainReadBuffer());
+    buffer.add("23");
+    EXPECT_TRUE(transport_socket_callbacks_->shouldDrainReadBuffer());
+    transport_socket_callbacks_->setTransportSocketIsReadable();
+    return {PostIoAction::KeepOpen, 4, false};
+  };
+  EXPECT_CALL(*transport_socket_, doRead(_)).WillOnce(Invoke(read));
+  EXPECT_CALL(*read_resume_cb, scheduleCallbackNextIteration());
+  EXPECT_CALL(*file_event_, activate(_)).Times(0);
+  file_ready_cb_(Event::FileReadyType::Read);
+
+  EXPECT_CALL(*file_event_, activate(Event::FileReadyType::Read));
+  read_resume_cb->invokeCallback();
+
+  EXPECT_CALL(*transport_socket_, doRead(_)).WillOnce(Invoke(read));
+  EXPECT_CALL(*read_resume_cb, scheduleCallbackNextIteration());
+  file_ready_cb_(Event::FileReadyType::Read);
+
+  // A connection read disabled in the meantime resumes reading once read enabled.
+  EXPECT_CALL(*file_event_, setEnabled(_));
+  connection_->readDisable(true);
+  EXPECT_CALL(*file_event_, activate(_)).Times(0);
+  read_resume_cb->invokeCallback();
+  EXPECT_CALL(*file_event_, setEnabled(_));
+  EXPECT_CALL(*file_event_, activate(Event::FileReadyType::Read));
+  connection_->readDisable(false);
+}
+
 // Verify that read resumption is scheduled when read is re-enabled while the read buffer is
 // non-empty.
 TEST_F(MockTransportConnectionImplTest, ReadBufferResumeAfterReadDisable) {
@@ -0,0 +1,296 @@
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "source/common/network/dns_resolver/coalescing_dns_resolver.h"
+#include "source/common/network/utility.h"
+#include "source/common/singleton/manager_impl.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class CoalescingDnsResolverTest : public testing::Test {
+public:
+  CoalescingDnsResolverTest()
+      : stats_({ALL_DNS_RESOLUTION_CACHE_STATS(
+            POOL_COUNTER_PREFIX(*store_.rootScope(), "dns_resolution_cache."),
+            POOL_GAUGE_PREFIX(*store_.rootScope(), "dns_resolution_cache."))}),
+        resolver_(std::make_shared<CoalescingDnsResolver>(mock_resolver_, time_system_, stats_)) {}
+
+  // Resolves a name, expecting the mock resolver to be queried, and returns the callback of the
+  // mock resolver.
+  DnsResolver::ResolveCb expectResolution(const std::string& name, DnsResolver::ResolveCb callback,
+                                          ActiveDnsQuery*& query) {
+    DnsResolver::ResolveCb resolver_callback;
+    EXPECT_CALL(*mock_resolver_, resolve(name, DnsLookupFamily::V4Only, _))
+        .WillOnce(
+            testing::DoAll(SaveArg<2>(&resolver_callback), Return(&mock_resolver_->active_query_)));
+    query = resolver_->resolve(name, DnsLookupFamily::V4Only, std::move(callback));
+    return resolver_callback;
+  }
+
+  static std::list<DnsResponse> responses(std::chrono::seconds ttl) {
+    std::list<DnsResponse> responses;
+    responses.emplace_back(Utility::parseInternetAddress("10.0.0.1"), ttl);
+    responses.emplace_back(Utility::parseInternetAddress("10.0.0.2"), ttl * 2);
+    return responses;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return store_.counter(absl::StrCat("dns_resolution_cache.", name)).value();
+  }
+
+  uint64_t gauge(const std::string& name) {
+    return store_
+        .gauge(absl::StrCat("dns_resolution_cache.", name), Stats::Gauge::ImportMode::NeverImport)
+        .value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::TestUtil::TestStore store_;
+  DnsResolutionCacheStats stats_;
+  std::shared_ptr<NiceMock<MockDnsResolver>> mock_resolver_{
+      std::make_shared<NiceMock<MockDnsResolver>>()};
+  std::shared_ptr<CoalescingDnsResolver> resolver_;
+};
+
+// The concurrent queries for a name are answered by a single resolution.
+TEST_F(CoalescingDnsResolverTest, CoalescesConcurrentQueries) {
+  uint32_t answers = 0;
+  auto callback = [&answers](DnsResolver::ResolutionStatus status,
+                             std::list<DnsResponse>&& response) {
+    EXPECT_EQ(DnsResolver::ResolutionStatus::Success, status);
+    EXPECT_EQ(2, response.size());
+    answers++;
+  };
+  ActiveDnsQuery* first = nullptr;
+  DnsResolver::ResolveCb resolver_callback = expectResolution("foo.com", callback, first);
+  EXPECT_NE(nullptr, first);
+
+  ActiveDnsQuery* second = resolver_->resolve("foo.com", DnsLookupFamily::V4Only, callback);
+  EXPECT_NE(nullptr, second);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(1, gauge("pending_resolutions"));
+
+  resolver_callback(DnsResolver::ResolutionStatus::Success, responses(std::chrono::seconds(30)));
+  EXPECT_EQ(2, answers);
+  EXPECT_EQ(2, counter("queries"));
+  EXPECT_EQ(1, counter("coalesced_queries"));
+  EXPECT_EQ(1, counter("resolutions"));
+  EXPECT_EQ(0, gauge("pending_resolutions"));
+  EXPECT_EQ(1, gauge("cached_answers"));
+}
+
+// The queries following a resolution are answered from the cache, with the remaining TTL, until
+// the smallest TTL of the answer expires.
+TEST_F(CoalescingDnsResolverTest, AnswersFromTheCacheUntilExpiry) {
+  ActiveDnsQuery* query = nullptr;
+  expectResolution("foo.com", [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {},
+                   query)(DnsResolver::ResolutionStatus::Success,
+                          responses(std::chrono::seconds(30)));
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(10500));
+  bool answered = false;
+  EXPECT_CALL(*mock_resolver_, resolve(_, _, _)).Times(0);
+  EXPECT_EQ(nullptr, resolver_->resolve(
+                         "foo.com", DnsLookupFamily::V4Only,
+                         [&answered](DnsResolver::ResolutionStatus status,
+                                     std::list<DnsResponse>&& response) {
+                           EXPECT_EQ(DnsResolver::ResolutionStatus::Success, status);
+                           ASSERT_EQ(2, response.size());
+                           EXPECT_EQ("10.0.0.1:0",
+                                     response.front().addrInfo().address_->asString());
+                           EXPECT_EQ(std::chrono::seconds(20), response.front().addrInfo().ttl_);
+                           EXPECT_EQ(std::chrono::seconds(20), response.back().addrInfo().ttl_);
+                           answered = true;
+                         }));
+  EXPECT_TRUE(answered);
+  EXPECT_EQ(1, counter("cache_hits"));
+  testing::Mock::VerifyAndClearExpectations(mock_resolver_.get());
+
+  // A different lookup family is not answered by the cached answer.
+  EXPECT_CALL(*mock_resolver_, resolve("foo.com", DnsLookupFamily::Auto, _));
+  resolver_->resolve("foo.com", DnsLookupFamily::Auto,
+                     [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {});
+
+  time_system_.advanceTimeWait(std::chrono::seconds(20));
+  expectResolution("foo.com", [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {},
+                   query);
+  EXPECT_EQ(1, counter("cache_hits"));
+  EXPECT_EQ(0, gauge("cached_answers"));
+}
+
+// The failed and empty resolutions are not cached.
+TEST_F(CoalescingDnsResolverTest, DoesNotCacheFailures) {
+  ActiveDnsQuery* query = nullptr;
+  auto callback = [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {};
+  expectResolution("foo.com", callback, query)(DnsResolver::ResolutionStatus::Failure, {});
+  expectResolution("foo.com", callback, query)(DnsResolver::ResolutionStatus::Success, {});
+  expectResolution("foo.com", callback, query)(DnsResolver::ResolutionStatus::Success,
+                                               responses(std::chrono::seconds(0)));
+  expectResolution("foo.com", callback, query);
+  EXPECT_EQ(0, counter("cache_hits"));
+  EXPECT_EQ(0, gauge("cached_answers"));
+}
+
+// The resolution is only cancelled once all its queries are cancelled.
+TEST_F(CoalescingDnsResolverTest, CancelsTheResolutionWithTheLastQuery) {
+  ActiveDnsQuery* first = nullptr;
+  expectResolution(
+      "foo.com", [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) { FAIL(); }, first);
+  bool answered = false;
+  ActiveDnsQuery* second =
+      resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                         [&answered](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {
+                           answered = true;
+                         });
+
+  EXPECT_CALL(mock_resolver_->active_query_, cancel(_)).Times(0);
+  first->cancel(ActiveDnsQuery::CancelReason::QueryAbandoned);
+  testing::Mock::VerifyAndClearExpectations(&mock_resolver_->active_query_);
+
+  EXPECT_CALL(mock_resolver_->active_query_, cancel(ActiveDnsQuery::CancelReason::Timeout));
+  second->cancel(ActiveDnsQuery::CancelReason::Timeout);
+  EXPECT_FALSE(answered);
+  EXPECT_EQ(0, gauge("pending_resolutions"));
+}
+
+// A query answered inline by the decorated resolver returns no handle.
+TEST_F(CoalescingDnsResolverTest, InlineResolution) {
+  EXPECT_CALL(*mock_resolver_, resolve("foo.com", DnsLookupFamily::V4Only, _))
+      .WillOnce([](const std::string&, DnsLookupFamily,
+                   DnsResolver::ResolveCb callback) -> ActiveDnsQuery* {
+        callback(DnsResolver::ResolutionStatus::Success, responses(std::chrono::seconds(30)));
+        return nullptr;
+      });
+  bool answered = false;
+  EXPECT_EQ(nullptr, resolver_->resolve(
+                         "foo.com", DnsLookupFamily::V4Only,
+                         [&answered](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {
+                           answered = true;
+                         }));
+  EXPECT_TRUE(answered);
+  EXPECT_EQ(0, gauge("pending_resolutions"));
+  EXPECT_EQ(1, gauge("cached_answers"));
+}
+
+// A callback may cancel the other queries of its resolution.
+TEST_F(CoalescingDnsResolverTest, CallbackCancelsAnotherQuery) {
+  ActiveDnsQuery* second = nullptr;
+  ActiveDnsQuery* first = nullptr;
+  DnsResolver::ResolveCb resolver_callback = expectResolution(
+      "foo.com",
+      [&second](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {
+        second->cancel(ActiveDnsQuery::CancelReason::QueryAbandoned);
+      },
+      first);
+  second = resolver_->resolve("foo.com", DnsLookupFamily::V4Only,
+                              [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {
+                                FAIL();
+                              });
+
+  EXPECT_CALL(mock_resolver_->active_query_, cancel(_)).Times(0);
+  resolver_callback(DnsResolver::ResolutionStatus::Success, responses(std::chrono::seconds(30)));
+}
+
+// Resetting the networking drops the cached answers.
+TEST_F(CoalescingDnsResolverTest, ResetNetworkingClearsTheCache) {
+  ActiveDnsQuery* query = nullptr;
+  auto callback = [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) {};
+  expectResolution("foo.com", callback, query)(DnsResolver::ResolutionStatus::Success,
+                                               responses(std::chrono::seconds(30)));
+  EXPECT_CALL(*mock_resolver_, resetNetworking());
+  resolver_->resetNetworking();
+  EXPECT_EQ(0, gauge("cached_answers"));
+  expectResolution("foo.com", callback, query);
+}
+
+// The pending resolutions are cancelled with the resolver.
+TEST_F(CoalescingDnsResolverTest, DestructionCancelsPendingResolutions) {
+  ActiveDnsQuery* query = nullptr;
+  expectResolution(
+      "foo.com", [](DnsResolver::ResolutionStatus, std::list<DnsResponse>&&) { FAIL(); }, query);
+  EXPECT_CALL(mock_resolver_->active_query_,
+              cancel(ActiveDnsQuery::CancelReason::QueryAbandoned));
+  resolver_.reset();
+  EXPECT_EQ(0, gauge("pending_resolutions"));
+}
+
+class CoalescingDnsResolverRegistryTest : public testing::Test {
+public:
+  CoalescingDnsResolverRegistryTest() {
+    scoped_runtime_.mergeValues({{"envoy.reloadable_features.coalesce_dns_resolutions", "true"}});
+    ON_CALL(factory_, createDnsResolver(_, _, _))
+        .WillByDefault([](Event::Dispatcher&, Api::Api&,
+                          const envoy::config::core::v3::TypedExtensionConfig&) {
+          return std::make_shared<NiceMock<MockDnsResolver>>();
+        });
+  }
+
+  DnsResolverSharedPtr create(const envoy::config::core::v3::TypedExtensionConfig& config) {
+    return createCoalescingDnsResolver(factory_, config, dispatcher_, api_, singleton_manager_,
+                                       *store_.rootScope());
+  }
+
+  TestScopedRuntime scoped_runtime_;
+  Stats::TestUtil::TestStore store_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Api::MockApi> api_;
+  Singleton::ManagerImpl singleton_manager_{Thread::threadFactoryForTest()};
+  NiceMock<MockDnsResolverFactory> factory_;
+};
+
+// The users of equivalent configs share a resolver, for as long as one of them holds it.
+TEST_F(CoalescingDnsResolverRegistryTest, SharesTheResolversOfEquivalentConfigs) {
+  envoy::config::core::v3::TypedExtensionConfig config;
+  config.set_name("envoy.network.dns_resolver.cares");
+  envoy::config::core::v3::TypedExtensionConfig other_config;
+  other_config.set_name("envoy.network.dns_resolver.getaddrinfo");
+
+  EXPECT_CALL(factory_, createDnsResolver(_, _, _)).Times(2);
+  DnsResolverSharedPtr resolver = create(config);
+  EXPECT_NE(nullptr, dynamic_cast<CoalescingDnsResolver*>(resolver.get()));
+  EXPECT_EQ(resolver, create(config));
+  DnsResolverSharedPtr other_resolver = create(other_config);
+  EXPECT_NE(resolver, other_resolver);
+  testing::Mock::VerifyAndClearExpectations(&factory_);
+
+  // The released resolver is not held by the registry.
+  std::weak_ptr<DnsResolver> released = resolver;
+  resolver.reset();
+  EXPECT_TRUE(released.expired());
+  EXPECT_CALL(factory_, createDnsResolver(_, _, _));
+  EXPECT_NE(nullptr, create(config));
+}
+
+// The resolvers are not shared while the runtime guard is disabled.
+TEST_F(CoalescingDnsResolverRegistryTest, RuntimeGuardDisabled) {
+  scoped_runtime_.mergeValues({{"envoy.reloadable_features.coalesce_dns_resolutions", "false"}});
+  envoy::config::core::v3::TypedExtensionConfig config;
+  EXPECT_CALL(factory_, createDnsResolver(_, _, _)).Times(2);
+  DnsResolverSharedPtr resolver = create(config);
+  EXPECT_EQ(nullptr, dynamic_cast<CoalescingDnsResolver*>(resolver.get()));
+  EXPECT_NE(resolver, create(config));
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
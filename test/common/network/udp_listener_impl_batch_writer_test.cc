@@ -27,6 +27,7 @@
 #include "source/common/network/udp_listener_impl.h"
 #include "source/common/network/utility.h"
 
+#include "source/common/quic/envoy_quic_utils.h"
 #include "source/common/quic/udp_gso_batch_writer.h"
 
 #include "test/common/network/udp_listener_impl_test_base.h"
@@ -267,6 +268,49 @@ TEST_P(UdpListenerImplBatchWriterTest, WriteBlocked) {
   }
 }
 
+/**
+ * Tests that the flushes of the QUIC connections are deferred to the end of the event loop
+ * iteration, so that the packets of successive flushes are sent by a single sendmsg.
+ */
+TEST_P(UdpListenerImplBatchWriterTest, DeferredFlushes) {
+  quic::test::MockQuicSyscallWrapper os_sys_calls;
+  quic::ScopedGlobalSyscallWrapperOverride os_calls(&os_sys_calls);
+  auto& writer = dynamic_cast<Quic::UdpGsoBatchWriter&>(*udp_packet_writer_);
+  const uint64_t total_bytes_sent =
+      listener_config_.listenerScope().counterFromString("total_bytes_sent").value();
+  writer.deferFlushes(dispatcherImpl());
+
+  const std::string payload("length7");
+  const quic::QuicSocketAddress peer_address =
+      Quic::envoyIpAddressToQuicSocketAddress(client_.localAddress()->ip());
+  const quic::QuicIpAddress self_address =
+      Quic::envoyIpAddressToQuicSocketAddress(send_to_addr_->ip()).host();
+  EXPECT_CALL(os_sys_calls, Sendmsg(_, _, _)).Times(0);
+  for (int i = 0; i < 3; i++) {
+    const quic::WriteResult write_result =
+        writer.WritePacket(payload.data(), payload.length(), self_address, peer_address,
+                           /*options=*/nullptr, quic::QuicPacketWriterParams());
+    EXPECT_EQ(quic::WRITE_STATUS_OK, write_result.status);
+    const quic::WriteResult flush_result = writer.Flush();
+    EXPECT_EQ(quic::WRITE_STATUS_OK, flush_result.status);
+    EXPECT_EQ(0, flush_result.bytes_written);
+  }
+  testing::Mock::VerifyAndClearExpectations(&os_sys_calls);
+
+  EXPECT_CALL(os_sys_calls, Sendmsg(_, _, _))
+      .WillOnce(Invoke([&](int /*sockfd*/, const msghdr* msg, int /*flags*/) {
+        EXPECT_EQ(3 * payload.length(), getPacketLength(msg));
+        return 3 * payload.length();
+      }));
+  dispatcherImpl().run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(listener_config_.listenerScope().counterFromString("total_bytes_sent").value(),
+            total_bytes_sent + 3 * payload.length());
+  EXPECT_EQ(listener_config_.listenerScope()
+                .gaugeFromString("internal_buffer_size", Stats::Gauge::ImportMode::NeverImport)
+                .value(),
+            0);
+}
+
 } // namespace
 } // namespace Network
 } // namespace Envoy
@@ -94,6 +94,8 @@ public:
   }
 
   static bool enabled(ActiveQuicListener& listener) { return listener.enabled_->enabled(); }
+
+  static bool flushesDeferred(ActiveQuicListener& listener) { return listener.flushes_deferred_; }
 };
 
 class ActiveQuicListenerFactoryPeer {
@@ -398,6 +400,20 @@ TEST_P(ActiveQuicListenerTest, ReceiveCHLO) {
   readFromClientSockets();
 }
 
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+TEST_P(ActiveQuicListenerTest, ReceiveCHLOWithDeferredFlushes) {
+  scoped_runtime_.mergeValues(
+      {{"envoy.reloadable_features.quic_defer_gso_batch_flushes", "true"}});
+  initialize();
+  EXPECT_TRUE(ActiveQuicListenerPeer::flushesDeferred(*quic_listener_));
+  maybeConfigureMocks(/* connection_count = */ 1);
+  sendCHLO(quic::test::TestConnectionId(1));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(1u, quic_dispatcher_->NumSessions());
+  readFromClientSockets();
+}
+#endif
+
 class MockNonDispatchedUdpPacketHandler : public Network::NonDispatchedUdpPacketHandler {
 public:
   MOCK_METHOD(void, handle, (uint32_t worker_index, const Network::UdpRecvData& packet));
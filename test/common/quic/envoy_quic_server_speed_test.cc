@@ -0,0 +1,625 @@
+// Measures the CPU cost of the QUIC data path of the server on a single core. The packets of an
+// in-process client are processed in memory, and the packets of the server are written to an
+// in-memory UdpPacketWriter:
+// - bmHandshake: the handshakes per second of the EnvoyQuicDispatcher. Each CHLO creates a session
+//   and runs the server side of the TLS 1.3 handshake, with a fake certificate signature.
+// - bmRequests: the requests and bytes per second of an EnvoyQuicServerSession, with the time per
+//   request spent receiving the request (QUIC framing, QPACK decoding and the conversion of the
+//   headers), in the request decoder standing for the filter chain, and encoding the response. The
+//   packets of the requests are not protected, their protection is measured by
+//   bmPacketProtection.
+// - bmPacketProtection: the sealing and opening of a packet with AES-128-GCM, the crypto cost per
+//   packet of the established connections.
+// - bmBatchWriterFlushes: the sendmsg calls per event loop iteration of the UdpGsoBatchWriter
+//   shared by the connections of a worker, with and without deferring their flushes to the end of
+//   the iteration.
+
+#include <openssl/aead.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/core/v3/protocol.pb.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/common/fmt.h"
+#include "source/common/listener_manager/connection_handler_impl.h"
+#include "source/common/network/listen_socket_impl.h"
+#include "source/common/network/socket_impl.h"
+#include "source/common/quic/envoy_quic_alarm_factory.h"
+#include "source/common/quic/envoy_quic_connection_helper.h"
+#include "source/common/quic/envoy_quic_dispatcher.h"
+#include "source/common/quic/envoy_quic_packet_writer.h"
+#include "source/common/quic/envoy_quic_server_connection.h"
+#include "source/common/quic/envoy_quic_server_session.h"
+#include "source/common/quic/envoy_quic_utils.h"
+#include "source/common/quic/quic_server_transport_socket_factory.h"
+#include "source/common/quic/udp_gso_batch_writer.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/common/stream_info/stream_info_impl.h"
+#include "source/extensions/quic/crypto_stream/envoy_quic_crypto_server_stream.h"
+
+#include "test/common/quic/envoy_quic_h3_fuzz_helper.h"
+#include "test/common/quic/test_proof_source.h"
+#include "test/common/quic/test_utils.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "quiche/quic/core/deterministic_connection_id_generator.h"
+#include "quiche/quic/core/quic_framer.h"
+#include "quiche/quic/core/quic_syscall_wrapper.h"
+#include "quiche/quic/core/tls_server_handshaker.h"
+#include "quiche/quic/test_tools/quic_test_utils.h"
+
+namespace Envoy {
+namespace Quic {
+namespace {
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+constexpr size_t NumSessionsToCreatePerLoop = 16;
+// The number of requests sent on each connection of bmRequests. The in-memory client does not
+// acknowledge the packets of the server, so the responses of a connection must fit in the initial
+// burst of the pacing sender.
+constexpr uint32_t RequestsPerConnection = 8;
+// The size of the data of the stream frames of the requests, which fits in a packet.
+constexpr size_t StreamFrameSize = 1200;
+
+// Counts the packets written by the server, and discards them.
+class InMemoryUdpPacketWriter : public Network::UdpPacketWriter {
+public:
+  // Network::UdpPacketWriter
+  Api::IoCallUint64Result writePacket(const Buffer::Instance& buffer, const Network::Address::Ip*,
+                                      const Network::Address::Instance&) override {
+    packets_++;
+    return Api::IoCallUint64Result(buffer.length(), Api::IoError::none());
+  }
+  bool isWriteBlocked() const override { return false; }
+  void setWritable() override {}
+  uint64_t getMaxPacketSize(const Network::Address::Instance&) const override {
+    return Network::UdpMaxOutgoingPacketSize;
+  }
+  bool isBatchMode() const override { return false; }
+  Network::UdpPacketWriterBuffer getNextWriteLocation(const Network::Address::Ip*,
+                                                      const Network::Address::Instance&) override {
+    return {nullptr, 0, nullptr};
+  }
+  Api::IoCallUint64Result flush() override {
+    return Api::IoCallUint64Result(0, Api::IoError::none());
+  }
+
+  uint64_t packets_{};
+};
+
+// An EnvoyQuicDispatcher creating a session for each CHLO, with a filter chain without any network
+// filter.
+class HandshakeHarness {
+public:
+  HandshakeHarness()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("speed_test")),
+        ip_version_(TestEnvironment::getIpVersionsForTest()[0]),
+        listen_socket_(std::make_unique<Network::NetworkListenSocket<
+                           Network::NetworkSocketTrait<Network::Socket::Type::Datagram>>>(
+            Network::Test::getCanonicalLoopbackAddress(ip_version_), nullptr, /*bind*/ true)),
+        connection_helper_(*dispatcher_), proof_source_(new TestProofSource()),
+        crypto_config_(quic::QuicCryptoServerConfig::TESTING, quic::QuicRandom::GetInstance(),
+                       std::unique_ptr<TestProofSource>(proof_source_),
+                       quic::KeyExchangeSource::Default()),
+        version_manager_(quic::CurrentSupportedHttp3Versions()),
+        quic_version_(version_manager_.GetSupportedVersions()[0]),
+        listener_stats_({ALL_LISTENER_STATS(POOL_COUNTER(listener_config_.listenerScope()),
+                                            POOL_GAUGE(listener_config_.listenerScope()),
+                                            POOL_HISTOGRAM(listener_config_.listenerScope()))}),
+        per_worker_stats_({ALL_PER_HANDLER_LISTENER_STATS(
+            POOL_COUNTER_PREFIX(listener_config_.listenerScope(), "worker."),
+            POOL_GAUGE_PREFIX(listener_config_.listenerScope(), "worker."))}),
+        quic_stat_names_(listener_config_.listenerScope().symbolTable()),
+        connection_handler_(*dispatcher_, absl::nullopt),
+        connection_id_generator_(quic::kQuicDefaultConnectionIdLength),
+        envoy_quic_dispatcher_(
+            &crypto_config_, quic_config_, &version_manager_,
+            std::make_unique<EnvoyQuicConnectionHelper>(*dispatcher_),
+            std::make_unique<EnvoyQuicAlarmFactory>(*dispatcher_, *connection_helper_.GetClock()),
+            quic::kQuicDefaultConnectionIdLength, connection_handler_, listener_config_,
+            listener_stats_, per_worker_stats_, *dispatcher_, *listen_socket_, quic_stat_names_,
+            crypto_stream_factory_, connection_id_generator_),
+        transport_socket_factory_(true, listener_config_.listenerScope(),
+                                  std::make_unique<NiceMock<Ssl::MockServerContextConfig>>()),
+        self_address_(envoyIpAddressToQuicSocketAddress(
+            listen_socket_->connectionInfoProvider().localAddress()->ip())),
+        peer_address_(ip_version_ == Network::Address::IpVersion::v4
+                          ? quic::QuicIpAddress::Loopback4()
+                          : quic::QuicIpAddress::Loopback6(),
+                      54321) {
+    writer_ = new InMemoryUdpPacketWriter();
+    envoy_quic_dispatcher_.InitializeWithWriter(
+        new EnvoyQuicPacketWriter(Network::UdpPacketWriterPtr(writer_)));
+
+    ON_CALL(listener_config_, perConnectionBufferLimitBytes()).WillByDefault(Return(1024 * 1024));
+    ON_CALL(listener_config_, filterChainManager()).WillByDefault(ReturnRef(filter_chain_manager_));
+    ON_CALL(filter_chain_manager_, findFilterChain(_, _))
+        .WillByDefault(Return(&proof_source_->filterChain()));
+    EXPECT_CALL(proof_source_->filterChain(), transportSocketFactory())
+        .WillRepeatedly(ReturnRef(transport_socket_factory_));
+    EXPECT_CALL(proof_source_->filterChain(), networkFilterFactories())
+        .WillRepeatedly(ReturnRef(filter_factories_));
+    ON_CALL(listener_config_.filter_chain_factory_, createQuicListenerFilterChain(_))
+        .WillByDefault(Return(true));
+    ON_CALL(listener_config_.filter_chain_factory_, createNetworkFilterChain(_, _))
+        .WillByDefault(Return(true));
+  }
+
+  ~HandshakeHarness() {
+    envoy_quic_dispatcher_.Shutdown();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  // Builds the CHLO of a new connection, as sent by a client.
+  std::unique_ptr<quic::QuicReceivedPacket> chloPacket(uint64_t connection) {
+    return std::move(quic::test::GetFirstFlightOfPackets(
+        quic_version_, quic_config_, quic::test::TestConnectionId(connection))[0]);
+  }
+
+  void processPacket(const quic::QuicReceivedPacket& packet) {
+    envoy_quic_dispatcher_.ProcessBufferedChlos(NumSessionsToCreatePerLoop);
+    envoy_quic_dispatcher_.ProcessPacket(self_address_, peer_address_, packet);
+  }
+
+  size_t sessions() const { return envoy_quic_dispatcher_.NumSessions(); }
+  uint64_t packetsWritten() const { return writer_->packets_; }
+
+private:
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  const Network::Address::IpVersion ip_version_;
+  Network::SocketPtr listen_socket_;
+  EnvoyQuicConnectionHelper connection_helper_;
+  TestProofSource* proof_source_;
+  quic::QuicCryptoServerConfig crypto_config_;
+  quic::QuicConfig quic_config_;
+  quic::QuicVersionManager version_manager_;
+  quic::ParsedQuicVersion quic_version_;
+  NiceMock<Network::MockListenerConfig> listener_config_;
+  Server::ListenerStats listener_stats_;
+  Server::PerHandlerListenerStats per_worker_stats_;
+  QuicStatNames quic_stat_names_;
+  Server::ConnectionHandlerImpl connection_handler_;
+  EnvoyQuicCryptoServerStreamFactoryImpl crypto_stream_factory_;
+  quic::DeterministicConnectionIdGenerator connection_id_generator_;
+  EnvoyQuicDispatcher envoy_quic_dispatcher_;
+  QuicServerTransportSocketFactory transport_socket_factory_;
+  NiceMock<Network::MockFilterChainManager> filter_chain_manager_;
+  Filter::NetworkFilterFactoriesList filter_factories_;
+  const quic::QuicSocketAddress self_address_;
+  const quic::QuicSocketAddress peer_address_;
+  InMemoryUdpPacketWriter* writer_;
+};
+
+// Processes the CHLOs of new connections. The CHLOs are built by the client outside of the timed
+// section.
+void bmHandshake(benchmark::State& state) {
+  HandshakeHarness harness;
+  uint64_t handshakes = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    state.PauseTiming();
+    std::unique_ptr<quic::QuicReceivedPacket> chlo = harness.chloPacket(handshakes + 1);
+    state.ResumeTiming();
+    harness.processPacket(*chlo);
+    handshakes++;
+  }
+  RELEASE_ASSERT(harness.sessions() == handshakes, "a CHLO did not create a session");
+  state.SetItemsProcessed(handshakes);
+  state.counters["packets_out_per_handshake"] =
+      benchmark::Counter(harness.packetsWritten(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(bmHandshake)->Unit(benchmark::kMicrosecond);
+
+// The crypto stream of the sessions of bmRequests, whose handshake is skipped.
+class EstablishedTlsServerHandshaker : public quic::TlsServerHandshaker {
+public:
+  EstablishedTlsServerHandshaker(quic::QuicSession* session,
+                                 const quic::QuicCryptoServerConfig& crypto_config)
+      : quic::TlsServerHandshaker(session, &crypto_config),
+        params_(new quic::QuicCryptoNegotiatedParameters) {
+    params_->cipher_suite = 1;
+  }
+
+  bool encryption_established() const override { return true; }
+  const quic::QuicCryptoNegotiatedParameters& crypto_negotiated_params() const override {
+    return *params_;
+  }
+
+private:
+  quiche::QuicheReferenceCountedPointer<quic::QuicCryptoNegotiatedParameters> params_;
+};
+
+class EstablishedCryptoServerStreamFactory : public EnvoyQuicCryptoServerStreamFactoryInterface {
+public:
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override { return nullptr; }
+  std::string name() const override { return "quic.established_crypto_server_stream"; }
+
+  std::unique_ptr<quic::QuicCryptoServerStreamBase> createEnvoyQuicCryptoServerStream(
+      const quic::QuicCryptoServerConfig* crypto_config, quic::QuicCompressedCertsCache*,
+      quic::QuicSession* session, quic::QuicCryptoServerStreamBase::Helper*,
+      OptRef<const Network::DownstreamTransportSocketFactory>, Event::Dispatcher&) override {
+    return std::make_unique<EstablishedTlsServerHandshaker>(session, *crypto_config);
+  }
+};
+
+// An EnvoyQuicServerSession whose handshake is skipped, receiving requests of a given body size
+// and number of extra headers, and answering each of them with headers only.
+class RequestHarness {
+public:
+  RequestHarness(uint32_t body_size, uint32_t extra_headers)
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("speed_test")),
+        connection_helper_(*dispatcher_),
+        alarm_factory_(*dispatcher_, *connection_helper_.GetClock()),
+        quic_version_(quic::CurrentSupportedHttp3Versions()[0]),
+        peer_address_(Network::Utility::getAddressWithPort(
+            *Network::Utility::getIpv6LoopbackAddress(), 12345)),
+        self_address_(Network::Utility::getAddressWithPort(
+            *Network::Utility::getIpv6LoopbackAddress(), 54321)),
+        client_address_(peer_address_->sockAddr(), peer_address_->sockAddrLen()),
+        server_address_(self_address_->sockAddr(), self_address_->sockAddrLen()),
+        quic_stat_names_(listener_config_.listenerScope().symbolTable()),
+        http3_stats_({ALL_HTTP3_CODEC_STATS(
+            POOL_COUNTER_PREFIX(listener_config_.listenerScope(), "http3."),
+            POOL_GAUGE_PREFIX(listener_config_.listenerScope(), "http3."))}),
+        crypto_config_(quic::QuicCryptoServerConfig::TESTING, quic::QuicRandom::GetInstance(),
+                       std::make_unique<TestProofSource>(), quic::KeyExchangeSource::Default()),
+        connection_stats_({QUIC_CONNECTION_STATS(
+            POOL_COUNTER_PREFIX(listener_config_.listenerScope(), "quic.connection"))}),
+        framer_({quic_version_}, connection_helper_.GetClock()->Now(),
+                quic::Perspective::IS_CLIENT, quic::kQuicDefaultConnectionIdLength),
+        packet_number_(0), body_size_(body_size) {
+    udp_writer_ = new InMemoryUdpPacketWriter();
+    writer_ = std::make_unique<EnvoyQuicPacketWriter>(Network::UdpPacketWriterPtr(udp_writer_));
+    // The server uses the default flow control windows of the listeners.
+    convertQuicConfig(envoy::config::core::v3::QuicProtocolOptions(), quic_config_);
+    framer_.SetEncrypter(quic::ENCRYPTION_INITIAL,
+                         std::make_unique<FuzzEncrypter>(quic::Perspective::IS_CLIENT));
+    buildRequestPackets(extra_headers);
+
+    ON_CALL(http_connection_callbacks_, newStream(_, _))
+        .WillByDefault(
+            Invoke([this](Http::ResponseEncoder& encoder, bool) -> Http::RequestDecoder& {
+              response_encoder_ = &encoder;
+              return request_decoder_;
+            }));
+    ON_CALL(request_decoder_, decodeHeaders_(_, _))
+        .WillByDefault(Invoke([this](Http::RequestHeaderMapSharedPtr&, bool end_stream) {
+          decode(0, end_stream);
+        }));
+    ON_CALL(request_decoder_, decodeData(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool end_stream) {
+          decode(data.length(), end_stream);
+        }));
+  }
+
+  ~RequestHarness() { disconnect(); }
+
+  void connect() {
+    auto connection = std::make_unique<EnvoyQuicServerConnection>(
+        quic::test::TestConnectionId(), server_address_, client_address_, connection_helper_,
+        alarm_factory_, writer_.get(), /*owns_writer=*/false,
+        quic::ParsedQuicVersionVector{quic_version_},
+        Quic::createConnectionSocket(peer_address_, self_address_, nullptr),
+        connection_id_generator_, nullptr);
+    connection->InstallDecrypter(quic::ENCRYPTION_FORWARD_SECURE,
+                                 std::make_unique<FuzzDecrypter>(quic::Perspective::IS_SERVER));
+    connection->SetEncrypter(quic::ENCRYPTION_FORWARD_SECURE,
+                             std::make_unique<FuzzEncrypter>(quic::Perspective::IS_SERVER));
+    connection->SetDefaultEncryptionLevel(quic::ENCRYPTION_FORWARD_SECURE);
+
+    auto stream_info = std::make_unique<StreamInfo::StreamInfoImpl>(
+        dispatcher_->timeSource(),
+        connection->connectionSocket()->connectionInfoProviderSharedPtr());
+    session_ = std::make_unique<EnvoyQuicServerSession>(
+        quic_config_, quic::ParsedQuicVersionVector{quic_version_}, std::move(connection), nullptr,
+        &crypto_stream_helper_, &crypto_config_, &compressed_certs_cache_, *dispatcher_,
+        quic::kDefaultFlowControlSendWindow * 1.5, quic_stat_names_,
+        listener_config_.listenerScope(), crypto_stream_factory_, std::move(stream_info),
+        connection_stats_);
+    session_->Initialize();
+    session_->setHeadersWithUnderscoreAction(envoy::config::core::v3::HttpProtocolOptions::ALLOW);
+    session_->setHttp3Options(http3_options_);
+    session_->setCodecStats(http3_stats_);
+    session_->setHttpConnectionCallbacks(http_connection_callbacks_);
+    session_->setMaxIncomingHeadersCount(100);
+    session_->set_max_inbound_header_list_size(64 * 1024u);
+    setQuicConfigWithDefaultValues(session_->config());
+    session_->OnConfigNegotiated();
+  }
+
+  void disconnect() {
+    if (session_ != nullptr) {
+      session_->connection()->CloseConnection(quic::QUIC_PEER_GOING_AWAY, "benchmark done",
+                                              quic::ConnectionCloseBehavior::SILENT_CLOSE);
+      session_.reset();
+    }
+  }
+
+  // Processes the packets of the request of the connection with the given index, and accounts the
+  // time spent receiving the request.
+  void sendRequest(uint32_t index) {
+    const MonotonicTime start = api_->timeSource().monotonicTime();
+    const std::chrono::nanoseconds handled = decoder_time_ + encoder_time_;
+    const quic::QuicTime receipt_time = connection_helper_.GetClock()->Now();
+    for (const auto& packet : request_packets_[index]) {
+      quic::QuicReceivedPacket received(packet->data(), packet->length(), receipt_time, false);
+      session_->ProcessUdpPacket(server_address_, client_address_, received);
+    }
+    receive_time_ += api_->timeSource().monotonicTime() - start -
+                     (decoder_time_ + encoder_time_ - handled);
+  }
+
+  uint64_t responses() const { return responses_; }
+  uint64_t receivedBytes() const { return received_bytes_; }
+  uint64_t packetsIn() const { return packets_in_; }
+  uint64_t packetsOut() const { return udp_writer_->packets_; }
+  std::chrono::nanoseconds receiveTime() const { return receive_time_; }
+  std::chrono::nanoseconds decoderTime() const { return decoder_time_; }
+  std::chrono::nanoseconds encoderTime() const { return encoder_time_; }
+
+private:
+  // Builds the packets of the requests of a connection, sent on the client initiated
+  // bidirectional streams. The same packets are sent on each connection.
+  void buildRequestPackets(uint32_t extra_headers) {
+    spdy::Http2HeaderBlock headers;
+    headers[":authority"] = "www.example.com";
+    headers[":method"] = body_size_ > 0 ? "POST" : "GET";
+    headers[":path"] = "/";
+    headers[":scheme"] = "https";
+    for (uint32_t i = 0; i < extra_headers; i++) {
+      headers[fmt::format("x-speed-test-{}", i)] = std::string(32, 'a');
+    }
+    std::string payload = spdyHeaderToHttp3StreamPayload(headers);
+    if (body_size_ > 0) {
+      payload += bodyToHttp3StreamPayload(std::string(body_size_, 'a'));
+    }
+
+    request_packets_.resize(RequestsPerConnection);
+    for (uint32_t i = 0; i < RequestsPerConnection; i++) {
+      // The client initiated bidirectional streams are 0, 4, 8...
+      const quic::QuicStreamId stream_id = 4 * i;
+      for (size_t offset = 0; offset < payload.size(); offset += StreamFrameSize) {
+        const size_t length = std::min(StreamFrameSize, payload.size() - offset);
+        request_packets_[i].push_back(serializeStreamFrame(
+            stream_id, offset + length == payload.size(), offset, payload.data() + offset, length));
+        packets_in_++;
+      }
+    }
+    packets_in_ /= RequestsPerConnection;
+  }
+
+  std::unique_ptr<quic::QuicEncryptedPacket> serializeStreamFrame(quic::QuicStreamId stream_id,
+                                                                  bool fin,
+                                                                  quic::QuicStreamOffset offset,
+                                                                  const char* data, size_t length) {
+    char* buffer = new char[QuicPacketizer::kMaxPacketSize];
+    quic::QuicPacketHeader header;
+    header.packet_number = packet_number_++;
+    header.destination_connection_id = quic::test::TestConnectionId();
+    header.source_connection_id = quic::test::TestConnectionId();
+    quic::QuicFrames frames = {
+        quic::QuicFrame(quic::QuicStreamFrame(stream_id, fin, offset, data, length))};
+    const size_t size =
+        framer_.BuildDataPacket(header, frames, buffer, QuicPacketizer::kMaxPacketSize,
+                                quic::EncryptionLevel::ENCRYPTION_INITIAL);
+    return std::make_unique<quic::QuicEncryptedPacket>(buffer, size, true);
+  }
+
+  // Stands for the filter chain, which answers each request once it is decoded.
+  void decode(uint64_t bytes, bool end_stream) {
+    const MonotonicTime start = api_->timeSource().monotonicTime();
+    received_bytes_ += bytes;
+    if (!end_stream) {
+      decoder_time_ += api_->timeSource().monotonicTime() - start;
+      return;
+    }
+    const MonotonicTime encode_start = api_->timeSource().monotonicTime();
+    decoder_time_ += encode_start - start;
+    response_encoder_->encodeHeaders(response_headers_, /*end_stream=*/true);
+    encoder_time_ += api_->timeSource().monotonicTime() - encode_start;
+    responses_++;
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  EnvoyQuicConnectionHelper connection_helper_;
+  EnvoyQuicAlarmFactory alarm_factory_;
+  const quic::ParsedQuicVersion quic_version_;
+  Network::Address::InstanceConstSharedPtr peer_address_;
+  Network::Address::InstanceConstSharedPtr self_address_;
+  const quic::QuicSocketAddress client_address_;
+  const quic::QuicSocketAddress server_address_;
+  InMemoryUdpPacketWriter* udp_writer_;
+  std::unique_ptr<EnvoyQuicPacketWriter> writer_;
+  NiceMock<Network::MockListenerConfig> listener_config_;
+  QuicStatNames quic_stat_names_;
+  Http::Http3::CodecStats http3_stats_;
+  quic::QuicConfig quic_config_;
+  envoy::config::core::v3::Http3ProtocolOptions http3_options_;
+  quic::DeterministicConnectionIdGenerator connection_id_generator_{
+      quic::kQuicDefaultConnectionIdLength};
+  quic::QuicCompressedCertsCache compressed_certs_cache_{100};
+  EstablishedCryptoServerStreamFactory crypto_stream_factory_;
+  const quic::QuicCryptoServerConfig crypto_config_;
+  QuicConnectionStats connection_stats_;
+  NiceMock<quic::test::MockQuicCryptoServerStreamHelper> crypto_stream_helper_;
+  NiceMock<Http::MockServerConnectionCallbacks> http_connection_callbacks_;
+  NiceMock<Http::MockRequestDecoder> request_decoder_;
+  Http::ResponseEncoder* response_encoder_{};
+  const Http::TestResponseHeaderMapImpl response_headers_{{":status", "200"}};
+  std::unique_ptr<EnvoyQuicServerSession> session_;
+
+  quic::QuicFramer framer_;
+  quic::QuicPacketNumber packet_number_;
+  const uint32_t body_size_;
+  std::vector<std::vector<std::unique_ptr<quic::QuicEncryptedPacket>>> request_packets_;
+  uint64_t packets_in_{};
+
+  uint64_t responses_{};
+  uint64_t received_bytes_{};
+  std::chrono::nanoseconds receive_time_{};
+  std::chrono::nanoseconds decoder_time_{};
+  std::chrono::nanoseconds encoder_time_{};
+};
+
+// Receives requests and answers them, reconnecting after RequestsPerConnection requests outside of
+// the timed section. Arguments: the size of the body of the requests, and the number of extra
+// headers of the requests, whose QPACK decoding shows in the receive time.
+void bmRequests(benchmark::State& state) {
+  RequestHarness harness(state.range(0), state.range(1));
+  uint64_t requests = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    const uint32_t index = requests % RequestsPerConnection;
+    if (index == 0) {
+      state.PauseTiming();
+      harness.disconnect();
+      harness.connect();
+      state.ResumeTiming();
+    }
+    harness.sendRequest(index);
+    requests++;
+  }
+  RELEASE_ASSERT(harness.responses() == requests, "a request was not answered");
+  state.SetItemsProcessed(requests);
+  state.SetBytesProcessed(harness.receivedBytes());
+  state.counters["packets_in_per_request"] = harness.packetsIn();
+  state.counters["packets_out_per_request"] =
+      benchmark::Counter(harness.packetsOut(), benchmark::Counter::kAvgIterations);
+  state.counters["receive_ns"] =
+      benchmark::Counter(harness.receiveTime().count(), benchmark::Counter::kAvgIterations);
+  state.counters["decoder_ns"] =
+      benchmark::Counter(harness.decoderTime().count(), benchmark::Counter::kAvgIterations);
+  state.counters["encoder_ns"] =
+      benchmark::Counter(harness.encoderTime().count(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(bmRequests)
+    ->Args({0, 0})
+    ->Args({0, 16})
+    ->Args({1024, 0})
+    ->Args({8192, 0})
+    ->Unit(benchmark::kMicrosecond);
+
+// Seals and opens a packet of the given size with AES-128-GCM, as the packet protection of QUIC
+// (RFC 9001) does. The header protection is not included.
+void bmPacketProtection(benchmark::State& state) {
+  const size_t packet_size = state.range(0);
+  const EVP_AEAD* aead = EVP_aead_aes_128_gcm();
+  const std::vector<uint8_t> key(EVP_AEAD_key_length(aead), 'k');
+  bssl::ScopedEVP_AEAD_CTX context;
+  RELEASE_ASSERT(EVP_AEAD_CTX_init(context.get(), aead, key.data(), key.size(),
+                                   EVP_AEAD_DEFAULT_TAG_LENGTH, nullptr) == 1,
+                 "");
+  // The header of a short header packet with a connection ID of 8 bytes, which is authenticated.
+  const std::vector<uint8_t> header(1 + quic::kQuicDefaultConnectionIdLength + 4, 0x40);
+  std::vector<uint8_t> nonce(EVP_AEAD_nonce_length(aead));
+  std::vector<uint8_t> plaintext(packet_size, 'a');
+  std::vector<uint8_t> ciphertext(packet_size + EVP_AEAD_max_overhead(aead));
+
+  uint64_t packets = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    // The nonce is derived from the packet number.
+    nonce.back() = static_cast<uint8_t>(packets);
+    size_t ciphertext_length = 0;
+    RELEASE_ASSERT(EVP_AEAD_CTX_seal(context.get(), ciphertext.data(), &ciphertext_length,
+                                     ciphertext.size(), nonce.data(), nonce.size(),
+                                     plaintext.data(), plaintext.size(), header.data(),
+                                     header.size()) == 1,
+                   "");
+    size_t plaintext_length = 0;
+    RELEASE_ASSERT(EVP_AEAD_CTX_open(context.get(), plaintext.data(), &plaintext_length,
+                                     plaintext.size(), nonce.data(), nonce.size(),
+                                     ciphertext.data(), ciphertext_length, header.data(),
+                                     header.size()) == 1,
+                   "");
+    packets++;
+  }
+  state.SetItemsProcessed(packets);
+  state.SetBytesProcessed(packets * packet_size);
+}
+BENCHMARK(bmPacketProtection)->Arg(64)->Arg(1200)->Unit(benchmark::kNanosecond);
+
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+// Counts the sendmsg calls of the writers instead of sending their packets.
+class CountingSyscallWrapper : public quic::QuicSyscallWrapper {
+public:
+  ssize_t Sendmsg(int, const msghdr* message, int) override {
+    sendmsgs_++;
+    ssize_t length = 0;
+    for (size_t i = 0; i < message->msg_iovlen; i++) {
+      length += message->msg_iov[i].iov_len;
+    }
+    return length;
+  }
+
+  uint64_t sendmsgs_{};
+};
+
+// Writes packets to the UdpGsoBatchWriter of a worker for its connections, each connection
+// flushing after each of its packets as when its alarms and streams write in turn, then ends the
+// event loop iteration. Arguments: the number of connections, the number of flushes per connection
+// and iteration, and whether the flushes are deferred to the end of the iteration.
+void bmBatchWriterFlushes(benchmark::State& state) {
+  const uint32_t connections = state.range(0);
+  const uint32_t flushes = state.range(1);
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("speed_test");
+  Network::SocketImpl socket(Network::Socket::Type::Datagram,
+                             Network::Utility::parseInternetAddressAndPort("127.0.0.1:0"),
+                             nullptr, Network::SocketCreationOptions{});
+  Stats::IsolatedStoreImpl store;
+  UdpGsoBatchWriter writer(socket.ioHandle(), *store.rootScope());
+  if (state.range(2) != 0) {
+    writer.deferFlushes(*dispatcher);
+  }
+  CountingSyscallWrapper syscalls;
+  quic::ScopedGlobalSyscallWrapperOverride syscalls_override(&syscalls);
+
+  std::vector<quic::QuicSocketAddress> peer_addresses;
+  for (uint32_t i = 0; i < connections; i++) {
+    peer_addresses.emplace_back(quic::QuicIpAddress::Loopback4(), 10000 + i);
+  }
+  const std::string packet(StreamFrameSize, 'a');
+  uint64_t packets = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    for (const quic::QuicSocketAddress& peer_address : peer_addresses) {
+      for (uint32_t i = 0; i < flushes; i++) {
+        writer.WritePacket(packet.data(), packet.size(), quic::QuicIpAddress::Loopback4(),
+                           peer_address, nullptr, quic::QuicPacketWriterParams());
+        writer.Flush();
+        packets++;
+      }
+    }
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  RELEASE_ASSERT(syscalls.sendmsgs_ > 0, "no packet was sent");
+  state.SetItemsProcessed(packets);
+  state.SetBytesProcessed(packets * packet.size());
+  state.counters["sendmsg_per_iteration"] =
+      benchmark::Counter(syscalls.sendmsgs_, benchmark::Counter::kAvgIterations);
+  state.counters["packets_per_sendmsg"] = static_cast<double>(packets) / syscalls.sendmsgs_;
+}
+BENCHMARK(bmBatchWriterFlushes)
+    ->Args({1, 8, 0})
+    ->Args({1, 8, 1})
+    ->Args({16, 4, 0})
+    ->Args({16, 4, 1})
+    ->Unit(benchmark::kMicrosecond);
+#endif
+
+} // namespace
+} // namespace Quic
+} // namespace Envoy
@@ -123,6 +123,9 @@ public:
     ASSERT(dynamic_cast<ConnPoolImplForTest*>(conn_pool_.get()) != nullptr);
     return dynamic_cast<ConnPoolImplForTest*>(conn_pool_.get())->maybePreconnect(ratio);
   }
+  uint32_t prewarm(uint32_t unused_capacity, uint32_t max_new_connections) override {
+    return conn_pool_->prewarm(unused_capacity, max_new_connections);
+  }
 
   struct TestConnection {
     Network::MockClientConnection* connection_;
@@ -4673,6 +4673,69 @@ TEST_F(ClusterManagerImplTest, UpstreamSocketOptionsUsedInConnPoolHash) {
   EXPECT_EQ(cp2, should_be_cp2);
 }
 
+// Adaptive prewarming warms the pool the requests use, and stops once requests use different
+// pools.
+TEST_F(ClusterManagerImplTest, AdaptivePrewarmUsesRequestPool) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      type: STATIC
+      preconnect_policy:
+        adaptive_prewarm:
+          interval: 1s
+          lookahead: 1s
+      load_assignment:
+        cluster_name: cluster_1
+        endpoints:
+        - lb_endpoints:
+          - endpoint:
+              address:
+                socket_address:
+                  address: 127.0.0.1
+                  port_value: 11001
+  )EOF";
+  create(parseBootstrapFromV3Yaml(yaml));
+
+  NiceMock<MockLoadBalancerContext> context1;
+  NiceMock<MockLoadBalancerContext> context2;
+  Network::Socket::OptionsSharedPtr options1 =
+      Network::SocketOptionFactory::buildTcpKeepaliveOptions({});
+  Network::Socket::OptionsSharedPtr options2 =
+      Network::SocketOptionFactory::buildIpPacketInfoOptions();
+  ON_CALL(context1, upstreamSocketOptions()).WillByDefault(Return(options1));
+  ON_CALL(context2, upstreamSocketOptions()).WillByDefault(Return(options2));
+  auto* cp1 = new NiceMock<Http::ConnectionPool::MockInstance>();
+  auto* cp2 = new NiceMock<Http::ConnectionPool::MockInstance>();
+
+  Event::MockTimer* prewarm_timer = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _)).WillOnce(Return(cp1));
+  EXPECT_EQ(cp1, HttpPoolDataPeer::getPool(
+                     cluster_manager_->getThreadLocalCluster("cluster_1")
+                         ->httpConnPool(ResourcePriority::Default, Http::Protocol::Http11,
+                                        &context1)));
+
+  // The pool of the socket options of the requests is warmed, not one without options.
+  EXPECT_CALL(*cp1, prewarm(1, 1));
+  prewarm_timer->invokeCallback();
+
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _)).WillOnce(Return(cp2));
+  EXPECT_EQ(cp2, HttpPoolDataPeer::getPool(
+                     cluster_manager_->getThreadLocalCluster("cluster_1")
+                         ->httpConnPool(ResourcePriority::Default, Http::Protocol::Http11,
+                                        &context2)));
+  // Neither pool is warmed anymore, and no new prewarming timer is created.
+  EXPECT_CALL(*cp1, prewarm(_, _)).Times(0);
+  EXPECT_CALL(*cp2, prewarm(_, _)).Times(0);
+  EXPECT_CALL(factory_.dispatcher_, createTimer_(_)).Times(0);
+  EXPECT_EQ(cp1, HttpPoolDataPeer::getPool(
+                     cluster_manager_->getThreadLocalCluster("cluster_1")
+                         ->httpConnPool(ResourcePriority::Default, Http::Protocol::Http11,
+                                        &context1)));
+}
+
 TEST_F(ClusterManagerImplTest, UpstreamSocketOptionsNullIsOkay) {
   createWithBasicStaticCluster();
   NiceMock<MockLoadBalancerContext> context;
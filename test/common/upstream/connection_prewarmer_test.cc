@@ -0,0 +1,182 @@
+#include <cmath>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+
+#include "source/common/upstream/connection_prewarmer.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/upstream/cluster_info.h"
+#include "test/mocks/upstream/priority_set.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+using testing::_;
+using testing::NiceMock;
+using testing::Return;
+
+class ConnectionPrewarmerTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::config::cluster::v3::Cluster::PreconnectPolicy::AdaptivePrewarm config;
+    TestUtility::loadFromYaml(yaml, config);
+    timer_ = new NiceMock<Event::MockTimer>(&dispatcher_);
+    prewarmer_ = std::make_unique<ConnectionPrewarmer>(
+        config, priority_set_, dispatcher_,
+        [this](const HostConstSharedPtr& host, uint32_t unused_capacity,
+               uint32_t max_new_connections) {
+          return prewarm_cb_.Call(host, unused_capacity, max_new_connections);
+        });
+  }
+
+  HostSharedPtr addHost(const std::string& url) {
+    HostSharedPtr host = makeTestHost(cluster_, url, simTime());
+    priority_set_.getMockHostSet(0)->hosts_.push_back(host);
+    return host;
+  }
+
+  void onRequests(const HostSharedPtr& host, uint32_t requests) {
+    for (uint32_t i = 0; i < requests; i++) {
+      prewarmer_->onRequest(host);
+    }
+  }
+
+  void runInterval() {
+    EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(1000), _));
+    timer_->invokeCallback();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Event::SimulatedTimeSystem& simTime() { return time_system_; }
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<MockPrioritySet> priority_set_;
+  std::shared_ptr<MockClusterInfo> cluster_{new NiceMock<MockClusterInfo>()};
+  testing::MockFunction<uint32_t(const HostConstSharedPtr&, uint32_t, uint32_t)> prewarm_cb_;
+  Event::MockTimer* timer_;
+  ConnectionPrewarmerPtr prewarmer_;
+};
+
+// The request rate of a host is averaged over the window, and the pool of the host is asked for
+// the capacity to serve the requests expected over the lookahead.
+TEST_F(ConnectionPrewarmerTest, RequestRate) {
+  initialize(R"EOF(
+interval: 1s
+rate_window: 1s
+lookahead: 1s
+)EOF");
+  const HostSharedPtr host = addHost("tcp://127.0.0.1:80");
+  const double alpha = 1 - std::exp(-1.0);
+
+  // The first sample of a host is taken as is.
+  onRequests(host, 10);
+  EXPECT_CALL(prewarm_cb_, Call(HostConstSharedPtr(host), 10, 10)).WillOnce(Return(10));
+  runInterval();
+  EXPECT_DOUBLE_EQ(10, prewarmer_->requestRate(host));
+
+  // Without requests, the rate decays.
+  EXPECT_CALL(prewarm_cb_, Call(HostConstSharedPtr(host), 4, 4)).WillOnce(Return(0));
+  runInterval();
+  EXPECT_NEAR(10 * (1 - alpha), prewarmer_->requestRate(host), 1e-9);
+
+  // Once the host is idle, it is no longer prewarmed, and the timer stops.
+  EXPECT_CALL(prewarm_cb_, Call(_, _, _)).WillRepeatedly(Return(0));
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(1000), _))
+      .Times(testing::AtLeast(1));
+  while (timer_->enabled_) {
+    timer_->invokeCallback();
+  }
+  EXPECT_EQ(0, prewarmer_->requestRate(host));
+
+  // The next request starts the timer again.
+  EXPECT_CALL(*timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  onRequests(host, 2);
+  EXPECT_TRUE(timer_->enabled_);
+}
+
+// Hosts which did not get requests yet are assumed to get the average rate of the cluster, so that
+// they are warm before taking traffic, and hosts leaving the cluster are forgotten.
+TEST_F(ConnectionPrewarmerTest, NewHostSeededWithAverageRate) {
+  initialize(R"EOF(
+interval: 1s
+rate_window: 1s
+lookahead: 1s
+)EOF");
+  const HostSharedPtr host1 = addHost("tcp://127.0.0.1:80");
+  onRequests(host1, 10);
+  EXPECT_CALL(prewarm_cb_, Call(_, _, _)).WillRepeatedly(Return(0));
+  runInterval();
+
+  const HostSharedPtr host2 = addHost("tcp://127.0.0.2:80");
+  runInterval();
+  EXPECT_GT(prewarmer_->requestRate(host2), 0);
+  EXPECT_DOUBLE_EQ(prewarmer_->requestRate(host1), prewarmer_->requestRate(host2));
+
+  priority_set_.getMockHostSet(0)->hosts_.erase(priority_set_.getMockHostSet(0)->hosts_.begin());
+  runInterval();
+  EXPECT_EQ(0, prewarmer_->requestRate(host1));
+  EXPECT_GT(prewarmer_->requestRate(host2), 0);
+}
+
+// When the demand exceeds the budget, the warm connections are shared in proportion to demand.
+TEST_F(ConnectionPrewarmerTest, BudgetSharedByDemand) {
+  initialize(R"EOF(
+interval: 1s
+rate_window: 1s
+lookahead: 1s
+max_warm_connections: 4
+)EOF");
+  const HostSharedPtr host1 = addHost("tcp://127.0.0.1:80");
+  const HostSharedPtr host2 = addHost("tcp://127.0.0.2:80");
+  onRequests(host1, 10);
+  onRequests(host2, 10);
+  EXPECT_CALL(prewarm_cb_, Call(HostConstSharedPtr(host1), 10, 2)).WillOnce(Return(2));
+  EXPECT_CALL(prewarm_cb_, Call(HostConstSharedPtr(host2), 10, 2)).WillOnce(Return(2));
+  runInterval();
+}
+
+// The budget is shared by the workers: the warm connections of the other workers count against it.
+TEST_F(ConnectionPrewarmerTest, BudgetSharedByWorkers) {
+  initialize(R"EOF(
+interval: 1s
+rate_window: 1s
+lookahead: 1s
+max_warm_connections: 4
+)EOF");
+  const HostSharedPtr host1 = addHost("tcp://127.0.0.1:80");
+  const HostSharedPtr host2 = addHost("tcp://127.0.0.2:80");
+  onRequests(host1, 10);
+  onRequests(host2, 10);
+  host1->stats().cx_warm_.set(2);
+  EXPECT_CALL(prewarm_cb_, Call(HostConstSharedPtr(host1), 10, 1)).WillOnce(Return(1));
+  EXPECT_CALL(prewarm_cb_, Call(HostConstSharedPtr(host2), 10, 1)).WillOnce(Return(1));
+  runInterval();
+
+  // Once the budget is used up, no connection is created, but the timer keeps running.
+  host2->stats().cx_warm_.set(2);
+  EXPECT_CALL(prewarm_cb_, Call(_, _, _)).Times(0);
+  runInterval();
+}
+
+// Unhealthy hosts are not prewarmed.
+TEST_F(ConnectionPrewarmerTest, UnhealthyHost) {
+  initialize(R"EOF(
+interval: 1s
+)EOF");
+  const HostSharedPtr host = addHost("tcp://127.0.0.1:80");
+  host->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  onRequests(host, 100);
+  EXPECT_CALL(prewarm_cb_, Call(_, _, _)).Times(0);
+  runInterval();
+  EXPECT_GT(prewarmer_->requestRate(host), 0);
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
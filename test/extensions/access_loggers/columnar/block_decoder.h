@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "source/extensions/access_loggers/columnar/block_encoder.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+
+struct DecodedColumn {
+  std::string name_;
+  ColumnType type_;
+  // The values of the entries, by entry. Only one of them is filled, depending on the type.
+  std::vector<absl::optional<std::string>> strings_;
+  std::vector<absl::optional<int64_t>> integers_;
+  // The number of distinct values of a string column.
+  uint64_t dictionary_size_{};
+};
+
+struct DecodedBlock {
+  uint64_t entries_{};
+  std::vector<DecodedColumn> columns_;
+};
+
+/**
+ * Decodes blocks written by ColumnarBlockEncoder, as a reader of the logs would.
+ */
+class BlockDecoder {
+public:
+  explicit BlockDecoder(absl::string_view input) : input_(input) {}
+
+  /**
+   * @return the blocks of the input, failing the test if the input is malformed.
+   */
+  std::vector<DecodedBlock> decode() {
+    std::vector<DecodedBlock> blocks;
+    while (!input_.empty()) {
+      EXPECT_EQ(ColumnarBlockEncoder::Magic, read(4));
+      EXPECT_EQ(ColumnarBlockEncoder::Version, static_cast<uint8_t>(read(1)[0]));
+      const uint64_t length = readVarint();
+      EXPECT_EQ(length, input_.size());
+      blocks.push_back(decodeBlock());
+    }
+    return blocks;
+  }
+
+private:
+  absl::string_view read(uint64_t length) {
+    if (length > input_.size()) {
+      ADD_FAILURE() << "truncated block";
+      length = input_.size();
+    }
+    const absl::string_view result = input_.substr(0, length);
+    input_.remove_prefix(length);
+    return result;
+  }
+
+  uint64_t readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && !input_.empty(); shift += 7) {
+      const uint8_t byte = input_[0];
+      input_.remove_prefix(1);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    ADD_FAILURE() << "truncated varint";
+    return value;
+  }
+
+  int64_t readZigzag() {
+    const uint64_t value = readVarint();
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+  }
+
+  DecodedBlock decodeBlock() {
+    DecodedBlock block;
+    block.entries_ = readVarint();
+    const uint64_t num_columns = readVarint();
+    for (uint64_t i = 0; i < num_columns; i++) {
+      DecodedColumn& column = block.columns_.emplace_back();
+      column.name_ = std::string(read(readVarint()));
+      column.type_ = static_cast<ColumnType>(read(1)[0]);
+      const absl::string_view validity = read((block.entries_ + 7) / 8);
+      const uint64_t data_length = readVarint();
+      const uint64_t remaining = input_.size() - data_length;
+
+      std::vector<std::string> dictionary;
+      if (column.type_ == ColumnConfig::STRING) {
+        column.dictionary_size_ = readVarint();
+        for (uint64_t j = 0; j < column.dictionary_size_; j++) {
+          dictionary.emplace_back(read(readVarint()));
+        }
+      }
+      int64_t previous = 0;
+      for (uint64_t entry = 0; entry < block.entries_; entry++) {
+        const bool valid = (static_cast<uint8_t>(validity[entry / 8]) >> (entry % 8)) & 1;
+        if (column.type_ == ColumnConfig::STRING) {
+          if (!valid) {
+            column.strings_.push_back(absl::nullopt);
+            continue;
+          }
+          const uint64_t index = readVarint();
+          EXPECT_LT(index, dictionary.size());
+          column.strings_.push_back(index < dictionary.size() ? dictionary[index] : "");
+        } else {
+          if (!valid) {
+            column.integers_.push_back(absl::nullopt);
+            continue;
+          }
+          int64_t value = readZigzag();
+          if (column.type_ == ColumnConfig::DELTA_INT64) {
+            value = static_cast<int64_t>(static_cast<uint64_t>(previous) +
+                                         static_cast<uint64_t>(value));
+            previous = value;
+          }
+          column.integers_.push_back(value);
+        }
+      }
+      EXPECT_EQ(remaining, input_.size());
+    }
+    return block;
+  }
+
+  absl::string_view input_;
+};
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
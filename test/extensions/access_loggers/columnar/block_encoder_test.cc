@@ -0,0 +1,168 @@
+#include "source/extensions/access_loggers/columnar/block_encoder.h"
+
+#include "test/extensions/access_loggers/columnar/block_decoder.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+namespace {
+
+using testing::ElementsAre;
+using testing::NiceMock;
+
+class ColumnarBlockEncoderTest : public testing::Test {
+public:
+  ColumnarSchemaConstSharedPtr makeSchema(const std::string& yaml) {
+    envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog config;
+    TestUtility::loadFromYaml(yaml, config);
+    return std::make_shared<const ColumnarSchema>(config.columns());
+  }
+
+  void add(ColumnarBlockEncoder& encoder, const std::string& path) {
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}};
+    if (!path.empty()) {
+      request_headers.setPath(path);
+    }
+    encoder.add({&request_headers}, stream_info_);
+  }
+
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+};
+
+// String columns are dictionary encoded, and record missing values.
+TEST_F(ColumnarBlockEncoderTest, StringColumns) {
+  ColumnarBlockEncoder encoder(makeSchema(R"EOF(
+columns:
+- name: path
+  format: "%REQ(:PATH)%"
+- name: request
+  format: "%REQ(:METHOD)% %REQ(:PATH)%"
+)EOF"));
+  add(encoder, "/a");
+  add(encoder, "/b");
+  add(encoder, "");
+  add(encoder, "/a");
+  EXPECT_EQ(4U, encoder.entries());
+
+  std::string output;
+  encoder.encode(output);
+  EXPECT_EQ(0U, encoder.entries());
+  const std::vector<DecodedBlock> blocks = BlockDecoder(output).decode();
+  ASSERT_EQ(1U, blocks.size());
+  EXPECT_EQ(4U, blocks[0].entries_);
+  ASSERT_EQ(2U, blocks[0].columns_.size());
+
+  const DecodedColumn& path = blocks[0].columns_[0];
+  EXPECT_EQ("path", path.name_);
+  EXPECT_EQ(ColumnConfig::STRING, path.type_);
+  EXPECT_EQ(2U, path.dictionary_size_);
+  EXPECT_THAT(path.strings_, ElementsAre("/a", "/b", absl::nullopt, "/a"));
+
+  // Commands without a value are empty within a longer format.
+  const DecodedColumn& request = blocks[0].columns_[1];
+  EXPECT_EQ(3U, request.dictionary_size_);
+  EXPECT_THAT(request.strings_, ElementsAre("GET /a", "GET /b", "GET ", "GET /a"));
+}
+
+// Integer columns take numbers, and strings which parse as integers.
+TEST_F(ColumnarBlockEncoderTest, IntegerColumns) {
+  ColumnarBlockEncoder encoder(makeSchema(R"EOF(
+columns:
+- name: bytes
+  format: "%BYTES_SENT%"
+  type: INT64
+- name: start
+  format: "%START_TIME(%s)%"
+  type: DELTA_INT64
+- name: code
+  format: "%RESPONSE_CODE_DETAILS%"
+  type: INT64
+)EOF"));
+  const SystemTime start_time(std::chrono::seconds(1700000000));
+  stream_info_.start_time_ = start_time;
+  stream_info_.bytes_sent_ = 100;
+  stream_info_.response_code_details_ = "42";
+  add(encoder, "/");
+  stream_info_.start_time_ = start_time + std::chrono::seconds(3);
+  stream_info_.bytes_sent_ = 0;
+  stream_info_.response_code_details_ = "not a number";
+  add(encoder, "/");
+  stream_info_.start_time_ = start_time + std::chrono::seconds(1);
+  add(encoder, "/");
+
+  std::string output;
+  encoder.encode(output);
+  const std::vector<DecodedBlock> blocks = BlockDecoder(output).decode();
+  ASSERT_EQ(1U, blocks.size());
+  EXPECT_THAT(blocks[0].columns_[0].integers_, ElementsAre(100, 0, 0));
+  EXPECT_THAT(blocks[0].columns_[1].integers_,
+              ElementsAre(1700000000, 1700000003, 1700000001));
+  EXPECT_THAT(blocks[0].columns_[2].integers_, ElementsAre(42, absl::nullopt, absl::nullopt));
+}
+
+// Each block is self contained: dictionaries and deltas restart, and empty blocks are not written.
+TEST_F(ColumnarBlockEncoderTest, MultipleBlocks) {
+  ColumnarBlockEncoder encoder(makeSchema(R"EOF(
+columns:
+- name: path
+  format: "%REQ(:PATH)%"
+- name: bytes
+  format: "%BYTES_SENT%"
+  type: DELTA_INT64
+)EOF"));
+  std::string output;
+  encoder.encode(output);
+  EXPECT_TRUE(output.empty());
+
+  stream_info_.bytes_sent_ = 10;
+  for (int i = 0; i < 9; i++) {
+    add(encoder, "/a");
+  }
+  encoder.encode(output);
+  stream_info_.bytes_sent_ = 20;
+  add(encoder, "/b");
+  encoder.encode(output);
+
+  const std::vector<DecodedBlock> blocks = BlockDecoder(output).decode();
+  ASSERT_EQ(2U, blocks.size());
+  EXPECT_EQ(9U, blocks[0].entries_);
+  EXPECT_EQ(1U, blocks[0].columns_[0].dictionary_size_);
+  EXPECT_THAT(blocks[0].columns_[1].integers_, testing::Each(10));
+  EXPECT_THAT(blocks[1].columns_[0].strings_, ElementsAre("/b"));
+  EXPECT_THAT(blocks[1].columns_[1].integers_, ElementsAre(20));
+}
+
+TEST_F(ColumnarBlockEncoderTest, IntegerColumnWithSeveralCommands) {
+  EXPECT_THROW_WITH_MESSAGE(makeSchema(R"EOF(
+columns:
+- name: bytes
+  format: "%BYTES_SENT% bytes"
+  type: INT64
+)EOF"),
+                            EnvoyException,
+                            "columnar access log: integer column 'bytes' must consist of a single "
+                            "command, got '%BYTES_SENT% bytes'");
+}
+
+TEST(ColumnarBlockEncoderVarintTest, Encoding) {
+  std::string output;
+  ColumnarBlockEncoder::appendVarint(output, 1);
+  ColumnarBlockEncoder::appendVarint(output, 300);
+  EXPECT_EQ(std::string("\x01\xac\x02", 3), output);
+  EXPECT_EQ(0U, ColumnarBlockEncoder::zigzag(0));
+  EXPECT_EQ(1U, ColumnarBlockEncoder::zigzag(-1));
+  EXPECT_EQ(2U, ColumnarBlockEncoder::zigzag(1));
+  EXPECT_EQ(UINT64_MAX, ColumnarBlockEncoder::zigzag(INT64_MIN));
+}
+
+} // namespace
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
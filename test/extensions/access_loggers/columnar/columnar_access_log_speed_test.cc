@@ -0,0 +1,152 @@
+// Compares the CPU and bytes per entry of the columnar encoder with those of the text and JSON
+// formats of the file access log, for the same fields.
+
+#include "source/common/formatter/substitution_formatter.h"
+#include "source/common/network/address_impl.h"
+#include "source/extensions/access_loggers/columnar/block_encoder.h"
+
+#include "test/common/stream_info/test_util.h"
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+namespace {
+
+constexpr uint32_t EntriesPerBlock = 1024;
+
+// The paths and user agents of the entries cycle through a few values, as they do in practice.
+constexpr absl::string_view Paths[] = {"/api/v1/users", "/api/v1/orders", "/static/app.js",
+                                       "/healthz"};
+constexpr absl::string_view UserAgents[] = {"curl/8.4.0", "Mozilla/5.0 (X11; Linux x86_64)",
+                                            "okhttp/4.12.0"};
+
+class Entries {
+public:
+  Entries() : stream_info_(time_system_) {
+    stream_info_.downstream_connection_info_provider_->setRemoteAddress(
+        std::make_shared<Network::Address::Ipv4Instance>("203.0.113.1"));
+    stream_info_.setResponseCode(200);
+    stream_info_.protocol(Http::Protocol::Http11);
+  }
+
+  // Prepares the next entry.
+  void next() {
+    request_headers_.setPath(Paths[count_ % std::size(Paths)]);
+    request_headers_.setCopy(Http::LowerCaseString("user-agent"),
+                             UserAgents[count_ % std::size(UserAgents)]);
+    stream_info_.addBytesSent(count_ % 4096);
+    count_++;
+  }
+
+  Formatter::HttpFormatterContext context() { return {&request_headers_}; }
+  const StreamInfo::StreamInfo& streamInfo() { return stream_info_; }
+
+private:
+  MockTimeSystem time_system_;
+  TestStreamInfo stream_info_;
+  Http::TestRequestHeaderMapImpl request_headers_{{":method", "GET"},
+                                                  {":authority", "example.com"}};
+  uint64_t count_{};
+};
+
+void reportBytesPerEntry(benchmark::State& state, uint64_t bytes) {
+  state.counters["bytes_per_entry"] =
+      benchmark::Counter(static_cast<double>(bytes) / std::max<int64_t>(state.iterations(), 1));
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_TextFormat(benchmark::State& state) {
+  Entries entries;
+  Formatter::FormatterImpl formatter(
+      "%START_TIME(%s%3f)% %DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT% %REQ(:METHOD)% "
+      "%REQ(:AUTHORITY)% %REQ(:PATH)% %PROTOCOL% %RESPONSE_CODE% %BYTES_SENT% %DURATION% "
+      "\"%REQ(USER-AGENT)%\"\n",
+      false);
+  std::string output;
+  uint64_t bytes = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    entries.next();
+    output.clear();
+    formatter.appendWithContext(entries.context(), entries.streamInfo(), output);
+    bytes += output.size();
+  }
+  reportBytesPerEntry(state, bytes);
+}
+BENCHMARK(BM_TextFormat);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_JsonFormat(benchmark::State& state) {
+  Entries entries;
+  ProtobufWkt::Struct json_format;
+  TestUtility::loadFromYaml(R"EOF(
+start_time: "%START_TIME(%s%3f)%"
+remote_address: "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%"
+method: "%REQ(:METHOD)%"
+authority: "%REQ(:AUTHORITY)%"
+path: "%REQ(:PATH)%"
+protocol: "%PROTOCOL%"
+response_code: "%RESPONSE_CODE%"
+bytes_sent: "%BYTES_SENT%"
+duration: "%DURATION%"
+user_agent: "%REQ(USER-AGENT)%"
+)EOF",
+                            json_format);
+  Formatter::JsonFormatterImpl formatter(json_format, true, false, false);
+  uint64_t bytes = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    entries.next();
+    bytes += formatter.formatWithContext(entries.context(), entries.streamInfo()).size();
+  }
+  reportBytesPerEntry(state, bytes);
+}
+BENCHMARK(BM_JsonFormat);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_ColumnarFormat(benchmark::State& state) {
+  Entries entries;
+  envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog config;
+  TestUtility::loadFromYaml(R"EOF(
+columns:
+- {name: start_time, format: "%START_TIME(%s%3f)%", type: DELTA_INT64}
+- {name: remote_address, format: "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%"}
+- {name: method, format: "%REQ(:METHOD)%"}
+- {name: authority, format: "%REQ(:AUTHORITY)%"}
+- {name: path, format: "%REQ(:PATH)%"}
+- {name: protocol, format: "%PROTOCOL%"}
+- {name: response_code, format: "%RESPONSE_CODE%", type: INT64}
+- {name: bytes_sent, format: "%BYTES_SENT%", type: INT64}
+- {name: duration, format: "%DURATION%", type: INT64}
+- {name: user_agent, format: "%REQ(USER-AGENT)%"}
+path: /dev/null
+)EOF",
+                            config);
+  ColumnarBlockEncoder encoder(std::make_shared<const ColumnarSchema>(config.columns()));
+  std::string output;
+  uint64_t bytes = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    entries.next();
+    encoder.add(entries.context(), entries.streamInfo());
+    if (encoder.entries() == EntriesPerBlock) {
+      output.clear();
+      encoder.encode(output);
+      bytes += output.size();
+    }
+  }
+  output.clear();
+  encoder.encode(output);
+  bytes += output.size();
+  reportBytesPerEntry(state, bytes);
+}
+BENCHMARK(BM_ColumnarFormat);
+
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,169 @@
+#include "envoy/config/accesslog/v3/accesslog.pb.h"
+#include "envoy/extensions/access_loggers/columnar/v3/columnar.pb.h"
+
+#include "source/common/access_log/access_log_impl.h"
+#include "source/extensions/access_loggers/columnar/config.h"
+
+#include "test/extensions/access_loggers/columnar/block_decoder.h"
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace Columnar {
+namespace {
+
+using testing::_;
+using testing::ElementsAre;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+TEST(ColumnarAccessLogConfigTest, ValidateFail) {
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  EXPECT_THROW(ColumnarAccessLogFactory().createAccessLogInstance(
+                   envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog(), nullptr,
+                   context),
+               ProtoValidationException);
+}
+
+class ColumnarAccessLogTest : public testing::Test {
+public:
+  AccessLog::InstanceSharedPtr createLogger(const std::string& yaml) {
+    envoy::extensions::access_loggers::columnar::v3::ColumnarAccessLog columnar_config;
+    TestUtility::loadFromYaml(yaml, columnar_config);
+    envoy::config::accesslog::v3::AccessLog config;
+    config.set_name("envoy.access_loggers.columnar");
+    config.mutable_typed_config()->PackFrom(columnar_config);
+    return AccessLog::AccessLogFactory::fromProto(config, context_);
+  }
+
+  void log(AccessLog::Instance& logger, const std::string& path) {
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", path}};
+    logger.log({&request_headers}, stream_info_);
+  }
+
+  NiceMock<Server::Configuration::MockFactoryContext> context_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+};
+
+// Entries are flushed to the file once a block is full, or when the flush interval elapses.
+TEST_F(ColumnarAccessLogTest, FileDestination) {
+  auto file = std::make_shared<AccessLog::MockAccessLogFile>();
+  EXPECT_CALL(context_.server_factory_context_.access_log_manager_,
+              createAccessLog(Filesystem::FilePathAndType{Filesystem::DestinationType::File,
+                                                          "/tmp/access.columnar"}))
+      .WillOnce(Return(file));
+  auto* flush_timer =
+      new NiceMock<Event::MockTimer>(&context_.server_factory_context_.thread_local_.dispatcher_);
+  AccessLog::InstanceSharedPtr logger = createLogger(R"EOF(
+columns:
+- name: path
+  format: "%REQ(:PATH)%"
+- name: bytes
+  format: "%BYTES_SENT%"
+  type: INT64
+path: /tmp/access.columnar
+max_block_entries: 2
+flush_interval: 5s
+)EOF");
+
+  std::string written;
+  EXPECT_CALL(*file, write(_)).WillRepeatedly(Invoke([&written](absl::string_view data) {
+    written.append(data);
+  }));
+
+  // The first entry of a block arms the flush timer, and a full block is flushed at once.
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(5000), _));
+  log(*logger, "/a");
+  EXPECT_TRUE(written.empty());
+  log(*logger, "/b");
+  std::vector<DecodedBlock> blocks = BlockDecoder(written).decode();
+  ASSERT_EQ(1U, blocks.size());
+  EXPECT_THAT(blocks[0].columns_[0].strings_, ElementsAre("/a", "/b"));
+
+  written.clear();
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(5000), _));
+  log(*logger, "/c");
+  flush_timer->invokeCallback();
+  blocks = BlockDecoder(written).decode();
+  ASSERT_EQ(1U, blocks.size());
+  EXPECT_THAT(blocks[0].columns_[0].strings_, ElementsAre("/c"));
+
+  // Nothing is written for an empty block.
+  written.clear();
+  flush_timer->invokeCallback();
+  EXPECT_TRUE(written.empty());
+}
+
+// Pending entries are flushed when the logger of the worker goes away.
+TEST_F(ColumnarAccessLogTest, FlushOnDestruction) {
+  auto file = std::make_shared<AccessLog::MockAccessLogFile>();
+  EXPECT_CALL(context_.server_factory_context_.access_log_manager_, createAccessLog(_))
+      .WillOnce(Return(file));
+  AccessLog::InstanceSharedPtr logger = createLogger(R"EOF(
+columns:
+- name: path
+  format: "%REQ(:PATH)%"
+path: /tmp/access.columnar
+)EOF");
+
+  log(*logger, "/a");
+  EXPECT_CALL(*file, write(_)).WillOnce(Invoke([](absl::string_view data) {
+    const std::vector<DecodedBlock> blocks = BlockDecoder(data).decode();
+    ASSERT_EQ(1U, blocks.size());
+    EXPECT_THAT(blocks[0].columns_[0].strings_, ElementsAre("/a"));
+  }));
+  logger.reset();
+}
+
+// Blocks which cannot be sent as datagrams are counted, rather than dropped silently.
+TEST_F(ColumnarAccessLogTest, DatagramDestination) {
+  AccessLog::InstanceSharedPtr logger = createLogger(R"EOF(
+columns:
+- name: path
+  format: "%REQ(:PATH)%"
+socket_address:
+  socket_address:
+    address: 127.0.0.1
+    port_value: 9
+max_block_entries: 1
+)EOF");
+
+  log(*logger, "/a");
+  Stats::Store& store = context_.server_factory_context_.store_;
+  EXPECT_EQ(1U, store.counter("access_logs.columnar.blocks_sent").value());
+  EXPECT_EQ(0U, store.counter("access_logs.columnar.blocks_dropped").value());
+
+  // A block larger than the largest UDP datagram cannot be sent.
+  log(*logger, std::string(70000, 'a'));
+  EXPECT_EQ(1U, store.counter("access_logs.columnar.blocks_sent").value());
+  EXPECT_EQ(1U, store.counter("access_logs.columnar.blocks_dropped").value());
+  EXPECT_EQ(1U, store.counter("access_logs.columnar.blocks_too_large").value());
+}
+
+TEST_F(ColumnarAccessLogTest, IntegerColumnWithSeveralCommands) {
+  EXPECT_THROW_WITH_MESSAGE(createLogger(R"EOF(
+columns:
+- name: duration
+  format: "%DURATION%ms"
+  type: INT64
+path: /tmp/access.columnar
+)EOF"),
+                            EnvoyException,
+                            "columnar access log: integer column 'duration' must consist of a "
+                            "single command, got '%DURATION%ms'");
+}
+
+} // namespace
+} // namespace Columnar
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
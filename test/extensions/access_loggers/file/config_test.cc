@@ -176,6 +176,23 @@ TEST_F(FileAccessLogTest, LogFormatJson) {
       true);
 }
 
+// The write ring size of the config is passed on to the file.
+TEST_F(FileAccessLogTest, WriteRingSize) {
+  envoy::extensions::access_loggers::file::v3::FileAccessLog fal_config;
+  TestUtility::loadFromYaml(R"(
+  path: "/foo"
+  write_ring_size: 4096
+)",
+                            fal_config);
+  envoy::config::accesslog::v3::AccessLog config;
+  config.mutable_typed_config()->PackFrom(fal_config);
+
+  Filesystem::FilePathAndType file_info{Filesystem::DestinationType::File, "/foo"};
+  EXPECT_CALL(context_.server_factory_context_.access_log_manager_,
+              createAccessLog(file_info, 4096));
+  AccessLog::AccessLogFactory::fromProto(config, context_);
+}
+
 } // namespace
 } // namespace File
 } // namespace AccessLoggers
@@ -6,6 +6,7 @@
 #include "test/mocks/filesystem/mocks.h"
 #include "test/mocks/server/factory_context.h"
 #include "test/test_common/environment.h"
+#include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -229,6 +230,14 @@ protected:
       TestEnvironment::substitute("{{ test_tmpdir }}/envoy_test/compressor_dictionary")};
   const std::string decompressor_dictionary_{
       TestEnvironment::substitute("{{ test_tmpdir }}/envoy_test/decompressor_dictionary")};
+
+  // Similar payloads, from which a dictionary can be trained.
+  static std::string trainingPayload(int i) {
+    return fmt::format(R"({{"id":{},"name":"user-{}","status":"active",)"
+                       R"("roles":["reader","writer"],)"
+                       R"("created_at":"2023-10-{:02}T12:00:00Z","score":{}}})",
+                       i, i * 7, i % 28 + 1, i * 13 % 101);
+  }
 };
 
 TEST_F(ZstdCompressionDictionaryTest, SameDictionary) {
@@ -318,6 +327,147 @@ TEST_F(ZstdCompressionDictionaryTest, MultipleDecompressorDictionary) {
   verifyByYaml(compressor_yaml_2, decompressor_yaml, true);
 }
 
+TEST_F(ZstdCompressionDictionaryTest, TrainedDictionary) {
+  auto* training_timer =
+      new NiceMock<Event::MockTimer>(dynamic_cast<Event::MockDispatcher*>(dispatcher_.get()));
+  std::string compressor_yaml{fmt::format(R"EOF(
+  compression_level: 7
+  chunk_size: 4096
+  dictionary_training:
+    stat_prefix: route_a
+    samples_per_training: 200
+    dictionary_size: 4096
+    dictionary_output_path: {}
+)EOF",
+                                          compressor_dictionary_)};
+
+  Zstd::Compressor::ZstdCompressorLibraryFactory compressor_lib_factory;
+  CompressorConfig compressor_config;
+  TestUtility::loadFromYaml(compressor_yaml, compressor_config);
+  compressor_factory_ =
+      compressor_lib_factory.createCompressorFactoryFromProto(compressor_config, mock_context_);
+
+  // Payloads compressed before a dictionary is trained are sampled and can be decompressed
+  // without a dictionary.
+  for (int i = 0; i < 200; i++) {
+    Buffer::OwnedImpl buffer(trainingPayload(i));
+    compressor_factory_->createCompressor()->compress(
+        buffer, Envoy::Compression::Compressor::State::Finish);
+  }
+  EXPECT_EQ(200, mock_context_.store_.counter("zstd.dictionary_training.route_a.samples_collected")
+                     .value());
+
+  training_timer->invokeCallback();
+  Event::GlobalTimeSystem time_system;
+  TestUtility::waitForCounterEq(mock_context_.store_,
+                                "zstd.dictionary_training.route_a.training_succeeded", 1,
+                                time_system);
+  EXPECT_NE(0,
+            mock_context_.store_.gauge("zstd.dictionary_training.route_a.dictionary_id",
+                                       Stats::Gauge::ImportMode::NeverImport)
+                .value());
+
+  // Payloads compressed after the dictionary has been installed need it to be decompressed.
+  Zstd::Decompressor::ZstdDecompressorLibraryFactory decompressor_lib_factory;
+  DecompressorConfig decompressor_config;
+  TestUtility::loadFromYaml(fmt::format(R"EOF(
+  dictionaries:
+    - filename: {}
+)EOF",
+                                        compressor_dictionary_),
+                            decompressor_config);
+  decompressor_factory_ = decompressor_lib_factory.createDecompressorFactoryFromProto(
+      decompressor_config, mock_context_);
+
+  const std::string original_text = trainingPayload(1000);
+  Buffer::OwnedImpl buffer(original_text);
+  compressor_factory_->createCompressor()->compress(buffer,
+                                                    Envoy::Compression::Compressor::State::Finish);
+  Buffer::OwnedImpl decompressed;
+  decompressor_factory_->createDecompressor("test.")->decompress(buffer, decompressed);
+  EXPECT_EQ(original_text, decompressed.toString());
+  EXPECT_EQ(original_text.size(),
+            mock_context_.store_
+                .counter("zstd.dictionary_training.route_a.dictionary_uncompressed_bytes")
+                .value());
+}
+
+// The dictionaries of all the compressor libraries are trained on one shared thread, and a trained
+// dictionary is added next to the configured one and used in its place.
+TEST_F(ZstdCompressionDictionaryTest, TrainedDictionaryWithConfiguredDictionary) {
+  auto* mock_dispatcher = dynamic_cast<Event::MockDispatcher*>(dispatcher_.get());
+  // The timers are handed out in the reverse order of their creation.
+  new NiceMock<Event::MockTimer>(mock_dispatcher);
+  auto* training_timer = new NiceMock<Event::MockTimer>(mock_dispatcher);
+  std::string compressor_yaml{fmt::format(R"EOF(
+  compression_level: 7
+  chunk_size: 4096
+  dictionary:
+    filename: {}
+  dictionary_training:
+    stat_prefix: route_b
+    samples_per_training: 200
+    dictionary_size: 4096
+    dictionary_output_path: {}
+)EOF",
+                                          dictionary_1_path_, compressor_dictionary_)};
+
+  Zstd::Compressor::ZstdCompressorLibraryFactory compressor_lib_factory;
+  CompressorConfig compressor_config;
+  TestUtility::loadFromYaml(compressor_yaml, compressor_config);
+  Singleton::Manager& singleton_manager =
+      mock_context_.server_factory_context_.singletonManager();
+  const std::string name = "zstd_dictionary_training_thread_singleton";
+  compressor_factory_ =
+      compressor_lib_factory.createCompressorFactoryFromProto(compressor_config, mock_context_);
+  auto training_thread =
+      singleton_manager.getTyped<Zstd::Compressor::ZstdDictionaryTrainingThread>(name);
+  EXPECT_NE(nullptr, training_thread);
+  Envoy::Compression::Compressor::CompressorFactoryPtr other_compressor_factory =
+      compressor_lib_factory.createCompressorFactoryFromProto(compressor_config, mock_context_);
+  EXPECT_EQ(training_thread,
+            singleton_manager.getTyped<Zstd::Compressor::ZstdDictionaryTrainingThread>(name));
+  training_thread.reset();
+
+  for (int i = 0; i < 200; i++) {
+    Buffer::OwnedImpl buffer(trainingPayload(i));
+    compressor_factory_->createCompressor()->compress(
+        buffer, Envoy::Compression::Compressor::State::Finish);
+  }
+  training_timer->invokeCallback();
+  Event::GlobalTimeSystem time_system;
+  TestUtility::waitForCounterEq(mock_context_.store_,
+                                "zstd.dictionary_training.route_b.training_succeeded", 1,
+                                time_system);
+
+  // The payloads are compressed with the trained dictionary.
+  Zstd::Decompressor::ZstdDecompressorLibraryFactory decompressor_lib_factory;
+  DecompressorConfig decompressor_config;
+  TestUtility::loadFromYaml(fmt::format(R"EOF(
+  dictionaries:
+    - filename: {}
+)EOF",
+                                        compressor_dictionary_),
+                            decompressor_config);
+  decompressor_factory_ = decompressor_lib_factory.createDecompressorFactoryFromProto(
+      decompressor_config, mock_context_);
+  const std::string original_text = trainingPayload(1000);
+  Buffer::OwnedImpl buffer(original_text);
+  compressor_factory_->createCompressor()->compress(buffer,
+                                                    Envoy::Compression::Compressor::State::Finish);
+  Buffer::OwnedImpl decompressed;
+  decompressor_factory_->createDecompressor("test.")->decompress(buffer, decompressed);
+  EXPECT_EQ(original_text, decompressed.toString());
+
+  // The training thread is destroyed with the last library training a dictionary.
+  compressor_factory_.reset();
+  EXPECT_NE(nullptr,
+            singleton_manager.getTyped<Zstd::Compressor::ZstdDictionaryTrainingThread>(name));
+  other_compressor_factory.reset();
+  EXPECT_EQ(nullptr,
+            singleton_manager.getTyped<Zstd::Compressor::ZstdDictionaryTrainingThread>(name));
+}
+
 } // namespace
 } // namespace Zstd
 } // namespace Compression
@@ -121,6 +121,25 @@ TEST_F(BufferFilterTest, ContentLengthPopulationAlreadyPresent) {
   EXPECT_EQ(headers.getContentLengthValue(), "3");
 }
 
+// A reset filter processes a new request as a new filter does.
+TEST_F(BufferFilterTest, ResetForReuse) {
+  Http::TestRequestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_.decodeHeaders(headers, false));
+  Buffer::OwnedImpl data1("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_.decodeData(data1, false));
+  filter_.onDestroy();
+
+  filter_.resetForReuse();
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks;
+  filter_.setDecoderFilterCallbacks(callbacks);
+  Http::TestRequestHeaderMapImpl headers2;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_.decodeHeaders(headers2, false));
+  Buffer::OwnedImpl data2("foo");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(data2, true));
+  EXPECT_EQ(headers2.getContentLengthValue(), "3");
+  EXPECT_EQ(headers.ContentLength(), nullptr);
+}
+
 TEST_F(BufferFilterTest, PerFilterConfigOverride) {
   envoy::extensions::filters::http::buffer::v3::BufferPerRoute per_route_cfg;
   auto* buf = per_route_cfg.mutable_buffer();
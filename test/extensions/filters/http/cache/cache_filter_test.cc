@@ -13,6 +13,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -25,14 +26,37 @@ using ::Envoy::StatusHelpers::IsOkAndHolds;
 using ::testing::IsNull;
 using ::testing::NotNull;
 
+// Upper-cases the body, which is enough to tell a compressed variant apart from the origin body.
+class UpperCaseCompressor : public Compression::Compressor::Compressor {
+public:
+  void compress(Buffer::Instance& buffer, Compression::Compressor::State) override {
+    const std::string upper = absl::AsciiStrToUpper(buffer.toString());
+    buffer.drain(buffer.length());
+    buffer.add(upper);
+  }
+};
+
+class UpperCaseCompressorFactory : public Compression::Compressor::CompressorFactory {
+public:
+  Compression::Compressor::CompressorPtr createCompressor() override {
+    return std::make_unique<UpperCaseCompressor>();
+  }
+  const std::string& statsPrefix() const override { CONSTRUCT_ON_FIRST_USE(std::string, "upper."); }
+  const std::string& contentEncoding() const override {
+    CONSTRUCT_ON_FIRST_USE(std::string, "upper");
+  }
+};
+
 class CacheFilterTest : public ::testing::Test {
 protected:
   // The filter has to be created as a shared_ptr to enable shared_from_this() which is used in the
   // cache callbacks.
-  CacheFilterSharedPtr makeFilter(std::shared_ptr<HttpCache> cache, bool auto_destroy = true) {
+  CacheFilterSharedPtr makeFilter(std::shared_ptr<HttpCache> cache, bool auto_destroy = true,
+                                  CompressedVariantsConstSharedPtr compressed_variants = nullptr) {
     std::shared_ptr<CacheFilter> filter(
         new CacheFilter(config_, /*stats_prefix=*/"", context_.scope(),
-                        context_.server_factory_context_.timeSource(), cache),
+                        context_.server_factory_context_.timeSource(), cache,
+                        std::move(compressed_variants)),
         [auto_destroy](CacheFilter* f) {
           if (auto_destroy) {
             f->onDestroy();
@@ -352,6 +376,190 @@ TEST_F(CacheFilterTest, CacheHitWithBody) {
   }
 }
 
+TEST_F(CacheFilterTest, CompressedVariant) {
+  request_headers_.setHost("CompressedVariant");
+  request_headers_.addCopy(Http::CustomHeaders::get().AcceptEncoding, "gzip;q=0.5, upper");
+  const std::string body = "abc";
+  std::vector<Compression::Compressor::CompressorFactoryPtr> compressor_factories;
+  compressor_factories.push_back(std::make_unique<UpperCaseCompressorFactory>());
+  auto compressed_variants = std::make_shared<CompressedVariants>(std::move(compressor_factories));
+
+  {
+    // Create filter for request 1.
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+
+    testDecodeRequestMiss(filter);
+
+    // The response passed downstream is not modified.
+    Buffer::OwnedImpl buffer(body);
+    response_headers_.setContentLength(body.size());
+    EXPECT_EQ(filter->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+    EXPECT_EQ(filter->encodeData(buffer, true), Http::FilterDataStatus::Continue);
+    EXPECT_EQ(buffer.toString(), body);
+    EXPECT_FALSE(response_headers_.has(Http::CustomHeaders::get().ContentEncoding));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+    filter->onStreamComplete();
+    EXPECT_THAT(insertStatus(), IsOkAndHolds(InsertStatus::InsertSucceeded));
+  }
+  waitBeforeSecondRequest();
+  {
+    // Request 2 is served the compressed variant.
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+
+    EXPECT_CALL(decoder_callbacks_,
+                encodeHeaders_(testing::AllOf(HeaderHasValueRef(
+                                                  Http::CustomHeaders::get().ContentEncoding,
+                                                  "upper"),
+                                              HeaderHasValueRef(Http::CustomHeaders::get().Vary,
+                                                                "Accept-Encoding")),
+                               false));
+    EXPECT_CALL(decoder_callbacks_,
+                encodeData(testing::Property(&Buffer::Instance::toString, testing::Eq("ABC")),
+                           true));
+    EXPECT_EQ(filter->decodeHeaders(request_headers_, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    ::testing::Mock::VerifyAndClearExpectations(&decoder_callbacks_);
+
+    filter->onStreamComplete();
+    EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CacheHit));
+  }
+  {
+    // Request 3 doesn't accept the encoding, so it doesn't share the compressed entry.
+    request_headers_.remove(Http::CustomHeaders::get().AcceptEncoding);
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+
+    testDecodeRequestMiss(filter);
+
+    filter->onStreamComplete();
+    EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CacheMiss));
+  }
+}
+
+TEST_F(CacheFilterTest, RangeRequestSkipsCompressedVariant) {
+  request_headers_.setHost("RangeRequestSkipsCompressedVariant");
+  std::vector<Compression::Compressor::CompressorFactoryPtr> compressor_factories;
+  compressor_factories.push_back(std::make_unique<UpperCaseCompressorFactory>());
+  auto compressed_variants = std::make_shared<CompressedVariants>(std::move(compressor_factories));
+
+  {
+    // A plain request inserts the uncompressed entry.
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+    testDecodeRequestMiss(filter);
+    Buffer::OwnedImpl buffer("abc");
+    response_headers_.setContentLength(3);
+    EXPECT_EQ(filter->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+    EXPECT_EQ(filter->encodeData(buffer, true), Http::FilterDataStatus::Continue);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    filter->onStreamComplete();
+  }
+  waitBeforeSecondRequest();
+  {
+    // A range request accepting the encoding is looked up in the uncompressed entry.
+    request_headers_.addCopy(Http::CustomHeaders::get().AcceptEncoding, "upper");
+    request_headers_.addCopy(Http::Headers::get().Range, "bytes=0-1");
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+    EXPECT_CALL(decoder_callbacks_,
+                encodeData(testing::Property(&Buffer::Instance::toString, testing::Eq("ab")),
+                           true));
+    EXPECT_EQ(filter->decodeHeaders(request_headers_, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    ::testing::Mock::VerifyAndClearExpectations(&decoder_callbacks_);
+
+    filter->onStreamComplete();
+    EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CacheHit));
+  }
+}
+
+TEST_F(CacheFilterTest, CompressedVariantSkipsContentTypeNotCompressible) {
+  request_headers_.setHost("CompressedVariantSkipsContentTypeNotCompressible");
+  request_headers_.addCopy(Http::CustomHeaders::get().AcceptEncoding, "upper");
+  std::vector<Compression::Compressor::CompressorFactoryPtr> compressor_factories;
+  compressor_factories.push_back(std::make_unique<UpperCaseCompressorFactory>());
+  auto compressed_variants = std::make_shared<CompressedVariants>(std::move(compressor_factories));
+
+  {
+    // The response isn't of a compressible content type, so it is inserted as is.
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+    testDecodeRequestMiss(filter);
+    Buffer::OwnedImpl buffer("abc");
+    response_headers_.setContentLength(3);
+    response_headers_.setContentType("image/png");
+    EXPECT_EQ(filter->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+    EXPECT_EQ(filter->encodeData(buffer, true), Http::FilterDataStatus::Continue);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    filter->onStreamComplete();
+  }
+  waitBeforeSecondRequest();
+  {
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+    EXPECT_CALL(decoder_callbacks_,
+                encodeHeaders_(testing::Not(HeaderHasValueRef(
+                                   Http::CustomHeaders::get().ContentEncoding, "upper")),
+                               false));
+    EXPECT_CALL(decoder_callbacks_,
+                encodeData(testing::Property(&Buffer::Instance::toString, testing::Eq("abc")),
+                           true));
+    EXPECT_EQ(filter->decodeHeaders(request_headers_, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    ::testing::Mock::VerifyAndClearExpectations(&decoder_callbacks_);
+
+    filter->onStreamComplete();
+    EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::CacheHit));
+  }
+}
+
+TEST_F(CacheFilterTest, CompressedVariantSuccessfulValidation) {
+  request_headers_.setHost("CompressedVariantSuccessfulValidation");
+  request_headers_.addCopy(Http::CustomHeaders::get().AcceptEncoding, "upper");
+  std::vector<Compression::Compressor::CompressorFactoryPtr> compressor_factories;
+  compressor_factories.push_back(std::make_unique<UpperCaseCompressorFactory>());
+  auto compressed_variants = std::make_shared<CompressedVariants>(std::move(compressor_factories));
+  const std::string etag = "W/\"abc123\"";
+
+  {
+    // Insert the compressed variant.
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+    testDecodeRequestMiss(filter);
+    response_headers_.setReferenceKey(Http::CustomHeaders::get().Etag, etag);
+    Buffer::OwnedImpl buffer("abc");
+    response_headers_.setContentLength(3);
+    EXPECT_EQ(filter->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+    EXPECT_EQ(filter->encodeData(buffer, true), Http::FilterDataStatus::Continue);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    filter->onStreamComplete();
+  }
+  waitBeforeSecondRequest();
+  {
+    // The validated compressed variant depends on accept-encoding, as a fresh hit does.
+    CacheFilterSharedPtr filter = makeFilter(simple_cache_, true, compressed_variants);
+    request_headers_.setReferenceKey(Http::CustomHeaders::get().CacheControl, "no-cache");
+    testDecodeRequestMiss(filter);
+    EXPECT_THAT(request_headers_, HeaderHasValueRef("if-none-match", etag));
+
+    Http::TestResponseHeaderMapImpl not_modified_response_headers = {
+        {":status", "304"}, {"date", formatter_.now(time_source_)}};
+    EXPECT_EQ(filter->encodeHeaders(not_modified_response_headers, true),
+              Http::FilterHeadersStatus::StopIteration);
+    EXPECT_THAT(not_modified_response_headers,
+                HeaderHasValueRef(Http::CustomHeaders::get().ContentEncoding, "upper"));
+    EXPECT_THAT(not_modified_response_headers,
+                HeaderHasValueRef(Http::CustomHeaders::get().Vary, "Accept-Encoding"));
+
+    EXPECT_CALL(
+        encoder_callbacks_,
+        addEncodedData(testing::Property(&Buffer::Instance::toString, testing::Eq("ABC")), true));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    ::testing::Mock::VerifyAndClearExpectations(&encoder_callbacks_);
+
+    filter->onStreamComplete();
+    EXPECT_THAT(lookupStatus(), IsOkAndHolds(LookupStatus::StaleHitWithSuccessfulValidation));
+  }
+}
+
 TEST_F(CacheFilterTest, WatermarkEventsAreSentIfCacheBlocksStreamAndLimitExceeded) {
   request_headers_.setHost("CacheHitWithBody");
   const std::string body1 = "abcde";
@@ -0,0 +1,126 @@
+#include "source/extensions/filters/http/cache/compressed_variants.h"
+
+#include "test/mocks/compression/compressor/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+class CompressedVariantsTest : public testing::Test {
+protected:
+  CompressedVariantsTest() {
+    auto br = std::make_unique<NiceMock<Compression::Compressor::MockCompressorFactory>>();
+    auto gzip = std::make_unique<NiceMock<Compression::Compressor::MockCompressorFactory>>();
+    ON_CALL(*br, contentEncoding()).WillByDefault(ReturnRef(br_encoding_));
+    ON_CALL(*gzip, contentEncoding()).WillByDefault(ReturnRef(gzip_encoding_));
+    br_ = br.get();
+    gzip_ = gzip.get();
+    std::vector<Compression::Compressor::CompressorFactoryPtr> compressor_factories;
+    compressor_factories.push_back(std::move(br));
+    compressor_factories.push_back(std::move(gzip));
+    variants_ = std::make_unique<CompressedVariants>(std::move(compressor_factories));
+  }
+
+  Compression::Compressor::CompressorFactory* select(absl::string_view accept_encoding) {
+    Http::TestRequestHeaderMapImpl request_headers;
+    if (!accept_encoding.empty()) {
+      request_headers.addCopy("accept-encoding", accept_encoding);
+    }
+    return variants_->select(request_headers);
+  }
+
+  const std::string br_encoding_{"br"};
+  const std::string gzip_encoding_{"gzip"};
+  Compression::Compressor::CompressorFactory* br_;
+  Compression::Compressor::CompressorFactory* gzip_;
+  std::unique_ptr<CompressedVariants> variants_;
+};
+
+TEST_F(CompressedVariantsTest, Select) {
+  EXPECT_EQ(nullptr, select(""));
+  EXPECT_EQ(nullptr, select("identity"));
+  EXPECT_EQ(nullptr, select("deflate, zstd"));
+  EXPECT_EQ(gzip_, select("gzip"));
+  EXPECT_EQ(gzip_, select("GZIP"));
+  EXPECT_EQ(br_, select("br, gzip"));
+  // Ties are broken by configuration order.
+  EXPECT_EQ(br_, select("gzip, br"));
+  EXPECT_EQ(gzip_, select("br;q=0.5, gzip"));
+  EXPECT_EQ(gzip_, select("br;q=0, gzip;q=0.1"));
+  EXPECT_EQ(nullptr, select("br;q=0, gzip;q=0"));
+  EXPECT_EQ(nullptr, select("br;q=invalid"));
+  EXPECT_EQ(br_, select("*"));
+  EXPECT_EQ(gzip_, select("*;q=0.5, br;q=0.1"));
+  EXPECT_EQ(nullptr, select("*;q=0"));
+}
+
+TEST_F(CompressedVariantsTest, IsCompressible) {
+  EXPECT_TRUE(variants_->isCompressible(Http::TestResponseHeaderMapImpl{
+      {":status", "200"}, {"cache-control", "public, max-age=3600"}}));
+  EXPECT_FALSE(variants_->isCompressible(
+      Http::TestResponseHeaderMapImpl{{":status", "200"}, {"content-encoding", "gzip"}}));
+  EXPECT_FALSE(variants_->isCompressible(Http::TestResponseHeaderMapImpl{
+      {":status", "200"}, {"cache-control", "public, no-transform"}}));
+  // The content types compressed by default by the compressor filter.
+  EXPECT_TRUE(variants_->isCompressible(Http::TestResponseHeaderMapImpl{
+      {":status", "200"}, {"content-type", "Text/HTML; charset=utf-8"}}));
+  EXPECT_FALSE(variants_->isCompressible(
+      Http::TestResponseHeaderMapImpl{{":status", "200"}, {"content-type", "image/png"}}));
+}
+
+TEST(CompressedVariantsContentTypesTest, IsCompressible) {
+  const CompressedVariants variants({}, {"image/bmp"});
+  EXPECT_TRUE(variants.isCompressible(
+      Http::TestResponseHeaderMapImpl{{":status", "200"}, {"content-type", "image/bmp"}}));
+  EXPECT_FALSE(variants.isCompressible(
+      Http::TestResponseHeaderMapImpl{{":status", "200"}, {"content-type", "text/html"}}));
+  EXPECT_TRUE(variants.isCompressible(Http::TestResponseHeaderMapImpl{{":status", "200"}}));
+}
+
+TEST(CompressedVariantsHeadersTest, SetVariantHeaders) {
+  {
+    Http::TestResponseHeaderMapImpl headers{
+        {":status", "200"}, {"content-length", "3"}, {"etag", "\"abc\""}};
+    CompressedVariants::setVariantHeaders(headers, "gzip");
+    EXPECT_EQ("gzip", headers.get_("content-encoding"));
+    EXPECT_FALSE(headers.has("content-length"));
+    EXPECT_FALSE(headers.has("etag"));
+  }
+  {
+    Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"etag", "W/\"abc\""}};
+    CompressedVariants::setVariantHeaders(headers, "gzip");
+    EXPECT_EQ("W/\"abc\"", headers.get_("etag"));
+  }
+}
+
+TEST(CompressedVariantsHeadersTest, InsertVaryHeader) {
+  {
+    Http::TestResponseHeaderMapImpl headers{{":status", "200"}};
+    CompressedVariants::insertVaryHeader(headers);
+    EXPECT_EQ("Accept-Encoding", headers.get_("vary"));
+  }
+  {
+    Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"vary", "accept"}};
+    CompressedVariants::insertVaryHeader(headers);
+    EXPECT_EQ("accept, Accept-Encoding", headers.get_("vary"));
+  }
+  {
+    Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"vary", "accept-encoding"}};
+    CompressedVariants::insertVaryHeader(headers);
+    EXPECT_EQ("accept-encoding", headers.get_("vary"));
+  }
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
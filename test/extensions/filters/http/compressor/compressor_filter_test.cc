@@ -417,6 +417,17 @@ TEST_F(CompressorFilterTest, ContentEncodingAlreadyEncoded) {
   EXPECT_FALSE(response_headers.has("transfer-encoding"));
   EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, false));
   EXPECT_EQ(1U, stats_.counter("test.compressor.test.test.not_compressed").value());
+  EXPECT_EQ(1U, stats_.counter("test.compressor.test.test.already_encoded").value());
+}
+
+// Content-Encoding: already encoded responses are counted even when they are too small to be
+// compressed anyway.
+TEST_F(CompressorFilterTest, ContentEncodingAlreadyEncodedBelowMinimumLength) {
+  doRequestNoCompression({{":method", "get"}, {"accept-encoding", "test"}});
+  Http::TestResponseHeaderMapImpl response_headers{
+      {":method", "get"}, {"content-length", "10"}, {"content-encoding", "gzip"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ(1U, stats_.counter("test.compressor.test.test.already_encoded").value());
 }
 
 // No compression when upstream response is empty.
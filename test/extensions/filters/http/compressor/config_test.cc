@@ -33,6 +33,61 @@ TEST(CompressorFilterFactoryTests, UnregisteredCompressorLibraryConfig) {
                          "'test.mock_compressor_library.Unregistered'"));
 }
 
+TEST(CompressorFilterFactoryTests, ParallelCompressionUnsupportedByLibrary) {
+  const std::string yaml_string = R"EOF(
+  compressor_library:
+    name: brotli
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.compression.brotli.compressor.v3.Brotli
+  response_direction_config:
+    parallel_compression: {}
+  )EOF";
+
+  envoy::extensions::filters::http::compressor::v3::Compressor proto_config;
+  TestUtility::loadFromYaml(yaml_string, proto_config);
+  CompressorFilterFactory factory;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  EXPECT_THAT(
+      factory.createFilterFactoryFromProto(proto_config, "stats", context).status().message(),
+      testing::HasSubstr("Parallel compression isn't supported by the compressor library"));
+}
+
+// The filter configs compressing in parallel share a single thread pool.
+TEST(CompressorFilterFactoryTests, ParallelCompressionSharedThreadPool) {
+  const std::string yaml_string = R"EOF(
+  compressor_library:
+    name: gzip
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip
+  response_direction_config:
+    parallel_compression: {}
+  )EOF";
+
+  envoy::extensions::filters::http::compressor::v3::Compressor proto_config;
+  TestUtility::loadFromYaml(yaml_string, proto_config);
+  CompressorFilterFactory factory;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  Singleton::Manager& singleton_manager = context.server_factory_context_.singletonManager();
+  const std::string name = "compression_thread_pool_singleton";
+  EXPECT_EQ(nullptr, singleton_manager.getTyped<CompressionThreadPool>(name));
+
+  absl::optional<Http::FilterFactoryCb> cb1 =
+      factory.createFilterFactoryFromProto(proto_config, "stats", context).value();
+  CompressionThreadPoolSharedPtr thread_pool =
+      singleton_manager.getTyped<CompressionThreadPool>(name);
+  EXPECT_NE(nullptr, thread_pool);
+  absl::optional<Http::FilterFactoryCb> cb2 =
+      factory.createFilterFactoryFromProto(proto_config, "stats", context).value();
+  EXPECT_EQ(thread_pool, singleton_manager.getTyped<CompressionThreadPool>(name));
+
+  // The pool is destroyed with the last filter config using it.
+  thread_pool.reset();
+  cb1.reset();
+  EXPECT_NE(nullptr, singleton_manager.getTyped<CompressionThreadPool>(name));
+  cb2.reset();
+  EXPECT_EQ(nullptr, singleton_manager.getTyped<CompressionThreadPool>(name));
+}
+
 TEST(CompressorFilterFactoryTests, EmptyPerRouteConfig) {
   envoy::extensions::filters::http::compressor::v3::CompressorPerRoute per_route;
   NiceMock<Server::Configuration::MockServerFactoryContext> context;
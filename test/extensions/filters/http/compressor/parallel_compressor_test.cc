@@ -0,0 +1,251 @@
+#include "source/extensions/filters/http/compressor/compressor_filter.h"
+#include "source/extensions/filters/http/compressor/parallel_compressor.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+namespace {
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+// Wraps every block in brackets, so that the output shows how the body was split.
+class BracketCompressor : public Envoy::Compression::Compressor::Compressor {
+public:
+  void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override {
+    EXPECT_EQ(Envoy::Compression::Compressor::State::Finish, state);
+    buffer.prepend("[");
+    buffer.add("]");
+  }
+};
+
+class BracketCompressorFactory : public Envoy::Compression::Compressor::CompressorFactory {
+public:
+  Envoy::Compression::Compressor::CompressorPtr createCompressor() override {
+    return std::make_unique<BracketCompressor>();
+  }
+  const std::string& statsPrefix() const override {
+    CONSTRUCT_ON_FIRST_USE(std::string, "bracket.");
+  }
+  const std::string& contentEncoding() const override {
+    CONSTRUCT_ON_FIRST_USE(std::string, "bracket");
+  }
+  bool supportsConcatenatedStreams() const override { return true; }
+};
+
+class ParallelCompressorTest : public testing::Test, public ParallelCompressor::Callbacks {
+protected:
+  // ParallelCompressor::Callbacks
+  void onCompressedBlock(Buffer::Instance& data, bool end_stream) override {
+    ASSERT_FALSE(ended_);
+    output_.append(data.toString());
+    data.drain(data.length());
+    blocks_++;
+    ended_ = end_stream;
+  }
+  void onAboveHighWatermark() override { above_high_watermark_++; }
+  void onBelowLowWatermark() override { below_low_watermark_++; }
+
+  ParallelCompressorPtr makeCompressor(uint32_t block_size, uint32_t max_blocks_in_flight) {
+    return std::make_unique<ParallelCompressor>(factory_, thread_pool_, *dispatcher_, *this,
+                                                block_size, max_blocks_in_flight);
+  }
+
+  void runUntilEnded() {
+    while (!ended_) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  Api::ApiPtr api_{Api::createApiForTest()};
+  Event::DispatcherPtr dispatcher_{api_->allocateDispatcher("test_thread")};
+  BracketCompressorFactory factory_;
+  // Declared after the dispatcher, so that the threads are joined first.
+  CompressionThreadPool thread_pool_{Thread::threadFactoryForTest(), 4};
+  std::string output_;
+  uint32_t blocks_{};
+  bool ended_{};
+  uint32_t above_high_watermark_{};
+  uint32_t below_low_watermark_{};
+};
+
+TEST_F(ParallelCompressorTest, BlocksAreSentInOrder) {
+  ParallelCompressorPtr compressor = makeCompressor(4, 100);
+  Buffer::OwnedImpl data("abcdefghij");
+  compressor->compress(data, false);
+  EXPECT_EQ(0, data.length());
+  Buffer::OwnedImpl more("kl");
+  compressor->compress(more, false);
+  Buffer::OwnedImpl last("m");
+  compressor->compress(last, true);
+  runUntilEnded();
+
+  EXPECT_EQ("[abcd][efgh][ijkl][m]", output_);
+  EXPECT_EQ(4, blocks_);
+  EXPECT_EQ(0, above_high_watermark_);
+}
+
+TEST_F(ParallelCompressorTest, EmptyLastBlock) {
+  ParallelCompressorPtr compressor = makeCompressor(4, 100);
+  Buffer::OwnedImpl data("abcd");
+  compressor->compress(data, false);
+  Buffer::OwnedImpl empty;
+  compressor->compress(empty, true);
+  runUntilEnded();
+
+  EXPECT_EQ("[abcd][]", output_);
+}
+
+TEST_F(ParallelCompressorTest, Watermarks) {
+  ParallelCompressorPtr compressor = makeCompressor(4, 2);
+  Buffer::OwnedImpl data("abcdefghijkl");
+  compressor->compress(data, false);
+  EXPECT_EQ(1, above_high_watermark_);
+  EXPECT_EQ(0, below_low_watermark_);
+  Buffer::OwnedImpl empty;
+  compressor->compress(empty, true);
+  runUntilEnded();
+
+  EXPECT_EQ("[abcd][efgh][ijkl][]", output_);
+  EXPECT_EQ(1, above_high_watermark_);
+  EXPECT_EQ(1, below_low_watermark_);
+}
+
+TEST_F(ParallelCompressorTest, DestroyedWithBlocksInFlight) {
+  ParallelCompressorPtr compressor = makeCompressor(4, 100);
+  Buffer::OwnedImpl data(std::string(4096, 'a'));
+  compressor->compress(data, true);
+  compressor.reset();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0, blocks_);
+}
+
+class ParallelCompressorFilterTest : public testing::Test {
+protected:
+  ParallelCompressorFilterTest() {
+    ON_CALL(runtime_.snapshot_, featureEnabled("test.filter_enabled", 100))
+        .WillByDefault(Return(true));
+    ON_CALL(encoder_callbacks_, dispatcher()).WillByDefault(ReturnRef(*dispatcher_));
+    ON_CALL(encoder_callbacks_, injectEncodedDataToFilterChain(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool end_stream) {
+          output_.append(data.toString());
+          data.drain(data.length());
+          ended_ = end_stream;
+        }));
+
+    envoy::extensions::filters::http::compressor::v3::Compressor compressor;
+    TestUtility::loadFromJson(R"EOF(
+{
+  "compressor_library": {
+     "name": "test",
+     "typed_config": {
+       "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+     }
+  },
+  "response_direction_config": {
+    "parallel_compression": {
+      "min_content_length": 8192,
+      "block_size": 4096
+    }
+  }
+}
+)EOF",
+                              compressor);
+    config_ = std::make_shared<CompressorFilterConfig>(
+        compressor, "test.", *stats_.rootScope(), runtime_,
+        std::make_unique<BracketCompressorFactory>(),
+        std::make_shared<CompressionThreadPool>(Thread::threadFactoryForTest(), 2));
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "get"},
+                                                   {"accept-encoding", "bracket"}};
+    filter_->decodeHeaders(request_headers, true);
+  }
+
+  ~ParallelCompressorFilterTest() override { filter_->onDestroy(); }
+
+  Api::ApiPtr api_{Api::createApiForTest()};
+  Event::DispatcherPtr dispatcher_{api_->allocateDispatcher("test_thread")};
+  Stats::TestUtil::TestStore stats_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  std::shared_ptr<CompressorFilterConfig> config_;
+  std::unique_ptr<CompressorFilter> filter_;
+  std::string output_;
+  bool ended_{};
+};
+
+TEST_F(ParallelCompressorFilterTest, LargeResponse) {
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-length", "10000"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ("bracket", headers.get_("content-encoding"));
+
+  Buffer::OwnedImpl data(std::string(10000, 'a'));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->encodeData(data, true));
+  while (!ended_) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  EXPECT_EQ(absl::StrCat("[", std::string(4096, 'a'), "][", std::string(4096, 'a'), "][",
+                         std::string(1808, 'a'), "]"),
+            output_);
+  EXPECT_EQ(1, stats_.counter("test.compressor.test.bracket.response.compressed").value());
+  EXPECT_EQ(1,
+            stats_.counter("test.compressor.test.bracket.response.parallel_compressed").value());
+  EXPECT_EQ(3, stats_.counter("test.compressor.test.bracket.response.parallel_blocks").value());
+  EXPECT_EQ(
+      10000,
+      stats_.counter("test.compressor.test.bracket.response.total_uncompressed_bytes").value());
+  EXPECT_EQ(10006,
+            stats_.counter("test.compressor.test.bracket.response.total_compressed_bytes").value());
+}
+
+TEST_F(ParallelCompressorFilterTest, LargeResponseWithTrailers) {
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-length", "10000"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+
+  Buffer::OwnedImpl data(std::string(10000, 'a'));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->encodeData(data, false));
+  Http::TestResponseTrailerMapImpl trailers{{"foo", "bar"}};
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_->encodeTrailers(trailers));
+
+  bool continued = false;
+  EXPECT_CALL(encoder_callbacks_, continueEncoding()).WillOnce(Invoke([&]() { continued = true; }));
+  while (!continued) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_FALSE(ended_);
+  EXPECT_EQ(10006, output_.size());
+}
+
+TEST_F(ParallelCompressorFilterTest, SmallResponseCompressedInline) {
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-length", "100"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ("bracket", headers.get_("content-encoding"));
+
+  Buffer::OwnedImpl data(std::string(100, 'a'));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+  EXPECT_EQ(absl::StrCat("[", std::string(100, 'a'), "]"), data.toString());
+  EXPECT_EQ(0,
+            stats_.counter("test.compressor.test.bracket.response.parallel_compressed").value());
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -8,6 +8,7 @@
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 
 using testing::ContainerEq;
@@ -402,6 +403,55 @@ TEST_F(RedisEncoderDecoderImplTest, NullArray) {
   EXPECT_EQ(RespType::Null, decoded_values_[0]->type());
 }
 
+// Large bulk strings are moved out of the decoded data into a buffer, encoded without copy.
+TEST_F(RedisEncoderDecoderImplTest, BufferedBulkString) {
+  const std::string large(DecoderImpl::DefaultBufferedBulkStringMinSize + 5, 'v');
+  const std::string request = absl::StrCat("*3\r\n$3\r\nset\r\n$3\r\nkey\r\n$", large.size(),
+                                           "\r\n", large, "\r\n");
+
+  // Two requests, fed in chunks which split the strings.
+  const std::string data = request + request;
+  for (uint64_t i = 0; i < data.size(); i += 4000) {
+    Buffer::OwnedImpl temp_buffer(data.substr(i, 4000));
+    decoder_.decode(temp_buffer);
+    EXPECT_EQ(0UL, temp_buffer.length());
+  }
+  ASSERT_EQ(2UL, decoded_values_.size());
+
+  std::vector<RespValue> values(3);
+  for (RespValue& value : values) {
+    value.type(RespType::BulkString);
+  }
+  values[0].asString() = "set";
+  values[1].asString() = "key";
+  values[2].asString() = large;
+  RespValue expected;
+  expected.type(RespType::Array);
+  expected.asArray().swap(values);
+  for (const RespValuePtr& value : decoded_values_) {
+    const RespValue& string = value->asArray()[2];
+    ASSERT_NE(nullptr, string.bulkStringBuffer());
+    EXPECT_EQ(large.size(), string.bulkStringBuffer()->length());
+    EXPECT_EQ(nullptr, value->asArray()[1].bulkStringBuffer());
+    encoder_.encode(*value, buffer_);
+  }
+
+  // The values are equal to the ones with strings, and copies share their buffer.
+  EXPECT_EQ(expected, *decoded_values_[0]);
+  RespValue copy = *decoded_values_[1];
+  EXPECT_EQ(decoded_values_[1]->asArray()[2].bulkStringBuffer(),
+            copy.asArray()[2].bulkStringBuffer());
+
+  // Strings which may be modified no longer use the buffer.
+  copy.asArray()[2].asString().push_back('v');
+  EXPECT_EQ(nullptr, copy.asArray()[2].bulkStringBuffer());
+  EXPECT_EQ(large + "v", copy.asArray()[2].asString());
+
+  // The encoded data may outlive the values.
+  decoded_values_.clear();
+  EXPECT_EQ(data, buffer_.toString());
+}
+
 TEST_F(RedisEncoderDecoderImplTest, InvalidType) {
   buffer_.add("^");
   EXPECT_THROW(decoder_.decode(buffer_), ProtocolError);
@@ -2,18 +2,22 @@
 // quiescent system with disabled cstate power management.
 
 #include <chrono>
+#include <limits>
 #include <string>
 #include <vector>
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/fmt.h"
 #include "source/common/stats/isolated_store_impl.h"
 #include "source/extensions/filters/network/common/redis/client_impl.h"
+#include "source/extensions/filters/network/common/redis/codec_impl.h"
 #include "source/extensions/filters/network/common/redis/supported_commands.h"
 #include "source/extensions/filters/network/redis_proxy/command_splitter_impl.h"
 #include "source/extensions/filters/network/redis_proxy/router_impl.h"
 
 #include "test/test_common/simulated_time_system.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/types/variant.h"
 #include "benchmark/benchmark.h"
 
@@ -83,6 +87,39 @@ public:
     }
   }
 };
+
+// Decodes requests and encodes them again, as the proxy does for the commands which it forwards
+// without change.
+class PassThroughCodec : public Common::Redis::DecoderCallbacks {
+public:
+  explicit PassThroughCodec(uint64_t buffered_bulk_string_min_size)
+      : decoder_(*this, buffered_bulk_string_min_size) {}
+
+  // Adds the data of a set request, split in slices as if read from a connection.
+  static void addSetRequest(uint64_t value_size, Buffer::Instance& data) {
+    const std::string request = absl::StrCat("*3\r\n$3\r\nset\r\n$36\r\n", std::string(36, 'k'),
+                                             "\r\n$", value_size, "\r\n",
+                                             std::string(value_size, 'v'), "\r\n");
+    for (uint64_t i = 0; i < request.size(); i += 16384) {
+      Buffer::OwnedImpl read(request.substr(i, 16384));
+      data.move(read);
+    }
+  }
+
+  void passThrough(Buffer::Instance& data) {
+    decoder_.decode(data);
+    out_.drain(out_.length());
+  }
+
+  // Common::Redis::DecoderCallbacks
+  void onRespValue(Common::Redis::RespValuePtr&& value) override { encoder_.encode(*value, out_); }
+
+private:
+  Common::Redis::DecoderImpl decoder_;
+  Common::Redis::EncoderImpl encoder_;
+  Buffer::OwnedImpl out_;
+};
+
 } // namespace RedisProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -133,3 +170,24 @@ static void bmSplitCreateVariant(benchmark::State& state) {
   state.counters["use_count"] = request.use_count();
 }
 BENCHMARK(bmSplitCreateVariant)->Ranges({{1, 100}, {64, 8 << 14}});
+
+// Forwards set requests of large values, with the values copied into strings or moved into buffers.
+static void bmPassThroughSet(benchmark::State& state) {
+  const bool buffered = state.range(0) != 0;
+  const uint64_t value_size = state.range(1);
+  Envoy::Extensions::NetworkFilters::RedisProxy::PassThroughCodec codec(
+      buffered ? Envoy::Extensions::NetworkFilters::Common::Redis::DecoderImpl::
+                     DefaultBufferedBulkStringMinSize
+               : std::numeric_limits<uint64_t>::max());
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    state.PauseTiming();
+    Envoy::Buffer::OwnedImpl data;
+    Envoy::Extensions::NetworkFilters::RedisProxy::PassThroughCodec::addSetRequest(value_size,
+                                                                                   data);
+    state.ResumeTiming();
+    codec.passThrough(data);
+  }
+  state.SetBytesProcessed(state.iterations() * value_size);
+}
+BENCHMARK(bmPassThroughSet)->ArgsProduct({{0, 1}, {100 << 10, 1 << 20}});
@@ -431,6 +431,68 @@ TEST_F(RedisSingleServerRequestTest, Time) {
   EXPECT_EQ(nullptr, handle_);
 }
 
+TEST_F(RedisSingleServerRequestTest, NearCacheHit) {
+  InSequence s;
+
+  NiceMock<MockNearCache> near_cache;
+  ON_CALL(*route_, nearCache()).WillByDefault(Return(OptRef<NearCache>(near_cache)));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"get", "hello"});
+
+  Common::Redis::RespValue response;
+  response.type(Common::Redis::RespType::BulkString);
+  response.asString() = "world";
+
+  EXPECT_CALL(callbacks_, connectionAllowed()).WillOnce(Return(true));
+  EXPECT_CALL(near_cache, lookup("hello"))
+      .WillOnce(Return(testing::ByMove(std::make_unique<Common::Redis::RespValue>(response))));
+  EXPECT_CALL(*conn_pool_, makeRequest_(_, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&response)));
+  handle_ = splitter_.makeRequest(std::move(request), callbacks_, dispatcher_, stream_info_);
+  EXPECT_EQ(nullptr, handle_);
+
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.get.total").value());
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.get.success").value());
+};
+
+TEST_F(RedisSingleServerRequestTest, NearCacheMiss) {
+  InSequence s;
+
+  NiceMock<MockNearCache> near_cache;
+  ON_CALL(*route_, nearCache()).WillByDefault(Return(OptRef<NearCache>(near_cache)));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"GET", "hello"});
+
+  EXPECT_CALL(near_cache, lookup("hello")).WillOnce(Return(testing::ByMove(nullptr)));
+  auto* fill = new MockNearCacheFill();
+  EXPECT_CALL(near_cache, startFill("hello"))
+      .WillOnce(Return(testing::ByMove(NearCacheFillPtr{fill})));
+  makeRequest("hello", std::move(request));
+  EXPECT_NE(nullptr, handle_);
+
+  // The response is cached before being sent downstream.
+  EXPECT_CALL(*fill, complete(_));
+  respond();
+};
+
+TEST_F(RedisSingleServerRequestTest, NearCacheNotUsedForOtherCommands) {
+  InSequence s;
+
+  NiceMock<MockNearCache> near_cache;
+  ON_CALL(*route_, nearCache()).WillByDefault(Return(OptRef<NearCache>(near_cache)));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"incr", "hello"});
+
+  EXPECT_CALL(near_cache, lookup(_)).Times(0);
+  EXPECT_CALL(near_cache, startFill(_)).Times(0);
+  makeRequest("hello", std::move(request));
+  EXPECT_NE(nullptr, handle_);
+  respond();
+};
+
 TEST_F(RedisSingleServerRequestTest, EvalSuccess) {
   InSequence s;
 
@@ -18,6 +18,7 @@
 #include "test/extensions/filters/network/common/redis/test_utils.h"
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
 #include "test/mocks/api/mocks.h"
+#include "test/mocks/network/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/cluster.h"
 #include "test/mocks/upstream/cluster_manager.h"
@@ -35,6 +36,7 @@ using testing::DoAll;
 using testing::Eq;
 using testing::InSequence;
 using testing::Invoke;
+using testing::Pointee;
 using testing::Ref;
 using testing::Return;
 using testing::ReturnNew;
@@ -93,11 +95,15 @@ public:
         std::make_shared<NiceMock<Extensions::Common::Redis::MockClusterRefreshManager>>();
     auto redis_command_stats =
         Common::Redis::RedisCommandStats::createRedisCommandStats(store_.symbolTable());
-    std::shared_ptr<InstanceImpl> conn_pool_impl = std::make_shared<InstanceImpl>(
-        cluster_name_, cm_, *this, tls_,
-        Common::Redis::Client::createConnPoolSettings(20, hashtagging, true, max_unknown_conns,
-                                                      read_policy_, redis_cx_rate_limit_per_sec),
-        api_, store_.rootScope(), redis_command_stats, cluster_refresh_manager_, dns_cache);
+    auto settings = Common::Redis::Client::createConnPoolSettings(
+        20, hashtagging, true, max_unknown_conns, read_policy_, redis_cx_rate_limit_per_sec);
+    if (get_coalescing_) {
+      settings.mutable_get_coalescing()->mutable_max_batch_size()->set_value(3);
+    }
+    std::shared_ptr<InstanceImpl> conn_pool_impl =
+        std::make_shared<InstanceImpl>(cluster_name_, cm_, *this, tls_, settings, api_,
+                                       store_.rootScope(), redis_command_stats,
+                                       cluster_refresh_manager_, dns_cache);
     conn_pool_impl->init();
     // Set the authentication password for this connection pool.
     conn_pool_impl->tls_->getTyped<InstanceImpl::ThreadLocalPool>().auth_username_ = auth_username_;
@@ -332,8 +338,20 @@ public:
   std::shared_ptr<NiceMock<Extensions::Common::Redis::MockClusterRefreshManager>>
       cluster_refresh_manager_;
   Common::Redis::Client::NoOpTransaction transaction_;
+  bool get_coalescing_{};
 };
 
+Common::Redis::RespValueSharedPtr makeCommand(const std::vector<std::string>& arguments) {
+  auto command = std::make_shared<Common::Redis::RespValue>();
+  command->type(Common::Redis::RespType::Array);
+  for (const std::string& argument : arguments) {
+    command->asArray().emplace_back();
+    command->asArray().back().type(Common::Redis::RespType::BulkString);
+    command->asArray().back().asString() = argument;
+  }
+  return command;
+}
+
 TEST_F(RedisConnPoolImplTest, Basic) {
   InSequence s;
 
@@ -889,6 +907,37 @@ TEST_F(RedisConnPoolImplTest, MakeRequestToHostWithZeroMaxUnknownUpstreamConnect
   tls_.shutdownThread();
 }
 
+// The keys of the hosts created for the redirections are tracked as well.
+TEST_F(RedisConnPoolImplTest, InvalidationTrackingOfRedirectHosts) {
+  setup();
+
+  NiceMock<MockInvalidationCallbacks> invalidation_callbacks;
+  InvalidationSubscriptionPtr subscription =
+      conn_pool_->subscribeToInvalidations("foo:", invalidation_callbacks);
+
+  Common::Redis::RespValue value;
+  Common::Redis::Client::MockPoolRequest active_request;
+  Common::Redis::Client::MockClientCallbacks callbacks;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  auto* connection = new NiceMock<Network::MockClientConnection>();
+  EXPECT_CALL(tls_.dispatcher_, createClientConnection_(_, _, _, _))
+      .WillOnce(Invoke([connection](Network::Address::InstanceConstSharedPtr address,
+                                    Network::Address::InstanceConstSharedPtr,
+                                    Network::TransportSocketPtr&,
+                                    const Network::ConnectionSocket::OptionsSharedPtr&) {
+        EXPECT_EQ("10.0.0.1:3000", address->asString());
+        return connection;
+      }));
+  EXPECT_CALL(*connection, connect());
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Ref(value), Ref(callbacks))).WillOnce(Return(&active_request));
+  EXPECT_EQ(&active_request, conn_pool_->makeRequestToHost("10.0.0.1:3000", value, callbacks));
+  EXPECT_FALSE(subscription->active());
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
 // This test forces the creation of 2 hosts (one with an IPv4 address, and the other with an IPv6
 // address) and pending requests using makeRequestToHost(). After their creation, "new" hosts are
 // discovered, and the original hosts are put aside to drain. The test then verifies the drain
@@ -1622,6 +1671,149 @@ TEST_F(RedisConnPoolImplTest, MakeRequestAndRedirectFollowedByDelete) {
   tls_.shutdownThread();
 }
 
+class RedisConnPoolGetCoalescingTest : public RedisConnPoolImplTest {
+public:
+  RedisConnPoolGetCoalescingTest() {
+    get_coalescing_ = true;
+    flush_cb_ = new NiceMock<Event::MockSchedulableCallback>(&tls_.dispatcher_);
+    setup();
+    EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_))
+        .WillRepeatedly(Return(cm_.thread_local_cluster_.lb_.host_));
+    EXPECT_CALL(*cm_.thread_local_cluster_.lb_.host_, address())
+        .WillRepeatedly(Return(test_address_));
+  }
+
+  Common::Redis::Client::PoolRequest* get(const std::string& key, MockPoolCallbacks& callbacks) {
+    return conn_pool_->makeRequest(key, makeCommand({"get", key}), callbacks, transaction_);
+  }
+
+  Event::MockSchedulableCallback* flush_cb_;
+};
+
+// GET requests to a host are sent as a MGET request, whose results are fanned out.
+TEST_F(RedisConnPoolGetCoalescingTest, CoalescedGets) {
+  MockPoolCallbacks callbacks1, callbacks2;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  EXPECT_NE(nullptr, get("foo", callbacks1));
+  EXPECT_NE(nullptr, get("bar", callbacks2));
+  EXPECT_TRUE(flush_cb_->enabled_);
+
+  Common::Redis::Client::MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "foo", "bar"})), _))
+      .WillOnce(Return(&active_request));
+  flush_cb_->invokeCallback();
+
+  Common::Redis::RespValuePtr response =
+      std::make_unique<Common::Redis::RespValue>(*makeCommand({"foo_value", ""}));
+  response->asArray()[1].type(Common::Redis::RespType::Null);
+  EXPECT_CALL(callbacks1, onResponse_(_)).WillOnce(Invoke([](Common::Redis::RespValuePtr& value) {
+    EXPECT_EQ("foo_value", value->asString());
+  }));
+  EXPECT_CALL(callbacks2, onResponse_(_)).WillOnce(Invoke([](Common::Redis::RespValuePtr& value) {
+    EXPECT_EQ(Common::Redis::RespType::Null, value->type());
+  }));
+  client->client_callbacks_.back()->onResponse(std::move(response));
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+// Full batches are sent without waiting, and a canceled GET request is removed from its batch.
+TEST_F(RedisConnPoolGetCoalescingTest, FullBatchAndCancel) {
+  MockPoolCallbacks callbacks1, callbacks2, callbacks3, callbacks4;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::PoolRequest* request1 = get("foo", callbacks1);
+  EXPECT_NE(nullptr, get("bar", callbacks2));
+  EXPECT_NE(nullptr, get("baz", callbacks3));
+  EXPECT_NE(nullptr, get("qux", callbacks4));
+  request1->cancel();
+
+  Common::Redis::Client::MockPoolRequest active_request1, active_request2;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "bar", "baz"})), _))
+      .WillOnce(Return(&active_request1));
+  // The single GET request of the open batch is sent as is.
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"get", "qux"})), _))
+      .WillOnce(Return(&active_request2));
+  flush_cb_->invokeCallback();
+
+  EXPECT_CALL(active_request1, cancel());
+  EXPECT_CALL(active_request2, cancel());
+  EXPECT_CALL(callbacks2, onFailure_());
+  EXPECT_CALL(callbacks3, onFailure_());
+  EXPECT_CALL(callbacks4, onFailure_());
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+// The GET requests of a MGET request failing with an error get the error, rather than being
+// retried against the failing host.
+TEST_F(RedisConnPoolGetCoalescingTest, ErrorFailsBatch) {
+  MockPoolCallbacks callbacks1, callbacks2;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  EXPECT_NE(nullptr, get("foo", callbacks1));
+  EXPECT_NE(nullptr, get("bar", callbacks2));
+
+  Common::Redis::Client::MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "foo", "bar"})), _))
+      .WillOnce(Return(&active_request));
+  flush_cb_->invokeCallback();
+
+  Common::Redis::RespValuePtr error = std::make_unique<Common::Redis::RespValue>();
+  error->type(Common::Redis::RespType::Error);
+  error->asString() = "LOADING Redis is loading the dataset in memory";
+  Common::Redis::RespValue expected = *error;
+  EXPECT_CALL(*client, makeRequest_(_, _)).Times(0);
+  EXPECT_CALL(store_.counter_, inc());
+  EXPECT_CALL(callbacks1, onResponse_(Pointee(Eq(expected))));
+  EXPECT_CALL(callbacks2, onResponse_(Pointee(Eq(expected))));
+  client->client_callbacks_.back()->onResponse(std::move(error));
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+// The GET requests of a redirected MGET request each follow the redirection.
+TEST_F(RedisConnPoolGetCoalescingTest, RedirectionRedirectsBatch) {
+  MockPoolCallbacks callbacks1, callbacks2;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  EXPECT_NE(nullptr, get("foo", callbacks1));
+  EXPECT_NE(nullptr, get("bar", callbacks2));
+
+  Common::Redis::Client::MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "foo", "bar"})), _))
+      .WillOnce(Return(&active_request));
+  flush_cb_->invokeCallback();
+
+  Common::Redis::RespValuePtr moved = std::make_unique<Common::Redis::RespValue>();
+  moved->type(Common::Redis::RespType::Error);
+  moved->asString() = "MOVED 1111 10.1.2.3:4000";
+  Common::Redis::Client::MockClient* redirected_client =
+      new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request1, active_request2;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(redirected_client));
+  EXPECT_CALL(*redirected_client, makeRequest_(Eq(*makeCommand({"get", "foo"})), _))
+      .WillOnce(Return(&active_request1));
+  EXPECT_CALL(*redirected_client, makeRequest_(Eq(*makeCommand({"get", "bar"})), _))
+      .WillOnce(Return(&active_request2));
+  EXPECT_CALL(*client, makeRequest_(_, _)).Times(0);
+  client->client_callbacks_.back()->onRedirection(std::move(moved), "10.1.2.3:4000", false);
+
+  EXPECT_CALL(callbacks1, onResponse_(_));
+  redirected_client->client_callbacks_.front()->onResponse(
+      std::make_unique<Common::Redis::RespValue>());
+  EXPECT_CALL(callbacks2, onResponse_(_));
+  redirected_client->client_callbacks_.back()->onResponse(
+      std::make_unique<Common::Redis::RespValue>());
+
+  EXPECT_CALL(*client, close());
+  EXPECT_CALL(*redirected_client, close());
+  tls_.shutdownThread();
+}
+
 } // namespace ConnPool
 } // namespace RedisProxy
 } // namespace NetworkFilters
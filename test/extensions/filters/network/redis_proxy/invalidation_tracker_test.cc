@@ -0,0 +1,362 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/network/common/redis/codec_impl.h"
+#include "source/extensions/filters/network/redis_proxy/invalidation_tracker.h"
+
+#include "test/extensions/filters/network/redis_proxy/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/connection.h"
+#include "test/mocks/upstream/host.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+class RedisInvalidationTrackerTest : public testing::Test {
+public:
+  // An upstream host, and the invalidation tracking connection to it.
+  struct TestHost {
+    TestHost(const std::string& url) : host_(std::make_shared<NiceMock<Upstream::MockHost>>()) {
+      ON_CALL(*host_, address()).WillByDefault(Return(Network::Utility::resolveUrl(url)));
+    }
+
+    std::shared_ptr<NiceMock<Upstream::MockHost>> host_;
+    NiceMock<Network::MockClientConnection>* connection_{};
+    Event::MockTimer* connect_timer_{};
+    Network::ReadFilterSharedPtr read_filter_;
+    Buffer::OwnedImpl written_;
+  };
+
+  RedisInvalidationTrackerTest()
+      : reconnect_timer_(new Event::MockTimer(&dispatcher_)),
+        tracker_(std::make_shared<InvalidationTracker>(dispatcher_)) {}
+
+  static Common::Redis::RespValue bulkString(const std::string& value) {
+    Common::Redis::RespValue resp_value;
+    resp_value.type(Common::Redis::RespType::BulkString);
+    resp_value.asString() = value;
+    return resp_value;
+  }
+
+  static Common::Redis::RespValue array(std::vector<Common::Redis::RespValue> values) {
+    Common::Redis::RespValue resp_value;
+    resp_value.type(Common::Redis::RespType::Array);
+    resp_value.asArray().swap(values);
+    return resp_value;
+  }
+
+  static std::string encode(const Common::Redis::RespValue& value) {
+    Common::Redis::EncoderImpl encoder;
+    Buffer::OwnedImpl buffer;
+    encoder.encode(value, buffer);
+    return buffer.toString();
+  }
+
+  static std::string command(const std::vector<std::string>& arguments) {
+    std::vector<Common::Redis::RespValue> values;
+    for (const std::string& argument : arguments) {
+      values.push_back(bulkString(argument));
+    }
+    return encode(array(std::move(values)));
+  }
+
+  void expectConnect(TestHost& host) {
+    host.connect_timer_ = new Event::MockTimer(&dispatcher_);
+    host.connection_ = new NiceMock<Network::MockClientConnection>();
+    EXPECT_CALL(*host.host_, createConnection_(_, _))
+        .WillOnce(Return(Upstream::MockHost::MockCreateConnectionData{host.connection_, nullptr}));
+    EXPECT_CALL(*host.connection_, addReadFilter(_)).WillOnce(SaveArg<0>(&host.read_filter_));
+    EXPECT_CALL(*host.connection_, connect());
+    EXPECT_CALL(*host.connect_timer_, enableTimer(std::chrono::milliseconds(5001), _));
+    ON_CALL(*host.connection_, write(_, _))
+        .WillByDefault(Invoke([&host](Buffer::Instance& data, bool) { host.written_.move(data); }));
+  }
+
+  // @return the commands written on the connection to the host since the last call.
+  std::string written(TestHost& host) {
+    const std::string written = host.written_.toString();
+    host.written_.drain(host.written_.length());
+    return written;
+  }
+
+  void reply(TestHost& host, const Common::Redis::RespValue& value) {
+    Buffer::OwnedImpl data(encode(value));
+    host.read_filter_->onData(data, false);
+  }
+
+  void replyOk(TestHost& host) {
+    Common::Redis::RespValue ok;
+    ok.type(Common::Redis::RespType::SimpleString);
+    ok.asString() = "OK";
+    reply(host, ok);
+  }
+
+  // Completes the handshake on a connection on which CLIENT ID was sent.
+  void completeHandshake(TestHost& host, int64_t client_id = 7) {
+    host.connection_->raiseEvent(Network::ConnectionEvent::Connected);
+    Common::Redis::RespValue id;
+    id.type(Common::Redis::RespType::Integer);
+    id.asInteger() = client_id;
+    reply(host, id);
+    EXPECT_EQ(command({"client", "tracking", "on", "redirect", std::to_string(client_id), "bcast",
+                       "prefix", "foo:"}) +
+                  command({"subscribe", "__redis__:invalidate"}),
+              written(host));
+    replyOk(host);
+
+    Common::Redis::RespValue count;
+    count.type(Common::Redis::RespType::Integer);
+    count.asInteger() = 1;
+    reply(host, array({bulkString("subscribe"), bulkString("__redis__:invalidate"), count}));
+  }
+
+  void invalidate(TestHost& host, const Common::Redis::RespValue& keys) {
+    reply(host, array({bulkString("message"), bulkString("__redis__:invalidate"), keys}));
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Event::MockTimer* reconnect_timer_;
+  InvalidationTrackerSharedPtr tracker_;
+  NiceMock<MockInvalidationCallbacks> callbacks_;
+};
+
+// The tracking is enabled after authenticating, with the id of the connection, before subscribing
+// to the invalidation channel.
+TEST_F(RedisInvalidationTrackerTest, Handshake) {
+  InvalidationSubscriptionPtr foo = tracker_->subscribe("foo:", callbacks_);
+  InvalidationSubscriptionPtr bar = tracker_->subscribe("bar:", callbacks_);
+  InvalidationSubscriptionPtr foo_1 = tracker_->subscribe("foo:1", callbacks_);
+  EXPECT_FALSE(foo->active());
+
+  TestHost host("tcp://10.0.0.1:6379");
+  expectConnect(host);
+  EXPECT_CALL(*host.connection_, noDelay(true));
+  tracker_->updateHosts({host.host_}, "user", "password");
+  EXPECT_EQ(command({"auth", "user", "password"}) + command({"client", "id"}), written(host));
+
+  host.connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_FALSE(host.connect_timer_->enabled());
+  replyOk(host);
+  EXPECT_EQ("", written(host));
+  Common::Redis::RespValue id;
+  id.type(Common::Redis::RespType::Integer);
+  id.asInteger() = 42;
+  reply(host, id);
+  EXPECT_EQ(command({"client", "tracking", "on", "redirect", "42", "bcast", "prefix", "bar:",
+                     "prefix", "foo:"}) +
+                command({"subscribe", "__redis__:invalidate"}),
+            written(host));
+  replyOk(host);
+  EXPECT_FALSE(foo->active());
+
+  Common::Redis::RespValue count;
+  count.type(Common::Redis::RespType::Integer);
+  count.asInteger() = 1;
+  reply(host, array({bulkString("subscribe"), bulkString("__redis__:invalidate"), count}));
+  EXPECT_TRUE(foo->active());
+  EXPECT_TRUE(bar->active());
+}
+
+// Only the password is sent when there is no username, and nothing without authentication.
+TEST_F(RedisInvalidationTrackerTest, HandshakeAuthPasswordOnly) {
+  InvalidationSubscriptionPtr subscription = tracker_->subscribe("foo:", callbacks_);
+
+  TestHost host1("tcp://10.0.0.1:6379");
+  expectConnect(host1);
+  tracker_->updateHosts({host1.host_}, "", "password");
+  EXPECT_EQ(command({"auth", "password"}) + command({"client", "id"}), written(host1));
+
+  TestHost host2("tcp://10.0.0.2:6379");
+  expectConnect(host2);
+  tracker_->updateHosts({host1.host_, host2.host_}, "", "");
+  EXPECT_EQ(command({"client", "id"}), written(host2));
+}
+
+// An error in the handshake closes the connection, which is reestablished later.
+TEST_F(RedisInvalidationTrackerTest, HandshakeError) {
+  InvalidationSubscriptionPtr subscription = tracker_->subscribe("foo:", callbacks_);
+
+  TestHost host("tcp://10.0.0.1:6379");
+  expectConnect(host);
+  tracker_->updateHosts({host.host_}, "", "");
+  EXPECT_CALL(*host.connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*reconnect_timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  Common::Redis::RespValue error;
+  error.type(Common::Redis::RespType::Error);
+  error.asString() = "ERR unknown command";
+  reply(host, error);
+  EXPECT_FALSE(subscription->active());
+}
+
+// The keys of the invalidation messages are passed to the subscriptions of their prefixes, and a
+// null payload, sent when the database is flushed, invalidates all the keys.
+TEST_F(RedisInvalidationTrackerTest, Invalidations) {
+  InvalidationSubscriptionPtr subscription = tracker_->subscribe("foo:", callbacks_);
+  NiceMock<MockInvalidationCallbacks> other_callbacks;
+  InvalidationSubscriptionPtr other = tracker_->subscribe("foo:bar:", other_callbacks);
+
+  TestHost host("tcp://10.0.0.1:6379");
+  expectConnect(host);
+  tracker_->updateHosts({host.host_}, "", "");
+  written(host);
+  completeHandshake(host);
+
+  EXPECT_CALL(callbacks_, onInvalidation(absl::string_view("foo:1")));
+  EXPECT_CALL(callbacks_, onInvalidation(absl::string_view("foo:bar:2")));
+  EXPECT_CALL(other_callbacks, onInvalidation(absl::string_view("foo:bar:2")));
+  invalidate(host, array({bulkString("foo:1"), bulkString("foo:bar:2")}));
+
+  EXPECT_CALL(callbacks_, onInvalidation(absl::string_view("foo:3")));
+  EXPECT_CALL(other_callbacks, onInvalidation(_)).Times(0);
+  invalidate(host, bulkString("foo:3"));
+
+  EXPECT_CALL(callbacks_, onInvalidateAll());
+  EXPECT_CALL(other_callbacks, onInvalidateAll());
+  Common::Redis::RespValue null;
+  invalidate(host, null);
+
+  // The other messages are ignored.
+  EXPECT_CALL(callbacks_, onInvalidation(_)).Times(0);
+  EXPECT_CALL(callbacks_, onInvalidateAll()).Times(0);
+  reply(host, array({bulkString("pong"), bulkString("")}));
+  EXPECT_TRUE(subscription->active());
+
+  // The callbacks of a destroyed subscription are no longer called.
+  other.reset();
+  EXPECT_CALL(callbacks_, onInvalidation(absl::string_view("foo:bar:4")));
+  invalidate(host, bulkString("foo:bar:4"));
+}
+
+// A connection not established in the connect timeout of the cluster is closed and reestablished.
+TEST_F(RedisInvalidationTrackerTest, ConnectTimeoutAndReconnect) {
+  InvalidationSubscriptionPtr subscription = tracker_->subscribe("foo:", callbacks_);
+
+  TestHost host("tcp://10.0.0.1:6379");
+  expectConnect(host);
+  tracker_->updateHosts({host.host_}, "", "");
+  EXPECT_TRUE(host.connect_timer_->enabled());
+
+  EXPECT_CALL(*host.connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(*reconnect_timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  host.connect_timer_->invokeCallback();
+  EXPECT_FALSE(subscription->active());
+
+  expectConnect(host);
+  reconnect_timer_->invokeCallback();
+  EXPECT_EQ(command({"client", "id"}), written(host));
+  completeHandshake(host);
+  EXPECT_TRUE(subscription->active());
+}
+
+// The keys modified while a connection is closed are not notified, so all the keys are invalidated
+// when a connection of an active tracker is closed.
+TEST_F(RedisInvalidationTrackerTest, RemoteCloseAndReconnect) {
+  InvalidationSubscriptionPtr subscription = tracker_->subscribe("foo:", callbacks_);
+
+  TestHost host("tcp://10.0.0.1:6379");
+  expectConnect(host);
+  tracker_->updateHosts({host.host_}, "", "");
+  written(host);
+  completeHandshake(host);
+  EXPECT_TRUE(subscription->active());
+
+  EXPECT_CALL(callbacks_, onInvalidateAll());
+  EXPECT_CALL(*reconnect_timer_, enableTimer(std::chrono::milliseconds(1000), _));
+  host.connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_FALSE(subscription->active());
+
+  expectConnect(host);
+  reconnect_timer_->invokeCallback();
+  written(host);
+  completeHandshake(host, 8);
+  EXPECT_TRUE(subscription->active());
+}
+
+// The added hosts are tracked, and the connections to the removed ones closed.
+TEST_F(RedisInvalidationTrackerTest, HostAddAndRemove) {
+  InvalidationSubscriptionPtr subscription = tracker_->subscribe("foo:", callbacks_);
+
+  TestHost host1("tcp://10.0.0.1:6379");
+  expectConnect(host1);
+  tracker_->updateHosts({host1.host_}, "", "");
+  written(host1);
+  completeHandshake(host1);
+  EXPECT_TRUE(subscription->active());
+
+  // The keys of the added host may be modified until its connection is subscribed.
+  TestHost host2("tcp://10.0.0.2:6379");
+  expectConnect(host2);
+  EXPECT_CALL(callbacks_, onInvalidateAll());
+  tracker_->updateHosts({host1.host_, host2.host_}, "", "");
+  EXPECT_FALSE(subscription->active());
+  written(host2);
+  completeHandshake(host2);
+  EXPECT_TRUE(subscription->active());
+
+  EXPECT_CALL(*host1.connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks_, onInvalidateAll()).Times(0);
+  EXPECT_CALL(*reconnect_timer_, enableTimer(_, _)).Times(0);
+  tracker_->updateHosts({host2.host_}, "", "");
+  EXPECT_TRUE(subscription->active());
+
+  // No key is tracked without hosts.
+  EXPECT_CALL(*host2.connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks_, onInvalidateAll());
+  tracker_->updateHosts({}, "", "");
+  EXPECT_FALSE(subscription->active());
+}
+
+// The connections are reestablished when the tracked prefixes change.
+TEST_F(RedisInvalidationTrackerTest, TrackedPrefixesChange) {
+  InvalidationSubscriptionPtr subscription = tracker_->subscribe("foo:", callbacks_);
+
+  TestHost host("tcp://10.0.0.1:6379");
+  expectConnect(host);
+  tracker_->updateHosts({host.host_}, "", "");
+  written(host);
+  completeHandshake(host);
+
+  // A prefix starting with a tracked one does not change the tracked prefixes.
+  InvalidationSubscriptionPtr foo_1 = tracker_->subscribe("foo:1", callbacks_);
+  EXPECT_TRUE(subscription->active());
+
+  Network::MockClientConnection* connection = host.connection_;
+  EXPECT_CALL(*connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks_, onInvalidateAll());
+  expectConnect(host);
+  InvalidationSubscriptionPtr bar = tracker_->subscribe("bar:", callbacks_);
+  EXPECT_FALSE(subscription->active());
+  EXPECT_EQ(command({"client", "id"}), written(host));
+}
+
+TEST(RedisInvalidationTrackerPrefixesTest, TrackedPrefixes) {
+  EXPECT_EQ(std::vector<std::string>({"a:", "b:"}),
+            InvalidationTracker::trackedPrefixes({"b:", "a:1", "a:", "b:c:"}));
+  EXPECT_EQ(std::vector<std::string>({"a:", "ab"}),
+            InvalidationTracker::trackedPrefixes({"ab", "a:"}));
+  EXPECT_EQ(std::vector<std::string>(), InvalidationTracker::trackedPrefixes({"a:", ""}));
+  EXPECT_EQ(std::vector<std::string>(), InvalidationTracker::trackedPrefixes({}));
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -20,6 +20,12 @@ MockRoute::MockRoute(ConnPool::InstanceSharedPtr conn_pool) : conn_pool_(std::mo
 }
 MockRoute::~MockRoute() = default;
 
+MockNearCacheFill::MockNearCacheFill() = default;
+MockNearCacheFill::~MockNearCacheFill() = default;
+
+MockNearCache::MockNearCache() = default;
+MockNearCache::~MockNearCache() = default;
+
 MockMirrorPolicy::MockMirrorPolicy(ConnPool::InstanceSharedPtr conn_pool)
     : conn_pool_(std::move(conn_pool)) {
   ON_CALL(*this, upstream()).WillByDefault(Return(conn_pool_));
@@ -38,6 +44,12 @@ MockPoolCallbacks::~MockPoolCallbacks() = default;
 MockInstance::MockInstance() = default;
 MockInstance::~MockInstance() = default;
 
+MockInvalidationSubscription::MockInvalidationSubscription() = default;
+MockInvalidationSubscription::~MockInvalidationSubscription() = default;
+
+MockInvalidationCallbacks::MockInvalidationCallbacks() = default;
+MockInvalidationCallbacks::~MockInvalidationCallbacks() = default;
+
 } // namespace ConnPool
 
 namespace CommandSplitter {
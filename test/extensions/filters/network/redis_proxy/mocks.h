@@ -12,6 +12,7 @@
 #include "source/extensions/filters/network/common/redis/fault.h"
 #include "source/extensions/filters/network/redis_proxy/command_splitter.h"
 #include "source/extensions/filters/network/redis_proxy/conn_pool.h"
+#include "source/extensions/filters/network/redis_proxy/near_cache.h"
 #include "source/extensions/filters/network/redis_proxy/router.h"
 
 #include "test/test_common/printers.h"
@@ -41,6 +42,7 @@ public:
 
   MOCK_METHOD(ConnPool::InstanceSharedPtr, upstream, (const std::string&), (const));
   MOCK_METHOD(const MirrorPolicies&, mirrorPolicies, (), (const));
+  MOCK_METHOD(OptRef<NearCache>, nearCache, (), (const));
   ConnPool::InstanceSharedPtr conn_pool_;
   MirrorPolicies policies_;
 };
@@ -56,6 +58,23 @@ public:
   ConnPool::InstanceSharedPtr conn_pool_;
 };
 
+class MockNearCacheFill : public NearCacheFill {
+public:
+  MockNearCacheFill();
+  ~MockNearCacheFill() override;
+
+  MOCK_METHOD(void, complete, (const Common::Redis::RespValue& value));
+};
+
+class MockNearCache : public NearCache {
+public:
+  MockNearCache();
+  ~MockNearCache() override;
+
+  MOCK_METHOD(Common::Redis::RespValuePtr, lookup, (const std::string& key));
+  MOCK_METHOD(NearCacheFillPtr, startFill, (const std::string& key));
+};
+
 class MockFaultManager : public Common::Redis::FaultManager {
 public:
   MockFaultManager();
@@ -93,6 +112,25 @@ public:
   MOCK_METHOD(Common::Redis::Client::PoolRequest*, makeRequest_,
               (const std::string& hash_key, RespVariant& request, PoolCallbacks& callbacks));
   MOCK_METHOD(bool, onRedirection, ());
+  MOCK_METHOD(InvalidationSubscriptionPtr, subscribeToInvalidations,
+              (const std::string& prefix, InvalidationCallbacks& callbacks));
+};
+
+class MockInvalidationSubscription : public InvalidationSubscription {
+public:
+  MockInvalidationSubscription();
+  ~MockInvalidationSubscription() override;
+
+  MOCK_METHOD(bool, active, (), (const));
+};
+
+class MockInvalidationCallbacks : public InvalidationCallbacks {
+public:
+  MockInvalidationCallbacks();
+  ~MockInvalidationCallbacks() override;
+
+  MOCK_METHOD(void, onInvalidation, (absl::string_view key));
+  MOCK_METHOD(void, onInvalidateAll, ());
 };
 } // namespace ConnPool
 
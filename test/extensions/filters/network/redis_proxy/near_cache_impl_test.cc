@@ -0,0 +1,194 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/network/redis_proxy/near_cache_impl.h"
+
+#include "test/extensions/filters/network/redis_proxy/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+class RedisNearCacheImplTest : public testing::Test {
+public:
+  void setup(uint64_t max_bytes = 0) {
+    envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::Route::NearCache
+        config;
+    if (max_bytes > 0) {
+      config.mutable_max_bytes()->set_value(max_bytes);
+    }
+    config.mutable_ttl()->set_seconds(10);
+
+    EXPECT_CALL(*upstream_, subscribeToInvalidations("foo:", _))
+        .WillOnce(Invoke([this](const std::string&, ConnPool::InvalidationCallbacks& callbacks) {
+          invalidation_callbacks_ = &callbacks;
+          auto subscription = std::make_unique<NiceMock<ConnPool::MockInvalidationSubscription>>();
+          ON_CALL(*subscription, active()).WillByDefault(Invoke([this]() { return active_; }));
+          return subscription;
+        }));
+    cache_ = std::make_unique<NearCacheImpl>(config, upstream_, "foo:", tls_,
+                                             store_.rootScope()->createScope("near_cache."),
+                                             time_system_);
+  }
+
+  Common::Redis::RespValue bulkString(const std::string& value) {
+    Common::Redis::RespValue resp_value;
+    resp_value.type(Common::Redis::RespType::BulkString);
+    resp_value.asString() = value;
+    return resp_value;
+  }
+
+  void fill(const std::string& key, const std::string& value) {
+    NearCacheFillPtr fill = cache_->startFill(key);
+    ASSERT_NE(nullptr, fill);
+    fill->complete(bulkString(value));
+  }
+
+  uint64_t counter(const std::string& name) {
+    return store_.counterFromString("near_cache." + name).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl store_;
+  std::shared_ptr<ConnPool::MockInstance> upstream_{std::make_shared<ConnPool::MockInstance>()};
+  ConnPool::InvalidationCallbacks* invalidation_callbacks_{};
+  bool active_{true};
+  std::unique_ptr<NearCacheImpl> cache_;
+};
+
+TEST_F(RedisNearCacheImplTest, HitAndMiss) {
+  setup();
+
+  EXPECT_EQ(nullptr, cache_->lookup("foo:1"));
+  fill("foo:1", "bar");
+
+  Common::Redis::RespValuePtr value = cache_->lookup("foo:1");
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ(bulkString("bar"), *value);
+  EXPECT_EQ(1UL, counter("hit"));
+  EXPECT_EQ(1UL, counter("miss"));
+  EXPECT_LT(0UL, store_.gaugeFromString("near_cache.bytes", Stats::Gauge::ImportMode::Accumulate)
+                     .value());
+}
+
+TEST_F(RedisNearCacheImplTest, NullValueCachedButNotErrors) {
+  setup();
+
+  Common::Redis::RespValue null_value;
+  cache_->startFill("foo:1")->complete(null_value);
+  Common::Redis::RespValue error;
+  error.type(Common::Redis::RespType::Error);
+  error.asString() = "ERR";
+  cache_->startFill("foo:2")->complete(error);
+
+  Common::Redis::RespValuePtr value = cache_->lookup("foo:1");
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ(Common::Redis::RespType::Null, value->type());
+  EXPECT_EQ(nullptr, cache_->lookup("foo:2"));
+}
+
+TEST_F(RedisNearCacheImplTest, Invalidation) {
+  setup();
+
+  fill("foo:1", "bar");
+  fill("foo:2", "baz");
+  invalidation_callbacks_->onInvalidation("foo:1");
+  EXPECT_EQ(nullptr, cache_->lookup("foo:1"));
+  EXPECT_NE(nullptr, cache_->lookup("foo:2"));
+  EXPECT_EQ(1UL, counter("invalidation"));
+
+  invalidation_callbacks_->onInvalidateAll();
+  EXPECT_EQ(nullptr, cache_->lookup("foo:2"));
+  EXPECT_EQ(2UL, counter("invalidation"));
+  EXPECT_EQ(0UL, store_.gaugeFromString("near_cache.bytes", Stats::Gauge::ImportMode::Accumulate)
+                     .value());
+}
+
+// A value read before the invalidation of its key may be stale, and is not cached.
+TEST_F(RedisNearCacheImplTest, InvalidationDuringFill) {
+  setup();
+
+  NearCacheFillPtr fill1 = cache_->startFill("foo:1");
+  NearCacheFillPtr fill2 = cache_->startFill("foo:2");
+  invalidation_callbacks_->onInvalidation("foo:1");
+  fill1->complete(bulkString("bar"));
+  fill2->complete(bulkString("baz"));
+  EXPECT_EQ(nullptr, cache_->lookup("foo:1"));
+  EXPECT_NE(nullptr, cache_->lookup("foo:2"));
+
+  // A fill started after the invalidation is cached.
+  fill("foo:1", "qux");
+  EXPECT_NE(nullptr, cache_->lookup("foo:1"));
+
+  NearCacheFillPtr fill3 = cache_->startFill("foo:3");
+  invalidation_callbacks_->onInvalidateAll();
+  fill3->complete(bulkString("bar"));
+  EXPECT_EQ(nullptr, cache_->lookup("foo:3"));
+}
+
+TEST_F(RedisNearCacheImplTest, NotCachedWhileInactive) {
+  setup();
+
+  NearCacheFillPtr fill1 = cache_->startFill("foo:1");
+  active_ = false;
+  fill1->complete(bulkString("bar"));
+  EXPECT_EQ(nullptr, cache_->lookup("foo:1"));
+  EXPECT_EQ(nullptr, cache_->startFill("foo:1"));
+}
+
+TEST_F(RedisNearCacheImplTest, Expiration) {
+  setup();
+
+  fill("foo:1", "bar");
+  time_system_.advanceTimeWait(std::chrono::seconds(9));
+  EXPECT_NE(nullptr, cache_->lookup("foo:1"));
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_EQ(nullptr, cache_->lookup("foo:1"));
+}
+
+TEST_F(RedisNearCacheImplTest, LeastRecentlyUsedEviction) {
+  setup(1024);
+
+  const std::string value(300, 'x');
+  fill("foo:1", value);
+  fill("foo:2", value);
+  EXPECT_NE(nullptr, cache_->lookup("foo:1"));
+  fill("foo:3", value);
+
+  EXPECT_NE(nullptr, cache_->lookup("foo:1"));
+  EXPECT_EQ(nullptr, cache_->lookup("foo:2"));
+  EXPECT_NE(nullptr, cache_->lookup("foo:3"));
+  EXPECT_EQ(1UL, counter("eviction"));
+
+  // The values larger than the cache are not cached.
+  fill("foo:4", std::string(1024, 'x'));
+  EXPECT_EQ(nullptr, cache_->lookup("foo:4"));
+}
+
+TEST_F(RedisNearCacheImplTest, FillOutlivesCache) {
+  setup();
+
+  NearCacheFillPtr fill = cache_->startFill("foo:1");
+  cache_.reset();
+  fill->complete(bulkString("bar"));
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
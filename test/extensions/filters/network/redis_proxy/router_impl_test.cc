@@ -69,6 +69,53 @@ TEST(PrefixRoutesTest, RoutedToCatchAll) {
   EXPECT_EQ(upstream_c, router.upstreamPool(key, stream_info)->upstream(""));
 }
 
+TEST(PrefixRoutesTest, NearCache) {
+  auto upstream_a = std::make_shared<ConnPool::MockInstance>();
+  auto upstream_b = std::make_shared<ConnPool::MockInstance>();
+  auto upstream_c = std::make_shared<ConnPool::MockInstance>();
+
+  Upstreams upstreams;
+  upstreams.emplace("fake_clusterA", upstream_a);
+  upstreams.emplace("fake_clusterB", upstream_b);
+  upstreams.emplace("fake_clusterC", upstream_c);
+
+  Runtime::MockLoader runtime_;
+
+  auto prefix_routes = createPrefixRoutes();
+  prefix_routes.mutable_routes(0)->mutable_near_cache();
+  prefix_routes.mutable_routes(1)->mutable_near_cache();
+  prefix_routes.mutable_routes(1)->set_remove_prefix(true);
+  prefix_routes.mutable_catch_all_route()->set_cluster("fake_clusterB");
+  prefix_routes.mutable_catch_all_route()->mutable_read_command_policy()->set_cluster(
+      "fake_clusterC");
+  prefix_routes.mutable_catch_all_route()->mutable_near_cache();
+
+  std::map<std::string, std::pair<ConnPool::InstanceSharedPtr, std::string>> near_caches;
+  NearCacheFactory near_cache_factory =
+      [&near_caches](
+          const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::PrefixRoutes::
+              Route& route,
+          const ConnPool::InstanceSharedPtr& upstream,
+          const std::string& tracking_prefix) -> NearCacheSharedPtr {
+    near_caches[route.prefix()] = {upstream, tracking_prefix};
+    return std::make_shared<NiceMock<MockNearCache>>();
+  };
+  PrefixRoutes router(prefix_routes, std::move(upstreams), runtime_, near_cache_factory);
+
+  // Only the keys of the routes matching them as is are tracked by prefix.
+  EXPECT_EQ(3UL, near_caches.size());
+  EXPECT_EQ(upstream_a, near_caches["ab"].first);
+  EXPECT_EQ("ab", near_caches["ab"].second);
+  EXPECT_EQ(upstream_b, near_caches["a"].first);
+  EXPECT_EQ("", near_caches["a"].second);
+  EXPECT_EQ(upstream_c, near_caches[""].first);
+  EXPECT_EQ("", near_caches[""].second);
+
+  std::string key("ab:bar");
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  EXPECT_TRUE(router.upstreamPool(key, stream_info)->nearCache().has_value());
+}
+
 TEST(PrefixRoutesTest, MissingCatchAll) {
   Upstreams upstreams;
   upstreams.emplace("fake_clusterA", std::make_shared<ConnPool::MockInstance>());
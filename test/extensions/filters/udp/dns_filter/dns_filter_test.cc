@@ -220,6 +220,35 @@ server_config:
             - "10.0.0.1"
 )EOF";
 
+  const std::string answer_cache_config = R"EOF(
+stat_prefix: "my_prefix"
+client_config:
+  resolver_timeout: 1s
+  typed_dns_resolver_config:
+    name: envoy.network.dns_resolver.cares
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.network.dns_resolver.cares.v3.CaresDnsResolverConfig
+      resolvers:
+      - socket_address:
+          address: "1.1.1.1"
+          port_value: 53
+  max_pending_lookups: 256
+  answer_cache:
+    max_entries: 2
+    negative_ttl: 5s
+    max_stale_ttl: 60s
+    prefetch_min_hits: 2
+server_config:
+  inline_dns_table:
+    external_retry_count: 0
+    virtual_domains:
+      - name: "www.foo1.com"
+        endpoint:
+          address_list:
+            address:
+            - "10.0.0.1"
+)EOF";
+
   static constexpr absl::string_view external_dns_table_config = R"EOF(
 stat_prefix: "my_prefix"
 client_config:
@@ -1071,6 +1100,165 @@ TEST_F(DnsFilterTest, ExternalResolutionExceedMaxPendingLookups) {
   EXPECT_EQ(1, config_->stats().unanswered_queries_.value());
 }
 
+TEST_F(DnsFilterTest, AnswerCacheHit) {
+  const std::string domain("www.foobaz.com");
+  setup(answer_cache_config);
+  const DnsAnswerCacheStats& cache_stats = config_->answerCacheConfig()->stats();
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A,
+                                                                  DNS_RECORD_CLASS_IN, 1));
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"130.207.244.251"}, std::chrono::seconds(60)));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  // The following query is answered from the cache, with its own ID and the remaining TTL.
+  simTime().advanceTimeWait(std::chrono::seconds(10));
+  sendQueryFromClient("10.0.0.2:1000", Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A,
+                                                                  DNS_RECORD_CLASS_IN, 2));
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(2, response_ctx_->id_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NO_ERROR, response_ctx_->getQueryResponseCode());
+  ASSERT_EQ(1, response_ctx_->answers_.size());
+  const auto& answer = response_ctx_->answers_.begin()->second;
+  Utils::verifyAddress({"130.207.244.251"}, answer);
+  EXPECT_EQ(std::chrono::seconds(50), answer->ttl_);
+
+  EXPECT_EQ(1, cache_stats.hits_.value());
+  EXPECT_EQ(1, cache_stats.misses_.value());
+  EXPECT_EQ(1, cache_stats.entries_.value());
+  EXPECT_EQ(2, config_->stats().downstream_tx_responses_.value());
+  EXPECT_EQ(1, config_->stats().externally_resolved_queries_.value());
+
+  // The queries of another type or for an expired answer are resolved again.
+  EXPECT_CALL(*resolver_, resolve(domain, _, _)).WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.2:1000", Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_AAAA,
+                                                                  DNS_RECORD_CLASS_IN, 3));
+  simTime().advanceTimeWait(std::chrono::seconds(50));
+  EXPECT_CALL(*resolver_, resolve(domain, _, _)).WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.2:1000", Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A,
+                                                                  DNS_RECORD_CLASS_IN, 4));
+  EXPECT_EQ(1, cache_stats.hits_.value());
+  EXPECT_EQ(3, cache_stats.misses_.value());
+}
+
+TEST_F(DnsFilterTest, AnswerCacheNegativeAnswersAndEviction) {
+  setup(answer_cache_config);
+  const DnsAnswerCacheStats& cache_stats = config_->answerCacheConfig()->stats();
+  const std::string query =
+      Utils::buildQueryForDomain("www.foobaz.com", DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve("www.foobaz.com", _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success, TestUtility::makeDnsResponse({}));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(resolver_.get()));
+
+  // The name error is returned from the cache for the negative TTL.
+  simTime().advanceTimeWait(std::chrono::seconds(4));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NAME_ERROR, response_ctx_->getQueryResponseCode());
+  EXPECT_EQ(0, response_ctx_->answers_.size());
+  EXPECT_EQ(1, cache_stats.negative_hits_.value());
+
+  // The least recently used answer is evicted when the cache is full.
+  for (const std::string domain : {"www.foobar.com", "www.foobat.com"}) {
+    EXPECT_CALL(*resolver_, resolve(domain, _, _))
+        .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+    sendQueryFromClient("10.0.0.1:1000",
+                        Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN));
+    resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+               TestUtility::makeDnsResponse({"130.207.244.251"}));
+  }
+  EXPECT_EQ(1, cache_stats.evictions_.value());
+  EXPECT_EQ(2, cache_stats.entries_.value());
+
+  EXPECT_CALL(*resolver_, resolve("www.foobaz.com", _, _))
+      .WillOnce(Return(&resolver_->active_query_));
+  sendQueryFromClient("10.0.0.1:1000", query);
+}
+
+TEST_F(DnsFilterTest, AnswerCacheServeStale) {
+  const std::string domain("www.foobaz.com");
+  setup(answer_cache_config);
+  const DnsAnswerCacheStats& cache_stats = config_->answerCacheConfig()->stats();
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain, _, _))
+      .Times(3)
+      .WillRepeatedly(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  const std::string query =
+      Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+  sendQueryFromClient("10.0.0.1:1000", query);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"130.207.244.251"}, std::chrono::seconds(10)));
+
+  // The expired answer is returned when the resolution fails.
+  simTime().advanceTimeWait(std::chrono::seconds(20));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Failure, TestUtility::makeDnsResponse({}));
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NO_ERROR, response_ctx_->getQueryResponseCode());
+  ASSERT_EQ(1, response_ctx_->answers_.size());
+  EXPECT_EQ(DnsAnswerCache::StaleAnswerTtl, response_ctx_->answers_.begin()->second->ttl_);
+  EXPECT_EQ(1, cache_stats.stale_hits_.value());
+
+  // Until it expired for longer than the maximum stale TTL.
+  simTime().advanceTimeWait(std::chrono::seconds(60));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Failure, TestUtility::makeDnsResponse({}));
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  EXPECT_EQ(DNS_RESPONSE_CODE_NAME_ERROR, response_ctx_->getQueryResponseCode());
+  EXPECT_EQ(1, cache_stats.stale_hits_.value());
+  EXPECT_EQ(0, cache_stats.entries_.value());
+}
+
+TEST_F(DnsFilterTest, AnswerCachePrefetch) {
+  const std::string domain("www.foobaz.com");
+  setup(answer_cache_config);
+  const DnsAnswerCacheStats& cache_stats = config_->answerCacheConfig()->stats();
+
+  Network::DnsResolver::ResolveCb resolve_cb;
+  EXPECT_CALL(*resolver_, resolve(domain, _, _))
+      .Times(2)
+      .WillRepeatedly(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  const std::string query =
+      Utils::buildQueryForDomain(domain, DNS_RECORD_TYPE_A, DNS_RECORD_CLASS_IN);
+  sendQueryFromClient("10.0.0.1:1000", query);
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"130.207.244.251"}, std::chrono::seconds(10)));
+
+  // The answer is not prefetched until it was returned enough times.
+  simTime().advanceTimeWait(std::chrono::milliseconds(9500));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  EXPECT_EQ(0, cache_stats.prefetches_.value());
+
+  // The client is answered from the cache while the answer is resolved again.
+  sendQueryFromClient("10.0.0.1:1000", query);
+  EXPECT_EQ(1, cache_stats.prefetches_.value());
+  EXPECT_EQ(3, config_->stats().downstream_tx_responses_.value());
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"130.207.244.252"}, std::chrono::seconds(10)));
+  EXPECT_EQ(3, config_->stats().downstream_tx_responses_.value());
+
+  simTime().advanceTimeWait(std::chrono::seconds(2));
+  sendQueryFromClient("10.0.0.1:1000", query);
+  response_ctx_ = ResponseValidator::createResponseContext(udp_response_, counters_);
+  EXPECT_TRUE(response_ctx_->parse_status_);
+  ASSERT_EQ(1, response_ctx_->answers_.size());
+  Utils::verifyAddress({"130.207.244.252"}, response_ctx_->answers_.begin()->second);
+  EXPECT_EQ(std::chrono::seconds(8), response_ctx_->answers_.begin()->second->ttl_);
+  EXPECT_EQ(3, cache_stats.hits_.value());
+}
+
 TEST_F(DnsFilterTest, ConsumeExternalJsonTableTest) {
   InSequence s;
 
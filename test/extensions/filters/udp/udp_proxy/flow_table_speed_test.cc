@@ -0,0 +1,90 @@
+// Measures the flows per second created and expired by a single core in the flow table of the UDP
+// proxy, with the memory of the table per flow, and the cost of the upstream socket per flow that
+// the reuse of the sockets of the expired flows avoids.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/fmt.h"
+#include "source/common/network/socket_impl.h"
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/udp/udp_proxy/flow_table.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+// The idle timeout of the flows, in ticks of the expiry timer.
+constexpr uint32_t IdleTimeoutTicks = 8;
+
+FlowKey flowKey(uint32_t i) {
+  const auto local_address = Network::Utility::parseInternetAddressAndPort("10.0.0.1:53");
+  const auto peer_address = Network::Utility::parseInternetAddressAndPort(
+      fmt::format("10.{}.{}.{}:{}", (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff,
+                  1024 + (i >> 24)));
+  return {*local_address, *peer_address};
+}
+
+// Short lived flows, such as DNS queries: each flow receives a datagram from downstream and one
+// from upstream, then expires. Argument: the number of flows created per tick.
+void bmFlowTableChurn(benchmark::State& state) {
+  const uint32_t flows_per_tick = state.range(0);
+  // The keys of the flows are built beforehand, as they would be by the listener.
+  std::vector<FlowKey> keys;
+  for (uint32_t i = 0; i < flows_per_tick * (IdleTimeoutTicks + 2); i++) {
+    keys.push_back(flowKey(i));
+  }
+
+  FlowTable<uint64_t> table(IdleTimeoutTicks);
+  uint64_t flows = 0;
+  size_t max_flows = 0;
+  size_t max_memory = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    for (uint32_t i = 0; i < flows_per_tick; i++) {
+      const FlowKey& key = keys[flows++ % keys.size()];
+      if (table.find(key) == nullptr) {
+        table.insert(key, flows);
+      }
+      benchmark::DoNotOptimize(table.find(key));
+    }
+    max_flows = std::max(max_flows, table.size());
+    max_memory = std::max(max_memory, table.memoryUsage());
+    table.advance([](const FlowKey&, uint64_t& value) { benchmark::DoNotOptimize(value); });
+  }
+  state.SetItemsProcessed(flows);
+  state.counters["flows"] = max_flows;
+  state.counters["bytes_per_flow"] = max_flows > 0 ? max_memory / max_flows : 0;
+}
+BENCHMARK(bmFlowTableChurn)->Arg(1 << 10)->Arg(1 << 17)->Unit(benchmark::kMillisecond);
+
+// The upstream socket of a new flow, created and connected on the loopback, then closed when the
+// flow expires. The sockets of the expired flows are reused by the flow table instead.
+void bmUpstreamSocketPerFlow(benchmark::State& state) {
+  const auto address = Network::Utility::parseInternetAddressAndPort("127.0.0.1:0");
+  Network::SocketImpl upstream(Network::Socket::Type::Datagram, address, nullptr,
+                               Network::SocketCreationOptions{});
+  RELEASE_ASSERT(upstream.ioHandle().bind(address).return_value_ == 0, "");
+  const auto upstream_address = upstream.ioHandle().localAddress();
+
+  uint64_t flows = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    Network::SocketImpl socket(Network::Socket::Type::Datagram, upstream_address, nullptr,
+                               Network::SocketCreationOptions{});
+    RELEASE_ASSERT(socket.ioHandle().connect(upstream_address).return_value_ == 0, "");
+    flows++;
+  }
+  state.SetItemsProcessed(flows);
+}
+BENCHMARK(bmUpstreamSocketPerFlow)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,103 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/udp/udp_proxy/flow_table.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+FlowKey flowKey(const std::string& peer_address, const std::string& local_address = "10.0.0.2:80") {
+  return {*Network::Utility::parseInternetAddressAndPort(local_address),
+          *Network::Utility::parseInternetAddressAndPort(peer_address)};
+}
+
+FlowKey flowKey(uint32_t i) {
+  return flowKey(fmt::format("10.{}.{}.{}:{}", (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff,
+                             1000 + (i >> 24)));
+}
+
+TEST(FlowKeyTest, Equality) {
+  EXPECT_EQ(flowKey("10.0.0.1:1000"), flowKey("10.0.0.1:1000"));
+  EXPECT_FALSE(flowKey("10.0.0.1:1000") == flowKey("10.0.0.1:1001"));
+  EXPECT_FALSE(flowKey("10.0.0.1:1000") == flowKey("10.0.0.3:1000"));
+  EXPECT_FALSE(flowKey("10.0.0.1:1000") == flowKey("10.0.0.1:1000", "10.0.0.2:81"));
+  EXPECT_FALSE(flowKey("[::1]:1000", "[::2]:80") == flowKey("[::1]:1000", "[::3]:80"));
+  EXPECT_EQ(flowKey("[::ffff:10.0.0.1]:1000", "[::ffff:10.0.0.2]:80"), flowKey("10.0.0.1:1000"));
+}
+
+TEST(FlowTableTest, InsertFindErase) {
+  FlowTable<std::unique_ptr<uint32_t>> table(8);
+
+  // The table grows while the flows are inserted, and the flows are shifted back when removed.
+  for (uint32_t i = 0; i < 1000; i++) {
+    table.insert(flowKey(i), std::make_unique<uint32_t>(i));
+  }
+  EXPECT_EQ(1000, table.size());
+  for (uint32_t i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(table.erase(flowKey(i)));
+  }
+  EXPECT_FALSE(table.erase(flowKey(0)));
+  EXPECT_EQ(500, table.size());
+  for (uint32_t i = 0; i < 1000; i++) {
+    std::unique_ptr<uint32_t>* value = table.find(flowKey(i));
+    if (i % 2 == 0) {
+      EXPECT_EQ(nullptr, value);
+    } else {
+      ASSERT_NE(nullptr, value);
+      EXPECT_EQ(i, **value);
+    }
+  }
+  EXPECT_LT(0, table.memoryUsage());
+
+  table.eraseIf([](const FlowKey&, std::unique_ptr<uint32_t>& value) { return *value < 500; });
+  EXPECT_EQ(250, table.size());
+  EXPECT_EQ(nullptr, table.find(flowKey(499)));
+  EXPECT_NE(nullptr, table.find(flowKey(501)));
+}
+
+TEST(FlowTableTest, Expiry) {
+  FlowTable<std::unique_ptr<uint32_t>> table(2);
+  std::vector<uint32_t> expired;
+  auto advance = [&table, &expired]() {
+    table.advance([&expired](const FlowKey&, std::unique_ptr<uint32_t>& value) {
+      expired.push_back(*value);
+    });
+  };
+
+  table.insert(flowKey(1), std::make_unique<uint32_t>(1));
+  table.insert(flowKey(2), std::make_unique<uint32_t>(2));
+  advance();
+  advance();
+  // The flow active at the second tick expires two ticks later.
+  EXPECT_NE(nullptr, table.find(flowKey(2)));
+  advance();
+  EXPECT_EQ(std::vector<uint32_t>({1}), expired);
+  advance();
+  EXPECT_EQ(std::vector<uint32_t>({1}), expired);
+  advance();
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), expired);
+  EXPECT_EQ(0, table.size());
+
+  // A flow removed and inserted again is only scheduled once.
+  table.insert(flowKey(3), std::make_unique<uint32_t>(3));
+  table.erase(flowKey(3));
+  advance();
+  table.insert(flowKey(3), std::make_unique<uint32_t>(4));
+  for (int i = 0; i < 3; i++) {
+    advance();
+  }
+  EXPECT_EQ(std::vector<uint32_t>({1, 2, 4}), expired);
+}
+
+} // namespace
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
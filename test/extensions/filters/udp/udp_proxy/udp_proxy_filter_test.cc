@@ -143,7 +143,10 @@ public:
 
     void recvDataFromUpstream(const std::string& data, int recv_sys_errno = 0,
                               int send_sys_errno = 0) {
-      EXPECT_CALL(*idle_timer_, enableTimer(parent_.config_->sessionTimeout(), nullptr));
+      // The flows of the flow table have no idle timer.
+      if (idle_timer_ != nullptr) {
+        EXPECT_CALL(*idle_timer_, enableTimer(parent_.config_->sessionTimeout(), nullptr));
+      }
 
       if (parent_.expect_gro_) {
         EXPECT_CALL(*socket_->io_handle_, supportsUdpGro());
@@ -516,6 +519,108 @@ upstream_socket_config:
 }
 
 // Route with source IP.
+// The GRO socket option is set on the upstream sockets when GRO is preferred.
+TEST_F(UdpProxyFilterTest, UpstreamGroSocketOption) {
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+  )EOF"));
+
+  expectSessionCreate(upstream_address_);
+  test_sessions_[0].expectSetIpTransparentSocketOption();
+  test_sessions_[0].expectWriteToUpstream("hello", 0, nullptr, true);
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+
+  if (ENVOY_SOCKET_UDP_GRO.hasValue()) {
+    EXPECT_EQ(1, test_sessions_[0].sock_opts_[ENVOY_SOCKET_UDP_GRO.level()]
+                                             [ENVOY_SOCKET_UDP_GRO.option()]);
+  }
+}
+
+// The datagrams written upstream in an event loop iteration are sent in GSO batches of datagrams
+// of the same size.
+TEST_F(UdpProxyFilterTest, UpstreamGsoBatches) {
+  EXPECT_CALL(os_sys_calls_, supportsUdpGso()).WillRepeatedly(Return(true));
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+upstream_socket_config:
+  prefer_gso: true
+  )EOF"));
+
+  expectSessionCreate(upstream_address_);
+  TestSession& session = test_sessions_[0];
+  session.expectSetIpTransparentSocketOption();
+  auto* flush_cb = new Event::MockSchedulableCallback(&callbacks_.udp_listener_.dispatcher_);
+  EXPECT_CALL(*session.idle_timer_, enableTimer(_, _)).Times(4);
+  EXPECT_CALL(*session.socket_->io_handle_, connect(_))
+      .WillOnce(Return(Api::SysCallIntResult{0, 0}));
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration()).Times(1);
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "world");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "abc");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello2");
+
+  std::vector<std::string> sent;
+  EXPECT_CALL(*session.socket_->io_handle_, sendmsg(_, _, 0, _, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&sent](const Buffer::RawSlice* slices, uint64_t num_slices, int,
+                                     const Network::Address::Ip*,
+                                     const Network::Address::Instance&) {
+        std::string data;
+        for (uint64_t i = 0; i < num_slices; i++) {
+          data.append(static_cast<const char*>(slices[i].mem_), slices[i].len_);
+        }
+        sent.push_back(data);
+        return makeNoError(data.size());
+      }));
+  flush_cb->invokeCallback();
+
+  // The single datagrams larger than the segment size require a larger segment size.
+  EXPECT_EQ(std::vector<std::string>({"helloworld", "abc", "hello2"}), sent);
+  EXPECT_EQ(6, session.sock_opts_[ENVOY_SOCKET_UDP_SEGMENT.level()]
+                                 [ENVOY_SOCKET_UDP_SEGMENT.option()]);
+  EXPECT_EQ(4, TestUtility::findCounter(factory_context_.server_factory_context_.cluster_manager_
+                                            .thread_local_cluster_.cluster_.info_->stats_store_,
+                                        "udp.sess_tx_datagrams")
+                   ->value());
+  EXPECT_EQ(1, TestUtility::findCounter(factory_context_.server_factory_context_.cluster_manager_
+                                            .thread_local_cluster_.cluster_.info_->stats_store_,
+                                        "udp.sess_tx_gso_batches")
+                   ->value());
+}
+
+// GSO is rejected when the platform does not support it.
+TEST_F(UdpProxyFilterTest, UpstreamGsoNotSupported) {
+  EXPECT_CALL(os_sys_calls_, supportsUdpGso()).WillRepeatedly(Return(false));
+  EXPECT_THROW_WITH_MESSAGE(setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+upstream_socket_config:
+  prefer_gso: true
+  )EOF")),
+                            EnvoyException,
+                            "prefer_gso is set but GSO is not supported by the platform.");
+}
+
 TEST_F(UdpProxyFilterTest, Router) {
   InSequence s;
 
@@ -600,6 +705,138 @@ matcher:
   EXPECT_EQ(output_.front(), "2 1");
 }
 
+// Verify the forwarding and the expiry of the flows of the flow table, and the reuse of the
+// upstream sockets of the expired flows.
+TEST_F(UdpProxyFilterTest, FlowTable) {
+  auto* expiry_timer = new Event::MockTimer(&callbacks_.udp_listener_.dispatcher_);
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+idle_timeout: 8s
+upstream_socket_config:
+  prefer_gro: false
+flow_table: {}
+  )EOF"),
+        true, false);
+  ON_CALL(callbacks_.udp_listener_, flush())
+      .WillByDefault(InvokeWithoutArgs([]() -> Api::IoCallUint64Result { return makeNoError(0); }));
+  InSequence s;
+
+  auto expect_send = [this](TestSession& session, const std::string& data) {
+    EXPECT_CALL(*session.socket_->io_handle_, sendmsg(_, 1, 0, nullptr, _))
+        .WillOnce(Invoke([data](const Buffer::RawSlice* slices, uint64_t, int,
+                                const Network::Address::Ip*,
+                                const Network::Address::Instance&) -> Api::IoCallUint64Result {
+          EXPECT_EQ(data, absl::string_view(static_cast<const char*>(slices[0].mem_),
+                                            slices[0].len_));
+          return makeNoError(data.size());
+        }));
+  };
+
+  // The socket of the first flow is created and connected right away.
+  test_sessions_.emplace_back(*this, upstream_address_);
+  TestSession& session = test_sessions_.back();
+  EXPECT_CALL(*filter_, createUdpSocket(_))
+      .WillOnce(Return(ByMove(Network::SocketPtr{session.socket_})));
+  EXPECT_CALL(*session.socket_->io_handle_, connect(_))
+      .WillOnce(Return(Api::SysCallIntResult{0, 0}));
+  EXPECT_CALL(*session.socket_->io_handle_,
+              createFileEvent_(_, _, Event::PlatformDefaultTriggerType, Event::FileReadyType::Read))
+      .WillOnce(SaveArg<1>(&session.file_event_cb_));
+  EXPECT_CALL(*expiry_timer, enableTimer(std::chrono::milliseconds(1000), nullptr));
+  expect_send(session, "hello");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  EXPECT_EQ(1, config_->stats().downstream_sess_total_.value());
+  EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
+
+  session.recvDataFromUpstream("world");
+  expect_send(session, "hello2");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello2");
+  checkTransferStats(11 /*rx_bytes*/, 2 /*rx_datagrams*/, 5 /*tx_bytes*/, 1 /*tx_datagrams*/);
+
+  // The flow expires on the first tick after the idle timeout.
+  EXPECT_CALL(*expiry_timer, enableTimer(std::chrono::milliseconds(1000), nullptr)).Times(8);
+  for (int i = 0; i < 9; i++) {
+    expiry_timer->invokeCallback();
+  }
+  EXPECT_EQ(1, config_->stats().idle_timeout_.value());
+  EXPECT_EQ(0, config_->stats().downstream_sess_active_.value());
+
+  // The socket of the expired flow is reused by the next flow to the host.
+  EXPECT_CALL(*expiry_timer, enableTimer(std::chrono::milliseconds(1000), nullptr));
+  expect_send(session, "hello3");
+  recvDataFromDownstream("10.0.0.3:1000", "10.0.0.2:80", "hello3");
+  EXPECT_EQ(2, config_->stats().downstream_sess_total_.value());
+  EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
+  EXPECT_EQ(1, TestUtility::findCounter(
+                   factory_context_.server_factory_context_.cluster_manager_.thread_local_cluster_
+                       .cluster_.info_->stats_store_,
+                   "udp.sess_socket_reused")
+                   ->value());
+
+  filter_.reset();
+  EXPECT_EQ(0, config_->stats().downstream_sess_active_.value());
+}
+
+TEST_F(UdpProxyFilterTest, FlowTableFull) {
+  InSequence s;
+
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+flow_table:
+  max_flows: 1
+  )EOF"));
+
+  test_sessions_.emplace_back(*this, upstream_address_);
+  TestSession& session = test_sessions_.back();
+  EXPECT_CALL(*filter_, createUdpSocket(_))
+      .WillOnce(Return(ByMove(Network::SocketPtr{session.socket_})));
+  EXPECT_CALL(*session.socket_->io_handle_, sendmsg(_, 1, 0, nullptr, _))
+      .WillOnce(Return(ByMove(makeNoError(5))));
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+
+  // The datagrams of the new flows are dropped.
+  recvDataFromDownstream("10.0.0.3:1000", "10.0.0.2:80", "hello");
+  EXPECT_EQ(1, config_->stats().downstream_sess_total_.value());
+  EXPECT_EQ(1, config_->stats().downstream_sess_flow_table_full_.value());
+}
+
+TEST_F(UdpProxyFilterTest, FlowTableExcludesSessionFeatures) {
+  auto config = R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+session_filters:
+- name: foo
+  typed_config:
+    '@type': type.googleapis.com/google.protobuf.Struct
+flow_table: {}
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(setup(readConfig(config)), EnvoyException,
+                            "The flow_table can't be used with use_original_src_ip, "
+                            "use_per_packet_load_balancing, access_log, session_filters or "
+                            "tunneling_config.");
+}
+
 // Verify downstream send and receive error handling.
 TEST_F(UdpProxyFilterTest, SendReceiveErrorHandling) {
   InSequence s;
@@ -0,0 +1,169 @@
+// Measures the packets per second forwarded on the loopback by a single core through the upstream
+// sockets of the UDP proxy, with and without GSO batching of the writes and GRO reads, for
+// DNS-like datagrams of varying sizes and game-like datagrams of a constant size.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/utility.h"
+#include "source/common/network/socket_impl.h"
+#include "source/common/network/socket_option_factory.h"
+#include "source/common/network/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+// The datagrams written upstream in an event loop iteration.
+constexpr uint32_t DatagramsPerBurst = 64;
+
+enum class Workload { Dns, Game };
+
+// DNS queries and responses of varying sizes, or game state updates of a constant size.
+std::vector<std::string> makeBurst(Workload workload) {
+  std::vector<std::string> burst;
+  for (uint32_t i = 0; i < DatagramsPerBurst; i++) {
+    const size_t size = workload == Workload::Dns ? 40 + (i * 97) % 472 : 120;
+    burst.emplace_back(size, 'a' + i % 26);
+  }
+  return burst;
+}
+
+class CountingProcessor : public Network::UdpPacketProcessor {
+public:
+  // Network::UdpPacketProcessor
+  void processPacket(Network::Address::InstanceConstSharedPtr,
+                     Network::Address::InstanceConstSharedPtr, Buffer::InstancePtr buffer,
+                     MonotonicTime) override {
+    received_++;
+    benchmark::DoNotOptimize(buffer->length());
+  }
+  void onDatagramsDropped(uint32_t) override {}
+  uint64_t maxDatagramSize() const override { return Network::DEFAULT_UDP_MAX_DATAGRAM_SIZE; }
+  size_t numPacketsExpectedPerEventLoop() const override {
+    return Network::MAX_NUM_PACKETS_PER_EVENT_LOOP;
+  }
+
+  uint64_t received_{};
+};
+
+// An upstream socket connected to an upstream host socket on the loopback.
+class LoopbackSockets {
+public:
+  LoopbackSockets(bool gro) {
+    auto address = Network::Utility::parseInternetAddressAndPort("127.0.0.1:0");
+    upstream_ = std::make_unique<Network::SocketImpl>(Network::Socket::Type::Datagram, address,
+                                                      nullptr, Network::SocketCreationOptions{});
+    RELEASE_ASSERT(upstream_->ioHandle().bind(address).return_value_ == 0, "");
+    const int buffer_size = 16 * 1024 * 1024;
+    upstream_->ioHandle().setOption(SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    if (gro) {
+      Network::Socket::applyOptions(Network::SocketOptionFactory::buildUdpGroOptions(), *upstream_,
+                                    envoy::config::core::v3::SocketOption::STATE_BOUND);
+    }
+    upstream_address_ = upstream_->ioHandle().localAddress();
+
+    session_ = std::make_unique<Network::SocketImpl>(Network::Socket::Type::Datagram,
+                                                     upstream_address_, nullptr,
+                                                     Network::SocketCreationOptions{});
+    RELEASE_ASSERT(session_->ioHandle().connect(upstream_address_).return_value_ == 0, "");
+  }
+
+  void send(const std::string& datagram) {
+    Buffer::OwnedImpl buffer(datagram);
+    Network::Utility::writeToSocket(session_->ioHandle(), buffer, nullptr, *upstream_address_);
+  }
+
+  // Sends the consecutive datagrams of the same size with a single GSO write, as the UDP proxy
+  // sessions do.
+  void sendWithGso(const std::vector<std::string>& burst) {
+    size_t next = 0;
+    while (next < burst.size()) {
+      const size_t size = burst[next].size();
+      Buffer::OwnedImpl batch;
+      size_t end = next;
+      while (end < burst.size() && burst[end].size() == size) {
+        batch.add(burst[end++]);
+      }
+      if (end - next > 1 || size > segment_size_) {
+        setSegmentSize(size);
+      }
+      Network::Utility::writeToSocket(session_->ioHandle(), batch, nullptr, *upstream_address_);
+      next = end;
+    }
+  }
+
+  uint64_t receive(bool gro) {
+    uint32_t packets_dropped = 0;
+    processor_.received_ = 0;
+    while (Network::Utility::readPacketsFromSocket(upstream_->ioHandle(), *upstream_address_,
+                                                   processor_, time_source_, gro,
+                                                   packets_dropped) == nullptr) {
+    }
+    return processor_.received_;
+  }
+
+private:
+  void setSegmentSize(size_t size) {
+    if (size != segment_size_) {
+      const int value = size;
+      session_->ioHandle().setOption(ENVOY_SOCKET_UDP_SEGMENT.level(),
+                                     ENVOY_SOCKET_UDP_SEGMENT.option(), &value, sizeof(value));
+      segment_size_ = size;
+    }
+  }
+
+  Network::SocketPtr upstream_;
+  Network::SocketPtr session_;
+  Network::Address::InstanceConstSharedPtr upstream_address_;
+  size_t segment_size_{};
+  CountingProcessor processor_;
+  RealTimeSource time_source_;
+};
+
+// Sends the bursts of datagrams upstream, then reads them. Arguments: workload (0: DNS, 1: game),
+// GSO writes, GRO reads.
+void bmUpstreamForwarding(benchmark::State& state) {
+  const Workload workload = state.range(0) == 0 ? Workload::Dns : Workload::Game;
+  const bool gso = state.range(1) != 0;
+  const bool gro = state.range(2) != 0;
+  if ((gso && !Api::OsSysCallsSingleton::get().supportsUdpGso()) ||
+      (gro && !Api::OsSysCallsSingleton::get().supportsUdpGro())) {
+    state.SkipWithError("GSO or GRO not supported");
+    return;
+  }
+
+  const std::vector<std::string> burst = makeBurst(workload);
+  LoopbackSockets sockets(gro);
+  uint64_t received = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    if (gso) {
+      sockets.sendWithGso(burst);
+    } else {
+      for (const std::string& datagram : burst) {
+        sockets.send(datagram);
+      }
+    }
+    received += sockets.receive(gro);
+  }
+  // Packets per second on a single core.
+  state.SetItemsProcessed(received);
+}
+BENCHMARK(bmUpstreamForwarding)
+    ->ArgsProduct({{0, 1}, {0, 1}, {0, 1}})
+    ->ArgNames({"game", "gso", "gro"})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
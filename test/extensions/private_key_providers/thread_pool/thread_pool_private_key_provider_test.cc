@@ -0,0 +1,289 @@
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+
+#include "source/extensions/private_key_providers/thread_pool/config.h"
+#include "source/extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/server/transport_socket_factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+class TestCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override { completions_++; }
+
+  uint32_t completions_{};
+};
+
+class ThreadPoolPrivateKeyProviderTest : public testing::Test {
+protected:
+  ThreadPoolPrivateKeyProviderTest() {
+    ON_CALL(factory_context_.server_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_, statsScope()).WillByDefault(ReturnRef(*stats_.rootScope()));
+  }
+
+  ~ThreadPoolPrivateKeyProviderTest() override {
+    for (auto& ssl : ssls_) {
+      provider_->unregisterPrivateKeyMethod(ssl.get());
+    }
+  }
+
+  void createProvider(const std::string& key_file, uint32_t max_batch_size = 16) {
+    const std::string yaml = fmt::format(R"EOF(
+provider_name: envoy.tls.key_providers.thread_pool
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+  private_key:
+    filename: "{{{{ test_rundir }}}}/test/extensions/transport_sockets/tls/test_data/{}"
+  threads: 2
+  max_batch_size: {}
+)EOF",
+                                         key_file, max_batch_size);
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider config;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(yaml), config);
+    provider_ = factory_.createPrivateKeyMethodProviderInstance(config, factory_context_);
+    method_ = provider_->getBoringSslPrivateKeyMethod();
+
+    const std::string key = TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/" + key_file));
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(key.data(), key.size()));
+    pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+    ASSERT_NE(nullptr, pkey_);
+  }
+
+  SSL* newSsl(TestCallbacks& callbacks) {
+    ssls_.emplace_back(SSL_new(ssl_ctx_.get()));
+    provider_->registerPrivateKeyMethod(ssls_.back().get(), callbacks, *dispatcher_);
+    return ssls_.back().get();
+  }
+
+  void runUntilCompleted(const std::vector<TestCallbacks*>& callbacks) {
+    auto completed = [&callbacks]() {
+      for (const TestCallbacks* cb : callbacks) {
+        if (cb->completions_ == 0) {
+          return false;
+        }
+      }
+      return true;
+    };
+    while (!completed()) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  bool verify(uint16_t signature_algorithm, const std::string& message,
+              const std::vector<uint8_t>& signature) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    if (!EVP_DigestVerifyInit(ctx.get(), &pctx,
+                              SSL_get_signature_algorithm_digest(signature_algorithm), nullptr,
+                              pkey_.get())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), signature.data(), signature.size(),
+                            reinterpret_cast<const uint8_t*>(message.data()), message.size());
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_.counter("thread_pool_private_key." + name).value();
+  }
+
+  Api::ApiPtr api_{Api::createApiForTest()};
+  Event::DispatcherPtr dispatcher_{api_->allocateDispatcher("test_thread")};
+  Stats::TestUtil::TestStore stats_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  ThreadPoolPrivateKeyMethodFactory factory_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_{SSL_CTX_new(TLS_method())};
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  // Declared after the dispatcher, so that the threads are joined first.
+  Ssl::PrivateKeyMethodProviderSharedPtr provider_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  std::vector<bssl::UniquePtr<SSL>> ssls_;
+};
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, SignRsaPss) {
+  createProvider("unittest_key.pem");
+  TestCallbacks callbacks;
+  SSL* ssl = newSsl(callbacks);
+  const std::string message = "handshake transcript";
+
+  std::vector<uint8_t> signature(512);
+  size_t signature_len;
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl, signature.data(), &signature_len, signature.size(),
+                          SSL_SIGN_RSA_PSS_RSAE_SHA256,
+                          reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+  runUntilCompleted({&callbacks});
+  EXPECT_EQ(1, callbacks.completions_);
+
+  EXPECT_EQ(ssl_private_key_success,
+            method_->complete(ssl, signature.data(), &signature_len, signature.size()));
+  signature.resize(signature_len);
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PSS_RSAE_SHA256, message, signature));
+  EXPECT_EQ(1, counter("sign"));
+  EXPECT_EQ(0, counter("failure"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, SignEcdsa) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  EXPECT_TRUE(provider_->isAvailable());
+  TestCallbacks callbacks;
+  SSL* ssl = newSsl(callbacks);
+  const std::string message = "handshake transcript";
+
+  std::vector<uint8_t> signature(512);
+  size_t signature_len;
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl, signature.data(), &signature_len, signature.size(),
+                          SSL_SIGN_ECDSA_SECP256R1_SHA256,
+                          reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->complete(ssl, signature.data(), &signature_len, signature.size()));
+  runUntilCompleted({&callbacks});
+  EXPECT_EQ(ssl_private_key_success,
+            method_->complete(ssl, signature.data(), &signature_len, signature.size()));
+  signature.resize(signature_len);
+  EXPECT_TRUE(verify(SSL_SIGN_ECDSA_SECP256R1_SHA256, message, signature));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, DecryptRsa) {
+  createProvider("unittest_key.pem");
+  TestCallbacks callbacks;
+  SSL* ssl = newSsl(callbacks);
+
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+  std::vector<uint8_t> plaintext(RSA_size(rsa), 'a');
+  // Keep the raw block below the modulus.
+  plaintext[0] = 0;
+  std::vector<uint8_t> ciphertext(RSA_size(rsa));
+  size_t ciphertext_len;
+  ASSERT_TRUE(RSA_encrypt(rsa, &ciphertext_len, ciphertext.data(), ciphertext.size(),
+                          plaintext.data(), plaintext.size(), RSA_NO_PADDING));
+
+  std::vector<uint8_t> out(RSA_size(rsa));
+  size_t out_len;
+  EXPECT_EQ(ssl_private_key_retry, method_->decrypt(ssl, out.data(), &out_len, out.size(),
+                                                    ciphertext.data(), ciphertext_len));
+  runUntilCompleted({&callbacks});
+  EXPECT_EQ(ssl_private_key_success, method_->complete(ssl, out.data(), &out_len, out.size()));
+  out.resize(out_len);
+  EXPECT_EQ(plaintext, out);
+  EXPECT_EQ(1, counter("decrypt"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, MismatchedSignatureAlgorithm) {
+  createProvider("unittest_key.pem");
+  TestCallbacks callbacks;
+  SSL* ssl = newSsl(callbacks);
+  const std::string message = "handshake transcript";
+
+  std::vector<uint8_t> signature(512);
+  size_t signature_len;
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl, signature.data(), &signature_len, signature.size(),
+                          SSL_SIGN_ECDSA_SECP256R1_SHA256,
+                          reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+  runUntilCompleted({&callbacks});
+  EXPECT_EQ(ssl_private_key_failure,
+            method_->complete(ssl, signature.data(), &signature_len, signature.size()));
+  EXPECT_EQ(1, counter("failure"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, CompletionsAreBatched) {
+  createProvider("selfsigned_ecdsa_p256_key.pem", 8);
+  const std::string message = "handshake transcript";
+  std::vector<TestCallbacks> callbacks(32);
+  std::vector<TestCallbacks*> callback_ptrs;
+  std::vector<SSL*> ssls;
+  for (TestCallbacks& cb : callbacks) {
+    callback_ptrs.push_back(&cb);
+    ssls.push_back(newSsl(cb));
+  }
+  std::vector<uint8_t> signature(512);
+  size_t signature_len;
+  for (SSL* ssl : ssls) {
+    EXPECT_EQ(ssl_private_key_retry,
+              method_->sign(ssl, signature.data(), &signature_len, signature.size(),
+                            SSL_SIGN_ECDSA_SECP256R1_SHA256,
+                            reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+  }
+  runUntilCompleted(callback_ptrs);
+  for (SSL* ssl : ssls) {
+    EXPECT_EQ(ssl_private_key_success,
+              method_->complete(ssl, signature.data(), &signature_len, signature.size()));
+  }
+  EXPECT_EQ(32, counter("sign"));
+  EXPECT_GE(counter("batches"), 4);
+  EXPECT_LE(counter("batches"), 32);
+  EXPECT_EQ(0, stats_.gauge("thread_pool_private_key.queued", Stats::Gauge::ImportMode::NeverImport)
+                   .value());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, ConnectionClosedDuringOperation) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  TestCallbacks callbacks;
+  TestCallbacks other_callbacks;
+  SSL* ssl = newSsl(callbacks);
+  SSL* other_ssl = newSsl(other_callbacks);
+  const std::string message = "handshake transcript";
+
+  std::vector<uint8_t> signature(512);
+  size_t signature_len;
+  for (SSL* s : {ssl, other_ssl}) {
+    EXPECT_EQ(ssl_private_key_retry,
+              method_->sign(s, signature.data(), &signature_len, signature.size(),
+                            SSL_SIGN_ECDSA_SECP256R1_SHA256,
+                            reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+  }
+  provider_->unregisterPrivateKeyMethod(ssl);
+  runUntilCompleted({&other_callbacks});
+  // Give a completion of the closed connection a chance to run.
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0, callbacks.completions_);
+  EXPECT_EQ(ssl_private_key_failure,
+            method_->complete(ssl, signature.data(), &signature_len, signature.size()));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RegisterTwice) {
+  createProvider("unittest_key.pem");
+  TestCallbacks callbacks;
+  SSL* ssl = newSsl(callbacks);
+  EXPECT_THROW_WITH_MESSAGE(
+      provider_->registerPrivateKeyMethod(ssl, callbacks, *dispatcher_), EnvoyException,
+      "Not registering the thread pool provider twice for the same context");
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, InvalidKey) {
+  EXPECT_THROW_WITH_MESSAGE(createProvider("unittest_cert.pem"), EnvoyException,
+                            "Failed to read private key.");
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
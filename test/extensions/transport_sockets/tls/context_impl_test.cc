@@ -1912,6 +1912,23 @@ TEST_F(ServerContextConfigImplTest, TlsCertificateNonEmpty) {
       EnvoyException, "Server TlsCertificates must have a certificate specified");
 }
 
+// Session secrets are only persisted unencrypted if explicitly allowed.
+TEST_F(ServerContextConfigImplTest, SessionCacheKeyValueStoreRequiresOptIn) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  envoy::extensions::transport_sockets::tls::v3::TlsCertificate* server_cert =
+      tls_context.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"));
+  server_cert->mutable_private_key()->set_filename(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"));
+  tls_context.mutable_session_cache()->mutable_key_value_config();
+
+  EXPECT_THROW_WITH_MESSAGE(
+      ServerContextConfigImpl server_context_config(tls_context, factory_context_), EnvoyException,
+      "The TLS session cache key value store requires allow_unencrypted_key_value_store, as "
+      "session secrets are stored unencrypted");
+}
+
 // Cannot ignore certificate expiration without a trusted CA.
 TEST_F(ServerContextConfigImplTest, InvalidIgnoreCertsNoCA) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
@@ -0,0 +1,205 @@
+#include "source/extensions/transport_sockets/tls/session_resumption.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/server/server_factory_context.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+class SessionResumptionManagerPeer {
+public:
+  static size_t numSessionCaches(SessionResumptionManager& manager) {
+    absl::MutexLock lock(&manager.mu_);
+    return manager.session_caches_.size();
+  }
+  static size_t numSessionTicketKeyProviders(SessionResumptionManager& manager) {
+    absl::MutexLock lock(&manager.mu_);
+    return manager.ticket_key_providers_.size();
+  }
+};
+
+namespace {
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Optional;
+
+class ShardedSessionCacheTest : public testing::Test {
+protected:
+  std::unique_ptr<ShardedSessionCache> makeCache(uint32_t max_entries, uint32_t num_shards,
+                                                 KeyValueStorePtr&& store = nullptr) {
+    return std::make_unique<ShardedSessionCache>(max_entries, num_shards, time_system_, dispatcher_,
+                                                 std::move(store));
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+};
+
+TEST_F(ShardedSessionCacheTest, InsertLookupRemove) {
+  auto cache = makeCache(100, 4);
+  EXPECT_EQ(absl::nullopt, cache->lookup("id1"));
+  cache->insert("id1", "session1", std::chrono::seconds(60));
+  cache->insert("id2", "session2", std::chrono::seconds(60));
+  EXPECT_THAT(cache->lookup("id1"), Optional(std::string("session1")));
+  EXPECT_THAT(cache->lookup("id2"), Optional(std::string("session2")));
+
+  cache->insert("id1", "session1b", std::chrono::seconds(60));
+  EXPECT_THAT(cache->lookup("id1"), Optional(std::string("session1b")));
+
+  cache->remove("id1");
+  EXPECT_EQ(absl::nullopt, cache->lookup("id1"));
+  EXPECT_THAT(cache->lookup("id2"), Optional(std::string("session2")));
+}
+
+TEST_F(ShardedSessionCacheTest, Expiry) {
+  auto cache = makeCache(100, 4);
+  cache->insert("id1", "session1", std::chrono::seconds(60));
+  cache->insert("id2", "session2", std::chrono::seconds(120));
+  time_system_.advanceTimeWait(std::chrono::seconds(60));
+  EXPECT_EQ(absl::nullopt, cache->lookup("id1"));
+  EXPECT_THAT(cache->lookup("id2"), Optional(std::string("session2")));
+}
+
+TEST_F(ShardedSessionCacheTest, EvictsOldest) {
+  auto cache = makeCache(2, 1);
+  cache->insert("id1", "session1", std::chrono::seconds(60));
+  cache->insert("id2", "session2", std::chrono::seconds(60));
+  // Replacing a session makes it the newest.
+  cache->insert("id1", "session1", std::chrono::seconds(60));
+  cache->insert("id3", "session3", std::chrono::seconds(60));
+  EXPECT_EQ(absl::nullopt, cache->lookup("id2"));
+  EXPECT_TRUE(cache->lookup("id1").has_value());
+  EXPECT_TRUE(cache->lookup("id3").has_value());
+}
+
+TEST_F(ShardedSessionCacheTest, KeyValueStore) {
+  const int64_t now =
+      std::chrono::duration_cast<std::chrono::seconds>(time_system_.systemTime().time_since_epoch())
+          .count();
+  auto store = std::make_unique<NiceMock<MockKeyValueStore>>();
+  auto* store_ptr = store.get();
+  EXPECT_CALL(*store, iterate(_)).WillOnce(Invoke([now](KeyValueStore::ConstIterateCb cb) {
+    // "id1", still valid.
+    cb("696431", absl::StrCat(now + 60, "\nsession1"));
+    // "id2", expired.
+    cb("696432", absl::StrCat(now - 1, "\nsession2"));
+    // Invalid entries are skipped.
+    cb("696433", "session3");
+  }));
+  auto cache = makeCache(100, 4, std::move(store));
+  EXPECT_THAT(cache->lookup("id1"), Optional(std::string("session1")));
+  EXPECT_EQ(absl::nullopt, cache->lookup("id2"));
+  EXPECT_EQ(absl::nullopt, cache->lookup("id3"));
+
+  // Updates are written through on the main thread.
+  EXPECT_CALL(*store_ptr, addOrUpdate("696434", absl::StrCat(now + 30, "\nsession4"),
+                                      Optional(std::chrono::seconds(30))));
+  cache->insert("id4", "session4", std::chrono::seconds(30));
+  EXPECT_CALL(*store_ptr, remove("696434"));
+  cache->remove("id4");
+  // Removing a missing session doesn't touch the store.
+  cache->remove("id4");
+}
+
+TEST(RotatingSessionTicketKeyProviderTest, Rotate) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  auto* timer = new NiceMock<Event::MockTimer>(&dispatcher);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(1000), _)).Times(3);
+  RotatingSessionTicketKeyProvider provider(std::chrono::milliseconds(1000), 2, dispatcher);
+
+  const Ssl::SessionTicketKeysConstSharedPtr first = provider.keys();
+  ASSERT_EQ(1, first->size());
+
+  timer->invokeCallback();
+  const Ssl::SessionTicketKeysConstSharedPtr second = provider.keys();
+  ASSERT_EQ(2, second->size());
+  EXPECT_NE((*second)[0].name_, (*first)[0].name_);
+  EXPECT_EQ((*second)[1].name_, (*first)[0].name_);
+  // Previously returned keys are unchanged.
+  EXPECT_EQ(1, first->size());
+
+  timer->invokeCallback();
+  const Ssl::SessionTicketKeysConstSharedPtr third = provider.keys();
+  ASSERT_EQ(2, third->size());
+  EXPECT_EQ((*third)[1].name_, (*second)[0].name_);
+}
+
+// The caches and key providers are shared by the contexts with an equal config, and removed with
+// the last context using them.
+TEST(SessionResumptionManagerTest, SharedUntilLastContext) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> server_context;
+  std::shared_ptr<SessionResumptionManager> manager = SessionResumptionManager::get(server_context);
+  EXPECT_EQ(manager, SessionResumptionManager::get(server_context));
+
+  envoy::extensions::transport_sockets::tls::v3::TlsSessionCache cache_config;
+  Ssl::SessionCacheSharedPtr cache1 = manager->getSessionCache(cache_config);
+  Ssl::SessionCacheSharedPtr cache2 = manager->getSessionCache(cache_config);
+  EXPECT_EQ(cache1, cache2);
+  cache_config.mutable_max_entries()->set_value(10);
+  Ssl::SessionCacheSharedPtr other_cache = manager->getSessionCache(cache_config);
+  EXPECT_NE(cache1, other_cache);
+  EXPECT_EQ(2, SessionResumptionManagerPeer::numSessionCaches(*manager));
+
+  cache1->insert("id", "session", std::chrono::seconds(60));
+  cache1.reset();
+  EXPECT_EQ(2, SessionResumptionManagerPeer::numSessionCaches(*manager));
+  cache2.reset();
+  EXPECT_EQ(1, SessionResumptionManagerPeer::numSessionCaches(*manager));
+  other_cache.reset();
+  EXPECT_EQ(0, SessionResumptionManagerPeer::numSessionCaches(*manager));
+
+  // A cache created after the last one was removed starts empty.
+  cache_config.clear_max_entries();
+  EXPECT_EQ(absl::nullopt, manager->getSessionCache(cache_config)->lookup("id"));
+
+  envoy::extensions::transport_sockets::tls::v3::TlsSessionTicketKeyRotation rotation_config;
+  Ssl::SessionTicketKeyProviderSharedPtr provider1 =
+      manager->getSessionTicketKeyProvider(rotation_config);
+  Ssl::SessionTicketKeyProviderSharedPtr provider2 =
+      manager->getSessionTicketKeyProvider(rotation_config);
+  EXPECT_EQ(provider1, provider2);
+  EXPECT_EQ(1, SessionResumptionManagerPeer::numSessionTicketKeyProviders(*manager));
+  provider1.reset();
+  provider2.reset();
+  EXPECT_EQ(0, SessionResumptionManagerPeer::numSessionTicketKeyProviders(*manager));
+}
+
+// The entries released on a worker are destroyed on the main thread, which owns their timers.
+TEST(SessionResumptionManagerTest, ReleasedOffMainThread) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> server_context;
+  std::shared_ptr<SessionResumptionManager> manager = SessionResumptionManager::get(server_context);
+  auto* timer = new NiceMock<Event::MockTimer>(&server_context.dispatcher_);
+  bool timer_destroyed = false;
+  timer->timer_destroyed_ = &timer_destroyed;
+
+  envoy::extensions::transport_sockets::tls::v3::TlsSessionTicketKeyRotation rotation_config;
+  Ssl::SessionTicketKeyProviderSharedPtr provider =
+      manager->getSessionTicketKeyProvider(rotation_config);
+
+  Event::PostCb posted;
+  EXPECT_CALL(server_context.dispatcher_, isThreadSafe()).WillOnce(testing::Return(false));
+  EXPECT_CALL(server_context.dispatcher_, post(_)).WillOnce(Invoke([&](Event::PostCb cb) {
+    posted = std::move(cb);
+  }));
+  provider.reset();
+  EXPECT_EQ(0, SessionResumptionManagerPeer::numSessionTicketKeyProviders(*manager));
+  EXPECT_FALSE(timer_destroyed);
+  posted();
+  EXPECT_TRUE(timer_destroyed);
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -1,6 +1,18 @@
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+
 #include "source/common/buffer/buffer_impl.h"
+#include "source/common/network/io_socket_handle_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+#include "source/extensions/transport_sockets/tls/kernel_tls.h"
 
+#include "test/mocks/server/transport_socket_factory_context.h"
 #include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
 
 #include "benchmark/benchmark.h"
 #include "openssl/ssl.h"
@@ -24,6 +36,7 @@ static void handleSslError(SSL* ssl, int err, bool is_server) {
   case SSL_ERROR_NONE:
   case SSL_ERROR_WANT_READ:
   case SSL_ERROR_WANT_WRITE:
+  case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
     return;
   default:
     drainErrorQueue();
@@ -192,5 +205,267 @@ static void testParams(benchmark::internal::Benchmark* b) {
 
 BENCHMARK(testThroughput)->Unit(::benchmark::kMicrosecond)->Apply(testParams);
 
+// Creates a connected pair of non-blocking TCP loopback sockets. Unlike Unix domain sockets, these
+// support kernel TLS.
+static void tcpLoopbackPair(int sockets[2]) {
+  const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_length = sizeof(address);
+  RELEASE_ASSERT(::bind(listener, reinterpret_cast<sockaddr*>(&address), address_length) == 0 &&
+                     ::listen(listener, 1) == 0 &&
+                     ::getsockname(listener, reinterpret_cast<sockaddr*>(&address),
+                                   &address_length) == 0,
+                 "listen");
+  sockets[1] = ::socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(::connect(sockets[1], reinterpret_cast<sockaddr*>(&address), address_length) == 0,
+                 "connect");
+  sockets[0] = ::accept(listener, nullptr, nullptr);
+  RELEASE_ASSERT(sockets[0] >= 0, "accept");
+  ::close(listener);
+  for (int i = 0; i < 2; i++) {
+    ::fcntl(sockets[i], F_SETFL, ::fcntl(sockets[i], F_GETFL) | O_NONBLOCK);
+  }
+}
+
+// Streams data from a client to a server over TCP loopback, with the record protection done by
+// BoringSSL, or by the kernel if range(0) is set. range(1) is the size of the application writes.
+static void testKernelTlsThroughput(benchmark::State& state) {
+  std::string error;
+  std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
+      bazel::tools::cpp::runfiles::Runfiles::Create("tls_throughput_benchmark", &error));
+  Envoy::TestEnvironment::setRunfiles(runfiles.get());
+
+  const bool kernel_tls = state.range(0);
+  const uint64_t write_size = state.range(1);
+
+  int sockets[2];
+  tcpLoopbackPair(sockets);
+  Network::IoSocketHandleImpl server_handle(sockets[0]);
+  Network::IoSocketHandleImpl client_handle(sockets[1]);
+
+  bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+  std::string cert_path = TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem");
+  std::string key_path = TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem");
+  auto err = SSL_CTX_use_certificate_file(server_ctx.get(), cert_path.c_str(), SSL_FILETYPE_PEM);
+  drainErrorQueue();
+  RELEASE_ASSERT(err > 0, "SSL_CTX_use_certificate_file");
+  err = SSL_CTX_use_PrivateKey_file(server_ctx.get(), key_path.c_str(), SSL_FILETYPE_PEM);
+  RELEASE_ASSERT(err > 0, "SSL_CTX_use_PrivateKey_file");
+  // Session tickets would be pending in the client when offloading.
+  SSL_CTX_set_options(server_ctx.get(), SSL_OP_NO_TICKET);
+
+  bssl::UniquePtr<SSL> server_ssl(SSL_new(server_ctx.get()));
+  SSL_set_fd(server_ssl.get(), sockets[0]);
+  SSL_set_accept_state(server_ssl.get());
+
+  bssl::UniquePtr<SSL> client_ssl(SSL_new(client_ctx.get()));
+  SSL_set_fd(client_ssl.get(), sockets[1]);
+  SSL_set_connect_state(client_ssl.get());
+
+  bool handshake_success = false;
+  for (int i = 0; i < 50; i++) {
+    int client_err = SSL_do_handshake(client_ssl.get());
+    int server_err = SSL_do_handshake(server_ssl.get());
+    if (client_err == 1 && server_err == 1) {
+      handshake_success = true;
+      break;
+    }
+    handleSslError(client_ssl.get(), client_err, false);
+    handleSslError(server_ssl.get(), server_err, true);
+  }
+  RELEASE_ASSERT(handshake_success, "handshake completed successfully");
+
+  Stats::IsolatedStoreImpl store;
+  SslStats stats = generateSslStats(*store.rootScope());
+  KernelTlsOffloadPtr server_offload;
+  KernelTlsOffloadPtr client_offload;
+  if (kernel_tls) {
+    server_offload = KernelTlsOffload::create(server_ssl.get(), server_handle, stats);
+    client_offload = KernelTlsOffload::create(client_ssl.get(), client_handle, stats);
+    if (server_offload == nullptr || client_offload == nullptr ||
+        !client_offload->writeOffloaded()) {
+      state.SkipWithError("kernel TLS is unavailable");
+      return;
+    }
+  }
+
+  static uint8_t read_buf[1024 * 1024];
+  const std::string data(write_size, 'a');
+  // Reads whatever is available on the server side.
+  auto read = [&]() -> uint64_t {
+    uint64_t bytes_read = 0;
+    while (true) {
+      if (server_offload != nullptr) {
+        Buffer::RawSlice slice{read_buf, sizeof(read_buf)};
+        uint8_t record_type;
+        Api::IoCallUint64Result result = server_offload->read(&slice, 1, record_type);
+        if (!result.ok() || result.return_value_ == 0) {
+          return bytes_read;
+        }
+        RELEASE_ASSERT(record_type == KernelTlsOffload::RecordTypeApplicationData, "record type");
+        bytes_read += result.return_value_;
+      } else {
+        const int rc = SSL_read(server_ssl.get(), read_buf, sizeof(read_buf));
+        if (rc <= 0) {
+          return bytes_read;
+        }
+        bytes_read += rc;
+      }
+    }
+  };
+
+  constexpr uint64_t BytesPerIteration = 16 * 1024 * 1024;
+  uint64_t bytes_transferred = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    uint64_t bytes_written = 0;
+    uint64_t bytes_read = 0;
+    while (bytes_read < BytesPerIteration) {
+      if (bytes_written < BytesPerIteration) {
+        const size_t len = std::min<uint64_t>(data.size(), BytesPerIteration - bytes_written);
+        if (client_offload != nullptr) {
+          const ssize_t rc = ::write(sockets[1], data.data(), len);
+          bytes_written += std::max<ssize_t>(rc, 0);
+        } else {
+          // BoringSSL seals at most 16kb per record.
+          const int rc = SSL_write(client_ssl.get(), data.data(), std::min<size_t>(len, 16384));
+          handleSslError(client_ssl.get(), rc, false);
+          bytes_written += std::max(rc, 0);
+        }
+      }
+      bytes_read += read();
+    }
+    bytes_transferred += bytes_read;
+  }
+  state.counters["throughput"] = benchmark::Counter(bytes_transferred, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(testKernelTlsThroughput)
+    ->Unit(::benchmark::kMillisecond)
+    ->ArgsProduct({{0, 1}, {16384, 262144}});
+
+class NoopPrivateKeyConnectionCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override {}
+};
+
+// Runs range(0) concurrent handshakes on a single thread, as a worker would during a handshake
+// storm. If range(1) is set, the server private key operations are offloaded to a thread pool
+// private key provider with range(1) threads.
+static void testHandshakeStorm(benchmark::State& state) {
+  std::string error;
+  std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
+      bazel::tools::cpp::runfiles::Runfiles::Create("tls_throughput_benchmark", &error));
+  Envoy::TestEnvironment::setRunfiles(runfiles.get());
+
+  const unsigned num_handshakes = state.range(0);
+  const unsigned num_threads = state.range(1);
+
+  bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+  std::string cert_path = TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem");
+  std::string key_path = TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem");
+  auto err = SSL_CTX_use_certificate_file(server_ctx.get(), cert_path.c_str(), SSL_FILETYPE_PEM);
+  drainErrorQueue();
+  RELEASE_ASSERT(err > 0, "SSL_CTX_use_certificate_file");
+  // Resumption would skip the private key operations.
+  SSL_CTX_set_session_cache_mode(server_ctx.get(), SSL_SESS_CACHE_OFF);
+  SSL_CTX_set_options(server_ctx.get(), SSL_OP_NO_TICKET);
+
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  testing::NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+  ON_CALL(factory_context.server_context_, api()).WillByDefault(testing::ReturnRef(*api));
+  std::shared_ptr<PrivateKeyMethodProvider::ThreadPool::ThreadPoolPrivateKeyMethodProvider>
+      provider;
+  if (num_threads > 0) {
+    envoy::extensions::private_key_providers::thread_pool::v3::ThreadPoolPrivateKeyMethodConfig
+        config;
+    config.mutable_private_key()->set_filename(key_path);
+    config.mutable_threads()->set_value(num_threads);
+    provider =
+        std::make_shared<PrivateKeyMethodProvider::ThreadPool::ThreadPoolPrivateKeyMethodProvider>(
+            config, factory_context);
+  } else {
+    err = SSL_CTX_use_PrivateKey_file(server_ctx.get(), key_path.c_str(), SSL_FILETYPE_PEM);
+    RELEASE_ASSERT(err > 0, "SSL_CTX_use_PrivateKey_file");
+  }
+  NoopPrivateKeyConnectionCallbacks callbacks;
+
+  struct Handshake {
+    int sockets_[2];
+    bssl::UniquePtr<SSL> server_ssl_;
+    bssl::UniquePtr<SSL> client_ssl_;
+    bool done_{};
+  };
+
+  uint64_t handshakes = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    state.PauseTiming();
+    std::vector<Handshake> storm(num_handshakes);
+    for (Handshake& handshake : storm) {
+      socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, handshake.sockets_);
+      handshake.server_ssl_.reset(SSL_new(server_ctx.get()));
+      SSL_set_fd(handshake.server_ssl_.get(), handshake.sockets_[0]);
+      SSL_set_accept_state(handshake.server_ssl_.get());
+      if (provider != nullptr) {
+        SSL_set_private_key_method(handshake.server_ssl_.get(),
+                                   provider->getBoringSslPrivateKeyMethod().get());
+        provider->registerPrivateKeyMethod(handshake.server_ssl_.get(), callbacks, *dispatcher);
+      }
+      handshake.client_ssl_.reset(SSL_new(client_ctx.get()));
+      SSL_set_fd(handshake.client_ssl_.get(), handshake.sockets_[1]);
+      SSL_set_connect_state(handshake.client_ssl_.get());
+    }
+    state.ResumeTiming();
+
+    unsigned remaining = num_handshakes;
+    while (remaining > 0) {
+      for (Handshake& handshake : storm) {
+        if (handshake.done_) {
+          continue;
+        }
+        int client_err = SSL_do_handshake(handshake.client_ssl_.get());
+        int server_err = SSL_do_handshake(handshake.server_ssl_.get());
+        if (client_err == 1 && server_err == 1) {
+          handshake.done_ = true;
+          remaining--;
+          continue;
+        }
+        handleSslError(handshake.client_ssl_.get(), client_err, false);
+        handleSslError(handshake.server_ssl_.get(), server_err, true);
+      }
+      // Deliver the completed private key operations.
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+    handshakes += num_handshakes;
+
+    state.PauseTiming();
+    for (Handshake& handshake : storm) {
+      if (provider != nullptr) {
+        provider->unregisterPrivateKeyMethod(handshake.server_ssl_.get());
+      }
+      ::close(handshake.sockets_[0]);
+      ::close(handshake.sockets_[1]);
+    }
+    state.ResumeTiming();
+  }
+  state.counters["handshakes"] = benchmark::Counter(handshakes, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(testHandshakeStorm)
+    ->Unit(::benchmark::kMillisecond)
+    ->ArgsProduct({{1, 64, 256}, {0, 1, 2, 4}})
+    ->UseRealTime();
+
 } // namespace Extensions::TransportSockets::Tls
 } // namespace Envoy
@@ -17,6 +17,7 @@ MockFilter::~MockFilter() = default;
 
 MockAccessLogManager::MockAccessLogManager() {
   ON_CALL(*this, createAccessLog(_)).WillByDefault(Return(file_));
+  ON_CALL(*this, createAccessLog(_, _)).WillByDefault(Return(file_));
 }
 
 MockAccessLogManager::~MockAccessLogManager() = default;
@@ -40,6 +40,8 @@ public:
   MOCK_METHOD(void, reopen, ());
   MOCK_METHOD(AccessLogFileSharedPtr, createAccessLog,
               (const Envoy::Filesystem::FilePathAndType& file_info));
+  MOCK_METHOD(AccessLogFileSharedPtr, createAccessLog,
+              (const Envoy::Filesystem::FilePathAndType& file_info, uint64_t write_ring_size));
 
   std::shared_ptr<MockAccessLogFile> file_{new testing::NiceMock<MockAccessLogFile>()};
 };
@@ -91,6 +91,9 @@ public:
     return timer;
   }
 
+  // Coarse timers are mocked as regular timers, so that MockTimer works for both.
+  Event::TimerPtr createCoarseTimer(Event::TimerCb cb) override { return createTimer(cb); }
+
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override {
     auto schedulable_cb = Event::SchedulableCallbackPtr{createSchedulableCallback_(cb)};
     if (!allow_null_callback_) {
@@ -143,6 +146,9 @@ public:
   MOCK_METHOD(bool, trackedObjectStackIsEmpty, (), (const));
   MOCK_METHOD(bool, isThreadSafe, (), (const));
   Buffer::WatermarkFactory& getWatermarkFactory() override { return buffer_factory_; }
+  const ConnectionReadBudget& connectionReadBudget() const override {
+    return connection_read_budget_;
+  }
   MOCK_METHOD(Thread::ThreadId, getCurrentThreadId, ());
   MOCK_METHOD(MonotonicTime, approximateMonotonicTime, (), (const));
   MOCK_METHOD(void, updateApproximateMonotonicTime, ());
@@ -151,6 +157,7 @@ public:
   std::unique_ptr<TimeSource> time_system_;
   std::list<DeferredDeletablePtr> to_delete_;
   testing::NiceMock<MockBufferFactory> buffer_factory_;
+  ConnectionReadBudget connection_read_budget_;
   bool allow_null_callback_{};
 
 private:
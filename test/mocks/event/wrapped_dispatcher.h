@@ -69,6 +69,8 @@ public:
     return impl_.createScaledTimer(timer_type, std::move(cb));
   }
 
+  TimerPtr createCoarseTimer(TimerCb cb) override { return impl_.createCoarseTimer(std::move(cb)); }
+
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override {
     return impl_.createSchedulableCallback(std::move(cb));
   }
@@ -108,6 +110,10 @@ public:
 
   void updateApproximateMonotonicTime() override { impl_.updateApproximateMonotonicTime(); }
 
+  const ConnectionReadBudget& connectionReadBudget() const override {
+    return impl_.connectionReadBudget();
+  }
+
   bool isThreadSafe() const override { return impl_.isThreadSafe(); }
 
   void shutdown() override { impl_.shutdown(); }
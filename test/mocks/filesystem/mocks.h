@@ -68,6 +68,7 @@ public:
   MOCK_METHOD(bool, illegalPath, (const std::string&));
   MOCK_METHOD(Api::IoCallResult<FileInfo>, stat, (absl::string_view));
   MOCK_METHOD(Api::IoCallBoolResult, createPath, (absl::string_view));
+  MOCK_METHOD(Api::IoCallBoolResult, rename, (const std::string&, const std::string&));
 };
 
 class MockWatcher : public Watcher {
@@ -37,6 +37,7 @@ public:
               (ResponseDecoder & response_decoder, Callbacks& callbacks,
                const Instance::StreamOptions&));
   MOCK_METHOD(bool, maybePreconnect, (float));
+  MOCK_METHOD(uint32_t, prewarm, (uint32_t, uint32_t));
   MOCK_METHOD(Upstream::HostDescriptionConstSharedPtr, host, (), (const));
   MOCK_METHOD(absl::string_view, protocolDescription, (), (const));
 
@@ -182,6 +182,8 @@ public:
   MOCK_METHOD(void, addStreamFilter, (Http::StreamFilterSharedPtr filter));
   MOCK_METHOD(void, addAccessLogHandler, (AccessLog::InstanceSharedPtr handler));
   MOCK_METHOD(Event::Dispatcher&, dispatcher, ());
+  MOCK_METHOD(OptRef<Arena>, streamArena, ());
+  MOCK_METHOD(void, addFilterReleaseCallbacks, (Http::FilterReleaseCallbacks & callbacks));
 };
 
 class MockFilterChainManager : public FilterChainManager {
@@ -194,6 +194,20 @@ TEST_P(ActiveUdpListenerTest, MultipleFiltersOnReceiveErrorStopIteration) {
   active_listener_->onReceiveError(Api::IoError::IoErrorCode::UnknownError);
 }
 
+TEST_P(ActiveUdpListenerTest, DatagramsForwardedToOtherWorker) {
+  setup(2);
+
+  Network::UdpRecvData data;
+  active_listener_->onData(std::move(data));
+  EXPECT_EQ(0, store_.counterFromString("udp.downstream_rx_datagram_forwarded").value());
+
+  // The datagrams owned by another worker are forwarded to it across threads.
+  active_listener_->destination_ = 1;
+  Network::UdpRecvData data2;
+  active_listener_->onData(std::move(data2));
+  EXPECT_EQ(1, store_.counterFromString("udp.downstream_rx_datagram_forwarded").value());
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
@@ -126,6 +126,22 @@ Api::IoCallBoolResult MemfileInstanceImpl::createPath(absl::string_view) {
   return resultSuccess(true);
 }
 
+Api::IoCallBoolResult MemfileInstanceImpl::rename(const std::string& old_path,
+                                                  const std::string& new_path) {
+  absl::MutexLock m(&lock_);
+  if (!use_memfiles_) {
+    return file_system_->rename(old_path, new_path);
+  }
+  auto it = files_.find(old_path);
+  if (it == files_.end()) {
+    return resultFailure(false, ENOENT);
+  }
+  std::shared_ptr<MemFileInfo> info = std::move(it->second);
+  files_.erase(it);
+  files_[new_path] = std::move(info);
+  return resultSuccess(true);
+}
+
 MemfileInstanceImpl::MemfileInstanceImpl() : file_system_{new InstanceImpl()} {}
 
 MemfileInstanceImpl& fileSystemForTest() {
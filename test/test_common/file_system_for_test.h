@@ -44,6 +44,8 @@ public:
 
   Api::IoCallBoolResult createPath(absl::string_view path) override;
 
+  Api::IoCallBoolResult rename(const std::string& old_path, const std::string& new_path) override;
+
 private:
   friend class ScopedUseMemfiles;
 